@@ -0,0 +1,154 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   CachingDatabase.h
+///
+
+#ifndef QC_REPOSITORY_CACHINGDATABASE_H
+#define QC_REPOSITORY_CACHINGDATABASE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "QualityControl/DatabaseInterface.h"
+
+namespace o2::monitoring
+{
+class Monitoring;
+}
+
+namespace o2::quality_control::repository
+{
+
+/// \brief Configuration of the CachingDatabase.
+///
+/// It is extracted from the "database" section of the configuration, all keys are optional.
+struct CachingDatabaseConfig {
+  bool enabled = false;          // "cache"
+  size_t maxBytes = 256 << 20;   // "cacheMaxBytes", serialized size of the objects kept in memory
+  std::string directory;         // "cacheDirectory", no on-disk cache if empty
+
+  static CachingDatabaseConfig fromDatabaseConfig(const std::unordered_map<std::string, std::string>& databaseConfig);
+};
+
+/// \brief Decorator of a DatabaseInterface which caches the retrieved objects.
+///
+/// The objects returned by retrieveTObject, retrieveMO and retrieveQO are kept serialized in memory, in a LRU cache
+/// bounded by their size in bytes, and optionally in a directory, in files named after the path, the validity and
+/// the ETag of the objects. The directory can be shared by consecutive or concurrent processes.
+/// A cached object is used only if its validity covers the requested timestamp. If its validity has not ended yet,
+/// newer versions might still be uploaded, so it is used only if the database still serves the same object for this
+/// timestamp, i.e. with the same ETag and Last-Modified headers. The check relies on DatabaseInterface::retrieveHeaders,
+/// which does not download the object, and is also needed to find an object in the cache directory.
+/// If a function providing the latest versions known from recent listings is set (see setLatestVersionFcn), an object
+/// cached in memory is used without this request when no version of its path was modified after it was created.
+/// The listings might miss the versions uploaded during their refresh period, like the NewObject triggers which fetch them.
+/// Objects whose validity has ended are trusted without asking the database. Queries for the latest object are not cached.
+/// All the other methods are forwarded to the decorated database.
+class CachingDatabase : public DatabaseInterface
+{
+ public:
+  struct Statistics {
+    size_t hits = 0;        // objects found in memory
+    size_t listed = 0;      // hits validated with a listing instead of a request to the database
+    size_t diskHits = 0;    // objects found in the cache directory
+    size_t misses = 0;      // objects retrieved from the database
+    size_t outdated = 0;    // cached objects which were replaced in the database
+    size_t evictions = 0;   // objects removed from memory to respect the maximum size
+    size_t bytes = 0;       // current size of the objects in memory
+    size_t entries = 0;     // current number of objects in memory
+  };
+
+  /// Returns the modification time of the latest version of an object, if it is known from a recent listing
+  using LatestVersionFcn = std::function<std::optional<uint64_t>(const std::string& path, const std::map<std::string, std::string>& metadata)>;
+
+  CachingDatabase(std::unique_ptr<DatabaseInterface> database, CachingDatabaseConfig config);
+  ~CachingDatabase() override;
+
+  /// \brief Lets the cache validate its objects with listings which are fetched anyway, see the class description.
+  void setLatestVersionFcn(LatestVersionFcn latestVersion);
+
+  void connect(const std::string& host, const std::string& database, const std::string& username, const std::string& password) override;
+  void connect(const std::unordered_map<std::string, std::string>& config) override;
+
+  void storeAny(const void* obj, std::type_info const& typeInfo, std::string const& path, std::map<std::string, std::string> const& metadata,
+                std::string const& detectorName, std::string const& taskName, long from = -1, long to = -1) override;
+  void storeMO(std::shared_ptr<const o2::quality_control::core::MonitorObject> mo) override;
+  void storeQO(std::shared_ptr<const o2::quality_control::core::QualityObject> qo) override;
+
+  void* retrieveAny(std::type_info const& tinfo, std::string const& path,
+                    std::map<std::string, std::string> const& metadata, long timestamp = Timestamp::Current,
+                    std::map<std::string, std::string>* headers = nullptr,
+                    const std::string& createdNotAfter = "", const std::string& createdNotBefore = "") override;
+  std::shared_ptr<o2::quality_control::core::MonitorObject> retrieveMO(std::string objectPath, std::string objectName,
+                                                                       long timestamp = Timestamp::Current,
+                                                                       const core::Activity& activity = {},
+                                                                       const std::map<std::string, std::string>& metadata = {}) override;
+  std::shared_ptr<o2::quality_control::core::QualityObject> retrieveQO(std::string qoPath, long timestamp = Timestamp::Current,
+                                                                       const core::Activity& activity = {},
+                                                                       const std::map<std::string, std::string>& metadata = {}) override;
+  TObject* retrieveTObject(std::string path, const std::map<std::string, std::string>& metadata, long timestamp = Timestamp::Current, std::map<std::string, std::string>* headers = nullptr) override;
+  std::map<std::string, std::string> retrieveHeaders(const std::string& path, const std::map<std::string, std::string>& metadata, long timestamp) override;
+  std::string retrieveJson(std::string path, long timestamp, const std::map<std::string, std::string>& metadata) override;
+
+  void disconnect() override;
+  void prepareTaskDataContainer(std::string taskName) override;
+  std::vector<std::string> getPublishedObjectNames(std::string taskName) override;
+  void truncate(std::string path, std::string objectName) override;
+  void setMaxObjectSize(size_t maxObjectSize) override;
+  core::ValidityInterval getLatestObjectValidity(const std::string& path, const std::map<std::string, std::string>& metadata = {}) override;
+
+  Statistics getStatistics() const;
+  /// \brief Sends the statistics of the cache as the metric "qc_object_cache".
+  void sendMetrics(o2::monitoring::Monitoring& collector) const;
+  void clear();
+
+ private:
+  struct Entry {
+    std::string key;
+    long validFrom;
+    long validUntil;
+    std::map<std::string, std::string> headers;
+    std::vector<char> payload; // the object serialized with TBufferFile
+  };
+
+  static std::string makeKey(const std::string& path, const std::map<std::string, std::string>& metadata);
+  bool isLatestInListing(const std::string& path, const std::map<std::string, std::string>& metadata, const Entry& entry) const;
+  std::shared_ptr<const Entry> findInMemory(const std::string& key, long timestamp);
+  void eraseFromMemory(const std::string& key, long validFrom);
+  void insertInMemory(std::shared_ptr<const Entry> entry);
+  std::string diskPath(const std::string& key, long validFrom, long validUntil, const std::string& etag) const;
+  std::shared_ptr<const Entry> readFromDisk(const std::string& key, const std::map<std::string, std::string>& currentHeaders) const;
+  void writeToDisk(const Entry& entry) const;
+
+  std::unique_ptr<DatabaseInterface> mDatabase;
+  CachingDatabaseConfig mConfig;
+  LatestVersionFcn mLatestVersion;
+
+  mutable std::mutex mMutex;
+  std::list<std::shared_ptr<const Entry>> mLru; // most recently used first
+  std::unordered_multimap<std::string, std::list<std::shared_ptr<const Entry>>::iterator> mIndex;
+  Statistics mStatistics;
+};
+
+} // namespace o2::quality_control::repository
+
+#endif // QC_REPOSITORY_CACHINGDATABASE_H
@@ -88,6 +88,20 @@ class CcdbDatabase : public DatabaseInterface
   // retrieval - general
   std::string retrieveJson(std::string path, long timestamp, const std::map<std::string, std::string>& metadata) override;
   TObject* retrieveTObject(std::string path, const std::map<std::string, std::string>& metadata, long timestamp = Timestamp::Current, std::map<std::string, std::string>* headers = nullptr) override;
+  std::map<std::string, std::string> retrieveHeaders(const std::string& path, const std::map<std::string, std::string>& metadata, long timestamp) override;
+
+  /**
+   * \brief Builds a MonitorObject out of an object retrieved at fullPath and its headers.
+   * It takes the ownership of obj, it returns nullptr if obj is not in a format we know.
+   */
+  static std::shared_ptr<o2::quality_control::core::MonitorObject> makeMonitorObject(TObject* obj, std::map<std::string, std::string>& headers,
+                                                                                     const std::string& fullPath, const std::string& provenance);
+  /**
+   * \brief Builds a QualityObject out of an object retrieved at fullPath and its headers.
+   * It takes the ownership of obj, it returns nullptr if obj is not a QualityObject.
+   */
+  static std::shared_ptr<o2::quality_control::core::QualityObject> makeQualityObject(TObject* obj, const std::map<std::string, std::string>& headers,
+                                                                                     const std::string& fullPath, const std::string& provenance);
 
   void disconnect() override;
   void prepareTaskDataContainer(std::string taskName) override;
@@ -111,6 +125,15 @@ class CcdbDatabase : public DatabaseInterface
    */
   boost::property_tree::ptree getListingAsPtree(const std::string& path, const std::map<std::string, std::string>& metadata = {}, bool latestOnly = false);
 
+  /**
+   * Return the listing of objects in the path as returned by the server in JSON format
+   * @param path the folder we want to list the children of, it may contain regular expressions.
+   * @param metadata metadata to filter queried objects.
+   * @param latestOnly return only the latest object matching the path and metadata.
+   * @return The listing in JSON format, as a string
+   */
+  std::string getListingAsJson(const std::string& path, const std::map<std::string, std::string>& metadata = {}, bool latestOnly = false);
+
   /**
    * Return validity of the latest matching object
    * @param path the folder we want to list the children of.
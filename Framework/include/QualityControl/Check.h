@@ -16,6 +16,8 @@
 #include <map>
 #include <vector>
 #include <memory>
+#include <string>
+#include <unordered_map>
 // O2
 #include <Framework/DataProcessorSpec.h>
 // QC
@@ -86,6 +88,13 @@ class Check
 
   CheckConfig mCheckConfig;
   CheckInterface* mCheckInterface = nullptr;
+  struct BeautifiedObject {
+    std::weak_ptr<core::MonitorObject> object;
+    core::Quality quality;
+  };
+  // the last beautified object of each name and the quality it was beautified for,
+  // the CheckRunner reuses the objects when their message did not change
+  std::unordered_map<std::string, BeautifiedObject> mBeautifiedObjects;
 };
 
 } // namespace o2::quality_control::checker
@@ -24,6 +24,7 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <unordered_map>
 #include <unordered_set>
 // O2
 #include <Common/Timer.h>
@@ -35,17 +36,20 @@
 #include "QualityControl/Check.h"
 #include "QualityControl/MonitorObject.h"
 #include "QualityControl/QualityObject.h"
+#include "QualityControl/SerializedInput.h"
 #include "QualityControl/UpdatePolicyManager.h"
 
 namespace o2::quality_control::core
 {
 class ServiceDiscovery;
-}
+class ThreadPool;
+} // namespace o2::quality_control::core
 
 namespace o2::quality_control::repository
 {
 class DatabaseInterface;
-}
+class StorageQueue;
+} // namespace o2::quality_control::repository
 
 namespace o2::framework
 {
@@ -60,6 +64,7 @@ class Monitoring;
 }
 
 class TClass;
+class TObjArray;
 
 // todo: do not expose other namespaces in headers
 using namespace o2::quality_control::core;
@@ -132,6 +137,16 @@ class CheckRunner : public framework::Task
   /// If all checks belong to the same detector we use it, otherwise we use "MANY"
   static std::string getDetectorName(const std::vector<CheckConfig> checks);
 
+  /// \brief Groups the checks which cannot be executed concurrently.
+  /// Checks are put in the same group if one of them beautifies an object used by the other one.
+  /// \return Indices of the checks in each group, in increasing order. Groups are sorted by their first index.
+  static std::vector<std::vector<size_t>> groupChecksSharingObjects(const std::vector<CheckConfig>& checks);
+
+  /// \brief Creates the cycle manifest of each task whose MonitorObjects are provided, see storeCycleManifests.
+  /// The manifest is a MonitorObject of the task named RepoPathUtils::cycleManifestName, which contains a TList with
+  /// the names of the objects. It has the activity and the cycle number of the first object and the union of the validities.
+  static std::vector<std::shared_ptr<MonitorObject>> makeCycleManifests(const std::vector<std::shared_ptr<MonitorObject>>& monitorObjects);
+
  private:
   /**
    * \brief Evaluate the quality of a MonitorObject.
@@ -159,6 +174,15 @@ class CheckRunner : public framework::Task
    */
   void store(std::vector<std::shared_ptr<MonitorObject>>& monitorObjects, long validFrom);
 
+  /**
+   * \brief Store a manifest for each task whose MonitorObjects were just stored.
+   *
+   * The manifest is stored after the MonitorObjects, in the folder of the task. It contains their names, their
+   * cycle number and validity. NewObject triggers wait for it to be sure that the task's objects are all available.
+   * Manifests are never dropped: if the storage queue is full, the queue is flushed and the manifest is stored synchronously.
+   */
+  void storeCycleManifests(const std::vector<std::shared_ptr<MonitorObject>>& monitorObjects);
+
   /**
    * \brief Send the QualityObjects on the DataProcessor output channel.
    */
@@ -196,9 +220,31 @@ class CheckRunner : public framework::Task
    * in case an external device is sending the data.
    * This method first transform the data in order to have a TObjArray of MonitorObjects.
    * It then stores these objects in the cache.
+   * The messages are deserialized only if the objects are stored or if we do not know yet which objects they contain.
+   * Otherwise, the objects are only marked as updated and deserialized when a Check which needs them is ready.
    * @param ctx
    */
   void prepareCacheData(framework::InputRecord& inputRecord);
+  /**
+   * \brief Deserialize the pending message of an input and put its MonitorObjects in the cache.
+   * @return The MonitorObjects received in this message. Markers of unchanged objects are replaced by the
+   *         cached objects, with their validity extended.
+   */
+  std::vector<std::shared_ptr<MonitorObject>> deserializeInput(const framework::InputSpec& input, SerializedInput& serializedInput);
+  /**
+   * \brief Put the MonitorObjects of a deserialized message in the cache, see deserializeInput.
+   * The array does not own its objects, their ownership is taken by the returned MonitorObjects and the cache.
+   * An encoded MonitorObjectCollection is decoded first. If it cannot be decoded, its objects are skipped.
+   */
+  std::vector<std::shared_ptr<MonitorObject>> cacheMonitorObjects(const framework::InputSpec& input, TObjArray& array, SerializedInput& serializedInput);
+  /**
+   * \brief Deserialize the messages of the given inputs which have not been deserialized yet.
+   */
+  void deserializePendingInputs(const framework::Inputs& inputs);
+  /**
+   * \brief Copy the payloads of the messages which are still pending, before DPL releases them at the end of run().
+   */
+  void keepPendingInputs();
   /**
    * Send metrics to the monitoring system if the time has come.
    */
@@ -218,6 +264,8 @@ class CheckRunner : public framework::Task
   std::shared_ptr<Activity> mActivity; // shareable with the Checks
   CheckRunnerConfig mConfig;
   std::shared_ptr<o2::quality_control::repository::DatabaseInterface> mDatabase;
+  std::shared_ptr<o2::quality_control::repository::StorageQueue> mStorageQueue; // set only if the asynchronous storage is enabled
+  std::shared_ptr<o2::quality_control::core::ThreadPool> mCheckPool;             // set only if checks are executed in parallel
   std::unordered_set<std::string> mInputStoreSet;
   std::vector<std::shared_ptr<MonitorObject>> mMonitorObjectStoreVector;
   UpdatePolicyManager updatePolicyManager;
@@ -229,6 +277,7 @@ class CheckRunner : public framework::Task
 
   // Checks cache
   std::map<std::string, std::shared_ptr<MonitorObject>> mMonitorObjects;
+  std::unordered_map<std::string /* input label */, SerializedInput> mSerializedInputs; // deserialized only when needed
 
   // Service discovery
   std::shared_ptr<ServiceDiscovery> mServiceDiscovery;
@@ -237,12 +286,14 @@ class CheckRunner : public framework::Task
   // monitoring
   std::shared_ptr<o2::monitoring::Monitoring> mCollector;
   int mTotalNumberObjectsReceived;
+  int mTotalNumberMessagesDeserialized = 0;
   int mTotalNumberCheckExecuted;
   int mTotalNumberQOStored;
   int mTotalNumberMOStored;
   int mTotalQOSent;
   int mNumberQOStored = 0; // since the last publication of the monitoring data
   int mNumberMOStored = 0; // since the last publication of the monitoring data
+  int mTotalNumberManifestsNotQueued = 0; // dropped by the storage queue and stored synchronously
   AliceO2::Common::Timer mTimer;
   AliceO2::Common::Timer mTimerTotalDurationActivity;
 };
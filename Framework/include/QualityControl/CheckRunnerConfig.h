@@ -33,6 +33,7 @@ struct CheckRunnerConfig {
   core::LogDiscardParameters infologgerDiscardParameters;
   core::Activity fallbackActivity;
   framework::Options options{};
+  size_t checkThreads = 1; // number of threads executing the ready Checks, they are executed sequentially if 1
 };
 
 } // namespace o2::quality_control::checker
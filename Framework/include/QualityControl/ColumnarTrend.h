@@ -0,0 +1,71 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    ColumnarTrend.h
+///
+
+#ifndef QUALITYCONTROL_COLUMNARTREND_H
+#define QUALITYCONTROL_COLUMNARTREND_H
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class TTree;
+
+namespace o2::quality_control::postprocessing
+{
+
+/// \brief In-memory copy of the numeric leaves of a trend TTree, with one contiguous vector per leaf.
+///
+/// It is kept next to the TTree, which stays the stored format of the trend, and allows to obtain the values
+/// of simple expressions like "source.mean:time" or "source.mean:meta.runNumber" without evaluating TTree formulas.
+/// The columns are named "branch.leaf", while the leaves named like their branch (e.g. "time") are also available
+/// under the branch name. Character strings and arrays are not copied.
+class ColumnarTrend
+{
+ public:
+  /// The values of a "y:x" expression
+  struct Series {
+    const std::vector<double>& y;
+    const std::vector<double>& x;
+  };
+
+  ColumnarTrend() = default;
+  ~ColumnarTrend() = default;
+
+  /// \brief Appends the values currently in the buffers of the tree's leaves, i.e. the last filled or read entry.
+  void appendCurrent(TTree& tree);
+  /// \brief Replaces the columns with all the entries of the tree.
+  void readFrom(TTree& tree);
+  void clear();
+
+  size_t size() const { return mSize; }
+  /// Returns the column of a leaf, nullptr if there is no such column
+  const std::vector<double>* getColumn(const std::string& name) const;
+
+  /// \brief Returns the values of a two-dimensional expression of plain leaf names, without a selection.
+  /// Returns nothing if the expression is anything more complex, it should be evaluated with TTree::Draw then.
+  std::optional<Series> evaluate(const std::string& varexp, const std::string& selection) const;
+
+ private:
+  static bool isPlainName(const std::string& expression);
+
+  std::unordered_map<std::string, std::vector<double>> mColumns;
+  std::unordered_map<std::string, std::string> mAliases; // "branch.leaf" -> "leaf" for the leaves named like their branch
+  size_t mSize = 0;
+};
+
+} // namespace o2::quality_control::postprocessing
+
+#endif // QUALITYCONTROL_COLUMNARTREND_H
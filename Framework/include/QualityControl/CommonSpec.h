@@ -47,6 +47,7 @@ struct CommonSpec {
   std::string bookkeepingUrl;
   std::string kafkaBrokersUrl;
   std::string kafkaTopicAliECSRun = "aliecs.run";
+  size_t checkRunnerThreads = 1;
 };
 
 } // namespace o2::quality_control::core
@@ -19,6 +19,8 @@
 #define QC_REPOSITORY_DATABASEFACTORY_H
 
 #include <memory>
+#include <string>
+#include <unordered_map>
 // QC
 #include "QualityControl/DatabaseInterface.h"
 
@@ -35,6 +37,11 @@ class DatabaseFactory
   /// \param name Possible values : "MySql", "CCDB"
   /// \author Barthelemy von Haller
   static std::unique_ptr<DatabaseInterface> create(std::string name);
+
+  /// \brief Create a new instance of a DatabaseInterface from the "database" section of the configuration.
+  /// The implementation is chosen with the key "implementation", the instance is wrapped in a CachingDatabase if the
+  /// cache is enabled. It is not connected yet.
+  static std::unique_ptr<DatabaseInterface> create(const std::unordered_map<std::string, std::string>& databaseConfig);
 };
 
 } // namespace o2::quality_control::repository
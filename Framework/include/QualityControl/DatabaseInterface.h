@@ -162,6 +162,19 @@ class DatabaseInterface
    */
   virtual TObject* retrieveTObject(std::string path, const std::map<std::string, std::string>& metadata, long timestamp = Timestamp::Current, std::map<std::string, std::string>* headers = nullptr) = 0;
 
+  /**
+   * \brief Look up an object and return its headers, without downloading it.
+   * It is meant to check cheaply whether an object changed (ETag, Last-Modified, validity).
+   * \param path the path of the object
+   * \param metadata filters under the form of key-value pairs to select data
+   * \param timestamp the timestamp to query the object
+   * \return the headers of the object, or an empty map if it was not found or the implementation does not support it.
+   */
+  virtual std::map<std::string, std::string> retrieveHeaders(const std::string& path, const std::map<std::string, std::string>& metadata, long timestamp)
+  {
+    return {};
+  }
+
   /**
    * \brief Look up an object and return it in JSON format.
    * Look up an object and return it in JSON format if found or an empty string if not.
@@ -0,0 +1,96 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    DownsampledTrend.h
+///
+
+#ifndef QUALITYCONTROL_DOWNSAMPLEDTREND_H
+#define QUALITYCONTROL_DOWNSAMPLEDTREND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+class TGraph;
+class TGraphAsymmErrors;
+
+namespace o2::quality_control::postprocessing
+{
+
+/// \brief A time series of bounded size, which keeps the recent points at full resolution and aggregates older ones.
+///
+/// The points are kept in tiers of at most `capacity` points each. New points enter the first tier. When a tier
+/// is full, its `factor` oldest points are aggregated into one point (min, mean, max, time span) which enters the next
+/// tier, while the points overflowing the last tier are dropped. Thus, the trend never holds more than
+/// `capacity * tiers` points, whatever its length in time. A capacity of 0 means that nothing is ever aggregated.
+class DownsampledTrend
+{
+ public:
+  struct Point {
+    double timeStart = 0;
+    double timeEnd = 0;
+    double min = 0;
+    double max = 0;
+    double sum = 0;
+    uint64_t count = 0;
+
+    double mean() const { return count > 0 ? sum / count : 0; }
+    double time() const { return (timeStart + timeEnd) / 2; }
+  };
+
+  explicit DownsampledTrend(size_t capacity = 0, size_t tiers = 3, size_t factor = 10);
+  ~DownsampledTrend() = default;
+
+  /// \brief Adds a measurement. Points are expected to come in increasing time order.
+  void add(double time, double value);
+  /// \brief Adds an already aggregated point.
+  void add(const Point& point);
+  /// \brief Merges another trend. The points of both are inserted again in time order into this trend,
+  /// so the result respects the capacity of this trend.
+  void merge(const DownsampledTrend& other);
+  void clear();
+
+  /// Returns the points from the oldest to the most recent one
+  std::vector<Point> getPoints() const;
+  size_t size() const;
+  bool empty() const { return size() == 0; }
+  /// The maximum number of points kept in the trend, 0 if unlimited
+  size_t getMaxSize() const { return mCapacity * mTiers.size(); }
+
+  /// \brief Replaces the points of the graph with the means of the trend points.
+  void fill(TGraph& graph) const;
+  /// \brief Replaces the points of the graph with the means of the trend points, the errors spanning [min, max].
+  void fill(TGraphAsymmErrors& graph) const;
+
+  /// \brief Selects which of the samples of a series should be kept to obtain a similar time resolution as with
+  /// the tiers of a DownsampledTrend, for series which cannot be aggregated.
+  ///
+  /// The newest `capacity` samples are all kept. Older samples are binned in time, with bins `factor` times wider in
+  /// each next tier, and only the most recent sample of each bin is kept. Each tier spans at most `capacity` bins,
+  /// the samples older than the last tier are dropped. The bins are aligned to multiples of their widths, so that
+  /// selecting again among the selected samples keeps them, unless they moved to a coarser tier.
+  /// \param times sample times, in increasing order
+  /// \return indices of the samples to keep, in increasing order
+  static std::vector<size_t> selectSamples(const std::vector<double>& times, size_t capacity, size_t tiers, size_t factor);
+
+ private:
+  void push(size_t tier, const Point& point);
+
+  size_t mCapacity;
+  size_t mFactor;
+  std::vector<std::deque<Point>> mTiers; // the first one has the most recent points
+};
+
+} // namespace o2::quality_control::postprocessing
+
+#endif // QUALITYCONTROL_DOWNSAMPLEDTREND_H
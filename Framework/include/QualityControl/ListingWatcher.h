@@ -0,0 +1,116 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    ListingWatcher.h
+///
+
+#ifndef QUALITYCONTROL_LISTINGWATCHER_H
+#define QUALITYCONTROL_LISTINGWATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace o2::quality_control::postprocessing
+{
+
+/// \brief Watches the latest versions of objects in a CCDB-like database on behalf of many subscribers.
+///
+/// NewObject triggers of all the post-processing tasks in a process subscribe to the watcher of their database.
+/// Subscriptions are grouped by the parent folder of the object path and by metadata, and each group is refreshed
+/// with a single listing of the latest objects in the folder, at most once per refresh period, whichever subscriber
+/// asks for it. The listing is parsed with a streaming JSON parser which keeps only the fields needed to detect
+/// new versions. A subscriber is notified of a new version of its object once, at the next poll.
+class ListingWatcher
+{
+ public:
+  struct ObjectVersion {
+    std::string path;
+    uint64_t validFrom = 0;
+    uint64_t validUntil = 0;
+    uint64_t lastModified = 0;
+    std::string cycleNumber;
+  };
+  /// Returns the JSON listing of the latest objects matching the path pattern and the metadata
+  using ListingFcn = std::function<std::string(const std::string& pathPattern, const std::map<std::string, std::string>& metadata)>;
+  using SubscriptionId = size_t;
+  /// A new object version is noticed at most this long after it was stored
+  static constexpr std::chrono::milliseconds defaultRefreshPeriod{ 1000 };
+
+  explicit ListingWatcher(ListingFcn listing, std::chrono::milliseconds refreshPeriod = defaultRefreshPeriod);
+  ~ListingWatcher() = default;
+
+  /// \brief Returns the watcher shared within the process for the given database, creating it if needed.
+  static std::shared_ptr<ListingWatcher> forDatabase(const std::string& databaseUrl);
+
+  /// \brief Subscribes to new versions of an object.
+  /// The version which is the latest at the moment of subscription is not notified.
+  SubscriptionId subscribe(const std::string& path, const std::map<std::string, std::string>& metadata);
+  void unsubscribe(SubscriptionId id);
+  /// \brief Returns the latest version of the object if it changed since the previous notification.
+  /// It refreshes the listing of the subscription's group if it is older than the refresh period.
+  std::optional<ObjectVersion> poll(SubscriptionId id);
+  /// \brief Returns the latest known version of the object, whether it was notified or not.
+  /// It refreshes the listing of the subscription's group if it is older than the refresh period.
+  std::optional<ObjectVersion> getLatest(SubscriptionId id);
+  /// \brief Returns the latest version of the object in the listings refreshed less than a refresh period ago.
+  /// No listing is requested. Only the groups whose metadata are a subset of the given metadata are considered,
+  /// so that they list all the objects which match them. Returns nothing if no such group lists the object.
+  std::optional<ObjectVersion> findRecent(const std::string& path, const std::map<std::string, std::string>& metadata);
+
+  /// \brief Extracts the object versions from a JSON listing of the CCDB, without building a DOM.
+  static std::vector<ObjectVersion> parseListing(std::string_view json);
+
+  /// Number of listings requested to the database so far
+  size_t getListingCount() const;
+
+ private:
+  struct Subscription {
+    std::string path;
+    std::string groupKey;
+    uint64_t lastNotified = 0;
+  };
+  struct Group {
+    std::string pathPattern;
+    std::map<std::string, std::string> metadata;
+    std::mutex mutex; // serializes the refreshes of this group
+    std::chrono::steady_clock::time_point lastRefresh{};
+    std::chrono::steady_clock::time_point lastListing{}; // the last refresh which returned a valid listing
+    std::unordered_map<std::string, ObjectVersion> latest; // by object path
+    size_t subscribers = 0;
+  };
+
+  static std::string folderOf(const std::string& path);
+  void refreshIfOutdated(Group& group);
+
+  ListingFcn mListing;
+  std::chrono::milliseconds mRefreshPeriod;
+
+  std::mutex mMutex; // protects the maps below
+  std::unordered_map<std::string, std::shared_ptr<Group>> mGroups;
+  std::unordered_map<SubscriptionId, Subscription> mSubscriptions;
+  SubscriptionId mNextId = 0;
+  std::atomic<size_t> mListingCount = 0;
+};
+
+} // namespace o2::quality_control::postprocessing
+
+#endif // QUALITYCONTROL_LISTINGWATCHER_H
@@ -0,0 +1,141 @@
+// Copyright 2019-2022 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   MockCcdbServer.h
+///
+
+#ifndef QC_REPOSITORY_MOCKCCDBSERVER_H
+#define QC_REPOSITORY_MOCKCCDBSERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace o2::quality_control::core
+{
+class ThreadPool;
+}
+
+namespace o2::quality_control::repository
+{
+
+/// \brief A local HTTP server standing in for the CCDB, which can be given as the database host of CcdbDatabase.
+///
+/// It implements the subset of the CCDB REST API used by the QC:
+/// - POST /path/from/until/key=value/...           stores an object (multipart upload)
+/// - GET|HEAD /path[/timestamp][/id][/key=value/...] retrieves the newest object valid at the timestamp, with its
+///                                                  validity, creation time and metadata as headers
+/// - PUT /path/timestamp[/id]?key=value&...        updates the metadata of an object
+/// - GET /browse/pattern[/key=value/...]           lists all the versions of the matching objects, newest first
+/// - GET /latest/pattern[/key=value/...]           lists the newest version of each matching object
+/// - DELETE /truncate/pattern, DELETE /path[/timestamp/id]
+/// The listings are JSON if requested with "Accept: application/json", text otherwise.
+///
+/// The objects are kept in memory, or in a directory if one is given, in which case they survive a restart.
+/// A latency can be added to every response and a fraction of the requests can be answered with errors, in order to
+/// test the clients against a slow or failing database. The connections are served by a pool of threads.
+class MockCcdbServer
+{
+ public:
+  struct Options {
+    uint16_t port = 0;                      // 0 lets the system pick a free port
+    std::string storageDirectory;           // empty to keep the objects in memory
+    std::chrono::milliseconds latency{ 0 }; // added to each response
+    double errorRate = 0;                   // fraction of the requests answered with "503 Service Unavailable"
+    size_t threads = 4;
+    unsigned seed = 0; // of the error injection
+  };
+
+  struct Statistics {
+    size_t requests = 0;
+    size_t storedObjects = 0;
+    size_t storedBytes = 0; // size of the upload requests bodies
+    size_t retrievals = 0;
+    size_t listings = 0;
+    size_t injectedErrors = 0;
+  };
+
+  explicit MockCcdbServer(uint16_t port = 0);
+  explicit MockCcdbServer(Options options);
+  ~MockCcdbServer();
+  MockCcdbServer(const MockCcdbServer&) = delete;
+  MockCcdbServer& operator=(const MockCcdbServer&) = delete;
+
+  void start();
+  void stop();
+
+  uint16_t getPort() const { return mPort; }
+  /// \brief The URL to use as the host of the database, e.g. "http://127.0.0.1:8084"
+  std::string getUrl() const;
+  Statistics getStatistics() const;
+  void resetStatistics();
+  /// \brief Number of stored object versions
+  size_t getNumberOfObjects() const;
+
+ private:
+  struct Request;
+  struct Response;
+  struct StoredObject {
+    std::string id;
+    std::string path;
+    long validFrom = 0;
+    long validUntil = 0;
+    long created = 0;
+    long lastModified = 0;
+    std::string fileName;
+    std::string contentType;
+    size_t size = 0;
+    std::map<std::string, std::string> metadata;
+    std::shared_ptr<const std::string> content; // null if it is in the storage directory
+  };
+
+  void serve();
+  void handleConnection(int socket);
+  Response handle(const Request& request);
+  Response store(const Request& request);
+  Response retrieve(const Request& request, bool withContent);
+  Response list(const Request& request, bool latestOnly);
+  Response updateMetadata(const Request& request);
+  Response remove(const Request& request);
+
+  long nextCreationTime();
+  void loadIndex();
+  void saveIndex() const;
+  std::string readContent(const StoredObject& object) const;
+
+  Options mOptions;
+  int mListeningSocket = -1;
+  uint16_t mPort = 0;
+  std::thread mThread;
+  std::unique_ptr<core::ThreadPool> mWorkers;
+  std::atomic<bool> mRunning = false;
+
+  mutable std::mutex mObjectsMutex;
+  std::vector<StoredObject> mObjects; // in the order of creation
+  long mLastCreationTime = 0;
+
+  mutable std::mutex mStatisticsMutex;
+  Statistics mStatistics;
+  std::mt19937 mErrorGenerator;
+};
+
+} // namespace o2::quality_control::repository
+
+#endif // QC_REPOSITORY_MOCKCCDBSERVER_H
@@ -116,6 +116,9 @@ class MonitorObject : public TObject
   void addOrUpdateMetadata(std::string key, std::string value);
   /// \brief Get metadata value of given key, returns std::nullopt if none exists;
   std::optional<std::string> getMetadata(const std::string& key);
+  /// \brief Returns true if this object only marks that the object with the same name did not change since its last publication.
+  /// Such markers do not carry the content of the object, only its name, activity, validity and metadata.
+  bool isUnchangedMarker() const;
 
   /// \brief Check if the encapsulated object inherits from the given class name
   /// \param className Name of the class to check inheritance from
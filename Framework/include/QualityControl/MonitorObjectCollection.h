@@ -17,21 +17,68 @@
 #ifndef QUALITYCONTROL_MONITOROBJECTCOLLECTION_H
 #define QUALITYCONTROL_MONITOROBJECTCOLLECTION_H
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <TObjArray.h>
 #include <Mergers/MergeInterface.h>
 
 namespace o2::quality_control::core
 {
 
+/// \brief A TObjArray of MonitorObjects which can be merged by the Mergers.
+///
+/// A transient name -> object index is kept alongside the array, so that looking up an object by its name, which
+/// happens for each object during merging and publishing, does not need to walk the whole array.
+/// The index is built lazily on the first lookup (e.g. after streaming) and kept in sync by the add/remove methods.
+/// Renaming an object after it was added to the collection is not tracked.
+///
+/// To reduce the network traffic, a collection can be sent encoded (see encode()). It is decoded by postDeserialization().
 class MonitorObjectCollection : public TObjArray, public mergers::MergeInterface
 {
  public:
+  /// \brief Transport encoding of the collection, see encode().
+  struct Encoding {
+    enum class Compression { None,
+                             Zlib,
+                             LZMA,
+                             LZ4,
+                             ZSTD };
+    Compression compression = Compression::None;
+    int level = 1;              // from 1 (fastest) to 9 (smallest)
+    double sparseOccupancy = 0; // histograms with at most this fraction of non-empty bins are sent sparse, 0 to disable
+
+    bool isEnabled() const { return compression != Compression::None || sparseOccupancy > 0; }
+    /// \brief Parses "none", "zlib", "lzma", "lz4" or "zstd", throws on other values.
+    static Compression compressionFromString(const std::string& name);
+  };
+
   MonitorObjectCollection() = default;
+  /// \brief Copies the array of pointers, the name index is rebuilt only when the copy is searched.
+  MonitorObjectCollection(const MonitorObjectCollection& other);
   ~MonitorObjectCollection() = default;
 
   void merge(mergers::MergeInterface* const other) override;
 
+  using TObjArray::FindObject;
+  TObject* FindObject(const char* name) const override;
+
+  void AddFirst(TObject* obj) override;
+  void AddLast(TObject* obj) override;
+  void AddAt(TObject* obj, Int_t idx) override;
+  void AddAtAndExpand(TObject* obj, Int_t idx) override;
+  Int_t AddAtFree(TObject* obj) override;
+  TObject* RemoveAt(Int_t idx) override;
+  TObject* Remove(TObject* obj) override;
+  void RemoveRange(Int_t idx1, Int_t idx2) override;
+  void SetLast(Int_t last) override;
+  void Clear(Option_t* option = "") override;
+  void Delete(Option_t* option = "") override;
+  /// \brief Called by ROOT when an object is deleted, if the collection is in the list of cleanups.
+  void RecursiveRemove(TObject* obj) override;
+
   void postDeserialization() override;
 
   void setDetector(const std::string&);
@@ -44,11 +91,39 @@ class MonitorObjectCollection : public TObjArray, public mergers::MergeInterface
 
   MergeInterface* cloneMovingWindow() const override;
 
+  /**
+   * \brief Creates a collection without objects, which carries the objects of this one encoded in a single buffer.
+   * The histograms with few non-empty bins are written as lists of bins, then the buffer is compressed with one of
+   * the algorithms of ROOT. The receiver gets the objects back with decode(), which is called by postDeserialization(),
+   * so the Mergers and CheckRunners accept both forms. The bins of the histograms are detached from them while they
+   * are written, thus the objects must not be used by other threads during the call.
+   */
+  std::unique_ptr<MonitorObjectCollection> encode(const Encoding& encoding) const;
+  bool isEncoded() const { return mEncodedSize > 0; }
+  /// \brief Size of the encoded buffer, as sent
+  size_t getEncodedBytes() const { return mEncodedObjects.size(); }
+  /// \brief Restores the objects of an encoded collection. It does nothing if it is not encoded, throws if the buffer is corrupted.
+  /// The collection is not encoded anymore afterwards, even if it throws. It then contains the objects decoded before the error.
+  void decode();
+
  private:
+  void indexObject(TObject* obj);
+  void unindexObject(TObject* obj);
+  void buildIndex() const;
+
   std::string mDetector = "TST";
   std::string mTaskName = "Test";
 
-  ClassDefOverride(MonitorObjectCollection, 3);
+  mutable std::unordered_map<std::string, TObject*> mIndex;       //! name of an object -> the first object with that name
+  mutable std::unordered_map<const TObject*, std::string> mNames; //! object -> its name when indexed, to remove it without accessing it
+  mutable bool mIndexBuilt = false;                                //! false if the index has to be rebuilt from the array
+  mutable bool mIndexHasDuplicates = false;                        //! true if at least two objects share the same name
+
+  std::vector<char> mEncodedObjects; // filled by encode(), empty otherwise
+  uint32_t mEncodedSize = 0;         // size of the encoded objects before compression, 0 if the collection is not encoded
+  bool mEncodedCompressed = false;
+
+  ClassDefOverride(MonitorObjectCollection, 4);
 };
 
 } // namespace o2::quality_control::core
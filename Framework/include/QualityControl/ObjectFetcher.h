@@ -0,0 +1,100 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   ObjectFetcher.h
+///
+
+#ifndef QUALITYCONTROL_OBJECTFETCHER_H
+#define QUALITYCONTROL_OBJECTFETCHER_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace o2::quality_control
+{
+namespace core
+{
+class Activity;
+class MonitorObject;
+class QualityObject;
+class ThreadPool;
+} // namespace core
+namespace repository
+{
+class DatabaseInterface;
+}
+} // namespace o2::quality_control
+
+namespace o2::quality_control::postprocessing
+{
+
+/// \brief Retrieves the objects of many data sources from the QCDB, concurrently if requested.
+///
+/// Post-processing tasks which trend many data sources spend most of their time waiting for the QCDB.
+/// With a parallelism larger than 1, the objects are retrieved by a pool of threads, each with its own connection
+/// to the QCDB, while the callback is invoked in the calling thread as soon as an object arrives. Thus, the objects
+/// can be reduced while the others are being retrieved, and the callback does not need to be thread-safe.
+/// The connections are created like the database of the runner, thus they are cached if the configuration enables it.
+/// Each of them gets an equal share of "cacheMaxBytes", while the cache directory, if any, is shared.
+/// With a parallelism of 1, the objects are retrieved sequentially with the provided database, as before.
+class ObjectFetcher
+{
+ public:
+  struct Request {
+    enum class Type {
+      MonitorObject,
+      QualityObject
+    };
+    std::string path;
+    std::string name; // for a QualityObject, the full path is path + "/" + name
+    Type type = Type::MonitorObject;
+  };
+  struct Result {
+    std::shared_ptr<core::MonitorObject> mo;
+    std::shared_ptr<core::QualityObject> qo;
+  };
+  /// Invoked for each request with its index and the retrieved object (nullptrs if it could not be retrieved)
+  using Callback = std::function<void(size_t, Result&&)>;
+
+  /// \param parallelism maximum number of objects retrieved at the same time
+  /// \param databaseConfig configuration of the QCDB used to open one connection per thread, if parallelism > 1
+  ObjectFetcher(size_t parallelism, std::unordered_map<std::string, std::string> databaseConfig);
+  ~ObjectFetcher();
+
+  /// \brief Retrieves the requested objects and calls the callback for each of them, in order of arrival.
+  /// It returns when all the objects have been processed by the callback.
+  void fetch(const std::vector<Request>& requests, long timestamp, const core::Activity& activity,
+             const std::map<std::string, std::string>& metadata, repository::DatabaseInterface& qcdb, const Callback& callback);
+
+  size_t getParallelism() const { return mParallelism; }
+
+ private:
+  static Result retrieve(repository::DatabaseInterface& qcdb, const Request& request, long timestamp,
+                         const core::Activity& activity, const std::map<std::string, std::string>& metadata);
+  std::unique_ptr<repository::DatabaseInterface> borrowConnection();
+  void returnConnection(std::unique_ptr<repository::DatabaseInterface> connection);
+
+  size_t mParallelism;
+  std::unordered_map<std::string, std::string> mDatabaseConfig;
+  std::unique_ptr<core::ThreadPool> mPool;
+  std::mutex mConnectionsMutex;
+  std::vector<std::unique_ptr<repository::DatabaseInterface>> mIdleConnections;
+};
+
+} // namespace o2::quality_control::postprocessing
+
+#endif // QUALITYCONTROL_OBJECTFETCHER_H
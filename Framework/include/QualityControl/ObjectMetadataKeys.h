@@ -38,6 +38,9 @@ constexpr auto qcQuality = "qc_quality";
 constexpr auto qcCheckName = "qc_check_name";
 constexpr auto qcAdjustableEOV = "adjustableEOV"; // this is a keyword for the CCDB
 constexpr auto cycleNumber = "CycleNumber";
+constexpr auto qcUnchanged = "qc_unchanged"; // the object is a marker replacing an object whose content did not change
+constexpr auto qcSerializedSize = "qc_serialized_size"; // in bytes, when the task measures the serialization of its objects
+constexpr auto qcStreamingTime = "qc_streaming_time";   // in microseconds, idem
 
 // QC Activity
 constexpr auto runType = "RunType";
@@ -23,7 +23,10 @@
 #include "QualityControl/MonitorObjectCollection.h"
 #include <Mergers/Mergeable.h>
 // stl
+#include <optional>
+#include <set>
 #include <string>
+#include <unordered_map>
 
 class TObject;
 
@@ -131,6 +134,77 @@ class ObjectsManager
 
   MonitorObjectCollection* getNonOwningArray() const;
 
+  /**
+   * \brief Returns a non-owning collection where the objects which did not change since the previous call are replaced by markers.
+   * The content of each object is first compared to the one it had during the previous call with a cheap summary
+   * (see contentSummary). Only if the summaries are equal, the content is compared with a checksum (see contentChecksum),
+   * thus an object whose checksum is not known yet is published once more before being replaced by a marker.
+   * Unchanged objects are replaced by lightweight MonitorObjects with the same name and validity, but without the content,
+   * which are recognized with MonitorObject::isUnchangedMarker(). The markers are owned by the ObjectsManager and
+   * remain valid until the next call. Objects of types which are not supported by contentChecksum are always included.
+   * The collection is created by new and must be cleaned up by the caller.
+   * @param onlyEmptyObjects if true, only the unchanged objects which are also empty are replaced. It should be used when
+   *                         the objects are reset after each publication and merged downstream, because then publishing
+   *                         the same content twice is not the same as publishing it once.
+   * @param numberUnchanged set to the number of objects replaced by markers
+   */
+  MonitorObjectCollection* getNonOwningArrayOfChangedObjects(bool onlyEmptyObjects, size_t& numberUnchanged);
+
+  /**
+   * \brief Computes a cheap checksum of the content of an object.
+   * It is implemented for histograms (TH1, TH2, TH3, THnSparse) and graphs, which cover the vast majority of published objects.
+   * @return the checksum, or std::nullopt if the type is not supported.
+   */
+  static std::optional<uint64_t> contentChecksum(const TObject* obj);
+
+  /// \brief Numbers which change with the content of an object in most cases, see contentSummary.
+  struct ContentSummary {
+    double entries = 0;
+    double sumOfWeights = 0;
+    int64_t size = 0;
+    uint64_t titleHash = 0;
+    bool operator==(const ContentSummary&) const = default;
+  };
+  /**
+   * \brief Summarizes the content of an object, without walking its bins when possible.
+   * It supports the same types as contentChecksum.
+   * @return the summary, or std::nullopt if the type is not supported.
+   */
+  static std::optional<ContentSummary> contentSummary(const TObject* obj);
+  /**
+   * \brief Makes the next call to getNonOwningArrayOfChangedObjects include all the objects.
+   * It should be called when the receivers might have lost the objects, e.g. when the Mergers reset them.
+   */
+  void forceFullPublication();
+
+  /// \brief Serialized size and streaming time of a MonitorObject, see measureSerialization.
+  struct SerializationCost {
+    MonitorObject* object;
+    size_t bytes;
+    double seconds;
+  };
+  /**
+   * \brief Streams each MonitorObject of the collection to measure its serialized size and the time it takes.
+   * The results are also stored in the metadata of each object (keys qcSerializedSize and qcStreamingTime), so that they
+   * are propagated to the database. Unchanged markers are skipped. It costs about as much as publishing the collection.
+   * @return the costs, in the order of the collection
+   */
+  static std::vector<SerializationCost> measureSerialization(MonitorObjectCollection& collection);
+  /**
+   * \brief Marks an object as low priority, which makes it the first to be dropped when a publication exceeds its budget.
+   * The object does not have to be published yet.
+   */
+  void setLowPriority(const std::string& objectName, bool lowPriority = true);
+  bool isLowPriority(const std::string& objectName) const;
+  /**
+   * \brief Removes low priority objects from the collection, the biggest first, until the total size fits in the budget
+   * or there are no low priority objects left. The costs of the removed objects are removed as well.
+   * The removed objects are forgotten by getNonOwningArrayOfChangedObjects, so that they are not replaced by markers
+   * of a content which was never sent.
+   * @return the removed objects
+   */
+  std::vector<MonitorObject*> enforceBudget(MonitorObjectCollection& collection, std::vector<SerializationCost>& costs, size_t budget);
+
   /**
    * \brief Add metadata to a MonitorObject.
    * Add a metadata pair to a MonitorObject. This is propagated to the database.
@@ -221,6 +295,15 @@ class ObjectsManager
   std::string mDetectorName;
   Activity mActivity;
   std::vector<std::string> mMovingWindowsList;
+  struct PublishedContent {
+    ContentSummary summary;
+    std::optional<uint64_t> checksum; // computed only when the summary did not change
+    uint64_t generation = 0;          // value of mPublicationGeneration when it was published
+  };
+  std::unordered_map<const MonitorObject*, PublishedContent> mLastPublishedContents;
+  uint64_t mPublicationGeneration = 0;
+  std::vector<std::unique_ptr<MonitorObject>> mUnchangedMarkers;
+  std::set<std::string> mLowPriorityObjects;
 
   void startPublishingImpl(TObject* obj, PublicationPolicy, bool ignoreMergeableWarning);
 };
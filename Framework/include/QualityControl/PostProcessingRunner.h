@@ -47,6 +47,11 @@ namespace o2::quality_control::repository
 class DatabaseInterface;
 }
 
+namespace o2::monitoring
+{
+class Monitoring;
+}
+
 namespace o2::quality_control::postprocessing
 {
 
@@ -121,6 +126,8 @@ class PostProcessingRunner
   PostProcessingRunnerConfig mRunnerConfig;
   std::shared_ptr<o2::quality_control::repository::DatabaseInterface> mSourceDatabase;
   std::shared_ptr<o2::quality_control::repository::DatabaseInterface> mDestinationDatabase;
+  // only used to report the statistics of the cache of the source database, if it is enabled
+  std::shared_ptr<o2::monitoring::Monitoring> mCollector;
   std::unique_ptr<repository::DatabaseInterface> configureDatabase(std::unordered_map<std::string, std::string>& dbConfig, const std::string& name);
 };
 
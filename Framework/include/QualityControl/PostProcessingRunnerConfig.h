@@ -37,6 +37,7 @@ struct PostProcessingRunnerConfig {
   double periodSeconds = 10.0;
   std::string configKeyValues; // These are for ConfigurableParams, not for override-values!
   boost::property_tree::ptree configTree{};
+  std::string monitoringUrl{};
 };
 
 } // namespace o2::quality_control::postprocessing
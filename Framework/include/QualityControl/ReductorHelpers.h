@@ -18,12 +18,14 @@
 #define QUALITYCONTROL_REDUCTORHELPERS_H
 
 #include <string>
+#include <vector>
 
 namespace o2::quality_control
 {
 namespace postprocessing
 {
 class Reductor;
+class ObjectFetcher;
 struct Trigger;
 } // namespace postprocessing
 namespace core
@@ -46,6 +48,17 @@ namespace implementation
 bool updateReductorImpl(Reductor* r, const Trigger& t, const std::string& path, const std::string& name, const std::string& type,
                         repository::DatabaseInterface& qcdb, core::ConditionAccess& ccdbAccess);
 
+struct ReductorSource {
+  Reductor* reductor;
+  const std::string& path;
+  const std::string& name;
+  const std::string& type;
+};
+
+/// \brief implementation details of updateReductors, hiding some header inclusions
+std::vector<bool> updateReductorsImpl(const std::vector<ReductorSource>& sources, const Trigger& t, repository::DatabaseInterface& qcdb,
+                                      core::ConditionAccess& ccdbAccess, ObjectFetcher& fetcher);
+
 } // namespace implementation
 
 /// \brief Updates the provided Reductor with implementation-specific procedures
@@ -67,5 +80,29 @@ bool updateReductor(Reductor* r, const Trigger& t, const DataSourceT& ds, reposi
   return implementation::updateReductorImpl(r, t, path, name, type, qcdb, ccdbAccess);
 }
 
+/// \brief Updates the Reductors of all the provided data sources, retrieving their objects with the fetcher
+///
+/// The objects in the QCDB are retrieved concurrently if the fetcher allows it, the Reductors are updated in the calling
+/// thread as soon as their object arrives. Conditions are accessed sequentially.
+/// \tparam DataSourceT data source structure type to be accessed. path, name and type string members are required.
+/// \param dataSources data sources
+/// \param getReductor function returning the Reductor of a data source
+/// \param t trigger
+/// \param qcdb QCDB interface, used if the fetcher does not have its own connections
+/// \param ccdbAccess a class which has access to conditions
+/// \param fetcher retrieves the objects from the QCDB
+/// \return for each data source, whether its reductor was updated successfully
+template <typename DataSourceT, typename GetReductorT>
+std::vector<bool> updateReductors(const std::vector<DataSourceT>& dataSources, GetReductorT&& getReductor, const Trigger& t,
+                                  repository::DatabaseInterface& qcdb, core::ConditionAccess& ccdbAccess, ObjectFetcher& fetcher)
+{
+  std::vector<implementation::ReductorSource> sources;
+  sources.reserve(dataSources.size());
+  for (const auto& ds : dataSources) {
+    sources.push_back({ getReductor(ds), ds.path, ds.name, ds.type });
+  }
+  return implementation::updateReductorsImpl(sources, t, qcdb, ccdbAccess, fetcher);
+}
+
 } // namespace o2::quality_control::postprocessing::reductor_helpers
 #endif // QUALITYCONTROL_REDUCTORHELPERS_H
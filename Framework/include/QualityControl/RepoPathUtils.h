@@ -29,6 +29,9 @@ namespace o2::quality_control::core
 class RepoPathUtils
 {
  public:
+  /// Name of the object stored by CheckRunners in the folder of a task once all its objects of a cycle are stored
+  static constexpr auto cycleManifestName = "qc_cycle_manifest";
+
   /**
    * Compute and return the path to the MonitorObject.
    * Current algorithm does <provenance(qc)>/<detectorCode>/MO/<taskName>/<moName>
@@ -0,0 +1,86 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    ScratchArena.h
+///
+
+#ifndef QC_CORE_SCRATCHARENA_H
+#define QC_CORE_SCRATCHARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace o2::quality_control::core
+{
+
+/// \brief Memory resource for the temporary structures built while processing one time frame.
+///
+/// Allocations are served from large chunks by bumping a pointer, deallocations do nothing. reset() makes the whole
+/// memory available again at once, it is called by the framework after each call to TaskInterface::monitorData, so
+/// nothing allocated in the arena may be used after monitorData returns. When a time frame needed more than one
+/// chunk, they are replaced by a single chunk of the total size at reset, so that the following time frames of
+/// similar size do not allocate any memory at all.
+///
+/// Containers which allocate and release many nodes while processing a time frame (std::pmr::map, std::pmr::set)
+/// should use a std::pmr::unsynchronized_pool_resource on top of the arena, so that the released nodes are reused.
+/// The arena is not thread safe.
+class ScratchArena : public std::pmr::memory_resource
+{
+ public:
+  struct Stats {
+    uint64_t allocations = 0;         // allocations served since the creation of the arena
+    uint64_t upstreamAllocations = 0; // chunks allocated since the creation of the arena
+    size_t bytesInUse = 0;            // bytes allocated since the last reset
+    size_t highWaterMark = 0;         // maximum of bytesInUse since the creation of the arena
+    size_t capacity = 0;              // total size of the chunks currently owned
+  };
+
+  explicit ScratchArena(size_t initialSize = 64 * 1024, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+  ~ScratchArena() override;
+  ScratchArena(const ScratchArena&) = delete;
+  ScratchArena& operator=(const ScratchArena&) = delete;
+
+  /// \brief Makes all the memory of the arena available again. Everything allocated so far becomes invalid.
+  void reset();
+  /// \brief Returns all the chunks to the upstream resource.
+  void release();
+
+  const Stats& getStats() const { return mStats; }
+
+ protected:
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void*, size_t, size_t) override {}
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+ private:
+  struct Chunk {
+    std::byte* data;
+    size_t size;
+    size_t alignment;
+  };
+
+  void addChunk(size_t minimumSize, size_t alignment);
+
+  std::pmr::memory_resource* mUpstream;
+  size_t mNextChunkSize;
+  std::vector<Chunk> mChunks;
+  size_t mCurrentChunk = 0;
+  size_t mOffset = 0; // in the current chunk
+  Stats mStats;
+};
+
+} // namespace o2::quality_control::core
+
+#endif // QC_CORE_SCRATCHARENA_H
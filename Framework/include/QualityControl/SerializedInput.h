@@ -0,0 +1,119 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   SerializedInput.h
+///
+
+#ifndef QC_CHECKER_SERIALIZEDINPUT_H
+#define QC_CHECKER_SERIALIZEDINPUT_H
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <Headers/DataHeader.h>
+
+class TObject;
+
+namespace o2::framework
+{
+struct DataRef;
+struct DataProcessingHeader;
+} // namespace o2::framework
+
+namespace o2::quality_control::checker
+{
+
+/// \brief The last message received on one input of a CheckRunner, kept serialized until its objects are needed.
+///
+/// Deserializing a TObjArray with all the MonitorObjects of a task is the main cost of a CheckRunner, while
+/// the Checks might not be ready to use them. The message is kept instead, a newer message replaces it
+/// and only the last one is deserialized when needed. A message which is the same as the previous one (same timeslice
+/// and creation time in its DataProcessingHeader, same payload buffer and size) is not kept again, since the objects
+/// which were deserialized from it are still valid. The content of the payload is not compared.
+///
+/// During the processing callback, only a pointer to the payload of the DPL message is kept. DPL releases the message
+/// afterwards, thus the payload of a message which is still pending at the end of the callback is copied with
+/// keepPayload(). This costs one copy of the payload per message left pending, in a buffer which is reused.
+///
+/// The names of the objects of the last deserialized message are kept as well, so that the caller can update
+/// the revisions of the objects without deserializing the following messages. It assumes that a data source
+/// keeps sending the same set of objects, newly added objects are discovered when the message is deserialized.
+class SerializedInput
+{
+ public:
+  /// \brief Keeps the message, unless it is the same as the last one.
+  /// The payload is only referenced, keepPayload() has to be called before the message is released.
+  /// \return true if the message is not the last one received.
+  bool receive(const framework::DataRef& ref);
+  /// \brief Keeps a copy of the header and a reference to the payload, unless they are the same as the last ones.
+  /// Messages without a DataProcessingHeader are always kept.
+  bool receive(const header::DataHeader& dataHeader, const framework::DataProcessingHeader* processingHeader, const char* payload, size_t payloadSize);
+
+  /// \brief Returns true if a message was received but not deserialized yet.
+  bool isPending() const { return mPending; }
+
+  /// \brief Deserializes the pending message. The copy of the payload, if any, is reused for the next message.
+  /// \throws std::runtime_error if no message is pending. An exception is also thrown if the payload cannot be deserialized.
+  std::unique_ptr<TObject> deserialize();
+
+  /// \brief Copies the payload of the pending message, so that it can be deserialized after the message is released.
+  /// Nothing is copied if no message is pending or if the payload was already copied.
+  void keepPayload();
+
+  /// \brief The names of the objects contained in the last deserialized message.
+  const std::vector<std::string>& getObjectNames() const { return mObjectNames; }
+  void setObjectNames(std::vector<std::string> objectNames)
+  {
+    mObjectNames = std::move(objectNames);
+    mObjectsKnown = true;
+  }
+  bool hasObjectNames() const { return mObjectsKnown; }
+
+  /// \brief Whether the last deserialized message contained markers of unchanged objects.
+  /// Such markers refer to the previous message, which thus cannot be skipped.
+  bool containsUnchangedMarkers() const { return mContainsUnchangedMarkers; }
+  void setContainsUnchangedMarkers(bool contains) { mContainsUnchangedMarkers = contains; }
+
+  /// \brief Forgets the messages and the object names.
+  void clear();
+
+  /// \brief The number of messages which were replaced before being deserialized.
+  size_t getNumberSkipped() const { return mNumberSkipped; }
+
+ private:
+  struct MessageIdentity {
+    uint64_t startTime;
+    uint64_t creation;
+    const char* payload;
+    size_t payloadSize;
+    bool operator==(const MessageIdentity&) const = default;
+  };
+
+  header::DataHeader mHeader;
+  const char* mPayloadView = nullptr; // either the DPL message or mPayload
+  size_t mPayloadSize = 0;
+  std::vector<char> mPayload;
+  std::optional<MessageIdentity> mIdentity;
+  bool mReceived = false;
+  bool mPending = false;
+  bool mObjectsKnown = false;
+  bool mContainsUnchangedMarkers = false;
+  std::vector<std::string> mObjectNames;
+  size_t mNumberSkipped = 0;
+};
+
+} // namespace o2::quality_control::checker
+
+#endif // QC_CHECKER_SERIALIZEDINPUT_H
@@ -20,6 +20,7 @@
 #define QUALITYCONTROL_SLICETRENDINGTASK_H
 
 #include "QualityControl/PostProcessingInterface.h"
+#include "QualityControl/ObjectFetcher.h"
 #include "QualityControl/SliceReductor.h"
 #include "QualityControl/SliceTrendingTaskConfig.h"
 
@@ -107,6 +108,7 @@ class SliceTrendingTask : public PostProcessingInterface
   std::unordered_map<std::string, int> mNumberPads;
   std::unordered_map<std::string, std::vector<std::vector<float>>> mAxisDivision;
   std::unordered_map<std::string, std::vector<std::vector<std::string>>> mSliceLabel;
+  std::unique_ptr<ObjectFetcher> mObjectFetcher;
 };
 
 } // namespace o2::quality_control::postprocessing
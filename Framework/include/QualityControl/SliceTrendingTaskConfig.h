@@ -72,6 +72,7 @@ struct SliceTrendingTaskConfig : PostProcessingConfig {
   bool producePlotsOnUpdate;
   bool resumeTrend;
   std::string trendingTimestamp;
+  size_t fetchParallelism = 1; // maximum number of objects retrieved concurrently from the QCDB
   std::vector<Plot> plots;
   std::vector<DataSource> dataSources;
 };
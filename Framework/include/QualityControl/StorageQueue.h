@@ -0,0 +1,145 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   StorageQueue.h
+///
+
+#ifndef QC_REPOSITORY_STORAGEQUEUE_H
+#define QC_REPOSITORY_STORAGEQUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace o2::monitoring
+{
+class Monitoring;
+}
+
+namespace o2::quality_control::core
+{
+class MonitorObject;
+class QualityObject;
+} // namespace o2::quality_control::core
+
+namespace o2::quality_control::repository
+{
+
+class DatabaseInterface;
+
+/// \brief Configuration of the StorageQueue.
+///
+/// It is extracted from the "database" section of the common configuration, all keys are optional.
+struct StorageQueueConfig {
+  enum class OverflowPolicy {
+    Drop, // new objects are rejected when the queue is full
+    Block // the caller waits until there is room in the queue
+  };
+
+  bool enabled = false;                           // "asyncStorage"
+  size_t threads = 2;                             // "asyncStorageThreads"
+  size_t maxInFlight = 1000;                      // "asyncStorageMaxInFlight"
+  size_t batchSize = 16;                          // "asyncStorageBatchSize"
+  size_t retries = 0;                             // "asyncStorageRetries"
+  OverflowPolicy overflow = OverflowPolicy::Drop; // "asyncStorageOverflowPolicy", "drop" or "block"
+
+  static StorageQueueConfig fromDatabaseConfig(const std::unordered_map<std::string, std::string>& databaseConfig);
+};
+
+/// \brief Bounded queue which uploads MonitorObjects and QualityObjects to the QCDB in background threads.
+///
+/// Each worker owns its own DatabaseInterface, created with the provided factory, so that the database
+/// implementations do not have to be thread-safe. The workers dequeue up to `batchSize` objects at once
+/// and upload them one after the other, which amortizes the locking and wake-ups when many objects are
+/// pushed in one go. The objects are considered "in flight" from the moment they are pushed until their
+/// upload is over, their number is bounded by `maxInFlight`.
+///
+/// The objects pushed to the queue should not be modified anymore by the caller.
+class StorageQueue
+{
+ public:
+  using DatabaseCreator = std::function<std::unique_ptr<DatabaseInterface>()>;
+
+  StorageQueue(StorageQueueConfig config, const DatabaseCreator& databaseCreator);
+  ~StorageQueue();
+
+  StorageQueue(const StorageQueue&) = delete;
+  StorageQueue& operator=(const StorageQueue&) = delete;
+
+  /// \brief Enqueue a MonitorObject for storage.
+  /// \return false if the object was dropped because the queue is full or stopped.
+  bool push(std::shared_ptr<const core::MonitorObject> mo);
+  /// \brief Enqueue a QualityObject for storage.
+  /// \return false if the object was dropped because the queue is full or stopped.
+  bool push(std::shared_ptr<const core::QualityObject> qo);
+  /// \brief Enqueue a MonitorObject which is uploaded only after all the objects pushed before it.
+  /// Objects pushed afterwards are not uploaded before it is taken by a worker.
+  /// \return false if the object was dropped because the queue is full or stopped.
+  bool pushAfterPrevious(std::shared_ptr<const core::MonitorObject> mo);
+
+  /// \brief Block until all the objects pushed so far have been uploaded (or have failed).
+  void flush();
+
+  /// \brief Send the queue depth, upload latency and counters to the monitoring and reset the periodic counters.
+  void sendMetrics(o2::monitoring::Monitoring& collector);
+
+  size_t getNumberInFlight() const;
+  size_t getTotalStored() const { return mTotalStored; }
+  size_t getTotalDropped() const { return mTotalDropped; }
+  size_t getTotalFailed() const { return mTotalFailed; }
+
+ private:
+  struct Item {
+    std::variant<std::shared_ptr<const core::MonitorObject>, std::shared_ptr<const core::QualityObject>> object;
+    bool afterPrevious = false;
+  };
+
+  bool pushItem(Item&& item);
+  bool canTakeFront() const;
+  void workerLoop(std::unique_ptr<DatabaseInterface> database);
+  bool upload(DatabaseInterface& database, const Item& item);
+
+  StorageQueueConfig mConfig;
+
+  mutable std::mutex mMutex;
+  std::condition_variable mItemAvailable;
+  std::condition_variable mSpaceAvailable;
+  std::condition_variable mAllDone;
+  std::deque<Item> mQueue;
+  size_t mInFlight = 0;  // queued + being uploaded, protected by mMutex
+  size_t mUploading = 0; // being uploaded, protected by mMutex
+  bool mStopping = false;
+  std::vector<std::thread> mWorkers;
+
+  // monitoring
+  std::atomic<size_t> mTotalStored = 0;
+  std::atomic<size_t> mTotalDropped = 0;
+  std::atomic<size_t> mTotalFailed = 0;
+  std::atomic<size_t> mTotalRetried = 0;
+  // upload latency since the last call to sendMetrics, protected by mMutex
+  double mLatencySumMs = 0;
+  double mLatencyMaxMs = 0;
+  size_t mLatencyCount = 0;
+};
+
+} // namespace o2::quality_control::repository
+
+#endif // QC_REPOSITORY_STORAGEQUEUE_H
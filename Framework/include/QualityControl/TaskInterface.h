@@ -25,6 +25,8 @@
 // QC
 #include "QualityControl/Activity.h"
 #include "QualityControl/ObjectsManager.h"
+#include "QualityControl/ScratchArena.h"
+#include "QualityControl/TaskProfiler.h"
 #include "QualityControl/UserCodeInterface.h"
 
 namespace o2::monitoring
@@ -96,14 +98,26 @@ class TaskInterface : public UserCodeInterface
   void setMonitoring(const std::shared_ptr<o2::monitoring::Monitoring>& mMonitoring);
   void setGlobalTrackingDataRequest(std::shared_ptr<o2::globaltracking::DataRequest>);
   const o2::globaltracking::DataRequest* getGlobalTrackingDataRequest() const;
+  /// \brief Returns the arena behind getScratchMemory(), it is reset by the framework after each monitorData.
+  ScratchArena& getScratchArena() { return *mScratchArena; }
+  /// \brief Returns the profiler behind profile(), it is configured by the framework.
+  TaskProfiler& getProfiler() { return *mProfiler; }
 
  protected:
   std::shared_ptr<ObjectsManager> getObjectsManager();
   std::shared_ptr<o2::monitoring::Monitoring> mMonitoring;
+  /// \brief Memory for the temporary structures of monitorData, to be used with the std::pmr containers.
+  /// Everything allocated there is released at once after monitorData returns. See ScratchArena for details.
+  std::pmr::memory_resource* getScratchMemory() { return mScratchArena.get(); }
+  /// \brief Measures the time spent until the end of the scope of the returned timer, if profiling is enabled for the task.
+  /// The sections are reported along with monitorData, endOfCycle and the publication. See TaskProfiler for details.
+  TaskProfiler::ScopedTimer profile(std::string_view section) { return mProfiler->scope(section); }
 
  private:
   std::shared_ptr<ObjectsManager> mObjectsManager;
   std::shared_ptr<o2::globaltracking::DataRequest> mGlobalTrackingDataRequest;
+  std::shared_ptr<ScratchArena> mScratchArena = std::make_shared<ScratchArena>(); //!
+  std::shared_ptr<TaskProfiler> mProfiler = std::make_shared<TaskProfiler>();     //!
 };
 
 } // namespace o2::quality_control::core
@@ -0,0 +1,166 @@
+// Copyright 2019-2022 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    TaskProfiler.h
+///
+
+#ifndef QC_CORE_TASKPROFILER_H
+#define QC_CORE_TASKPROFILER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace o2::quality_control::core
+{
+
+/// \brief Distribution of durations, with a relative precision of about 6%, giving percentiles in constant memory.
+///
+/// The durations are counted in buckets of exponentially growing width: 16 linear sub-buckets per power of two.
+class LatencyHistogram
+{
+ public:
+  void add(uint64_t nanoseconds);
+  void reset();
+
+  uint64_t getCount() const { return mCount; }
+  /// \brief The duration below which the given fraction of the entries lie, e.g. 0.99 for the 99th percentile
+  uint64_t getPercentile(double fraction) const;
+  uint64_t getMax() const { return mMax; }
+
+ private:
+  static constexpr size_t subBucketBits = 4;
+  static constexpr size_t nBuckets = (64 - subBucketBits + 1) << subBucketBits;
+  static size_t bucketIndex(uint64_t value);
+  static uint64_t bucketMiddle(size_t index);
+
+  std::array<uint32_t, nBuckets> mCounts{};
+  uint64_t mCount = 0;
+  uint64_t mMax = 0;
+};
+
+/// \brief Measures the time spent in the sections of the code of a task.
+///
+/// The TaskRunner measures the calls to monitorData, endOfCycle and the publication. The tasks can measure parts
+/// of their own code with scoped timers:
+/// \code{.cxx}
+/// void MyTask::monitorData(o2::framework::ProcessingContext& ctx)
+/// {
+///   {
+///     auto timer = profile("decoding");
+///     decode(ctx);
+///   }
+///   ...
+/// }
+/// \endcode
+/// For each section, the profiler keeps the distribution of the wall time per call and the total CPU time of the
+/// calling thread, over the current cycle. Optionally, each call is also kept as an event of a Chrome trace
+/// (to open with chrome://tracing or https://ui.perfetto.dev).
+/// When the profiler is disabled, the timers do nothing. The profiler is thread safe.
+class TaskProfiler
+{
+ public:
+  struct SectionStats {
+    std::string name;
+    uint64_t calls = 0;
+    double p50 = 0; // seconds
+    double p90 = 0;
+    double p99 = 0;
+    double max = 0;
+    double cpuTime = 0;     // seconds, total
+    int64_t heapGrowth = 0; // bytes, total, only measured if requested when starting the timer, see heapInUse()
+  };
+
+  class ScopedTimer
+  {
+   public:
+    ScopedTimer() = default; // does nothing
+    ScopedTimer(TaskProfiler* profiler, size_t section, bool measureHeap = false);
+    ~ScopedTimer() { stop(); }
+    ScopedTimer(ScopedTimer&& other) noexcept;
+    ScopedTimer& operator=(ScopedTimer&& other) noexcept;
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    /// \brief Records the section before the end of the scope. It returns the duration in seconds, 0 if disabled.
+    double stop();
+
+   private:
+    TaskProfiler* mProfiler = nullptr;
+    size_t mSection = 0;
+    bool mMeasureHeap = false;
+    uint64_t mStart = 0;
+    uint64_t mCpuStart = 0;
+    int64_t mHeapStart = 0;
+  };
+
+  /// \param traceFile  where to write the Chrome trace in writeTrace(), no events are kept if empty
+  void configure(bool enabled, std::string traceFile = "", size_t maxTraceEvents = 1000000);
+  bool isEnabled() const { return mEnabled; }
+  const std::string& getTraceFile() const { return mTraceFile; }
+
+  /// \brief Starts timing the section with the given name, until the end of the scope of the returned timer.
+  ScopedTimer scope(std::string_view name, bool measureHeap = false);
+  /// \brief Records one call to a section, the times are in nanoseconds.
+  void record(size_t section, uint64_t start, uint64_t duration, uint64_t cpuTime, int64_t heapGrowth = 0);
+
+  /// \brief The statistics of the sections called since the last resetCycle(), in the order of their first call.
+  std::vector<SectionStats> getStats() const;
+  void resetCycle();
+
+  /// \brief Writes the events recorded since the last clearTrace() as a Chrome trace, returns false on failure.
+  bool writeTrace(const std::string& processName) const;
+  void clearTrace();
+  size_t getNumberOfTraceEvents() const;
+
+  /// \brief Wall clock of the timers, in nanoseconds
+  static uint64_t now();
+  /// \brief CPU time of the calling thread, in nanoseconds
+  static uint64_t threadCpuTime();
+  /// \brief Bytes in use in the heap of the process, 0 if it is not known on this platform.
+  /// It is approximate: it includes the allocations of all the threads, and it relies on mallinfo2(), which walks all
+  /// the malloc arenas and is too slow to be called for each time frame.
+  static int64_t heapInUse();
+
+ private:
+  struct Section {
+    std::string name;
+    LatencyHistogram latency;
+    uint64_t cpuTime = 0;
+    int64_t heapGrowth = 0;
+  };
+  struct TraceEvent {
+    uint32_t section;
+    uint32_t thread;
+    uint64_t start;
+    uint64_t duration;
+  };
+
+  size_t getSection(std::string_view name);
+
+  bool mEnabled = false;
+  std::string mTraceFile;
+  size_t mMaxTraceEvents = 0;
+
+  mutable std::mutex mMutex;
+  std::vector<Section> mSections;
+  std::vector<TraceEvent> mTraceEvents;
+  size_t mDroppedTraceEvents = 0;
+};
+
+} // namespace o2::quality_control::core
+
+#endif // QC_CORE_TASKPROFILER_H
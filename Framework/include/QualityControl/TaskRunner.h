@@ -53,6 +53,7 @@ namespace o2::quality_control::core
 class Timekeeper;
 class TaskInterface;
 class ObjectsManager;
+class MonitorObjectCollection;
 
 /// \brief A class driving the execution of a QC task inside DPL.
 ///
@@ -128,6 +129,9 @@ class TaskRunner : public framework::Task
   void finishCycle(framework::DataAllocator& outputs);
   int publish(framework::DataAllocator& outputs);
   void publishCycleStats();
+  /// \brief Measures the serialization of the objects to publish and applies the publication budget.
+  void accountSerialization(MonitorObjectCollection& array);
+  std::string getTraceFilePath() const;
   void saveToFile();
 
  private:
@@ -152,6 +156,13 @@ class TaskRunner : public framework::Task
   int mTotalNumberObjectsPublished = 0; // over a run
   double mLastPublicationDuration = 0;
   uint64_t mDataReceivedInCycle = 0;
+  uint64_t mSerializedBytesInCycle = 0;
+  double mSerializationTimeInCycle = 0;
+  uint64_t mLargestObjectInCycle = 0;
+  int mObjectsDroppedInCycle = 0;
+  uint64_t mEncodedBytesInCycle = 0;
+  double mEncodingTimeInCycle = 0;
+  int64_t mHeapInUseAtCycleStart = 0; // sampled once per cycle when profiling
   AliceO2::Common::Timer mTimerTotalDurationActivity;
   AliceO2::Common::Timer mTimerDurationCycle;
 };
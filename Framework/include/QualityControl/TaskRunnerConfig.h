@@ -24,6 +24,7 @@
 #include <Framework/DataProcessorSpec.h>
 #include "QualityControl/Activity.h"
 #include "QualityControl/LogDiscardParameters.h"
+#include "QualityControl/MonitorObjectCollection.h"
 #include "QualityControl/UserCodeConfig.h"
 
 namespace o2::base
@@ -59,6 +60,15 @@ struct TaskRunnerConfig : public UserCodeConfig {
   std::shared_ptr<o2::globaltracking::DataRequest> globalTrackingDataRequest;
   std::vector<std::string> movingWindows;
   bool disableLastCycle = false;
+  bool skipUnchangedObjects = false; // objects which did not change since the last publication are replaced by markers
+  bool profiling = false;            // per-section timings of monitorData, endOfCycle, publication and the user sections
+  std::string profilingTraceFile{};  // Chrome trace of the profiled sections, written at the end of each activity
+  bool serializationAccounting = false; // measures the serialized size and streaming time of each published object
+  size_t publicationBudgetBytes = 0;    // 0 means no budget
+  bool dropObjectsOverBudget = false;   // drops low priority objects instead of only warning when over budget
+  std::vector<std::string> lowPriorityObjects;
+  MonitorObjectCollection::Encoding transportEncoding{}; // of the published collections
+  size_t fullPublicationPeriod = 0;                      // in cycles, all objects are published when the Mergers reset, 0 for never
 };
 
 } // namespace o2::quality_control::core
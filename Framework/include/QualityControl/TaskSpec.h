@@ -77,6 +77,16 @@ struct TaskSpec {
   GlobalTrackingDataRequestSpec globalTrackingDataRequest;
   std::vector<std::string> movingWindows;
   bool disableLastCycle = false;
+  bool skipUnchangedObjects = false;
+  bool profiling = false;
+  std::string profilingTraceFile;
+  bool serializationAccounting = false;
+  size_t publicationBudgetBytes = 0;
+  bool dropObjectsOverBudget = false;
+  std::vector<std::string> lowPriorityObjects;
+  std::string transportCompression = "none";
+  int transportCompressionLevel = 1;
+  double transportSparseOccupancy = 0;
 };
 
 } // namespace o2::quality_control::core
@@ -0,0 +1,70 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   ThreadPool.h
+///
+
+#ifndef QC_CORE_THREADPOOL_H
+#define QC_CORE_THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace o2::quality_control::core
+{
+
+/// \brief A fixed number of threads executing the submitted functions in the order of submission.
+///
+/// Exceptions thrown by the functions are forwarded to the returned futures.
+/// The destructor waits until all the submitted functions have been executed.
+class ThreadPool
+{
+ public:
+  explicit ThreadPool(size_t nThreads);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  template <typename F>
+  std::future<std::invoke_result_t<F>> submit(F&& function)
+  {
+    // std::function requires a copyable target, while std::packaged_task is movable only
+    auto task = std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(std::forward<F>(function));
+    auto future = task->get_future();
+    enqueue([task]() { (*task)(); });
+    return future;
+  }
+
+  size_t getNThreads() const { return mWorkers.size(); }
+
+ private:
+  void enqueue(std::function<void()>&& task);
+  void workerLoop();
+
+  std::vector<std::thread> mWorkers;
+  std::deque<std::function<void()>> mTasks;
+  std::mutex mMutex;
+  std::condition_variable mTaskAvailable;
+  bool mStopping = false;
+};
+
+} // namespace o2::quality_control::core
+
+#endif // QC_CORE_THREADPOOL_H
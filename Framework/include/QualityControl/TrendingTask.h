@@ -18,11 +18,17 @@
 #define QUALITYCONTROL_TRENDINGTASK_H
 
 #include "QualityControl/PostProcessingInterface.h"
+#include "QualityControl/ObjectFetcher.h"
 #include "QualityControl/Reductor.h"
 #include "QualityControl/TrendingTaskConfig.h"
+#include "QualityControl/ColumnarTrend.h"
+#include "QualityControl/ThreadPool.h"
 
+#include <future>
 #include <memory>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 #include <TTree.h>
 
 class TAxis;
@@ -67,6 +73,11 @@ class TrendingTask : public PostProcessingInterface
       return "runNumber/L:runNumberStr/C";
     }
   } mMetaData;
+  struct RenderedPlot {
+    std::string name;
+    uint64_t revision; // the revision of the plot when it was submitted for rendering
+    std::unique_ptr<TCanvas> canvas;
+  };
 
   static void setUserAxesLabels(TAxis* xAxis, TAxis* yAxis, const std::string& graphAxesLabels);
   static void setUserYAxisRange(TH1* hist, const std::string& graphYAxisRange);
@@ -77,16 +88,38 @@ class TrendingTask : public PostProcessingInterface
 
   /// returns true only if all datasources were available to update reductor
   bool trendValues(const Trigger& t, repository::DatabaseInterface&);
-  void generatePlots();
-  TCanvas* drawPlot(const TrendingTaskConfig::Plot& plotConfig);
+  /// generates the configured plots, or only those whose data sources were updated since they were last generated
+  void generatePlots(bool onlyChanged = false);
+  /// sets the global palette of ROOT for the plot, it must be called from the main thread before drawPlot
+  static void selectPalette(const TrendingTaskConfig::Plot& plotConfig);
+  /// draws a plot out of the trend, taking the values of simple expressions from the columns if they are provided.
+  /// The canvas is called after the plot, unless a canvasName is given.
+  TCanvas* drawPlot(TTree& trend, const ColumnarTrend* columns, const TrendingTaskConfig::Plot& plotConfig, const std::string& canvasName = "");
+  static void drawSeries(TTree& trend, const ColumnarTrend::Series& series, const std::string& varexp, const std::string& option, bool firstGraphInPlot);
+  static bool isGraphOption(const std::string& option);
+  /// publishes the plots generated in the background, if they are ready or if asked to wait for them
+  void collectRenderedPlots(bool wait);
+  void publishPlot(TCanvas* canvas);
+  uint64_t getPlotRevision(const TrendingTaskConfig::Plot& plotConfig) const;
+  static bool referencesName(const std::string& expression, const std::string& name);
   void initializeTrend(repository::DatabaseInterface& qcdb);
+  void downsampleTrend();
   bool canContinueTrend(TTree* tree);
 
   TrendingTaskConfig mConfig;
   UInt_t mTime;
   std::unique_ptr<TTree> mTrend;
+  ColumnarTrend mColumns; //! the numeric values of mTrend, to draw the plots without evaluating TTree formulas
+  Long64_t mEntriesAfterDownsampling = 0;
   std::map<std::string, std::unique_ptr<TObject>> mPlots;
   std::unordered_map<std::string, std::unique_ptr<Reductor>> mReductors;
+  std::unique_ptr<ObjectFetcher> mObjectFetcher;
+  std::unordered_map<std::string, uint64_t> mSourceRevisions;    // incremented at each successful update of a source
+  uint64_t mFilledEntries = 0;                                   // entries filled in the trend, including those removed by downsampling
+  std::unordered_map<std::string, uint64_t> mDrawnPlotRevisions; // revisions of the published plots, see getPlotRevision
+  std::future<std::vector<RenderedPlot>> mRenderedPlots;         //!
+  // the last member, so that it waits for the plots being generated before anything else is destroyed
+  std::unique_ptr<core::ThreadPool> mPlotRenderer; //!
 };
 
 } // namespace o2::quality_control::postprocessing
@@ -91,7 +91,14 @@ struct TrendingTaskConfig : PostProcessingConfig {
   bool producePlotsOnUpdate{};
   bool resumeTrend{};
   bool trendIfAllInputs{ false };
+  bool renderPlotsInBackground{ false };
   std::string trendingTimestamp;
+  size_t fetchParallelism = 1; // maximum number of objects retrieved concurrently from the QCDB
+  // if not zero, the trend keeps this many most recent entries and only a selection of the older ones,
+  // see DownsampledTrend::selectSamples
+  size_t trendCapacity = 0;
+  size_t trendTiers = 3;
+  size_t trendDownsamplingFactor = 10;
   std::vector<Plot> plots;
   std::vector<DataSource> dataSources;
 };
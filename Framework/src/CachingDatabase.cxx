@@ -0,0 +1,516 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   CachingDatabase.cxx
+///
+
+#include "QualityControl/CachingDatabase.h"
+
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <unistd.h>
+#include <Monitoring/Monitoring.h>
+#include <TBufferFile.h>
+#include <TObject.h>
+
+#include "QualityControl/ActivityHelpers.h"
+#include "QualityControl/CcdbDatabase.h"
+#include "QualityControl/MonitorObject.h"
+#include "QualityControl/ObjectMetadataKeys.h"
+#include "QualityControl/QualityObject.h"
+#include "QualityControl/QcInfoLogger.h"
+
+using namespace o2::quality_control::core;
+using namespace o2::monitoring;
+
+namespace o2::quality_control::repository
+{
+
+namespace
+{
+constexpr auto etagHeader = "ETag";
+constexpr auto lastModifiedHeader = "Last-Modified";
+
+const std::string* findHeader(const std::map<std::string, std::string>& headers, const char* key)
+{
+  auto it = headers.find(key);
+  return it != headers.end() && !it->second.empty() ? &it->second : nullptr;
+}
+
+// The same object is served if it has the same ETag and modification time.
+// We do not trust objects without ETag.
+bool isSameObject(const std::map<std::string, std::string>& cached, const std::map<std::string, std::string>& current)
+{
+  auto cachedEtag = findHeader(cached, etagHeader);
+  auto currentEtag = findHeader(current, etagHeader);
+  if (cachedEtag == nullptr || currentEtag == nullptr || *cachedEtag != *currentEtag) {
+    return false;
+  }
+  auto cachedLastModified = findHeader(cached, lastModifiedHeader);
+  auto currentLastModified = findHeader(current, lastModifiedHeader);
+  if (cachedLastModified == nullptr || currentLastModified == nullptr) {
+    return cachedLastModified == currentLastModified;
+  }
+  return *cachedLastModified == *currentLastModified;
+}
+
+bool getValidity(const std::map<std::string, std::string>& headers, long& validFrom, long& validUntil)
+{
+  auto from = findHeader(headers, metadata_keys::validFrom);
+  auto until = findHeader(headers, metadata_keys::validUntil);
+  if (from == nullptr || until == nullptr) {
+    return false;
+  }
+  try {
+    validFrom = std::stol(*from);
+    validUntil = std::stol(*until);
+  } catch (const std::exception&) {
+    return false;
+  }
+  return validFrom < validUntil;
+}
+
+long currentTimestamp()
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::vector<char> serialize(const TObject& obj)
+{
+  TBufferFile buffer(TBuffer::kWrite);
+  buffer.WriteObject(&obj);
+  return { buffer.Buffer(), buffer.Buffer() + buffer.Length() };
+}
+
+TObject* deserialize(const std::vector<char>& payload)
+{
+  // the buffer does not take the ownership of the payload, which is not modified when reading
+  TBufferFile buffer(TBuffer::kRead, payload.size(), const_cast<char*>(payload.data()), false);
+  return buffer.ReadObject(TObject::Class());
+}
+} // namespace
+
+CachingDatabaseConfig CachingDatabaseConfig::fromDatabaseConfig(const std::unordered_map<std::string, std::string>& databaseConfig)
+{
+  CachingDatabaseConfig config;
+  auto get = [&databaseConfig](const std::string& key) -> const std::string* {
+    auto it = databaseConfig.find(key);
+    return it != databaseConfig.end() && !it->second.empty() ? &it->second : nullptr;
+  };
+
+  if (auto value = get("cache")) {
+    config.enabled = *value == "true" || *value == "1";
+  }
+  if (auto value = get("cacheMaxBytes")) {
+    config.maxBytes = std::stoul(*value);
+  }
+  if (auto value = get("cacheDirectory")) {
+    config.directory = *value;
+  }
+  return config;
+}
+
+CachingDatabase::CachingDatabase(std::unique_ptr<DatabaseInterface> database, CachingDatabaseConfig config)
+  : mDatabase(std::move(database)), mConfig(std::move(config))
+{
+  if (!mConfig.directory.empty()) {
+    std::error_code ec;
+    std::filesystem::create_directories(mConfig.directory, ec);
+    if (ec) {
+      ILOG(Warning, Support) << "Could not create the cache directory '" << mConfig.directory << "' (" << ec.message() << "), objects will be cached only in memory" << ENDM;
+      mConfig.directory.clear();
+    }
+  }
+  ILOG(Debug, Devel) << "Caching retrieved objects in memory up to " << mConfig.maxBytes << " bytes"
+                     << (mConfig.directory.empty() ? "" : " and in " + mConfig.directory) << ENDM;
+}
+
+CachingDatabase::~CachingDatabase()
+{
+  auto statistics = getStatistics();
+  ILOG(Debug, Devel) << "Object cache: " << statistics.hits << " hits (" << statistics.listed << " validated with a listing), " << statistics.diskHits << " disk hits, " << statistics.misses << " misses, "
+                     << statistics.outdated << " outdated, " << statistics.evictions << " evictions" << ENDM;
+}
+
+void CachingDatabase::setLatestVersionFcn(LatestVersionFcn latestVersion)
+{
+  mLatestVersion = std::move(latestVersion);
+}
+
+void CachingDatabase::connect(const std::string& host, const std::string& database, const std::string& username, const std::string& password)
+{
+  mDatabase->connect(host, database, username, password);
+}
+
+void CachingDatabase::connect(const std::unordered_map<std::string, std::string>& config)
+{
+  mDatabase->connect(config);
+}
+
+void CachingDatabase::storeAny(const void* obj, std::type_info const& typeInfo, std::string const& path, std::map<std::string, std::string> const& metadata,
+                               std::string const& detectorName, std::string const& taskName, long from, long to)
+{
+  mDatabase->storeAny(obj, typeInfo, path, metadata, detectorName, taskName, from, to);
+}
+
+void CachingDatabase::storeMO(std::shared_ptr<const o2::quality_control::core::MonitorObject> mo)
+{
+  mDatabase->storeMO(std::move(mo));
+}
+
+void CachingDatabase::storeQO(std::shared_ptr<const o2::quality_control::core::QualityObject> qo)
+{
+  mDatabase->storeQO(std::move(qo));
+}
+
+void* CachingDatabase::retrieveAny(std::type_info const& tinfo, std::string const& path, std::map<std::string, std::string> const& metadata, long timestamp,
+                                   std::map<std::string, std::string>* headers, const std::string& createdNotAfter, const std::string& createdNotBefore)
+{
+  return mDatabase->retrieveAny(tinfo, path, metadata, timestamp, headers, createdNotAfter, createdNotBefore);
+}
+
+std::shared_ptr<o2::quality_control::core::MonitorObject> CachingDatabase::retrieveMO(std::string objectPath, std::string objectName, long timestamp,
+                                                                                      const core::Activity& activity,
+                                                                                      const std::map<std::string, std::string>& metadataToRetrieve)
+{
+  std::string fullPath = activity.mProvenance + "/" + objectPath + "/" + objectName;
+  std::map<std::string, std::string> headers;
+  std::map<std::string, std::string> metadata = activity_helpers::asDatabaseMetadata(activity, false);
+  metadata.insert(metadataToRetrieve.begin(), metadataToRetrieve.end());
+  TObject* obj = retrieveTObject(fullPath, metadata, timestamp, &headers);
+  if (obj == nullptr) {
+    if (headers.count("Error") > 0) {
+      ILOG(Error, Support) << headers["Error"] << ENDM;
+    }
+    return nullptr;
+  }
+  return CcdbDatabase::makeMonitorObject(obj, headers, fullPath, activity.mProvenance);
+}
+
+std::shared_ptr<o2::quality_control::core::QualityObject> CachingDatabase::retrieveQO(std::string qoPath, long timestamp, const core::Activity& activity,
+                                                                                      const std::map<std::string, std::string>& metadataToRetrieve)
+{
+  std::map<std::string, std::string> headers;
+  std::map<std::string, std::string> metadata = activity_helpers::asDatabaseMetadata(activity, false);
+  metadata.insert(metadataToRetrieve.begin(), metadataToRetrieve.end());
+  auto fullPath = activity.mProvenance + "/" + qoPath;
+  TObject* obj = retrieveTObject(fullPath, metadata, timestamp, &headers);
+  if (obj == nullptr) {
+    return nullptr;
+  }
+  return CcdbDatabase::makeQualityObject(obj, headers, fullPath, activity.mProvenance);
+}
+
+TObject* CachingDatabase::retrieveTObject(std::string path, const std::map<std::string, std::string>& metadata, long timestamp, std::map<std::string, std::string>* headers)
+{
+  // the latest object can change at any moment, we would have to ask for its validity anyway
+  if (timestamp == Timestamp::Latest) {
+    return mDatabase->retrieveTObject(path, metadata, timestamp, headers);
+  }
+  if (timestamp == Timestamp::Current) {
+    timestamp = currentTimestamp();
+  }
+
+  auto key = makeKey(path, metadata);
+  std::map<std::string, std::string> currentHeaders;
+  bool currentHeadersRetrieved = false;
+
+  auto entry = findInMemory(key, timestamp);
+  if (entry != nullptr && entry->validUntil <= currentTimestamp()) {
+    // the validity of the object ended, it is not expected to be replaced
+    std::lock_guard lock(mMutex);
+    mStatistics.hits++;
+  } else if (entry != nullptr && isLatestInListing(path, metadata, *entry)) {
+    std::lock_guard lock(mMutex);
+    mStatistics.hits++;
+    mStatistics.listed++;
+  } else if (entry != nullptr) {
+    currentHeaders = mDatabase->retrieveHeaders(path, metadata, timestamp);
+    currentHeadersRetrieved = true;
+    if (!isSameObject(entry->headers, currentHeaders)) {
+      ILOG(Debug, Devel) << "Cached object " << path << " was replaced in the database" << ENDM;
+      eraseFromMemory(key, entry->validFrom);
+      entry.reset();
+      std::lock_guard lock(mMutex);
+      mStatistics.outdated++;
+    } else {
+      std::lock_guard lock(mMutex);
+      mStatistics.hits++;
+    }
+  }
+
+  if (entry == nullptr && !mConfig.directory.empty()) {
+    if (!currentHeadersRetrieved) {
+      currentHeaders = mDatabase->retrieveHeaders(path, metadata, timestamp);
+    }
+    entry = readFromDisk(key, currentHeaders);
+    if (entry != nullptr) {
+      insertInMemory(entry);
+      std::lock_guard lock(mMutex);
+      mStatistics.diskHits++;
+    }
+  }
+
+  if (entry != nullptr) {
+    auto* obj = deserialize(entry->payload);
+    if (obj != nullptr) {
+      ILOG(Debug, Devel) << "Retrieved object " << path << " with timestamp " << timestamp << " from the cache" << ENDM;
+      if (headers != nullptr) {
+        headers->insert(entry->headers.begin(), entry->headers.end());
+      }
+      return obj;
+    }
+    ILOG(Warning, Support) << "Could not deserialize the cached object " << path << ", retrieving it from the database" << ENDM;
+    eraseFromMemory(key, entry->validFrom);
+  }
+
+  std::map<std::string, std::string> retrievedHeaders;
+  auto* obj = mDatabase->retrieveTObject(path, metadata, timestamp, &retrievedHeaders);
+  {
+    std::lock_guard lock(mMutex);
+    mStatistics.misses++;
+  }
+  if (obj != nullptr) {
+    auto newEntry = std::make_shared<Entry>();
+    if (getValidity(retrievedHeaders, newEntry->validFrom, newEntry->validUntil) && findHeader(retrievedHeaders, etagHeader) != nullptr) {
+      newEntry->key = key;
+      newEntry->headers = retrievedHeaders;
+      newEntry->payload = serialize(*obj);
+      if (!mConfig.directory.empty()) {
+        writeToDisk(*newEntry);
+      }
+      insertInMemory(std::move(newEntry));
+    }
+  }
+  if (headers != nullptr) {
+    headers->insert(retrievedHeaders.begin(), retrievedHeaders.end());
+  }
+  return obj;
+}
+
+std::map<std::string, std::string> CachingDatabase::retrieveHeaders(const std::string& path, const std::map<std::string, std::string>& metadata, long timestamp)
+{
+  return mDatabase->retrieveHeaders(path, metadata, timestamp);
+}
+
+std::string CachingDatabase::retrieveJson(std::string path, long timestamp, const std::map<std::string, std::string>& metadata)
+{
+  return mDatabase->retrieveJson(std::move(path), timestamp, metadata);
+}
+
+void CachingDatabase::disconnect()
+{
+  mDatabase->disconnect();
+}
+
+void CachingDatabase::prepareTaskDataContainer(std::string taskName)
+{
+  mDatabase->prepareTaskDataContainer(std::move(taskName));
+}
+
+std::vector<std::string> CachingDatabase::getPublishedObjectNames(std::string taskName)
+{
+  return mDatabase->getPublishedObjectNames(std::move(taskName));
+}
+
+void CachingDatabase::truncate(std::string path, std::string objectName)
+{
+  mDatabase->truncate(std::move(path), std::move(objectName));
+}
+
+void CachingDatabase::setMaxObjectSize(size_t maxObjectSize)
+{
+  mDatabase->setMaxObjectSize(maxObjectSize);
+}
+
+core::ValidityInterval CachingDatabase::getLatestObjectValidity(const std::string& path, const std::map<std::string, std::string>& metadata)
+{
+  return mDatabase->getLatestObjectValidity(path, metadata);
+}
+
+CachingDatabase::Statistics CachingDatabase::getStatistics() const
+{
+  std::lock_guard lock(mMutex);
+  auto statistics = mStatistics;
+  statistics.entries = mLru.size();
+  return statistics;
+}
+
+void CachingDatabase::sendMetrics(Monitoring& collector) const
+{
+  auto statistics = getStatistics();
+  collector.send(Metric{ "qc_object_cache" }
+                   .addValue(statistics.hits, "hits")
+                   .addValue(statistics.listed, "listed")
+                   .addValue(statistics.diskHits, "disk_hits")
+                   .addValue(statistics.misses, "misses")
+                   .addValue(statistics.outdated, "outdated")
+                   .addValue(statistics.evictions, "evictions")
+                   .addValue(statistics.bytes, "bytes")
+                   .addValue(statistics.entries, "entries"));
+}
+
+void CachingDatabase::clear()
+{
+  std::lock_guard lock(mMutex);
+  mLru.clear();
+  mIndex.clear();
+  mStatistics.bytes = 0;
+}
+
+std::string CachingDatabase::makeKey(const std::string& path, const std::map<std::string, std::string>& metadata)
+{
+  std::string key = path + "?";
+  for (const auto& [name, value] : metadata) {
+    key += name + "=" + value + "&";
+  }
+  return key;
+}
+
+bool CachingDatabase::isLatestInListing(const std::string& path, const std::map<std::string, std::string>& metadata, const Entry& entry) const
+{
+  // The database serves the most recent version valid at the timestamp. If no version of the path was created or
+  // modified after the cached one, it still serves the cached one. Objects modified after their creation are
+  // validated with their headers.
+  auto created = findHeader(entry.headers, metadata_keys::created);
+  if (!mLatestVersion || created == nullptr) {
+    return false;
+  }
+  auto latest = mLatestVersion(path, metadata);
+  try {
+    return latest.has_value() && latest.value() <= std::stoull(*created);
+  } catch (const std::exception&) {
+    return false;
+  }
+}
+
+std::shared_ptr<const CachingDatabase::Entry> CachingDatabase::findInMemory(const std::string& key, long timestamp)
+{
+  std::lock_guard lock(mMutex);
+  auto [begin, end] = mIndex.equal_range(key);
+  for (auto it = begin; it != end; ++it) {
+    const auto& entry = *it->second;
+    if (entry->validFrom <= timestamp && timestamp < entry->validUntil) {
+      mLru.splice(mLru.begin(), mLru, it->second);
+      return entry;
+    }
+  }
+  return nullptr;
+}
+
+void CachingDatabase::eraseFromMemory(const std::string& key, long validFrom)
+{
+  std::lock_guard lock(mMutex);
+  auto [begin, end] = mIndex.equal_range(key);
+  for (auto it = begin; it != end; ++it) {
+    if ((*it->second)->validFrom == validFrom) {
+      mStatistics.bytes -= (*it->second)->payload.size();
+      mLru.erase(it->second);
+      mIndex.erase(it);
+      return;
+    }
+  }
+}
+
+void CachingDatabase::insertInMemory(std::shared_ptr<const Entry> entry)
+{
+  if (entry->payload.size() > mConfig.maxBytes) {
+    return;
+  }
+  eraseFromMemory(entry->key, entry->validFrom);
+
+  std::lock_guard lock(mMutex);
+  mStatistics.bytes += entry->payload.size();
+  mLru.push_front(entry);
+  mIndex.emplace(entry->key, mLru.begin());
+
+  while (mStatistics.bytes > mConfig.maxBytes) {
+    auto last = std::prev(mLru.end());
+    auto [begin, end] = mIndex.equal_range((*last)->key);
+    for (auto it = begin; it != end; ++it) {
+      if (it->second == last) {
+        mIndex.erase(it);
+        break;
+      }
+    }
+    mStatistics.bytes -= (*last)->payload.size();
+    mStatistics.evictions++;
+    mLru.erase(last);
+  }
+}
+
+std::string CachingDatabase::diskPath(const std::string& key, long validFrom, long validUntil, const std::string& etag) const
+{
+  // the path of the object is kept in the directory structure for readability, the metadata are hashed.
+  // The files contain the raw TBufferFile content, not ROOT files, hence the extension.
+  auto path = key.substr(0, key.find('?'));
+  std::string sanitizedEtag;
+  for (char c : etag) {
+    if (std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_') {
+      sanitizedEtag += c;
+    }
+  }
+  auto fileName = std::to_string(std::hash<std::string>{}(key)) + "_" + std::to_string(validFrom) + "_" + std::to_string(validUntil) + "_" + sanitizedEtag + ".tbuf";
+  return (std::filesystem::path(mConfig.directory) / path / fileName).string();
+}
+
+std::shared_ptr<const CachingDatabase::Entry> CachingDatabase::readFromDisk(const std::string& key, const std::map<std::string, std::string>& currentHeaders) const
+{
+  // the file name contains the validity and the ETag of the object, so finding it is enough to know it is up-to-date
+  auto entry = std::make_shared<Entry>();
+  auto etag = findHeader(currentHeaders, etagHeader);
+  if (etag == nullptr || !getValidity(currentHeaders, entry->validFrom, entry->validUntil)) {
+    return nullptr;
+  }
+  std::ifstream file(diskPath(key, entry->validFrom, entry->validUntil, *etag), std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    return nullptr;
+  }
+  auto size = file.tellg();
+  file.seekg(0);
+  entry->payload.resize(size);
+  if (!file.read(entry->payload.data(), size)) {
+    return nullptr;
+  }
+  entry->key = key;
+  entry->headers = currentHeaders;
+  return entry;
+}
+
+void CachingDatabase::writeToDisk(const Entry& entry) const
+{
+  auto path = std::filesystem::path(diskPath(entry.key, entry.validFrom, entry.validUntil, entry.headers.at(etagHeader)));
+  std::error_code ec;
+  std::filesystem::create_directories(path.parent_path(), ec);
+  // we write to a temporary file first, so that concurrent processes never read an incomplete file
+  auto temporaryPath = path;
+  temporaryPath += ".tmp" + std::to_string(getpid()) + "_" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+  {
+    std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+    if (!file.write(entry.payload.data(), entry.payload.size())) {
+      ILOG(Warning, Support) << "Could not write the cached object to " << temporaryPath.string() << ENDM;
+      std::filesystem::remove(temporaryPath, ec);
+      return;
+    }
+  }
+  std::filesystem::rename(temporaryPath, path, ec);
+  if (ec) {
+    ILOG(Warning, Support) << "Could not write the cached object to " << path.string() << " (" << ec.message() << ")" << ENDM;
+    std::filesystem::remove(temporaryPath, ec);
+  }
+}
+
+} // namespace o2::quality_control::repository
@@ -293,6 +293,18 @@ TObject* CcdbDatabase::retrieveTObject(std::string path, std::map<std::string, s
   return object;
 }
 
+std::map<std::string, std::string> CcdbDatabase::retrieveHeaders(const std::string& path, const std::map<std::string, std::string>& metadata, long timestamp)
+{
+  if (timestamp == Timestamp::Latest) {
+    auto latestValidity = getLatestObjectValidity(path, metadata);
+    if (latestValidity.isInvalid()) {
+      return {};
+    }
+    timestamp = latestValidity.getMin();
+  }
+  return ccdbApi->retrieveHeaders(path, metadata, timestamp);
+}
+
 void* CcdbDatabase::retrieveAny(const type_info& tinfo, const string& path, const map<std::string, std::string>& metadata, long timestamp, std::map<std::string, std::string>* headers, const string& createdNotAfter, const string& createdNotBefore)
 {
   if (timestamp == Timestamp::Latest) {
@@ -328,7 +340,12 @@ std::shared_ptr<o2::quality_control::core::MonitorObject> CcdbDatabase::retrieve
     }
     return nullptr;
   }
+  return makeMonitorObject(obj, headers, fullPath, activity.mProvenance);
+}
 
+std::shared_ptr<o2::quality_control::core::MonitorObject> CcdbDatabase::makeMonitorObject(TObject* obj, std::map<std::string, std::string>& headers,
+                                                                                          const std::string& fullPath, const std::string& provenance)
+{
   // retrieve headers to determine the version of the QC framework
   Version objectVersion(headers[metadata_keys::qcVersion]);
   ILOG(Debug, Devel) << "Version of object is " << objectVersion << ENDM;
@@ -340,6 +357,7 @@ std::shared_ptr<o2::quality_control::core::MonitorObject> CcdbDatabase::retrieve
     mo.reset(dynamic_cast<MonitorObject*>(obj));
     if (mo == nullptr) {
       ILOG(Error, Devel) << "Could not cast the object " << fullPath << " to MonitorObject (objectVersion: " << objectVersion << ")" << ENDM;
+      delete obj;
       return nullptr;
     }
   } else {
@@ -349,7 +367,7 @@ std::shared_ptr<o2::quality_control::core::MonitorObject> CcdbDatabase::retrieve
     // TODO should we remove the headers we know are general such as ETag and qc_task_name ?
     mo->addMetadata(headers);
     // we could just copy the argument here, but this would not cover cases where the activity in headers has more non-default fields
-    mo->setActivity(activity_helpers::asActivity(headers, activity.mProvenance));
+    mo->setActivity(activity_helpers::asActivity(headers, provenance));
   }
   mo->setIsOwner(true);
   return mo;
@@ -367,14 +385,21 @@ std::shared_ptr<o2::quality_control::core::QualityObject> CcdbDatabase::retrieve
   if (obj == nullptr) {
     return nullptr;
   }
+  return makeQualityObject(obj, headers, fullPath, activity.mProvenance);
+}
+
+std::shared_ptr<o2::quality_control::core::QualityObject> CcdbDatabase::makeQualityObject(TObject* obj, const std::map<std::string, std::string>& headers,
+                                                                                          const std::string& fullPath, const std::string& provenance)
+{
   std::shared_ptr<QualityObject> qo(dynamic_cast<QualityObject*>(obj));
   if (qo == nullptr) {
     ILOG(Error, Devel) << "Could not cast the object " << fullPath << " to QualityObject" << ENDM;
+    delete obj;
   } else {
     // TODO should we remove the headers we know are general such as ETag and qc_task_name ?
     qo->addMetadata(headers);
     // we could just copy the argument here, but this would not cover cases where the activity in headers has more non-default fields
-    qo->setActivity(activity_helpers::asActivity(headers, activity.mProvenance));
+    qo->setActivity(activity_helpers::asActivity(headers, provenance));
   }
   return qo;
 }
@@ -483,7 +508,7 @@ std::vector<std::string> CcdbDatabase::getListing(const std::string& subpath)
   return result;
 }
 
-boost::property_tree::ptree CcdbDatabase::getListingAsPtree(const std::string& path, const std::map<std::string, std::string>& metadata, bool latestOnly)
+std::string CcdbDatabase::getListingAsJson(const std::string& path, const std::map<std::string, std::string>& metadata, bool latestOnly)
 {
   // CCDB accepts metadata filters as slash-separated key=value pairs at the end of the object path
   std::stringstream pathWithMetadata;
@@ -491,8 +516,12 @@ boost::property_tree::ptree CcdbDatabase::getListingAsPtree(const std::string& p
   for (const auto& [key, value] : metadata) {
     pathWithMetadata << '/' << key << '=' << value;
   }
+  return getListingAsString(pathWithMetadata.str(), "application/json", latestOnly);
+}
 
-  std::stringstream listingAsStringStream{ getListingAsString(pathWithMetadata.str(), "application/json", latestOnly) };
+boost::property_tree::ptree CcdbDatabase::getListingAsPtree(const std::string& path, const std::map<std::string, std::string>& metadata, bool latestOnly)
+{
+  std::stringstream listingAsStringStream{ getListingAsJson(path, metadata, latestOnly) };
 
   boost::property_tree::ptree listingAsTree;
   try {
@@ -108,7 +108,7 @@ QualityObjectsType Check::check(std::map<std::string, std::shared_ptr<MonitorObj
      */
     std::ranges::copy(mCheckConfig.objectNames |
                         std::views::filter([&](const auto& key) { return moMap.count(key) > 0; }) |
-                        std::views::transform([&](const auto& key) { return std::pair{ key, moMap[key] }; }),
+                        std::views::transform([&](const auto& key) { return std::pair{ key, moMap.at(key) }; }),
                       std::inserter(shadowMap, shadowMap.end()));
   }
 
@@ -183,6 +183,12 @@ void Check::beautify(std::map<std::string, std::shared_ptr<MonitorObject>>& moMa
   }
 
   for (auto const& item : moMap) {
+    // An object which was already beautified for this quality would be decorated twice
+    auto& beautified = mBeautifiedObjects[item.first];
+    if (beautified.object.lock() == item.second && beautified.quality == quality) {
+      continue;
+    }
+    beautified = { item.second, quality };
     try {
       mCheckInterface->beautify(item.second /*mo*/, quality);
     } catch (...) {
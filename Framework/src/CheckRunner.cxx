@@ -26,17 +26,27 @@
 #include <Monitoring/Monitoring.h>
 #include <CommonUtils/ConfigurableParam.h>
 
+#include <cstdint>
+#include <numeric>
 #include <utility>
 // QC
 #include "QualityControl/DatabaseFactory.h"
+#include "QualityControl/StorageQueue.h"
+#include "QualityControl/ThreadPool.h"
 #include "QualityControl/runnerUtils.h"
 #include "QualityControl/InfrastructureSpecReader.h"
 #include "QualityControl/CheckRunnerFactory.h"
 #include "QualityControl/RootClassFactory.h"
 #include "QualityControl/ConfigParamGlo.h"
 #include "QualityControl/Bookkeeping.h"
+#include "QualityControl/RepoPathUtils.h"
+#include "QualityControl/ObjectMetadataKeys.h"
+#include "QualityControl/MonitorObjectCollection.h"
 
 #include <TSystem.h>
+#include <TROOT.h>
+#include <TList.h>
+#include <TObjString.h>
 
 using namespace std::chrono;
 using namespace AliceO2::Common;
@@ -187,6 +197,11 @@ void CheckRunner::init(framework::InitContext& iCtx)
       check.init();
       updatePolicyManager.addPolicy(check.getName(), check.getUpdatePolicyType(), check.getObjectsNames(), check.getAllObjectsOption(), false);
     }
+    if (mConfig.checkThreads > 1 && mChecks.size() > 1) {
+      ROOT::EnableThreadSafety();
+      mCheckPool = std::make_shared<ThreadPool>(std::min(mConfig.checkThreads, mChecks.size()));
+      ILOG(Info, Devel) << "Checks will be executed by " << mCheckPool->getNThreads() << " threads" << ENDM;
+    }
   } catch (...) {
     // catch the exceptions and print it (the ultimate caller might not know how to display it)
     ILOG(Fatal, Ops) << "Unexpected exception during initialization: "
@@ -206,13 +221,20 @@ long getCurrentTimestamp()
 
 void CheckRunner::run(framework::ProcessingContext& ctx)
 {
-  prepareCacheData(ctx.inputs());
-
-  auto qualityObjects = check();
+  QualityObjectsType qualityObjects;
+  try {
+    prepareCacheData(ctx.inputs());
+    qualityObjects = check();
+  } catch (...) {
+    keepPendingInputs();
+    throw;
+  }
+  keepPendingInputs();
 
   auto now = getCurrentTimestamp();
   store(qualityObjects, now);
   store(mMonitorObjectStoreVector, now);
+  storeCycleManifests(mMonitorObjectStoreVector);
 
   send(qualityObjects, ctx.outputs());
 
@@ -229,56 +251,137 @@ void CheckRunner::prepareCacheData(framework::InputRecord& inputRecord)
   for (const auto& input : mInputs) {
     auto dataRef = inputRecord.get(input.binding.c_str());
     if (dataRef.header != nullptr && dataRef.payload != nullptr) {
+      auto label = DataSpecUtils::label(input);
+      auto& serializedInput = mSerializedInputs[label];
+      bool store = mInputStoreSet.count(label) > 0; // Check if this CheckRunner stores this input
 
-      // We don't know what we receive, so we test for an array and then try a tobject.
-      // If we received a tobject, it gets encapsulated in the tobjarray.
-      shared_ptr<TObjArray> array = nullptr;
-      auto tobj = DataRefUtils::as<TObject>(dataRef);
-      // if the object has not been found, it will raise an exception that we just let go.
-      if (tobj->InheritsFrom("TObjArray")) {
-        array.reset(dynamic_cast<TObjArray*>(tobj.release()));
-        array->SetOwner(false);
-        ILOG(Debug, Devel) << "CheckRunner " << mDeviceName
-                           << " received an array with " << array->GetEntries()
-                           << " entries from " << input.binding << ENDM;
+      if (serializedInput.isPending() && serializedInput.containsUnchangedMarkers()) {
+        // the new message might refer to objects which were sent only in the pending one
+        deserializeInput(input, serializedInput);
+      }
+      serializedInput.receive(dataRef);
+
+      // We deserialize the message now only if we do not know which objects it contains or if all of them are stored.
+      // Otherwise, we only mark the objects as updated and wait until a Check which is ready needs them.
+      if (serializedInput.isPending() && (!serializedInput.hasObjectNames() || store)) {
+        auto monitorObjects = deserializeInput(input, serializedInput);
+        if (store) { // Monitor Objects will be stored later, after possible beautification
+          mMonitorObjectStoreVector.insert(mMonitorObjectStoreVector.end(), monitorObjects.begin(), monitorObjects.end());
+        }
       } else {
-        // it is just a TObject not embedded in a TObjArray. We build a TObjArray for it.
-        auto* newArray = new TObjArray();    // we cannot use `array` to add an object as it is const
-        TObject* newTObject = tobj->Clone(); // we need a copy to avoid that it gets deleted behind our back.
-        newArray->Add(newTObject);
-        array.reset(newArray); // now that the array is ready we can adopt it.
-        ILOG(Debug, Devel) << "CheckRunner " << mDeviceName
-                           << " received a tobject named " << tobj->GetName()
-                           << " from " << input.binding << ENDM;
+        for (const auto& objectName : serializedInput.getObjectNames()) {
+          updatePolicyManager.updateObjectRevision(objectName);
+        }
       }
+      mTotalNumberObjectsReceived += serializedInput.getObjectNames().size();
+    }
+  }
+}
 
-      // for each item of the array, check whether it is a MonitorObject. If not, create one and encapsulate.
-      // Then, store the MonitorObject in the various maps and vectors we will use later.
-      bool store = mInputStoreSet.count(DataSpecUtils::label(input)) > 0; // Check if this CheckRunner stores this input
-      for (const auto tObject : *array) {
-        std::shared_ptr<MonitorObject> mo{ dynamic_cast<MonitorObject*>(tObject) };
-
-        if (mo == nullptr) {
-          ILOG(Debug, Devel) << "The MO is null, probably a TObject could not be casted into an MO." << ENDM;
-          ILOG(Debug, Devel) << "    Creating an ad hoc MO." << ENDM;
-          header::DataOrigin origin = DataSpecUtils::asConcreteOrigin(input);
-          mo = std::make_shared<MonitorObject>(tObject, input.binding, "CheckRunner", origin.str);
-          mo->setActivity(*mActivity);
-        }
+std::vector<std::shared_ptr<MonitorObject>> CheckRunner::deserializeInput(const framework::InputSpec& input, SerializedInput& serializedInput)
+{
+  // We don't know what we receive, so we test for an array and then try a tobject.
+  // If we received a tobject, it gets encapsulated in the tobjarray.
+  shared_ptr<TObjArray> array = nullptr;
+  auto tobj = serializedInput.deserialize();
+  mTotalNumberMessagesDeserialized++;
+  // if the object has not been found, it will raise an exception that we just let go.
+  if (tobj->InheritsFrom("TObjArray")) {
+    array.reset(dynamic_cast<TObjArray*>(tobj.release()));
+    array->SetOwner(false);
+    ILOG(Debug, Devel) << "CheckRunner " << mDeviceName
+                       << " received an array with " << array->GetEntries()
+                       << " entries from " << input.binding << ENDM;
+  } else {
+    // it is just a TObject not embedded in a TObjArray. We build a TObjArray for it.
+    // The deserialized object is already ours, no need to clone it.
+    auto* newArray = new TObjArray();
+    ILOG(Debug, Devel) << "CheckRunner " << mDeviceName
+                       << " received a tobject named " << tobj->GetName()
+                       << " from " << input.binding << ENDM;
+    newArray->Add(tobj.release());
+    array.reset(newArray); // now that the array is ready we can adopt it.
+  }
+
+  return cacheMonitorObjects(input, *array, serializedInput);
+}
+
+std::vector<std::shared_ptr<MonitorObject>> CheckRunner::cacheMonitorObjects(const framework::InputSpec& input, TObjArray& array, SerializedInput& serializedInput)
+{
+  // tasks may send their objects encoded to save bandwidth
+  if (auto collection = dynamic_cast<MonitorObjectCollection*>(&array); collection != nullptr && collection->isEncoded()) {
+    try {
+      collection->decode();
+    } catch (const std::exception& e) {
+      ILOG(Error, Support) << "CheckRunner " << mDeviceName << " could not decode the objects received from "
+                           << input.binding << ", they are skipped: " << e.what() << ENDM;
+      // the objects decoded before the error are not owned by anybody
+      array.Delete();
+      return {};
+    }
+  }
 
-        if (mo) {
-          mo->setIsOwner(true);
-          mMonitorObjects[mo->getFullName()] = mo;
-          updatePolicyManager.updateObjectRevision(mo->getFullName());
-          mTotalNumberObjectsReceived++;
+  // for each item of the array, check whether it is a MonitorObject. If not, create one and encapsulate.
+  // Then, store the MonitorObject in the various maps and vectors we will use later.
+  std::vector<std::shared_ptr<MonitorObject>> monitorObjects;
+  std::vector<std::string> objectNames;
+  bool containsUnchangedMarkers = false;
+  for (const auto tObject : array) {
+    std::shared_ptr<MonitorObject> mo{ dynamic_cast<MonitorObject*>(tObject) };
+
+    if (mo == nullptr) {
+      ILOG(Debug, Devel) << "The MO is null, probably a TObject could not be casted into an MO." << ENDM;
+      ILOG(Debug, Devel) << "    Creating an ad hoc MO." << ENDM;
+      header::DataOrigin origin = DataSpecUtils::asConcreteOrigin(input);
+      mo = std::make_shared<MonitorObject>(tObject, input.binding, "CheckRunner", origin.str);
+      mo->setActivity(*mActivity);
+    }
 
-          if (store) { // Monitor Object will be stored later, after possible beautification
-            mMonitorObjectStoreVector.push_back(mo);
-          }
+    if (mo && mo->isUnchangedMarker()) {
+      mo->setIsOwner(true);
+      containsUnchangedMarkers = true;
+      objectNames.push_back(mo->getFullName());
+      // The object did not change since its last publication, we keep the one we have, but extend its validity.
+      // It is returned like a new one, so that stored inputs upload it again with the extended validity.
+      if (auto existing = mMonitorObjects.find(mo->getFullName()); existing != mMonitorObjects.end()) {
+        if (mo->getValidity().isValid()) {
+          existing->second->updateValidity(mo->getValidity().getMin());
+          existing->second->updateValidity(mo->getValidity().getMax());
         }
+        updatePolicyManager.updateObjectRevision(mo->getFullName());
+        monitorObjects.push_back(existing->second);
       }
+      continue;
+    }
+
+    if (mo) {
+      mo->setIsOwner(true);
+      mMonitorObjects[mo->getFullName()] = mo;
+      updatePolicyManager.updateObjectRevision(mo->getFullName());
+      objectNames.push_back(mo->getFullName());
+      monitorObjects.push_back(mo);
     }
   }
+  serializedInput.setObjectNames(std::move(objectNames));
+  serializedInput.setContainsUnchangedMarkers(containsUnchangedMarkers);
+  return monitorObjects;
+}
+
+void CheckRunner::deserializePendingInputs(const framework::Inputs& inputs)
+{
+  for (const auto& input : inputs) {
+    auto serializedInput = mSerializedInputs.find(DataSpecUtils::label(input));
+    if (serializedInput != mSerializedInputs.end() && serializedInput->second.isPending()) {
+      deserializeInput(input, serializedInput->second);
+    }
+  }
+}
+
+void CheckRunner::keepPendingInputs()
+{
+  for (auto& [label, serializedInput] : mSerializedInputs) {
+    serializedInput.keepPayload();
+  }
 }
 
 void CheckRunner::sendPeriodicMonitoring()
@@ -291,39 +394,119 @@ void CheckRunner::sendPeriodicMonitoring()
     double rateQOs = mNumberQOStored / timeSinceLastCall;
     mCollector->send({ mTotalNumberObjectsReceived, "qc_checkrunner_objects_received" });
     mCollector->send({ mTotalNumberCheckExecuted, "qc_checkrunner_checks_executed" });
+    uint64_t messagesSkipped = 0;
+    for (const auto& [label, serializedInput] : mSerializedInputs) {
+      messagesSkipped += serializedInput.getNumberSkipped();
+    }
+    mCollector->send(Metric{ "qc_checkrunner_messages" }
+                       .addValue(mTotalNumberMessagesDeserialized, "deserialized")
+                       .addValue(messagesSkipped, "skipped"));
     mCollector->send(Metric{ "qc_checkrunner_stored" }
                        .addValue(mTotalNumberMOStored, "mos")
                        .addValue(rateMOs, "mos_per_second")
                        .addValue(mTotalNumberQOStored, "qos")
-                       .addValue(rateQOs, "qos_per_second"));
+                       .addValue(rateQOs, "qos_per_second")
+                       .addValue(mTotalNumberManifestsNotQueued, "manifests_not_queued"));
     mCollector->send({ mTotalQOSent, "qc_checkrunner_qo_sent" });
     mCollector->send({ mTimerTotalDurationActivity.getTime(), "qc_checkrunner_duration" });
+    if (mStorageQueue) {
+      mStorageQueue->sendMetrics(*mCollector);
+    }
     mNumberQOStored = 0;
     mNumberMOStored = 0;
   }
 }
 
+std::vector<std::vector<size_t>> CheckRunner::groupChecksSharingObjects(const std::vector<CheckConfig>& checks)
+{
+  auto shareObjects = [](const CheckConfig& a, const CheckConfig& b) {
+    if (a.allObjects || b.allObjects) {
+      return true;
+    }
+    return std::ranges::any_of(a.objectNames, [&b](const std::string& name) {
+      return std::ranges::find(b.objectNames, name) != b.objectNames.end();
+    });
+  };
+
+  // union-find of the checks which cannot run concurrently, because one of them beautifies an object used by the other
+  std::vector<size_t> parent(checks.size());
+  std::iota(parent.begin(), parent.end(), 0);
+  std::function<size_t(size_t)> root = [&](size_t i) { return parent[i] == i ? i : parent[i] = root(parent[i]); };
+  for (size_t i = 0; i < checks.size(); i++) {
+    for (size_t j = i + 1; j < checks.size(); j++) {
+      if ((checks[i].allowBeautify || checks[j].allowBeautify) && shareObjects(checks[i], checks[j])) {
+        parent[std::max(root(i), root(j))] = std::min(root(i), root(j));
+      }
+    }
+  }
+
+  std::vector<std::vector<size_t>> groups;
+  std::vector<size_t> groupOfRoot(checks.size(), SIZE_MAX);
+  for (size_t i = 0; i < checks.size(); i++) {
+    auto& group = groupOfRoot[root(i)];
+    if (group == SIZE_MAX) {
+      group = groups.size();
+      groups.emplace_back();
+    }
+    groups[group].push_back(i);
+  }
+  return groups;
+}
+
 QualityObjectsType CheckRunner::check()
 {
   ILOG(Debug, Devel) << "Trying " << mChecks.size() << " checks for " << mMonitorObjects.size() << " monitor objects"
                      << ENDM;
 
-  QualityObjectsType allQOs;
+  std::vector<Check*> readyChecks;
   for (auto& [checkName, check] : mChecks) {
     if (updatePolicyManager.isReady(check.getName())) {
       ILOG(Debug, Support) << "Monitor Objects for the check '" << checkName << "' are ready --> check()" << ENDM;
-      auto newQOs = check.check(mMonitorObjects);
-      mTotalNumberCheckExecuted += newQOs.size();
-
-      allQOs.insert(allQOs.end(), std::make_move_iterator(newQOs.begin()), std::make_move_iterator(newQOs.end()));
-      newQOs.clear();
-
-      // Was checked, update latest revision
-      updatePolicyManager.updateActorRevision(checkName);
+      deserializePendingInputs(check.getInputs());
+      readyChecks.push_back(&check);
     } else {
       ILOG(Debug, Support) << "Monitor Objects for the check '" << checkName << "' are not ready, ignoring" << ENDM;
     }
   }
+
+  // QOs are kept per check, so that they are returned in the same order regardless of the execution order
+  std::vector<QualityObjectsType> qosPerCheck(readyChecks.size());
+  if (mCheckPool && readyChecks.size() > 1) {
+    // Checks beautifying an object used by another Check run sequentially in the same group, the groups run in parallel.
+    // The objects map itself is not modified until all the Checks are done.
+    std::vector<CheckConfig> readyConfigs;
+    for (const auto* check : readyChecks) {
+      readyConfigs.push_back(check->getConfig());
+    }
+    std::vector<std::future<void>> futures;
+    for (const auto& group : groupChecksSharingObjects(readyConfigs)) {
+      futures.push_back(mCheckPool->submit([this, group, &readyChecks, &qosPerCheck]() {
+        for (auto i : group) {
+          qosPerCheck[i] = readyChecks[i]->check(mMonitorObjects);
+        }
+      }));
+    }
+    for (auto& future : futures) {
+      future.wait();
+    }
+    for (auto& future : futures) {
+      future.get(); // rethrows the exceptions which might have been thrown by the Checks
+    }
+  } else {
+    for (size_t i = 0; i < readyChecks.size(); i++) {
+      qosPerCheck[i] = readyChecks[i]->check(mMonitorObjects);
+    }
+  }
+
+  QualityObjectsType allQOs;
+  for (size_t i = 0; i < readyChecks.size(); i++) {
+    auto& newQOs = qosPerCheck[i];
+    mTotalNumberCheckExecuted += newQOs.size();
+    allQOs.insert(allQOs.end(), std::make_move_iterator(newQOs.begin()), std::make_move_iterator(newQOs.end()));
+
+    // Was checked, update latest revision
+    updatePolicyManager.updateActorRevision(readyChecks[i]->getName());
+  }
   return allQOs;
 }
 
@@ -332,7 +515,14 @@ void CheckRunner::store(QualityObjectsType& qualityObjects, long validFrom)
   ILOG(Debug, Devel) << "Storing " << qualityObjects.size() << " QualityObjects" << ENDM;
   try {
     for (auto& qo : qualityObjects) {
-      mDatabase->storeQO(qo);
+      if (mStorageQueue) {
+        // QOs are created anew by each check, nobody else modifies them after this point
+        if (!mStorageQueue->push(std::shared_ptr<const QualityObject>(qo))) {
+          continue;
+        }
+      } else {
+        mDatabase->storeQO(qo);
+      }
       mTotalNumberQOStored++;
       mNumberQOStored++;
     }
@@ -350,7 +540,14 @@ void CheckRunner::store(std::vector<std::shared_ptr<MonitorObject>>& monitorObje
   ILOG(Debug, Devel) << "Storing " << monitorObjects.size() << " MonitorObjects" << ENDM;
   try {
     for (auto& mo : monitorObjects) {
-      mDatabase->storeMO(mo);
+      if (mStorageQueue) {
+        // The MO might be beautified again by a check while it is being uploaded, thus we give a copy to the queue.
+        if (!mStorageQueue->push(std::make_shared<const MonitorObject>(*mo))) {
+          continue;
+        }
+      } else {
+        mDatabase->storeMO(mo);
+      }
 
       mTotalNumberMOStored++;
       mNumberMOStored++;
@@ -364,6 +561,59 @@ void CheckRunner::store(std::vector<std::shared_ptr<MonitorObject>>& monitorObje
   }
 }
 
+std::vector<std::shared_ptr<MonitorObject>> CheckRunner::makeCycleManifests(const std::vector<std::shared_ptr<MonitorObject>>& monitorObjects)
+{
+  // the objects of one task are received together, we group them by task folder
+  std::map<std::string, std::vector<std::shared_ptr<MonitorObject>>> objectsPerTask;
+  for (const auto& mo : monitorObjects) {
+    objectsPerTask[RepoPathUtils::getMoPath(mo->getDetectorName(), mo->getTaskName(), "", mo->getActivity().mProvenance)].push_back(mo);
+  }
+
+  std::vector<std::shared_ptr<MonitorObject>> manifests;
+  for (const auto& [taskPath, objects] : objectsPerTask) {
+    const auto& first = objects.front();
+    auto* names = new TList();
+    names->SetName(RepoPathUtils::cycleManifestName);
+    names->SetOwner(true);
+    for (const auto& mo : objects) {
+      names->Add(new TObjString(mo->getName().c_str()));
+    }
+    auto manifest = std::make_shared<MonitorObject>(names, first->getTaskName(), first->getTaskClass(), first->getDetectorName());
+    manifest->setIsOwner(true);
+    manifest->setActivity(first->getActivity());
+    for (const auto& mo : objects) {
+      manifest->updateValidity(mo->getValidity().getMin());
+      manifest->updateValidity(mo->getValidity().getMax());
+    }
+    if (auto cycle = first->getMetadata(repository::metadata_keys::cycleNumber); cycle.has_value()) {
+      manifest->addOrUpdateMetadata(repository::metadata_keys::cycleNumber, cycle.value());
+    }
+    manifests.push_back(std::move(manifest));
+  }
+  return manifests;
+}
+
+void CheckRunner::storeCycleManifests(const std::vector<std::shared_ptr<MonitorObject>>& monitorObjects)
+{
+  for (const auto& manifest : makeCycleManifests(monitorObjects)) {
+    try {
+      if (mStorageQueue) {
+        if (mStorageQueue->pushAfterPrevious(manifest)) {
+          continue;
+        }
+        // Triggers waiting for the manifest would otherwise wait until their timeout. It is stored synchronously,
+        // after the objects of the cycle, so that it is still the last one.
+        ILOG(Warning, Support) << "The storage queue dropped the cycle manifest of " << manifest->getTaskName() << ", storing it synchronously" << ENDM;
+        mTotalNumberManifestsNotQueued++;
+        mStorageQueue->flush();
+      }
+      mDatabase->storeMO(manifest);
+    } catch (boost::exception& e) {
+      ILOG(Info, Support) << "Unable to store the cycle manifest of " << manifest->getTaskName() << ": " << diagnostic_information(e) << ENDM;
+    }
+  }
+}
+
 void CheckRunner::send(QualityObjectsType& qualityObjects, framework::DataAllocator& allocator)
 {
   // Note that we might send multiple QOs in one output, as separate parts.
@@ -415,6 +665,16 @@ void CheckRunner::initDatabase()
   mDatabase = DatabaseFactory::create(mConfig.database.at("implementation"));
   mDatabase->connect(mConfig.database);
   ILOG(Info, Devel) << "Database that is going to be used > Implementation : " << mConfig.database.at("implementation") << " / Host : " << mConfig.database.at("host") << ENDM;
+
+  auto storageQueueConfig = StorageQueueConfig::fromDatabaseConfig(mConfig.database);
+  if (storageQueueConfig.enabled) {
+    // each worker gets its own connection, so that we do not share the underlying http client between threads
+    mStorageQueue = std::make_shared<StorageQueue>(storageQueueConfig, [databaseConfig = mConfig.database]() {
+      auto database = DatabaseFactory::create(databaseConfig.at("implementation"));
+      database->connect(databaseConfig);
+      return database;
+    });
+  }
 }
 
 void CheckRunner::initMonitoring()
@@ -440,6 +700,9 @@ void CheckRunner::initLibraries()
 void CheckRunner::endOfStream(framework::EndOfStreamContext& eosContext)
 {
   mReceivedEOS = true;
+  if (mStorageQueue) {
+    mStorageQueue->flush();
+  }
 }
 
 void CheckRunner::start(ServiceRegistryRef services)
@@ -451,6 +714,7 @@ void CheckRunner::start(ServiceRegistryRef services)
   mTimerTotalDurationActivity.reset();
   mCollector->setRunNumber(mActivity->mId);
   mReceivedEOS = false;
+  mSerializedInputs.clear();
   for (auto& [checkName, check] : mChecks) {
     check.startOfActivity(*mActivity);
   }
@@ -468,6 +732,10 @@ void CheckRunner::stop()
   if (!mReceivedEOS) {
     ILOG(Warning, Devel) << "The STOP transition happened before an EndOfStream was received. The very last QC objects in this run might not have been stored." << ENDM;
   }
+  if (mStorageQueue) {
+    ILOG(Debug, Devel) << "Waiting for " << mStorageQueue->getNumberInFlight() << " objects to be stored" << ENDM;
+    mStorageQueue->flush();
+  }
   for (auto& [checkName, check] : mChecks) {
     check.endOfActivity(*mActivity);
   }
@@ -489,11 +757,13 @@ void CheckRunner::reset()
   }
 
   mTotalNumberObjectsReceived = 0;
+  mTotalNumberMessagesDeserialized = 0;
   mTotalNumberCheckExecuted = 0;
   mTotalNumberMOStored = 0;
   mNumberMOStored = 0;
   mTotalNumberQOStored = 0;
   mNumberQOStored = 0;
+  mTotalNumberManifestsNotQueued = 0;
   mTotalQOSent = 0;
 }
 
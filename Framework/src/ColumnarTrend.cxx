@@ -0,0 +1,114 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    ColumnarTrend.cxx
+///
+
+#include "QualityControl/ColumnarTrend.h"
+
+#include <TTree.h>
+#include <TBranch.h>
+#include <TLeaf.h>
+#include <TLeafC.h>
+#include <TLeafElement.h>
+#include <TLeafObject.h>
+#include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+namespace o2::quality_control::postprocessing
+{
+
+void ColumnarTrend::appendCurrent(TTree& tree)
+{
+  for (auto* branchObject : *tree.GetListOfBranches()) {
+    auto* branch = static_cast<TBranch*>(branchObject);
+    for (auto* leafObject : *branch->GetListOfLeaves()) {
+      auto* leaf = static_cast<TLeaf*>(leafObject);
+      if (dynamic_cast<TLeafC*>(leaf) || dynamic_cast<TLeafElement*>(leaf) || dynamic_cast<TLeafObject*>(leaf) || leaf->GetLen() != 1) {
+        continue;
+      }
+      std::string leafName = leaf->GetName();
+      std::string name = std::string(branch->GetName()) + "." + leafName;
+      if (leafName == branch->GetName()) {
+        mAliases[name] = leafName;
+        name = leafName;
+      }
+      auto& column = mColumns[name];
+      // a column which did not exist so far is padded, so all of them stay aligned
+      column.resize(mSize, std::nan(""));
+      column.push_back(leaf->GetValue(0));
+    }
+  }
+  mSize++;
+}
+
+void ColumnarTrend::readFrom(TTree& tree)
+{
+  clear();
+  for (Long64_t i = 0; i < tree.GetEntries(); i++) {
+    tree.GetEntry(i);
+    appendCurrent(tree);
+  }
+}
+
+void ColumnarTrend::clear()
+{
+  mColumns.clear();
+  mAliases.clear();
+  mSize = 0;
+}
+
+const std::vector<double>* ColumnarTrend::getColumn(const std::string& name) const
+{
+  auto alias = mAliases.find(name);
+  auto column = mColumns.find(alias == mAliases.end() ? name : alias->second);
+  if (column == mColumns.end() || column->second.size() != mSize) {
+    return nullptr;
+  }
+  return &column->second;
+}
+
+bool ColumnarTrend::isPlainName(const std::string& expression)
+{
+  if (expression.empty() || std::isdigit(static_cast<unsigned char>(expression.front())) || expression.front() == '.' || expression.back() == '.') {
+    return false;
+  }
+  return std::all_of(expression.begin(), expression.end(), [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.'; });
+}
+
+std::optional<ColumnarTrend::Series> ColumnarTrend::evaluate(const std::string& varexp, const std::string& selection) const
+{
+  if (!boost::algorithm::trim_copy(selection).empty()) {
+    return std::nullopt;
+  }
+  std::vector<std::string> variables;
+  boost::algorithm::split(variables, varexp, boost::is_any_of(":"));
+  if (variables.size() != 2) {
+    return std::nullopt;
+  }
+  for (auto& variable : variables) {
+    boost::algorithm::trim(variable);
+    if (!isPlainName(variable)) {
+      return std::nullopt;
+    }
+  }
+  auto y = getColumn(variables[0]);
+  auto x = getColumn(variables[1]);
+  if (y == nullptr || x == nullptr) {
+    return std::nullopt;
+  }
+  return Series{ *y, *x };
+}
+
+} // namespace o2::quality_control::postprocessing
@@ -19,6 +19,7 @@
 // O2
 #include <Common/Exceptions.h>
 // QC
+#include "QualityControl/CachingDatabase.h"
 #include "QualityControl/CcdbDatabase.h"
 #include "QualityControl/DummyDatabase.h"
 #include "QualityControl/QcInfoLogger.h"
@@ -56,4 +57,16 @@ std::unique_ptr<DatabaseInterface> DatabaseFactory::create(std::string name)
   return nullptr;
 }
 
+std::unique_ptr<DatabaseInterface> DatabaseFactory::create(const std::unordered_map<std::string, std::string>& databaseConfig)
+{
+  if (databaseConfig.count("implementation") == 0) {
+    BOOST_THROW_EXCEPTION(FatalException() << errinfo_details("No database implementation in the configuration"));
+  }
+  auto database = create(databaseConfig.at("implementation"));
+  if (auto cacheConfig = CachingDatabaseConfig::fromDatabaseConfig(databaseConfig); cacheConfig.enabled) {
+    database = std::make_unique<CachingDatabase>(std::move(database), std::move(cacheConfig));
+  }
+  return database;
+}
+
 } // namespace o2::quality_control::repository
@@ -0,0 +1,194 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    DownsampledTrend.cxx
+///
+
+#include "QualityControl/DownsampledTrend.h"
+
+#include <TGraph.h>
+#include <TGraphAsymmErrors.h>
+#include <algorithm>
+#include <cmath>
+
+namespace o2::quality_control::postprocessing
+{
+
+namespace
+{
+void combine(DownsampledTrend::Point& into, const DownsampledTrend::Point& point)
+{
+  if (point.count == 0) {
+    return;
+  }
+  if (into.count == 0) {
+    into = point;
+    return;
+  }
+  into.timeStart = std::min(into.timeStart, point.timeStart);
+  into.timeEnd = std::max(into.timeEnd, point.timeEnd);
+  into.min = std::min(into.min, point.min);
+  into.max = std::max(into.max, point.max);
+  into.sum += point.sum;
+  into.count += point.count;
+}
+} // namespace
+
+DownsampledTrend::DownsampledTrend(size_t capacity, size_t tiers, size_t factor)
+  : mCapacity(capacity), mFactor(std::max<size_t>(factor, 2)), mTiers(std::max<size_t>(tiers, 1))
+{
+}
+
+void DownsampledTrend::add(double time, double value)
+{
+  add(Point{ time, time, value, value, value, 1 });
+}
+
+void DownsampledTrend::add(const Point& point)
+{
+  if (point.count == 0) {
+    return;
+  }
+  push(0, point);
+}
+
+void DownsampledTrend::push(size_t tier, const Point& point)
+{
+  auto& points = mTiers[tier];
+  points.push_back(point);
+  if (mCapacity == 0 || points.size() <= mCapacity) {
+    return;
+  }
+  if (tier + 1 == mTiers.size()) {
+    points.pop_front();
+    return;
+  }
+  Point aggregate;
+  for (size_t i = 0; i < mFactor && !points.empty(); i++) {
+    combine(aggregate, points.front());
+    points.pop_front();
+  }
+  push(tier + 1, aggregate);
+}
+
+void DownsampledTrend::merge(const DownsampledTrend& other)
+{
+  auto points = getPoints();
+  auto otherPoints = other.getPoints();
+  points.insert(points.end(), otherPoints.begin(), otherPoints.end());
+  std::stable_sort(points.begin(), points.end(), [](const Point& a, const Point& b) { return a.timeStart < b.timeStart; });
+
+  clear();
+  for (const auto& point : points) {
+    add(point);
+  }
+}
+
+void DownsampledTrend::clear()
+{
+  for (auto& tier : mTiers) {
+    tier.clear();
+  }
+}
+
+std::vector<DownsampledTrend::Point> DownsampledTrend::getPoints() const
+{
+  std::vector<Point> points;
+  points.reserve(size());
+  for (auto tier = mTiers.rbegin(); tier != mTiers.rend(); ++tier) {
+    points.insert(points.end(), tier->begin(), tier->end());
+  }
+  return points;
+}
+
+size_t DownsampledTrend::size() const
+{
+  size_t size = 0;
+  for (const auto& tier : mTiers) {
+    size += tier.size();
+  }
+  return size;
+}
+
+void DownsampledTrend::fill(TGraph& graph) const
+{
+  auto points = getPoints();
+  graph.Set(static_cast<Int_t>(points.size()));
+  for (size_t i = 0; i < points.size(); i++) {
+    graph.SetPoint(static_cast<Int_t>(i), points[i].time(), points[i].mean());
+  }
+}
+
+void DownsampledTrend::fill(TGraphAsymmErrors& graph) const
+{
+  auto points = getPoints();
+  graph.Set(static_cast<Int_t>(points.size()));
+  for (size_t i = 0; i < points.size(); i++) {
+    const auto& point = points[i];
+    graph.SetPoint(static_cast<Int_t>(i), point.time(), point.mean());
+    graph.SetPointError(static_cast<Int_t>(i), point.time() - point.timeStart, point.timeEnd - point.time(),
+                        point.mean() - point.min, point.max - point.mean());
+  }
+}
+
+std::vector<size_t> DownsampledTrend::selectSamples(const std::vector<double>& times, size_t capacity, size_t tiers, size_t factor)
+{
+  std::vector<size_t> selected;
+  const size_t n = times.size();
+  if (capacity == 0 || n <= capacity) {
+    selected.resize(n);
+    for (size_t i = 0; i < n; i++) {
+      selected[i] = i;
+    }
+    return selected;
+  }
+
+  // the most recent samples are kept at full resolution
+  for (size_t i = n; i > n - capacity; i--) {
+    selected.push_back(i - 1);
+  }
+
+  // the widths of the bins of the coarser tiers are derived from the mean spacing of the most recent samples
+  factor = std::max<size_t>(factor, 2);
+  double spacing = capacity > 1 ? (times[n - 1] - times[n - capacity]) / static_cast<double>(capacity - 1) : 0;
+  if (!(spacing > 0)) {
+    spacing = 1;
+  }
+  auto binOf = [](double time, double width) { return static_cast<int64_t>(std::floor(time / width)); };
+  const auto binsPerTier = static_cast<int64_t>(capacity);
+
+  size_t tier = 1;
+  double width = spacing * factor;
+  int64_t newestBin = binOf(times[n - capacity], width);
+  int64_t lastKeptBin = newestBin + 1;
+  for (size_t i = n - capacity; i > 0 && tier < tiers; i--) {
+    auto bin = binOf(times[i - 1], width);
+    while (bin <= newestBin - binsPerTier && tier < tiers) {
+      // the sample is older than what the current tier can hold, we move to the next one
+      double tierStart = static_cast<double>(newestBin - binsPerTier + 1) * width;
+      tier++;
+      width *= factor;
+      newestBin = binOf(tierStart, width);
+      lastKeptBin = newestBin + 1;
+      bin = binOf(times[i - 1], width);
+    }
+    if (tier < tiers && bin != lastKeptBin) {
+      selected.push_back(i - 1);
+      lastKeptBin = bin;
+    }
+  }
+
+  std::reverse(selected.begin(), selected.end());
+  return selected;
+}
+
+} // namespace o2::quality_control::postprocessing
@@ -81,6 +81,7 @@ CommonSpec InfrastructureSpecReader::readSpecEntry<CommonSpec>(const std::string
   spec.bookkeepingUrl = commonTree.get<std::string>("bookkeeping.url", spec.bookkeepingUrl);
   spec.kafkaBrokersUrl = commonTree.get<std::string>("kafka.url", spec.kafkaBrokersUrl);
   spec.kafkaTopicAliECSRun = commonTree.get<std::string>("kafka.topicAliecsRun", spec.kafkaTopicAliECSRun);
+  spec.checkRunnerThreads = commonTree.get<size_t>("checkRunner.threads", spec.checkRunnerThreads);
 
   return spec;
 }
@@ -100,6 +101,15 @@ TaskSpec InfrastructureSpecReader::readSpecEntry<TaskSpec>(const std::string& ta
   ts.moduleName = taskTree.get<std::string>("moduleName");
   ts.detectorName = taskTree.get<std::string>("detectorName");
   ts.disableLastCycle = taskTree.get<bool>("disableLastCycle", false);
+  ts.skipUnchangedObjects = taskTree.get<bool>("skipUnchangedObjects", false);
+  ts.profiling = taskTree.get<bool>("profiling", false);
+  ts.profilingTraceFile = taskTree.get<std::string>("profilingTraceFile", "");
+  ts.serializationAccounting = taskTree.get<bool>("serializationAccounting", false);
+  ts.publicationBudgetBytes = taskTree.get<size_t>("publicationBudgetBytes", 0);
+  ts.dropObjectsOverBudget = taskTree.get<bool>("dropObjectsOverBudget", false);
+  ts.transportCompression = taskTree.get<std::string>("transportEncoding.compression", ts.transportCompression);
+  ts.transportCompressionLevel = taskTree.get<int>("transportEncoding.level", ts.transportCompressionLevel);
+  ts.transportSparseOccupancy = taskTree.get<double>("transportEncoding.sparseOccupancy", ts.transportSparseOccupancy);
   ts.cycleDurationSeconds = taskTree.get<int>("cycleDurationSeconds", -1);
   if (taskTree.count("cycleDurations") > 0) {
     for (const auto& cycleConfig : taskTree.get_child("cycleDurations")) {
@@ -181,6 +191,12 @@ TaskSpec InfrastructureSpecReader::readSpecEntry<TaskSpec>(const std::string& ta
     }
   }
 
+  if (taskTree.count("lowPriorityObjects") > 0) {
+    for (const auto& [key, value] : taskTree.get_child("lowPriorityObjects")) {
+      ts.lowPriorityObjects.emplace_back(value.get_value<std::string>());
+    }
+  }
+
   return ts;
 }
 
@@ -0,0 +1,341 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    ListingWatcher.cxx
+///
+
+#include "QualityControl/ListingWatcher.h"
+#include "QualityControl/CcdbDatabase.h"
+#include "QualityControl/ObjectMetadataKeys.h"
+#include "QualityControl/QcInfoLogger.h"
+
+#include <algorithm>
+#include <cctype>
+#include <rapidjson/memorystream.h>
+#include <rapidjson/reader.h>
+
+using namespace o2::quality_control::repository;
+
+namespace o2::quality_control::postprocessing
+{
+
+namespace
+{
+// SAX handler which keeps only the fields of the elements of the "objects" array that we need.
+// Expected layout: { "objects": [ { "path": "...", "validFrom": 1, ... }, ... ], "subfolders": [ ... ] }
+class ListingHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, ListingHandler>
+{
+ public:
+  explicit ListingHandler(std::vector<ListingWatcher::ObjectVersion>& versions) : mVersions(versions) {}
+
+  bool StartObject()
+  {
+    mDepth++;
+    if (mInObjects && mDepth == 3) {
+      mVersions.emplace_back();
+    }
+    return true;
+  }
+  bool EndObject(rapidjson::SizeType)
+  {
+    mDepth--;
+    return true;
+  }
+  bool StartArray()
+  {
+    mDepth++;
+    if (mDepth == 2 && mKey == "objects") {
+      mInObjects = true;
+    }
+    return true;
+  }
+  bool EndArray(rapidjson::SizeType)
+  {
+    if (mDepth == 2) {
+      mInObjects = false;
+    }
+    mDepth--;
+    return true;
+  }
+  bool Key(const char* str, rapidjson::SizeType length, bool)
+  {
+    mKey.assign(str, length);
+    return true;
+  }
+  bool String(const char* str, rapidjson::SizeType length, bool)
+  {
+    if (isObjectField()) {
+      std::string_view value(str, length);
+      if (mKey == "path") {
+        mVersions.back().path = value;
+      } else if (mKey == metadata_keys::cycleNumber) {
+        mVersions.back().cycleNumber = value;
+      } else if (!value.empty() && std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        // some servers quote the numbers
+        setNumber(std::stoull(std::string(value)));
+      }
+    }
+    return true;
+  }
+  bool Uint(unsigned value) { return setNumber(value); }
+  bool Int(int value) { return setNumber(value < 0 ? 0 : value); }
+  bool Uint64(uint64_t value) { return setNumber(value); }
+  bool Int64(int64_t value) { return setNumber(value < 0 ? 0 : value); }
+  bool Double(double value) { return setNumber(value < 0 ? 0 : static_cast<uint64_t>(value)); }
+
+ private:
+  bool isObjectField() const { return mInObjects && mDepth == 3 && !mVersions.empty(); }
+  bool setNumber(uint64_t value)
+  {
+    if (isObjectField()) {
+      if (mKey == "validFrom") {
+        mVersions.back().validFrom = value;
+      } else if (mKey == "validUntil") {
+        mVersions.back().validUntil = value;
+      } else if (mKey == metadata_keys::lastModified) {
+        mVersions.back().lastModified = value;
+      } else if (mKey == metadata_keys::cycleNumber) {
+        mVersions.back().cycleNumber = std::to_string(value);
+      }
+    }
+    return true;
+  }
+
+  std::vector<ListingWatcher::ObjectVersion>& mVersions;
+  std::string mKey;
+  int mDepth = 0;
+  bool mInObjects = false;
+};
+
+// the listing interprets the path as a regular expression, while object paths may contain e.g. '+' or '.'
+std::string escapeRegex(const std::string& text)
+{
+  static const std::string metacharacters = R"(\^$.|?*+()[]{})";
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (char c : text) {
+    if (metacharacters.find(c) != std::string::npos) {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped;
+}
+
+std::string makeGroupKey(const std::string& pathPattern, const std::map<std::string, std::string>& metadata)
+{
+  std::string key = pathPattern;
+  for (const auto& [name, value] : metadata) {
+    key += "/" + name + "=" + value;
+  }
+  return key;
+}
+} // namespace
+
+ListingWatcher::ListingWatcher(ListingFcn listing, std::chrono::milliseconds refreshPeriod)
+  : mListing(std::move(listing)), mRefreshPeriod(refreshPeriod)
+{
+}
+
+std::shared_ptr<ListingWatcher> ListingWatcher::forDatabase(const std::string& databaseUrl)
+{
+  static std::mutex registryMutex;
+  static std::unordered_map<std::string, std::weak_ptr<ListingWatcher>> registry;
+
+  std::lock_guard lock(registryMutex);
+  if (auto watcher = registry[databaseUrl].lock()) {
+    return watcher;
+  }
+  // We support only CCDB here.
+  auto db = std::make_shared<CcdbDatabase>();
+  db->connect(databaseUrl, "", "", "");
+  auto watcher = std::make_shared<ListingWatcher>([db](const std::string& pathPattern, const std::map<std::string, std::string>& metadata) {
+    return db->getListingAsJson(pathPattern, metadata, true);
+  });
+  registry[databaseUrl] = watcher;
+  ILOG(Debug, Devel) << "Created a listing watcher for the database '" << databaseUrl << "'" << ENDM;
+  return watcher;
+}
+
+std::string ListingWatcher::folderOf(const std::string& path)
+{
+  auto lastSlash = path.rfind('/');
+  return lastSlash == std::string::npos ? escapeRegex(path) : escapeRegex(path.substr(0, lastSlash)) + "/.*";
+}
+
+ListingWatcher::SubscriptionId ListingWatcher::subscribe(const std::string& path, const std::map<std::string, std::string>& metadata)
+{
+  auto pathPattern = folderOf(path);
+  auto groupKey = makeGroupKey(pathPattern, metadata);
+  std::shared_ptr<Group> group;
+  SubscriptionId id;
+  {
+    std::lock_guard lock(mMutex);
+    auto& groupPtr = mGroups[groupKey];
+    if (groupPtr == nullptr) {
+      groupPtr = std::make_shared<Group>();
+      groupPtr->pathPattern = pathPattern;
+      groupPtr->metadata = metadata;
+    }
+    groupPtr->subscribers++;
+    group = groupPtr;
+    id = mNextId++;
+    mSubscriptions[id] = { path, groupKey, 0 };
+  }
+
+  // the version which exists at subscription is considered as already seen
+  uint64_t lastModified = 0;
+  {
+    std::lock_guard groupLock(group->mutex);
+    refreshIfOutdated(*group);
+    if (auto it = group->latest.find(path); it != group->latest.end()) {
+      lastModified = it->second.lastModified;
+    }
+  }
+  std::lock_guard lock(mMutex);
+  mSubscriptions[id].lastNotified = lastModified;
+  return id;
+}
+
+void ListingWatcher::unsubscribe(SubscriptionId id)
+{
+  std::lock_guard lock(mMutex);
+  auto subscription = mSubscriptions.find(id);
+  if (subscription == mSubscriptions.end()) {
+    return;
+  }
+  auto group = mGroups.find(subscription->second.groupKey);
+  if (group != mGroups.end() && --group->second->subscribers == 0) {
+    mGroups.erase(group);
+  }
+  mSubscriptions.erase(subscription);
+}
+
+std::optional<ListingWatcher::ObjectVersion> ListingWatcher::poll(SubscriptionId id)
+{
+  auto latest = getLatest(id);
+  if (!latest.has_value()) {
+    return std::nullopt;
+  }
+
+  std::lock_guard lock(mMutex);
+  auto subscription = mSubscriptions.find(id);
+  if (subscription == mSubscriptions.end() || latest->lastModified <= subscription->second.lastNotified) {
+    return std::nullopt;
+  }
+  subscription->second.lastNotified = latest->lastModified;
+  return latest;
+}
+
+std::optional<ListingWatcher::ObjectVersion> ListingWatcher::getLatest(SubscriptionId id)
+{
+  std::shared_ptr<Group> group;
+  std::string path;
+  {
+    std::lock_guard lock(mMutex);
+    auto subscription = mSubscriptions.find(id);
+    if (subscription == mSubscriptions.end()) {
+      return std::nullopt;
+    }
+    group = mGroups.at(subscription->second.groupKey);
+    path = subscription->second.path;
+  }
+
+  std::optional<ObjectVersion> latest;
+  {
+    std::lock_guard groupLock(group->mutex);
+    refreshIfOutdated(*group);
+    if (auto it = group->latest.find(path); it != group->latest.end()) {
+      latest = it->second;
+    }
+  }
+  return latest;
+}
+
+std::optional<ListingWatcher::ObjectVersion> ListingWatcher::findRecent(const std::string& path, const std::map<std::string, std::string>& metadata)
+{
+  auto pathPattern = folderOf(path);
+  std::vector<std::shared_ptr<Group>> groups;
+  {
+    std::lock_guard lock(mMutex);
+    for (const auto& [groupKey, group] : mGroups) {
+      bool subset = std::all_of(group->metadata.begin(), group->metadata.end(), [&metadata](const auto& entry) {
+        auto it = metadata.find(entry.first);
+        return it != metadata.end() && it->second == entry.second;
+      });
+      if (group->pathPattern == pathPattern && subset) {
+        groups.push_back(group);
+      }
+    }
+  }
+
+  std::optional<ObjectVersion> latest;
+  auto now = std::chrono::steady_clock::now();
+  for (const auto& group : groups) {
+    std::lock_guard groupLock(group->mutex);
+    if (group->lastListing == std::chrono::steady_clock::time_point{} || now - group->lastListing >= mRefreshPeriod) {
+      continue;
+    }
+    if (auto it = group->latest.find(path); it != group->latest.end() && (!latest.has_value() || it->second.lastModified > latest->lastModified)) {
+      latest = it->second;
+    }
+  }
+  return latest;
+}
+
+void ListingWatcher::refreshIfOutdated(Group& group)
+{
+  auto now = std::chrono::steady_clock::now();
+  if (group.lastRefresh != std::chrono::steady_clock::time_point{} && now - group.lastRefresh < mRefreshPeriod) {
+    return;
+  }
+  group.lastRefresh = now;
+  mListingCount++;
+
+  auto json = mListing(group.pathPattern, group.metadata);
+  if (json.find("\"objects\"") == std::string::npos) {
+    ILOG(Warning, Support) << "Could not get a valid listing for '" << group.pathPattern << "'" << ENDM;
+    return;
+  }
+  group.lastListing = now;
+  auto versions = parseListing(json);
+  // we keep the previous versions of the objects which disappeared from the listing, so they are not notified again
+  // if they come back. If more than one version of an object is returned, we keep the most recently modified.
+  for (auto& version : versions) {
+    auto& latest = group.latest[version.path];
+    if (version.lastModified >= latest.lastModified) {
+      latest = std::move(version);
+    }
+  }
+}
+
+std::vector<ListingWatcher::ObjectVersion> ListingWatcher::parseListing(std::string_view json)
+{
+  std::vector<ObjectVersion> versions;
+  ListingHandler handler(versions);
+  rapidjson::Reader reader;
+  rapidjson::MemoryStream stream(json.data(), json.size());
+  if (reader.Parse(stream, handler).IsError()) {
+    ILOG(Error, Support) << "Failed to parse a listing from the database: " << json << ENDM;
+    return {};
+  }
+  // an element without path would be of no use
+  versions.erase(std::remove_if(versions.begin(), versions.end(), [](const ObjectVersion& version) { return version.path.empty(); }), versions.end());
+  return versions;
+}
+
+size_t ListingWatcher::getListingCount() const
+{
+  return mListingCount;
+}
+
+} // namespace o2::quality_control::postprocessing
@@ -0,0 +1,879 @@
+// Copyright 2019-2022 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   MockCcdbServer.cxx
+///
+
+#include "QualityControl/MockCcdbServer.h"
+#include "QualityControl/ThreadPool.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace o2::quality_control::repository
+{
+
+struct MockCcdbServer::Request {
+  std::string method;
+  std::string path;                           // without the query, not decoded
+  std::map<std::string, std::string> query;   // decoded
+  std::map<std::string, std::string> headers; // names in lower case
+  std::string body;
+};
+
+struct MockCcdbServer::Response {
+  int status = 200;
+  std::string reason = "OK";
+  std::vector<std::pair<std::string, std::string>> headers;
+  std::string body;
+  std::string contentType = "text/plain";
+  long contentLength = -1; // if different from the body size, for HEAD requests
+};
+
+namespace
+{
+constexpr int ioTimeoutMs = 5000;
+constexpr auto indexFileName = "index.txt";
+
+// reads at least one more byte into buffer, returns false if the connection was closed or timed out
+bool receive(int socket, std::string& buffer)
+{
+  pollfd descriptor{ socket, POLLIN, 0 };
+  if (poll(&descriptor, 1, ioTimeoutMs) <= 0) {
+    return false;
+  }
+  char chunk[65536];
+  ssize_t received = recv(socket, chunk, sizeof(chunk), 0);
+  if (received <= 0) {
+    return false;
+  }
+  buffer.append(chunk, received);
+  return true;
+}
+
+bool sendAll(int socket, const std::string& data)
+{
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t result = send(socket, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (result <= 0) {
+      return false;
+    }
+    sent += result;
+  }
+  return true;
+}
+
+// receives until buffer contains at least size bytes
+bool receiveUntil(int socket, std::string& buffer, size_t size)
+{
+  while (buffer.size() < size) {
+    if (!receive(socket, buffer)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool readChunkedBody(int socket, std::string& buffer, size_t position, std::string& body)
+{
+  while (true) {
+    size_t lineEnd;
+    while ((lineEnd = buffer.find("\r\n", position)) == std::string::npos) {
+      if (!receive(socket, buffer)) {
+        return false;
+      }
+    }
+    size_t chunkSize = std::stoul(buffer.substr(position, lineEnd - position), nullptr, 16);
+    position = lineEnd + 2;
+    if (!receiveUntil(socket, buffer, position + chunkSize + 2)) {
+      return false;
+    }
+    body.append(buffer, position, chunkSize);
+    position += chunkSize + 2;
+    if (chunkSize == 0) {
+      return true; // trailers are not supported, the client does not send any
+    }
+  }
+}
+
+std::string urlDecode(const std::string& encoded)
+{
+  std::string decoded;
+  for (size_t i = 0; i < encoded.size(); i++) {
+    if (encoded[i] == '%' && i + 2 < encoded.size() && std::isxdigit(encoded[i + 1]) && std::isxdigit(encoded[i + 2])) {
+      decoded += static_cast<char>(std::stoi(encoded.substr(i + 1, 2), nullptr, 16));
+      i += 2;
+    } else {
+      decoded += encoded[i];
+    }
+  }
+  return decoded;
+}
+
+std::string urlEncode(const std::string& decoded)
+{
+  static const char* hex = "0123456789ABCDEF";
+  std::string encoded;
+  for (unsigned char c : decoded) {
+    if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '/' || c == ':') {
+      encoded += c;
+    } else {
+      encoded += '%';
+      encoded += hex[c >> 4];
+      encoded += hex[c & 15];
+    }
+  }
+  return encoded;
+}
+
+std::vector<std::string> split(const std::string& string, char delimiter)
+{
+  std::vector<std::string> parts;
+  std::stringstream stream(string);
+  for (std::string part; std::getline(stream, part, delimiter);) {
+    if (!part.empty()) {
+      parts.push_back(part);
+    }
+  }
+  return parts;
+}
+
+std::string join(const std::vector<std::string>& parts)
+{
+  std::string joined;
+  for (const auto& part : parts) {
+    joined += (joined.empty() ? "" : "/") + part;
+  }
+  return joined;
+}
+
+bool isNumber(const std::string& string)
+{
+  return !string.empty() && std::all_of(string.begin(), string.end(), ::isdigit);
+}
+
+bool isUuid(const std::string& string)
+{
+  static const std::regex uuid("[0-9a-fA-F]{8}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{12}");
+  return std::regex_match(string, uuid);
+}
+
+bool hasRegexCharacters(const std::string& string)
+{
+  return string.find_first_of(".*+?[](){}|^$\\") != std::string::npos;
+}
+
+// the CCDB accepts both "path/.*" and "path/*" as patterns
+std::regex toRegex(const std::string& pattern)
+{
+  std::string expression;
+  for (size_t i = 0; i < pattern.size(); i++) {
+    if (pattern[i] == '*' && (i == 0 || pattern[i - 1] != '.')) {
+      expression += '.';
+    }
+    expression += pattern[i];
+  }
+  return std::regex(expression.empty() ? ".*" : expression);
+}
+
+std::string makeUuid()
+{
+  thread_local std::mt19937_64 generator{ std::random_device{}() };
+  const uint64_t high = generator();
+  const uint64_t low = generator();
+  char uuid[37];
+  std::snprintf(uuid, sizeof(uuid), "%08x-%04x-%04x-%04x-%012llx", static_cast<unsigned>(high >> 32), static_cast<unsigned>((high >> 16) & 0xffff),
+                static_cast<unsigned>(high & 0xffff), static_cast<unsigned>(low >> 48), static_cast<unsigned long long>(low & 0xffffffffffffULL));
+  return uuid;
+}
+
+long now()
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::string toHttpDate(long milliseconds)
+{
+  std::time_t seconds = milliseconds / 1000;
+  std::tm time{};
+  gmtime_r(&seconds, &time);
+  char buffer[64];
+  std::strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &time);
+  return buffer;
+}
+
+std::string jsonEscape(const std::string& string)
+{
+  std::string escaped;
+  for (unsigned char c : string) {
+    switch (c) {
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      case '\t':
+        escaped += "\\t";
+        break;
+      default:
+        if (c < 0x20) {
+          char buffer[8];
+          std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+          escaped += buffer;
+        } else {
+          escaped += c;
+        }
+    }
+  }
+  return escaped;
+}
+
+// The path of a request split into the object path, the trailing numbers and id, and the metadata filters,
+// e.g. "qc/TST/MO/Task/object/1000/2000/RunNumber=1"
+struct ParsedPath {
+  std::vector<std::string> segments; // without the metadata
+  std::map<std::string, std::string> metadata;
+
+  explicit ParsedPath(const std::string& path)
+  {
+    for (const auto& segment : split(path, '/')) {
+      auto equal = segment.find('=');
+      if (equal != std::string::npos) {
+        metadata[urlDecode(segment.substr(0, equal))] = urlDecode(segment.substr(equal + 1));
+      } else {
+        segments.push_back(urlDecode(segment));
+      }
+    }
+  }
+
+  std::optional<long> popNumber()
+  {
+    if (segments.empty() || !isNumber(segments.back())) {
+      return std::nullopt;
+    }
+    long number = std::stol(segments.back());
+    segments.pop_back();
+    return number;
+  }
+
+  std::string popUuid()
+  {
+    if (segments.empty() || !isUuid(segments.back())) {
+      return {};
+    }
+    std::string id = segments.back();
+    segments.pop_back();
+    return id;
+  }
+};
+
+bool matchesMetadata(const std::map<std::string, std::string>& metadata, const std::map<std::string, std::string>& filters)
+{
+  for (const auto& [key, value] : filters) {
+    auto it = metadata.find(key);
+    if (it == metadata.end() || it->second != value) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// the content and headers of the first file of a multipart/form-data body, or the whole body if it is not multipart
+void extractUpload(const std::string& contentTypeHeader, const std::string& body, std::string& content, std::string& fileName, std::string& contentType)
+{
+  contentType = "application/octet-stream";
+  auto boundaryPosition = contentTypeHeader.find("boundary=");
+  if (contentTypeHeader.rfind("multipart/form-data", 0) != 0 || boundaryPosition == std::string::npos) {
+    content = body;
+    return;
+  }
+  std::string boundary = contentTypeHeader.substr(boundaryPosition + 9);
+  if (!boundary.empty() && boundary.front() == '"') {
+    boundary = boundary.substr(1, boundary.find('"', 1) - 1);
+  }
+  const std::string delimiter = "--" + boundary;
+  size_t partBegin = body.find(delimiter);
+  while (partBegin != std::string::npos) {
+    partBegin += delimiter.size() + 2; // the CRLF after the delimiter
+    size_t headersEnd = body.find("\r\n\r\n", partBegin);
+    size_t partEnd = body.find("\r\n" + delimiter, partBegin);
+    if (headersEnd == std::string::npos || partEnd == std::string::npos) {
+      break;
+    }
+    const std::string headers = body.substr(partBegin, headersEnd - partBegin);
+    auto fileNamePosition = headers.find("filename=\"");
+    if (fileNamePosition != std::string::npos) {
+      fileNamePosition += 10;
+      fileName = headers.substr(fileNamePosition, headers.find('"', fileNamePosition) - fileNamePosition);
+      std::smatch match;
+      static const std::regex partContentType("Content-Type: *([^\r\n]+)", std::regex::icase);
+      if (std::regex_search(headers, match, partContentType)) {
+        contentType = match[1];
+      }
+      content = body.substr(headersEnd + 4, partEnd - headersEnd - 4);
+      return;
+    }
+    partBegin = body.find(delimiter, partEnd + 2);
+  }
+  content = body;
+}
+} // namespace
+
+MockCcdbServer::MockCcdbServer(uint16_t port) : MockCcdbServer([port]() {
+    Options options;
+    options.port = port;
+    return options;
+  }())
+{
+}
+
+MockCcdbServer::MockCcdbServer(Options options) : mOptions(std::move(options)), mErrorGenerator(mOptions.seed)
+{
+  if (!mOptions.storageDirectory.empty()) {
+    fs::create_directories(mOptions.storageDirectory);
+    loadIndex();
+  }
+
+  mListeningSocket = socket(AF_INET, SOCK_STREAM, 0);
+  if (mListeningSocket < 0) {
+    throw std::runtime_error(std::string("MockCcdbServer: could not create a socket: ") + std::strerror(errno));
+  }
+  int reuse = 1;
+  setsockopt(mListeningSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(mOptions.port);
+  socklen_t length = sizeof(address);
+  if (bind(mListeningSocket, reinterpret_cast<sockaddr*>(&address), length) < 0 ||
+      listen(mListeningSocket, 64) < 0 ||
+      getsockname(mListeningSocket, reinterpret_cast<sockaddr*>(&address), &length) < 0) {
+    std::string error = std::strerror(errno);
+    close(mListeningSocket);
+    throw std::runtime_error("MockCcdbServer: could not listen on port " + std::to_string(mOptions.port) + ": " + error);
+  }
+  mPort = ntohs(address.sin_port);
+}
+
+MockCcdbServer::~MockCcdbServer()
+{
+  stop();
+  close(mListeningSocket);
+}
+
+void MockCcdbServer::start()
+{
+  if (mRunning.exchange(true)) {
+    return;
+  }
+  mWorkers = std::make_unique<core::ThreadPool>(std::max<size_t>(1, mOptions.threads));
+  mThread = std::thread(&MockCcdbServer::serve, this);
+}
+
+void MockCcdbServer::stop()
+{
+  mRunning = false;
+  if (mThread.joinable()) {
+    mThread.join();
+  }
+  mWorkers.reset(); // waits for the connections being served
+}
+
+std::string MockCcdbServer::getUrl() const
+{
+  return "http://127.0.0.1:" + std::to_string(mPort);
+}
+
+MockCcdbServer::Statistics MockCcdbServer::getStatistics() const
+{
+  std::lock_guard lock(mStatisticsMutex);
+  return mStatistics;
+}
+
+void MockCcdbServer::resetStatistics()
+{
+  std::lock_guard lock(mStatisticsMutex);
+  mStatistics = {};
+}
+
+size_t MockCcdbServer::getNumberOfObjects() const
+{
+  std::lock_guard lock(mObjectsMutex);
+  return mObjects.size();
+}
+
+void MockCcdbServer::serve()
+{
+  while (mRunning) {
+    pollfd descriptor{ mListeningSocket, POLLIN, 0 };
+    if (poll(&descriptor, 1, 100) <= 0) {
+      continue;
+    }
+    int connection = accept(mListeningSocket, nullptr, nullptr);
+    if (connection < 0) {
+      continue;
+    }
+    mWorkers->submit([this, connection]() {
+      handleConnection(connection);
+      close(connection);
+    });
+  }
+}
+
+void MockCcdbServer::handleConnection(int socket)
+{
+  Request request;
+  std::string buffer;
+  size_t headerEnd;
+  while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+    if (!receive(socket, buffer)) {
+      return;
+    }
+  }
+
+  size_t lineEnd = buffer.find("\r\n");
+  const auto requestLine = split(buffer.substr(0, lineEnd), ' ');
+  if (requestLine.size() < 2) {
+    return;
+  }
+  request.method = requestLine[0];
+  const std::string& target = requestLine[1];
+  auto queryBegin = target.find('?');
+  request.path = target.substr(0, queryBegin);
+  if (queryBegin != std::string::npos) {
+    for (const auto& parameter : split(target.substr(queryBegin + 1), '&')) {
+      auto equal = parameter.find('=');
+      request.query[urlDecode(parameter.substr(0, equal))] = equal == std::string::npos ? "" : urlDecode(parameter.substr(equal + 1));
+    }
+  }
+
+  for (size_t position = lineEnd + 2; position < headerEnd;) {
+    lineEnd = buffer.find("\r\n", position);
+    const std::string line = buffer.substr(position, lineEnd - position);
+    position = lineEnd + 2;
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    std::string name = line.substr(0, colon);
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+    size_t valueBegin = line.find_first_not_of(' ', colon + 1);
+    request.headers[name] = valueBegin == std::string::npos ? "" : line.substr(valueBegin);
+  }
+
+  // curl waits for this before sending large bodies
+  auto expect = request.headers.find("expect");
+  if (expect != request.headers.end() && expect->second == "100-continue" && !sendAll(socket, "HTTP/1.1 100 Continue\r\n\r\n")) {
+    return;
+  }
+
+  const size_t bodyBegin = headerEnd + 4;
+  auto contentLength = request.headers.find("content-length");
+  auto transferEncoding = request.headers.find("transfer-encoding");
+  if (contentLength != request.headers.end()) {
+    size_t size = std::stoul(contentLength->second);
+    if (!receiveUntil(socket, buffer, bodyBegin + size)) {
+      return;
+    }
+    request.body = buffer.substr(bodyBegin, size);
+  } else if (transferEncoding != request.headers.end() && transferEncoding->second == "chunked") {
+    if (!readChunkedBody(socket, buffer, bodyBegin, request.body)) {
+      return;
+    }
+  }
+
+  if (mOptions.latency.count() > 0) {
+    std::this_thread::sleep_for(mOptions.latency);
+  }
+  Response response = handle(request);
+
+  std::ostringstream message;
+  message << "HTTP/1.1 " << response.status << " " << response.reason << "\r\n"
+          << "Content-Type: " << response.contentType << "\r\n"
+          << "Content-Length: " << (response.contentLength >= 0 ? response.contentLength : response.body.size()) << "\r\n";
+  for (const auto& [name, value] : response.headers) {
+    message << name << ": " << value << "\r\n";
+  }
+  message << "Connection: close\r\n\r\n";
+  if (request.method != "HEAD") {
+    message << response.body;
+  }
+  sendAll(socket, message.str());
+}
+
+MockCcdbServer::Response MockCcdbServer::handle(const Request& request)
+{
+  {
+    std::lock_guard lock(mStatisticsMutex);
+    mStatistics.requests++;
+    if (mOptions.errorRate > 0 && std::uniform_real_distribution<double>(0, 1)(mErrorGenerator) < mOptions.errorRate) {
+      mStatistics.injectedErrors++;
+      return { 503, "Service Unavailable" };
+    }
+  }
+
+  const auto& method = request.method;
+  if (method == "POST" || (method == "PUT" && request.query.empty())) {
+    return store(request);
+  } else if (method == "PUT") {
+    return updateMetadata(request);
+  } else if (method == "DELETE") {
+    return remove(request);
+  } else if (method == "GET" && (request.path.rfind("/browse", 0) == 0 || request.path.rfind("/latest", 0) == 0)) {
+    return list(request, request.path.rfind("/latest", 0) == 0);
+  } else if ((method == "GET" || method == "HEAD") && split(request.path, '/').empty()) {
+    return { 200, "OK" }; // used to check that the host is reachable
+  } else if (method == "GET" || method == "HEAD") {
+    return retrieve(request, method == "GET");
+  }
+  return { 405, "Method Not Allowed" };
+}
+
+MockCcdbServer::Response MockCcdbServer::store(const Request& request)
+{
+  ParsedPath parsed(request.path);
+  auto validUntil = parsed.popNumber();
+  auto validFrom = parsed.popNumber();
+  if (!validFrom || !validUntil || parsed.segments.empty()) {
+    return { 400, "Bad Request", {}, "Expected /path/validFrom/validUntil[/key=value...]" };
+  }
+
+  StoredObject object;
+  std::string content;
+  auto contentTypeHeader = request.headers.find("content-type");
+  extractUpload(contentTypeHeader == request.headers.end() ? "" : contentTypeHeader->second, request.body, content, object.fileName, object.contentType);
+  object.path = join(parsed.segments);
+  object.validFrom = *validFrom;
+  object.validUntil = *validUntil;
+  object.metadata = parsed.metadata;
+  object.size = content.size();
+
+  {
+    std::lock_guard lock(mObjectsMutex);
+    object.created = object.lastModified = nextCreationTime();
+    object.id = makeUuid();
+    if (object.fileName.empty()) {
+      object.fileName = object.id;
+    }
+    if (mOptions.storageDirectory.empty()) {
+      object.content = std::make_shared<const std::string>(std::move(content));
+    } else {
+      std::ofstream file(fs::path(mOptions.storageDirectory) / object.id, std::ios::binary);
+      file.write(content.data(), content.size());
+    }
+    mObjects.push_back(std::move(object));
+    if (!mOptions.storageDirectory.empty()) {
+      saveIndex();
+    }
+  }
+  {
+    std::lock_guard lock(mStatisticsMutex);
+    mStatistics.storedObjects++;
+    mStatistics.storedBytes += request.body.size();
+  }
+  return { 201, "Created", { { "Location", "/" + join(parsed.segments) + "/" + std::to_string(*validFrom) } } };
+}
+
+MockCcdbServer::Response MockCcdbServer::retrieve(const Request& request, bool withContent)
+{
+  ParsedPath parsed(request.path);
+  const std::string id = parsed.popUuid();
+  const long timestamp = parsed.popNumber().value_or(now());
+  const std::string path = join(parsed.segments);
+  auto header = [&](const char* name, long defaultValue) {
+    auto it = request.headers.find(name);
+    return it == request.headers.end() || !isNumber(it->second) ? defaultValue : std::stol(it->second);
+  };
+  const long createdNotAfter = header("if-not-after", std::numeric_limits<long>::max());
+  const long createdNotBefore = header("if-not-before", 0);
+  {
+    std::lock_guard lock(mStatisticsMutex);
+    mStatistics.retrievals++;
+  }
+
+  StoredObject object;
+  {
+    std::lock_guard lock(mObjectsMutex);
+    auto found = std::find_if(mObjects.rbegin(), mObjects.rend(), [&](const StoredObject& candidate) {
+      return candidate.path == path && (id.empty() || candidate.id == id) &&
+             candidate.validFrom <= timestamp && timestamp < candidate.validUntil &&
+             candidate.created <= createdNotAfter && candidate.created >= createdNotBefore &&
+             matchesMetadata(candidate.metadata, parsed.metadata);
+    });
+    if (found == mObjects.rend()) {
+      return { 404, "Not Found" };
+    }
+    object = *found;
+  }
+
+  const std::string etag = "\"" + object.id + "\"";
+  auto ifNoneMatch = request.headers.find("if-none-match");
+  if (ifNoneMatch != request.headers.end() && ifNoneMatch->second == etag) {
+    return { 304, "Not Modified", { { "ETag", etag } } };
+  }
+
+  Response response;
+  response.contentType = object.contentType;
+  response.headers = {
+    { "Valid-From", std::to_string(object.validFrom) },
+    { "Valid-Until", std::to_string(object.validUntil) },
+    { "Created", std::to_string(object.created) },
+    { "Last-Modified", toHttpDate(object.lastModified) },
+    { "ETag", etag },
+    { "Content-Disposition", "inline;filename=\"" + object.fileName + "\"" },
+    { "Content-Location", "/download/" + object.id },
+  };
+  for (const auto& [key, value] : object.metadata) {
+    response.headers.emplace_back(key, value);
+  }
+  if (withContent) {
+    response.body = readContent(object);
+  } else {
+    response.contentLength = object.size;
+  }
+  return response;
+}
+
+MockCcdbServer::Response MockCcdbServer::list(const Request& request, bool latestOnly)
+{
+  ParsedPath parsed(request.path);
+  parsed.segments.erase(parsed.segments.begin()); // "browse" or "latest"
+  const std::string pattern = join(parsed.segments);
+  std::regex expression;
+  try {
+    expression = toRegex(pattern);
+  } catch (const std::regex_error&) {
+    return { 400, "Bad Request", {}, "Invalid pattern " + pattern };
+  }
+  {
+    std::lock_guard lock(mStatisticsMutex);
+    mStatistics.listings++;
+  }
+
+  std::vector<StoredObject> objects;
+  std::set<std::string> subfolders;
+  {
+    std::lock_guard lock(mObjectsMutex);
+    std::set<std::string> listedPaths;
+    for (auto it = mObjects.rbegin(); it != mObjects.rend(); ++it) {
+      if (!std::regex_match(it->path, expression)) {
+        if (!pattern.empty() && !hasRegexCharacters(pattern) && it->path.rfind(pattern + "/", 0) == 0) {
+          subfolders.insert(pattern + "/" + split(it->path.substr(pattern.size() + 1), '/').front());
+        }
+        continue;
+      }
+      if (!matchesMetadata(it->metadata, parsed.metadata) || (latestOnly && !listedPaths.insert(it->path).second)) {
+        continue;
+      }
+      objects.push_back(*it);
+    }
+  }
+
+  Response response;
+  auto accept = request.headers.find("accept");
+  std::string acceptValue = accept == request.headers.end() ? "" : accept->second;
+  std::transform(acceptValue.begin(), acceptValue.end(), acceptValue.begin(), [](unsigned char c) { return std::tolower(c); });
+  std::ostringstream body;
+  if (acceptValue.find("application/json") != std::string::npos) {
+    response.contentType = "application/json";
+    body << R"({"objects":[)";
+    for (size_t i = 0; i < objects.size(); i++) {
+      const auto& object = objects[i];
+      body << (i > 0 ? "," : "") << "{"
+           << R"("path":")" << jsonEscape(object.path) << R"(",)"
+           << R"("id":")" << object.id << R"(",)"
+           << R"("validFrom":)" << object.validFrom << ","
+           << R"("validUntil":)" << object.validUntil << ","
+           << R"("initialValidity":)" << object.validUntil << ","
+           << R"("createTime":)" << object.created << ","
+           << R"("lastModified":)" << object.lastModified << ","
+           << R"("Valid-From":)" << object.validFrom << ","
+           << R"("Valid-Until":)" << object.validUntil << ","
+           << R"("Created":)" << object.created << ","
+           << R"("fileName":")" << jsonEscape(object.fileName) << R"(",)"
+           << R"("contentType":")" << jsonEscape(object.contentType) << R"(",)"
+           << R"("size":)" << object.size;
+      for (const auto& [key, value] : object.metadata) {
+        body << R"(,")" << jsonEscape(key) << R"(":")" << jsonEscape(value) << R"(")";
+      }
+      body << "}";
+    }
+    body << R"(],"subfolders":[)";
+    size_t i = 0;
+    for (const auto& subfolder : subfolders) {
+      body << (i++ > 0 ? "," : "") << '"' << jsonEscape(subfolder) << '"';
+    }
+    body << "]}";
+  } else {
+    for (const auto& object : objects) {
+      body << object.path << "\n";
+    }
+    body << "Subfolders:\n";
+    for (const auto& subfolder : subfolders) {
+      body << subfolder << "\n";
+    }
+  }
+  response.body = body.str();
+  return response;
+}
+
+MockCcdbServer::Response MockCcdbServer::updateMetadata(const Request& request)
+{
+  ParsedPath parsed(request.path);
+  const std::string id = parsed.popUuid();
+  const long timestamp = parsed.popNumber().value_or(now());
+  const std::string path = join(parsed.segments);
+
+  std::lock_guard lock(mObjectsMutex);
+  auto found = std::find_if(mObjects.rbegin(), mObjects.rend(), [&](const StoredObject& candidate) {
+    return candidate.path == path && (id.empty() || candidate.id == id) && candidate.validFrom <= timestamp && timestamp < candidate.validUntil;
+  });
+  if (found == mObjects.rend()) {
+    return { 404, "Not Found" };
+  }
+  for (const auto& [key, value] : request.query) {
+    found->metadata[key] = value;
+  }
+  found->lastModified = now();
+  if (!mOptions.storageDirectory.empty()) {
+    saveIndex();
+  }
+  return { 200, "OK" };
+}
+
+MockCcdbServer::Response MockCcdbServer::remove(const Request& request)
+{
+  ParsedPath parsed(request.path);
+  std::function<bool(const StoredObject&)> selected;
+  if (!parsed.segments.empty() && parsed.segments.front() == "truncate") {
+    parsed.segments.erase(parsed.segments.begin());
+    std::regex expression;
+    try {
+      expression = toRegex(join(parsed.segments));
+    } catch (const std::regex_error&) {
+      return { 400, "Bad Request" };
+    }
+    selected = [expression](const StoredObject& object) { return std::regex_match(object.path, expression); };
+  } else {
+    const std::string id = parsed.popUuid();
+    const auto timestamp = parsed.popNumber();
+    const std::string path = join(parsed.segments);
+    selected = [=](const StoredObject& object) {
+      return object.path == path && (id.empty() || object.id == id) && (!timestamp || (object.validFrom <= *timestamp && *timestamp < object.validUntil));
+    };
+  }
+
+  std::lock_guard lock(mObjectsMutex);
+  auto removed = std::stable_partition(mObjects.begin(), mObjects.end(), [&](const StoredObject& object) { return !selected(object); });
+  if (!mOptions.storageDirectory.empty()) {
+    for (auto it = removed; it != mObjects.end(); ++it) {
+      fs::remove(fs::path(mOptions.storageDirectory) / it->id);
+    }
+  }
+  mObjects.erase(removed, mObjects.end());
+  if (!mOptions.storageDirectory.empty()) {
+    saveIndex();
+  }
+  return { 200, "OK" };
+}
+
+long MockCcdbServer::nextCreationTime()
+{
+  // strictly increasing, so that the order of creation is never ambiguous
+  mLastCreationTime = std::max(now(), mLastCreationTime + 1);
+  return mLastCreationTime;
+}
+
+std::string MockCcdbServer::readContent(const StoredObject& object) const
+{
+  if (object.content) {
+    return *object.content;
+  }
+  std::ifstream file(fs::path(mOptions.storageDirectory) / object.id, std::ios::binary);
+  return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+}
+
+// One line per object, the fields separated by tabs: id, path, validFrom, validUntil, created, lastModified,
+// fileName, contentType, size, then the metadata as key=value. The strings are URL-encoded.
+void MockCcdbServer::saveIndex() const
+{
+  const auto indexPath = fs::path(mOptions.storageDirectory) / indexFileName;
+  const auto temporaryPath = fs::path(indexPath).concat(".tmp");
+  {
+    std::ofstream index(temporaryPath);
+    for (const auto& object : mObjects) {
+      index << object.id << '\t' << urlEncode(object.path) << '\t' << object.validFrom << '\t' << object.validUntil << '\t'
+            << object.created << '\t' << object.lastModified << '\t' << urlEncode(object.fileName) << '\t'
+            << urlEncode(object.contentType) << '\t' << object.size;
+      for (const auto& [key, value] : object.metadata) {
+        index << '\t' << urlEncode(key) << '=' << urlEncode(value);
+      }
+      index << '\n';
+    }
+  }
+  fs::rename(temporaryPath, indexPath);
+}
+
+void MockCcdbServer::loadIndex()
+{
+  std::ifstream index(fs::path(mOptions.storageDirectory) / indexFileName);
+  for (std::string line; std::getline(index, line);) {
+    const auto fields = split(line, '\t');
+    if (fields.size() < 9) {
+      continue;
+    }
+    StoredObject object;
+    object.id = fields[0];
+    object.path = urlDecode(fields[1]);
+    object.validFrom = std::stol(fields[2]);
+    object.validUntil = std::stol(fields[3]);
+    object.created = std::stol(fields[4]);
+    object.lastModified = std::stol(fields[5]);
+    object.fileName = urlDecode(fields[6]);
+    object.contentType = urlDecode(fields[7]);
+    object.size = std::stoul(fields[8]);
+    for (size_t i = 9; i < fields.size(); i++) {
+      auto equal = fields[i].find('=');
+      object.metadata[urlDecode(fields[i].substr(0, equal))] = urlDecode(fields[i].substr(equal + 1));
+    }
+    mLastCreationTime = std::max(mLastCreationTime, object.created);
+    mObjects.push_back(std::move(object));
+  }
+}
+
+} // namespace o2::quality_control::repository
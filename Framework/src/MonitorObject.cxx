@@ -19,6 +19,7 @@
 #include <TClass.h>
 #include "QualityControl/RepoPathUtils.h"
 #include "QualityControl/QcInfoLogger.h"
+#include "QualityControl/ObjectMetadataKeys.h"
 
 #include <iterator>
 #include <optional>
@@ -163,6 +164,11 @@ std::optional<std::string> MonitorObject::getMetadata(const std::string& key)
   return std::nullopt;
 }
 
+bool MonitorObject::isUnchangedMarker() const
+{
+  return mUserMetadata.count(repository::metadata_keys::qcUnchanged) > 0;
+}
+
 bool MonitorObject::encapsulatedInheritsFrom(std::string_view className) const
 {
   if (!mObject) {
@@ -22,7 +22,21 @@
 
 #include <Mergers/MergerAlgorithm.h>
 #include <TNamed.h>
+#include <TH1.h>
+#include <TArrayC.h>
+#include <TArrayS.h>
+#include <TArrayI.h>
+#include <TArrayF.h>
+#include <TArrayD.h>
+#include <TBufferFile.h>
+#include <Compression.h>
+#include <RZip.h>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
 #include <optional>
+#include <stdexcept>
 #include <string>
 
 using namespace o2::mergers;
@@ -55,6 +69,182 @@ void mergeCycles(MonitorObject* targetMO, MonitorObject* otherMO)
   }
 }
 
+// Same as TObjArray::At, but without complaining if the index is out of bounds, as it is legit when expanding the array.
+TObject* slotContent(const TObjArray& array, Int_t idx)
+{
+  Int_t j = idx - array.LowerBound();
+  return (j >= 0 && j < array.Capacity()) ? array.UncheckedAt(idx) : nullptr;
+}
+
+MonitorObjectCollection::MonitorObjectCollection(const MonitorObjectCollection& other)
+  : TObjArray(other),
+    MergeInterface(other),
+    mDetector(other.mDetector),
+    mTaskName(other.mTaskName),
+    mEncodedObjects(other.mEncodedObjects),
+    mEncodedSize(other.mEncodedSize),
+    mEncodedCompressed(other.mEncodedCompressed)
+{
+}
+
+void MonitorObjectCollection::indexObject(TObject* obj)
+{
+  if (obj == nullptr || !mIndexBuilt) {
+    return;
+  }
+  auto [it, inserted] = mIndex.try_emplace(obj->GetName(), obj);
+  if (inserted) {
+    mNames[obj] = it->first;
+  } else if (it->second != obj) {
+    // TObjArray::FindObject returns the first matching object, so we keep the one we already have
+    mIndexHasDuplicates = true;
+  }
+}
+
+void MonitorObjectCollection::unindexObject(TObject* obj)
+{
+  // We do not call any method of the object, since it might be a MonitorObject whose encapsulated object is already deleted.
+  if (obj == nullptr || !mIndexBuilt) {
+    return;
+  }
+  auto nameIt = mNames.find(obj);
+  if (nameIt == mNames.end()) {
+    return;
+  }
+  mIndex.erase(nameIt->second);
+  mNames.erase(nameIt);
+  if (mIndexHasDuplicates) {
+    // another object with the same name might have to take its place
+    mIndexBuilt = false;
+  }
+}
+
+void MonitorObjectCollection::buildIndex() const
+{
+  mIndex.clear();
+  mNames.clear();
+  mIndex.reserve(GetEntriesFast());
+  mNames.reserve(GetEntriesFast());
+  mIndexHasDuplicates = false;
+  for (Int_t i = 0; i < GetEntriesFast(); i++) {
+    if (auto obj = UncheckedAt(i)) {
+      auto [it, inserted] = mIndex.try_emplace(obj->GetName(), obj);
+      if (inserted) {
+        mNames[obj] = it->first;
+      } else {
+        mIndexHasDuplicates |= it->second != obj;
+      }
+    }
+  }
+  mIndexBuilt = true;
+}
+
+TObject* MonitorObjectCollection::FindObject(const char* name) const
+{
+  if (name == nullptr) {
+    return nullptr;
+  }
+  if (!mIndexBuilt) {
+    buildIndex();
+  }
+  auto it = mIndex.find(name);
+  if (it == mIndex.end()) {
+    return nullptr;
+  }
+  if (std::strcmp(it->second->GetName(), name) != 0) {
+    // the object has been renamed in the meantime, we fall back to the linear search
+    mIndexBuilt = false;
+    return TObjArray::FindObject(name);
+  }
+  return it->second;
+}
+
+void MonitorObjectCollection::AddFirst(TObject* obj)
+{
+  unindexObject(First());
+  TObjArray::AddFirst(obj);
+  indexObject(obj);
+}
+
+void MonitorObjectCollection::AddLast(TObject* obj)
+{
+  TObjArray::AddLast(obj);
+  indexObject(obj);
+}
+
+void MonitorObjectCollection::AddAt(TObject* obj, Int_t idx)
+{
+  unindexObject(slotContent(*this, idx));
+  TObjArray::AddAt(obj, idx);
+  indexObject(obj);
+}
+
+void MonitorObjectCollection::AddAtAndExpand(TObject* obj, Int_t idx)
+{
+  unindexObject(slotContent(*this, idx));
+  TObjArray::AddAtAndExpand(obj, idx);
+  indexObject(obj);
+}
+
+Int_t MonitorObjectCollection::AddAtFree(TObject* obj)
+{
+  auto idx = TObjArray::AddAtFree(obj);
+  indexObject(obj);
+  return idx;
+}
+
+TObject* MonitorObjectCollection::RemoveAt(Int_t idx)
+{
+  auto removed = TObjArray::RemoveAt(idx);
+  unindexObject(removed);
+  return removed;
+}
+
+TObject* MonitorObjectCollection::Remove(TObject* obj)
+{
+  auto removed = TObjArray::Remove(obj);
+  unindexObject(removed);
+  return removed;
+}
+
+void MonitorObjectCollection::RemoveRange(Int_t idx1, Int_t idx2)
+{
+  for (Int_t idx = idx1; idx <= idx2; idx++) {
+    unindexObject(slotContent(*this, idx));
+  }
+  TObjArray::RemoveRange(idx1, idx2);
+}
+
+void MonitorObjectCollection::SetLast(Int_t last)
+{
+  // the objects beyond the new last slot are not visible anymore, it is simpler to rebuild the index
+  TObjArray::SetLast(last);
+  mIndexBuilt = false;
+}
+
+void MonitorObjectCollection::Clear(Option_t* option)
+{
+  TObjArray::Clear(option);
+  mIndex.clear();
+  mNames.clear();
+  mIndexHasDuplicates = false;
+}
+
+void MonitorObjectCollection::Delete(Option_t* option)
+{
+  TObjArray::Delete(option);
+  mIndex.clear();
+  mNames.clear();
+  mIndexHasDuplicates = false;
+}
+
+void MonitorObjectCollection::RecursiveRemove(TObject* obj)
+{
+  // the object is being deleted, unindexObject does not access it
+  unindexObject(obj);
+  TObjArray::RecursiveRemove(obj);
+}
+
 void MonitorObjectCollection::merge(mergers::MergeInterface* const other)
 {
   auto otherCollection = dynamic_cast<MonitorObjectCollection*>(other); // reinterpret_cast maybe?
@@ -103,8 +293,15 @@ void MonitorObjectCollection::merge(mergers::MergeInterface* const other)
         continue;
       }
 
-      // That might be another collection or a concrete object to be merged, we walk on the collection recursively.
-      algorithm::merge(targetMO->getObject(), otherMO->getObject());
+      if (otherMO->isUnchangedMarker()) {
+        // The input object did not change since its last publication, there is nothing to merge, only the validity is extended.
+      } else if (targetMO->isUnchangedMarker()) {
+        // We had only a marker so far, the input carries the actual content.
+        otherMO->Copy(*targetMO);
+      } else {
+        // That might be another collection or a concrete object to be merged, we walk on the collection recursively.
+        algorithm::merge(targetMO->getObject(), otherMO->getObject());
+      }
       if (otherMO->getValidity().isValid()) {
         if (targetMO->getValidity().isInvalid()) {
           targetMO->setValidity(otherMO->getValidity());
@@ -124,6 +321,14 @@ void MonitorObjectCollection::merge(mergers::MergeInterface* const other)
 
 void MonitorObjectCollection::postDeserialization()
 {
+  try {
+    decode();
+  } catch (const std::exception& e) {
+    ILOG(Error) << "Could not decode the MonitorObjectCollection '" << GetName() << "' of the task '" << mTaskName
+                << "', its objects are lost: " << e.what() << ENDM;
+    mEncodedObjects.clear();
+    mEncodedSize = 0;
+  }
   auto it = this->MakeIterator();
   while (auto obj = it->Next()) {
     auto mo = dynamic_cast<MonitorObject*>(obj);
@@ -146,6 +351,8 @@ void MonitorObjectCollection::postDeserialization()
   }
   this->SetOwner(true);
   delete it;
+  // the array has been filled by the streamer, which bypasses the Add methods
+  buildIndex();
 }
 
 void MonitorObjectCollection::setDetector(const std::string& detector)
@@ -247,4 +454,326 @@ MergeInterface* MonitorObjectCollection::cloneMovingWindow() const
   return mw;
 }
 
+namespace
+{
+
+// The maximum size of a block compressed at once by ROOT
+constexpr int maxCompressionBlock = 0xffffff;
+// The size of the header ROOT adds to each compressed block
+constexpr int compressionHeaderSize = 9;
+
+// Calls the function with the bin array of the histogram, cast to its concrete type.
+template <typename Function>
+bool withBinArray(TH1* histo, Function&& function)
+{
+  if (auto array = dynamic_cast<TArrayD*>(histo)) {
+    function(array);
+  } else if (auto array = dynamic_cast<TArrayF*>(histo)) {
+    function(array);
+  } else if (auto array = dynamic_cast<TArrayI*>(histo)) {
+    function(array);
+  } else if (auto array = dynamic_cast<TArrayS*>(histo)) {
+    function(array);
+  } else if (auto array = dynamic_cast<TArrayC*>(histo)) {
+    function(array);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// The non-empty bins of a histogram, sent instead of its bin arrays
+struct SparseBins {
+  Int_t object = 0; // index in the collection
+  Int_t size = 0;
+  bool hasSumw2 = false;
+  std::vector<Int_t> bins;
+  std::vector<Double_t> contents;
+  std::vector<Double_t> sumw2;
+};
+
+std::optional<SparseBins> makeSparseBins(TH1* histo, double maxOccupancy)
+{
+  std::optional<SparseBins> result;
+  withBinArray(histo, [&](auto array) {
+    const TArrayD* sumw2 = histo->GetSumw2N() > 0 ? histo->GetSumw2() : nullptr;
+    if (array->fN == 0 || (sumw2 != nullptr && sumw2->fN != array->fN)) {
+      return;
+    }
+    const auto maxBins = static_cast<size_t>(maxOccupancy * array->fN);
+    SparseBins sparse;
+    sparse.size = array->fN;
+    sparse.hasSumw2 = sumw2 != nullptr;
+    for (Int_t bin = 0; bin < array->fN; bin++) {
+      if (array->fArray[bin] == 0 && (sumw2 == nullptr || sumw2->fArray[bin] == 0)) {
+        continue;
+      }
+      if (sparse.bins.size() >= maxBins) {
+        return;
+      }
+      sparse.bins.push_back(bin);
+      sparse.contents.push_back(array->fArray[bin]);
+      if (sumw2 != nullptr) {
+        sparse.sumw2.push_back(sumw2->fArray[bin]);
+      }
+    }
+    result = std::move(sparse);
+  });
+  return result;
+}
+
+// Empties the bin arrays of histograms while they are streamed, puts them back when destroyed.
+class DetachedBins
+{
+ public:
+  DetachedBins() = default;
+  DetachedBins(const DetachedBins&) = delete;
+  DetachedBins& operator=(const DetachedBins&) = delete;
+  ~DetachedBins()
+  {
+    for (auto it = mRestore.rbegin(); it != mRestore.rend(); ++it) {
+      (*it)();
+    }
+  }
+
+  void detach(TH1* histo)
+  {
+    withBinArray(histo, [this](auto array) { detachArray(array); });
+    if (histo->GetSumw2N() > 0) {
+      detachArray(histo->GetSumw2());
+    }
+  }
+
+ private:
+  template <typename ArrayT>
+  void detachArray(ArrayT* array)
+  {
+    mRestore.emplace_back([array, data = array->fArray, size = array->fN]() {
+      array->fArray = data;
+      array->fN = size;
+    });
+    array->fArray = nullptr;
+    array->fN = 0;
+  }
+
+  std::vector<std::function<void()>> mRestore;
+};
+
+ROOT::RCompressionSetting::EAlgorithm::EValues toRootAlgorithm(MonitorObjectCollection::Encoding::Compression compression)
+{
+  using Compression = MonitorObjectCollection::Encoding::Compression;
+  switch (compression) {
+    case Compression::Zlib:
+      return ROOT::RCompressionSetting::EAlgorithm::kZLIB;
+    case Compression::LZMA:
+      return ROOT::RCompressionSetting::EAlgorithm::kLZMA;
+    case Compression::LZ4:
+      return ROOT::RCompressionSetting::EAlgorithm::kLZ4;
+    case Compression::ZSTD:
+      return ROOT::RCompressionSetting::EAlgorithm::kZSTD;
+    default:
+      return ROOT::RCompressionSetting::EAlgorithm::kUndefined;
+  }
+}
+
+// Compresses the buffer block by block, as TMessage does. Returns nothing if the data cannot be compressed.
+std::optional<std::vector<char>> compress(char* data, int size, const MonitorObjectCollection::Encoding& encoding)
+{
+  const int blocks = size / maxCompressionBlock + 1;
+  std::vector<char> compressed(size + blocks * compressionHeaderSize + 28);
+  int written = 0;
+  for (int offset = 0; offset < size; offset += maxCompressionBlock) {
+    int blockSize = std::min(maxCompressionBlock, size - offset);
+    int available = static_cast<int>(compressed.size()) - written;
+    int compressedSize = 0;
+    R__zipMultipleAlgorithm(encoding.level, &blockSize, data + offset, &available, compressed.data() + written, &compressedSize, toRootAlgorithm(encoding.compression));
+    if (compressedSize == 0) {
+      return std::nullopt;
+    }
+    written += compressedSize;
+  }
+  if (written >= size) {
+    return std::nullopt;
+  }
+  compressed.resize(written);
+  return compressed;
+}
+
+std::vector<char> decompress(std::vector<char>& compressed, size_t size)
+{
+  std::vector<char> decompressed(size);
+  size_t read = 0;
+  size_t written = 0;
+  while (read < compressed.size()) {
+    auto source = reinterpret_cast<unsigned char*>(compressed.data() + read);
+    int sourceSize = 0;
+    int targetSize = 0;
+    if (compressed.size() - read < compressionHeaderSize || R__unzip_header(&sourceSize, source, &targetSize) != 0) {
+      throw std::runtime_error("invalid compression header");
+    }
+    if (sourceSize <= 0 || read + sourceSize > compressed.size() || written + targetSize > size) {
+      throw std::runtime_error("compressed block out of bounds");
+    }
+    int unzipped = 0;
+    R__unzip(&sourceSize, source, &targetSize, reinterpret_cast<unsigned char*>(decompressed.data() + written), &unzipped);
+    if (unzipped != targetSize) {
+      throw std::runtime_error("could not decompress a block");
+    }
+    read += sourceSize;
+    written += targetSize;
+  }
+  if (written != size) {
+    throw std::runtime_error("the decompressed size does not match");
+  }
+  return decompressed;
+}
+
+} // namespace
+
+MonitorObjectCollection::Encoding::Compression MonitorObjectCollection::Encoding::compressionFromString(const std::string& name)
+{
+  if (name == "none") {
+    return Compression::None;
+  } else if (name == "zlib") {
+    return Compression::Zlib;
+  } else if (name == "lzma") {
+    return Compression::LZMA;
+  } else if (name == "lz4") {
+    return Compression::LZ4;
+  } else if (name == "zstd") {
+    return Compression::ZSTD;
+  }
+  throw std::runtime_error("Unknown compression algorithm '" + name + "', expected none, zlib, lzma, lz4 or zstd");
+}
+
+std::unique_ptr<MonitorObjectCollection> MonitorObjectCollection::encode(const Encoding& encoding) const
+{
+  auto encoded = std::make_unique<MonitorObjectCollection>();
+  encoded->SetName(GetName());
+  encoded->setDetector(mDetector);
+  encoded->setTaskName(mTaskName);
+
+  // Layout: number of objects, the objects, number of sparse histograms, their non-empty bins.
+  TBufferFile buffer(TBuffer::kWrite);
+  {
+    DetachedBins detachedBins;
+    std::vector<SparseBins> sparseHistograms;
+    buffer.WriteInt(GetEntries());
+    Int_t index = 0;
+    for (auto obj : *this) {
+      auto mo = dynamic_cast<MonitorObject*>(obj);
+      auto histo = mo != nullptr && encoding.sparseOccupancy > 0 ? dynamic_cast<TH1*>(mo->getObject()) : nullptr;
+      if (histo != nullptr) {
+        if (auto sparse = makeSparseBins(histo, encoding.sparseOccupancy)) {
+          sparse->object = index;
+          sparseHistograms.push_back(std::move(sparse.value()));
+          detachedBins.detach(histo);
+        }
+      }
+      buffer.WriteObject(obj);
+      index++;
+    }
+
+    buffer.WriteInt(static_cast<Int_t>(sparseHistograms.size()));
+    for (const auto& sparse : sparseHistograms) {
+      const auto bins = static_cast<Int_t>(sparse.bins.size());
+      buffer.WriteInt(sparse.object);
+      buffer.WriteInt(sparse.size);
+      buffer.WriteBool(sparse.hasSumw2);
+      buffer.WriteInt(bins);
+      buffer.WriteFastArray(sparse.bins.data(), bins);
+      buffer.WriteFastArray(sparse.contents.data(), bins);
+      if (sparse.hasSumw2) {
+        buffer.WriteFastArray(sparse.sumw2.data(), bins);
+      }
+    }
+  }
+
+  encoded->mEncodedSize = buffer.Length();
+  std::optional<std::vector<char>> compressed;
+  if (encoding.compression != Encoding::Compression::None) {
+    compressed = compress(buffer.Buffer(), buffer.Length(), encoding);
+  }
+  if (compressed.has_value()) {
+    encoded->mEncodedObjects = std::move(compressed.value());
+    encoded->mEncodedCompressed = true;
+  } else {
+    encoded->mEncodedObjects.assign(buffer.Buffer(), buffer.Buffer() + buffer.Length());
+  }
+  return encoded;
+}
+
+void MonitorObjectCollection::decode()
+{
+  if (!isEncoded()) {
+    return;
+  }
+  // the envelope is emptied first, so that the collection is not encoded anymore even if the buffer is corrupted
+  auto encoded = std::move(mEncodedObjects);
+  const auto encodedSize = mEncodedSize;
+  const auto encodedCompressed = mEncodedCompressed;
+  mEncodedObjects.clear();
+  mEncodedObjects.shrink_to_fit();
+  mEncodedSize = 0;
+  mEncodedCompressed = false;
+  std::vector<char> data = encodedCompressed ? decompress(encoded, encodedSize) : std::move(encoded);
+
+  TBufferFile buffer(TBuffer::kRead, static_cast<Int_t>(data.size()), data.data(), false);
+  auto readCount = [&buffer, &data](Int_t max) {
+    Int_t count = 0;
+    buffer.ReadInt(count);
+    if (count < 0 || count > max || buffer.Length() > static_cast<Int_t>(data.size())) {
+      throw std::runtime_error("invalid encoded collection");
+    }
+    return count;
+  };
+
+  constexpr auto maxCount = std::numeric_limits<Int_t>::max();
+  const auto objects = readCount(maxCount);
+  for (Int_t i = 0; i < objects; i++) {
+    Add(static_cast<TObject*>(buffer.ReadObjectAny(TObject::Class())));
+  }
+
+  const auto sparseHistograms = readCount(objects);
+  std::vector<Int_t> bins;
+  std::vector<Double_t> values;
+  for (Int_t i = 0; i < sparseHistograms; i++) {
+    const auto index = readCount(objects - 1);
+    const auto size = readCount(maxCount);
+    Bool_t hasSumw2 = false;
+    buffer.ReadBool(hasSumw2);
+    const auto nonEmpty = readCount(size);
+    if (buffer.Length() + nonEmpty * (sizeof(Int_t) + (hasSumw2 ? 2 : 1) * sizeof(Double_t)) > data.size()) {
+      throw std::runtime_error("sparse histogram out of bounds");
+    }
+    bins.resize(nonEmpty);
+    values.resize(nonEmpty);
+    buffer.ReadFastArray(bins.data(), nonEmpty);
+    if (std::any_of(bins.begin(), bins.end(), [size](Int_t bin) { return bin < 0 || bin >= size; })) {
+      throw std::runtime_error("sparse histogram bin out of range");
+    }
+
+    auto mo = dynamic_cast<MonitorObject*>(At(index));
+    auto histo = mo != nullptr ? dynamic_cast<TH1*>(mo->getObject()) : nullptr;
+    if (histo == nullptr) {
+      throw std::runtime_error("sparse bins for an object which is not a histogram");
+    }
+    buffer.ReadFastArray(values.data(), nonEmpty);
+    withBinArray(histo, [&](auto array) {
+      array->Set(size);
+      for (Int_t bin = 0; bin < nonEmpty; bin++) {
+        array->fArray[bins[bin]] = values[bin];
+      }
+    });
+    if (hasSumw2) {
+      buffer.ReadFastArray(values.data(), nonEmpty);
+      auto sumw2 = histo->GetSumw2();
+      sumw2->Set(size);
+      for (Int_t bin = 0; bin < nonEmpty; bin++) {
+        sumw2->fArray[bins[bin]] = values[bin];
+      }
+    }
+  }
+}
+
 } // namespace o2::quality_control::core
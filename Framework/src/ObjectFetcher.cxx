@@ -0,0 +1,150 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   ObjectFetcher.cxx
+///
+
+#include "QualityControl/ObjectFetcher.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <boost/exception/diagnostic_information.hpp>
+#include <TROOT.h>
+
+#include "QualityControl/Activity.h"
+#include "QualityControl/CachingDatabase.h"
+#include "QualityControl/DatabaseFactory.h"
+#include "QualityControl/DatabaseInterface.h"
+#include "QualityControl/MonitorObject.h"
+#include "QualityControl/QualityObject.h"
+#include "QualityControl/QcInfoLogger.h"
+#include "QualityControl/ThreadPool.h"
+
+using namespace o2::quality_control::core;
+using namespace o2::quality_control::repository;
+
+namespace o2::quality_control::postprocessing
+{
+
+ObjectFetcher::ObjectFetcher(size_t parallelism, std::unordered_map<std::string, std::string> databaseConfig)
+  : mParallelism(std::max<size_t>(parallelism, 1)),
+    mDatabaseConfig(std::move(databaseConfig))
+{
+  if (mParallelism > 1 && mDatabaseConfig.count("implementation") == 0) {
+    ILOG(Warning, Devel) << "The database configuration is incomplete, the objects will be retrieved sequentially" << ENDM;
+    mParallelism = 1;
+  }
+  if (mParallelism > 1) {
+    // each connection has its own memory cache, we split the budget so that they do not use more than one cache would
+    if (auto cacheConfig = CachingDatabaseConfig::fromDatabaseConfig(mDatabaseConfig); cacheConfig.enabled) {
+      mDatabaseConfig["cacheMaxBytes"] = std::to_string(cacheConfig.maxBytes / mParallelism);
+    }
+    ROOT::EnableThreadSafety(); // the objects are deserialized in parallel
+    mPool = std::make_unique<ThreadPool>(mParallelism);
+  }
+}
+
+ObjectFetcher::~ObjectFetcher() = default;
+
+ObjectFetcher::Result ObjectFetcher::retrieve(DatabaseInterface& qcdb, const Request& request, long timestamp,
+                                              const Activity& activity, const std::map<std::string, std::string>& metadata)
+{
+  Result result;
+  if (request.type == Request::Type::MonitorObject) {
+    result.mo = qcdb.retrieveMO(request.path, request.name, timestamp, activity, metadata);
+  } else {
+    result.qo = qcdb.retrieveQO(request.path + "/" + request.name, timestamp, activity, metadata);
+  }
+  return result;
+}
+
+std::unique_ptr<DatabaseInterface> ObjectFetcher::borrowConnection()
+{
+  {
+    std::lock_guard<std::mutex> lock(mConnectionsMutex);
+    if (!mIdleConnections.empty()) {
+      auto connection = std::move(mIdleConnections.back());
+      mIdleConnections.pop_back();
+      return connection;
+    }
+  }
+  // there are at most as many connections as threads
+  // they are built like the runner's database, with the same cache configuration
+  auto connection = DatabaseFactory::create(mDatabaseConfig);
+  connection->connect(mDatabaseConfig);
+  return connection;
+}
+
+void ObjectFetcher::returnConnection(std::unique_ptr<DatabaseInterface> connection)
+{
+  std::lock_guard<std::mutex> lock(mConnectionsMutex);
+  mIdleConnections.push_back(std::move(connection));
+}
+
+void ObjectFetcher::fetch(const std::vector<Request>& requests, long timestamp, const Activity& activity,
+                          const std::map<std::string, std::string>& metadata, DatabaseInterface& qcdb, const Callback& callback)
+{
+  if (!mPool || requests.size() < 2) {
+    for (size_t i = 0; i < requests.size(); i++) {
+      callback(i, retrieve(qcdb, requests[i], timestamp, activity, metadata));
+    }
+    return;
+  }
+
+  std::mutex arrivedMutex;
+  std::condition_variable arrivedCondition;
+  std::deque<std::pair<size_t, Result>> arrived;
+  for (size_t i = 0; i < requests.size(); i++) {
+    mPool->submit([&, i]() {
+      Result result;
+      try {
+        auto connection = borrowConnection();
+        result = retrieve(*connection, requests[i], timestamp, activity, metadata);
+        returnConnection(std::move(connection));
+      } catch (...) {
+        ILOG(Error, Support) << "Could not retrieve the object '" << requests[i].path << "/" << requests[i].name << "': "
+                             << boost::current_exception_diagnostic_information(true) << ENDM;
+      }
+      // we notify under the lock, because the calling thread destroys the condition variable once it got all the objects
+      std::lock_guard<std::mutex> lock(arrivedMutex);
+      arrived.emplace_back(i, std::move(result));
+      arrivedCondition.notify_one();
+    });
+  }
+
+  // the objects are processed in the calling thread in the order of arrival
+  // we cannot return before all the objects arrived, since the threads use the local variables
+  std::exception_ptr callbackException;
+  for (size_t processed = 0; processed < requests.size(); processed++) {
+    std::pair<size_t, Result> next;
+    {
+      std::unique_lock<std::mutex> lock(arrivedMutex);
+      arrivedCondition.wait(lock, [&] { return !arrived.empty(); });
+      next = std::move(arrived.front());
+      arrived.pop_front();
+    }
+    if (!callbackException) {
+      try {
+        callback(next.first, std::move(next.second));
+      } catch (...) {
+        callbackException = std::current_exception();
+      }
+    }
+  }
+  if (callbackException) {
+    std::rethrow_exception(callbackException);
+  }
+}
+
+} // namespace o2::quality_control::postprocessing
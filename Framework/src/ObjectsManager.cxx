@@ -18,11 +18,26 @@
 
 #include "QualityControl/QcInfoLogger.h"
 #include "QualityControl/MonitorObjectCollection.h"
+#include "QualityControl/ObjectMetadataKeys.h"
 #include <Common/Exceptions.h>
 #include <TObjArray.h>
+#include <TArrayC.h>
+#include <TArrayS.h>
+#include <TArrayI.h>
+#include <TArrayL64.h>
+#include <TArrayF.h>
+#include <TArrayD.h>
+#include <TGraph.h>
+#include <TH1.h>
+#include <THnSparse.h>
+#include <TNamed.h>
+#include <TBufferFile.h>
 
 #include <utility>
 #include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iterator>
 #include <ranges>
 
 using namespace o2::quality_control::core;
@@ -92,6 +107,7 @@ void ObjectsManager::stopPublishing(TObject* object)
   }
   if (moToRemove) {
     mPublicationPoliciesForMOs.erase(moToRemove);
+    mLastPublishedContents.erase(moToRemove);
     mMonitorObjects->Remove(moToRemove);
     mMonitorObjects->Compress();
   }
@@ -101,6 +117,7 @@ void ObjectsManager::stopPublishing(const string& objectName)
 {
   auto* mo = dynamic_cast<MonitorObject*>(getMonitorObject(objectName));
   mPublicationPoliciesForMOs.erase(mo);
+  mLastPublishedContents.erase(mo);
   mMonitorObjects->Remove(mo);
   mMonitorObjects->Compress();
 }
@@ -123,6 +140,7 @@ void ObjectsManager::stopPublishingAll()
 {
   mMonitorObjects->Clear();
   mPublicationPoliciesForMOs.clear();
+  mLastPublishedContents.clear();
 }
 
 bool ObjectsManager::isBeingPublished(const string& name)
@@ -156,6 +174,190 @@ MonitorObjectCollection* ObjectsManager::getNonOwningArray() const
   return new MonitorObjectCollection(*mMonitorObjects);
 }
 
+namespace
+{
+// FNV-1a, it is fast and good enough to detect changes
+class Checksum
+{
+ public:
+  void add(const void* data, size_t size)
+  {
+    auto bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+      mValue = (mValue ^ bytes[i]) * 1099511628211ull;
+    }
+  }
+  template <typename T>
+  void add(const T& value)
+  {
+    add(&value, sizeof(T));
+  }
+  void addString(const char* string)
+  {
+    add(string, string ? std::strlen(string) : 0);
+  }
+  // returns false if the array type is not known
+  bool addArray(const TArray* array)
+  {
+    if (array == nullptr) {
+      return true;
+    }
+    add(array->GetSize());
+    if (auto a = dynamic_cast<const TArrayD*>(array)) {
+      add(a->GetArray(), a->GetSize() * sizeof(Double_t));
+    } else if (auto a = dynamic_cast<const TArrayF*>(array)) {
+      add(a->GetArray(), a->GetSize() * sizeof(Float_t));
+    } else if (auto a = dynamic_cast<const TArrayI*>(array)) {
+      add(a->GetArray(), a->GetSize() * sizeof(Int_t));
+    } else if (auto a = dynamic_cast<const TArrayS*>(array)) {
+      add(a->GetArray(), a->GetSize() * sizeof(Short_t));
+    } else if (auto a = dynamic_cast<const TArrayC*>(array)) {
+      add(a->GetArray(), a->GetSize() * sizeof(Char_t));
+    } else if (auto a = dynamic_cast<const TArrayL64*>(array)) {
+      add(a->GetArray(), a->GetSize() * sizeof(Long64_t));
+    } else {
+      return false;
+    }
+    return true;
+  }
+  uint64_t value() const { return mValue; }
+
+ private:
+  uint64_t mValue = 14695981039346656037ull;
+};
+
+bool isEmpty(const TObject* obj)
+{
+  if (auto histo = dynamic_cast<const TH1*>(obj)) {
+    return histo->GetEntries() == 0;
+  }
+  if (auto sparse = dynamic_cast<const THnBase*>(obj)) {
+    return sparse->GetEntries() == 0;
+  }
+  if (auto graph = dynamic_cast<const TGraph*>(obj)) {
+    return graph->GetN() == 0;
+  }
+  return false;
+}
+} // namespace
+
+MonitorObjectCollection* ObjectsManager::getNonOwningArrayOfChangedObjects(bool onlyEmptyObjects, size_t& numberUnchanged)
+{
+  mUnchangedMarkers.clear();
+  numberUnchanged = 0;
+
+  auto array = new MonitorObjectCollection();
+  array->SetName(mMonitorObjects->GetName());
+  array->setDetector(mMonitorObjects->getDetector());
+  array->setTaskName(mMonitorObjects->getTaskName());
+  for (auto tobj : *mMonitorObjects) {
+    auto mo = dynamic_cast<MonitorObject*>(tobj);
+    auto summary = mo != nullptr ? contentSummary(mo->getObject()) : std::nullopt;
+    if (!summary.has_value()) {
+      array->Add(tobj);
+      continue;
+    }
+
+    auto [it, inserted] = mLastPublishedContents.try_emplace(mo);
+    auto& published = it->second;
+    bool changed = inserted || published.generation != mPublicationGeneration || !(published.summary == summary.value());
+    std::optional<uint64_t> checksum;
+    if (!changed) {
+      // The summary is the same, but the bins might have been modified without changing the statistics.
+      checksum = contentChecksum(mo->getObject());
+      changed = !checksum.has_value() || !published.checksum.has_value() || published.checksum.value() != checksum.value();
+    }
+    if (changed || (onlyEmptyObjects && !isEmpty(mo->getObject()))) {
+      published = { summary.value(), checksum, mPublicationGeneration };
+      array->Add(mo);
+      continue;
+    }
+
+    // The marker keeps the name, so it can be matched by Mergers and CheckRunners, but not the content.
+    auto marker = std::make_unique<MonitorObject>(new TNamed(mo->GetName(), mo->GetName()), mo->getTaskName(), mo->getTaskClass(), mo->getDetectorName());
+    marker->setIsOwner(true);
+    marker->setActivity(mo->getActivity());
+    marker->setValidity(mo->getValidity());
+    marker->addMetadata(mo->getMetadataMap());
+    marker->addOrUpdateMetadata(repository::metadata_keys::qcUnchanged, "1");
+    array->Add(marker.get());
+    mUnchangedMarkers.push_back(std::move(marker));
+    numberUnchanged++;
+  }
+  return array;
+}
+
+std::optional<uint64_t> ObjectsManager::contentChecksum(const TObject* obj)
+{
+  if (obj == nullptr) {
+    return std::nullopt;
+  }
+  Checksum checksum;
+  checksum.addString(obj->GetTitle());
+  if (auto histo = dynamic_cast<const TH1*>(obj)) {
+    checksum.add(histo->GetEntries());
+    checksum.add(histo->GetNcells());
+    if (!checksum.addArray(dynamic_cast<const TArray*>(histo)) || !checksum.addArray(histo->GetSumw2())) {
+      return std::nullopt;
+    }
+    return checksum.value();
+  }
+  if (auto sparse = dynamic_cast<const THnBase*>(obj)) {
+    // filling a THn always increments the number of entries, setting bin contents directly is seldom used
+    checksum.add(sparse->GetEntries());
+    checksum.add(sparse->GetNbins());
+    checksum.add(sparse->GetSumw());
+    checksum.add(sparse->GetSumw2());
+    return checksum.value();
+  }
+  if (auto graph = dynamic_cast<const TGraph*>(obj)) {
+    checksum.add(graph->GetN());
+    checksum.add(graph->GetX(), graph->GetN() * sizeof(Double_t));
+    checksum.add(graph->GetY(), graph->GetN() * sizeof(Double_t));
+    return checksum.value();
+  }
+  return std::nullopt;
+}
+
+std::optional<ObjectsManager::ContentSummary> ObjectsManager::contentSummary(const TObject* obj)
+{
+  if (obj == nullptr) {
+    return std::nullopt;
+  }
+  ContentSummary summary;
+  Checksum title;
+  title.addString(obj->GetTitle());
+  summary.titleHash = title.value();
+  if (auto histo = dynamic_cast<const TH1*>(obj)) {
+    // the statistics are updated by the fills, unlike GetSumOfWeights() they do not need a loop over the bins
+    Double_t stats[TH1::kNstat] = { 0 };
+    histo->GetStats(stats);
+    summary.entries = histo->GetEntries();
+    summary.sumOfWeights = stats[0];
+    summary.size = histo->GetNcells();
+    return summary;
+  }
+  if (auto sparse = dynamic_cast<const THnBase*>(obj)) {
+    summary.entries = sparse->GetEntries();
+    summary.sumOfWeights = sparse->GetSumw();
+    summary.size = sparse->GetNbins();
+    return summary;
+  }
+  if (auto graph = dynamic_cast<const TGraph*>(obj)) {
+    summary.size = graph->GetN();
+    for (int i = 0; i < graph->GetN(); i++) {
+      summary.sumOfWeights += graph->GetY()[i];
+    }
+    return summary;
+  }
+  return std::nullopt;
+}
+
+void ObjectsManager::forceFullPublication()
+{
+  mPublicationGeneration++;
+}
+
 void ObjectsManager::addMetadata(const std::string& objectName, const std::string& key, const std::string& value)
 {
   MonitorObject* mo = getMonitorObject(objectName);
@@ -239,6 +441,8 @@ const Activity& ObjectsManager::getActivity() const
 void ObjectsManager::setActivity(const Activity& activity)
 {
   mActivity = activity;
+  // the first publication in a new activity should contain all the objects
+  forceFullPublication();
   // update the activity of all the objects
   for (auto tobj : *mMonitorObjects) {
     auto* mo = dynamic_cast<MonitorObject*>(tobj);
@@ -256,4 +460,72 @@ const std::vector<std::string>& ObjectsManager::getMovingWindowsList() const
   return mMovingWindowsList;
 }
 
+std::vector<ObjectsManager::SerializationCost> ObjectsManager::measureSerialization(MonitorObjectCollection& collection)
+{
+  std::vector<SerializationCost> costs;
+  costs.reserve(collection.GetEntriesFast());
+  // the buffer is reused, so that only the first objects pay for its growth
+  TBufferFile buffer(TBuffer::kWrite);
+  for (auto tobj : collection) {
+    auto mo = dynamic_cast<MonitorObject*>(tobj);
+    if (mo == nullptr || mo->isUnchangedMarker()) {
+      continue;
+    }
+    buffer.Reset();
+    auto start = std::chrono::steady_clock::now();
+    buffer.WriteObject(mo);
+    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+    costs.push_back({ mo, static_cast<size_t>(buffer.Length()), duration.count() });
+    mo->addOrUpdateMetadata(repository::metadata_keys::qcSerializedSize, std::to_string(buffer.Length()));
+    mo->addOrUpdateMetadata(repository::metadata_keys::qcStreamingTime, std::to_string(static_cast<uint64_t>(duration.count() * 1e6)));
+  }
+  return costs;
+}
+
+void ObjectsManager::setLowPriority(const std::string& objectName, bool lowPriority)
+{
+  if (lowPriority) {
+    mLowPriorityObjects.insert(objectName);
+  } else {
+    mLowPriorityObjects.erase(objectName);
+  }
+}
+
+bool ObjectsManager::isLowPriority(const std::string& objectName) const
+{
+  return mLowPriorityObjects.count(objectName) > 0;
+}
+
+std::vector<MonitorObject*> ObjectsManager::enforceBudget(MonitorObjectCollection& collection, std::vector<SerializationCost>& costs, size_t budget)
+{
+  size_t total = 0;
+  for (const auto& cost : costs) {
+    total += cost.bytes;
+  }
+  std::vector<MonitorObject*> dropped;
+  if (total <= budget) {
+    return dropped;
+  }
+
+  std::vector<SerializationCost> candidates;
+  std::copy_if(costs.begin(), costs.end(), std::back_inserter(candidates), [this](const SerializationCost& cost) {
+    return isLowPriority(cost.object->GetName());
+  });
+  std::sort(candidates.begin(), candidates.end(), [](const SerializationCost& a, const SerializationCost& b) { return a.bytes > b.bytes; });
+  for (const auto& candidate : candidates) {
+    if (total <= budget) {
+      break;
+    }
+    collection.Remove(candidate.object);
+    mLastPublishedContents.erase(candidate.object); // so that it is published in full next time
+    total -= candidate.bytes;
+    dropped.push_back(candidate.object);
+  }
+  collection.Compress();
+  std::erase_if(costs, [&dropped](const SerializationCost& cost) {
+    return std::find(dropped.begin(), dropped.end(), cost.object) != dropped.end();
+  });
+  return dropped;
+}
+
 } // namespace o2::quality_control::core
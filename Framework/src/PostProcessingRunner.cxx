@@ -17,6 +17,8 @@
 #include "QualityControl/PostProcessingTaskSpec.h"
 #include "QualityControl/TriggerHelpers.h"
 #include "QualityControl/DatabaseFactory.h"
+#include "QualityControl/CachingDatabase.h"
+#include "QualityControl/ListingWatcher.h"
 #include "QualityControl/QcInfoLogger.h"
 #include "QualityControl/CommonSpec.h"
 #include "QualityControl/InfrastructureSpecReader.h"
@@ -31,6 +33,7 @@
 #include <utility>
 #include <Framework/DataAllocator.h>
 #include <CommonUtils/ConfigurableParam.h>
+#include <Monitoring/MonitoringFactory.h>
 #include <TSystem.h>
 
 using namespace o2::quality_control::core;
@@ -68,7 +71,7 @@ void PostProcessingRunner::init(const boost::property_tree::ptree& config, core:
 
 std::unique_ptr<DatabaseInterface> PostProcessingRunner::configureDatabase(std::unordered_map<std::string, std::string>& dbConfig, const std::string& name)
 {
-  auto database = DatabaseFactory::create(dbConfig.at("implementation"));
+  auto database = DatabaseFactory::create(dbConfig);
   database->connect(dbConfig);
   ILOG(Info, Devel) << name << " database that is going to be used > Implementation : " << dbConfig.at("implementation") << " / "
                     << " Host : " << dbConfig.at("host") << ENDM;
@@ -93,6 +96,23 @@ void PostProcessingRunner::init(const PostProcessingRunnerConfig& runnerConfig,
   // configuration of the database
   mSourceDatabase = configureDatabase(mRunnerConfig.sourceDatabase, "Source");
   mDestinationDatabase = configureDatabase(mRunnerConfig.destinationDatabase, "Destination");
+  if (auto cachingDatabase = std::dynamic_pointer_cast<CachingDatabase>(mSourceDatabase);
+      cachingDatabase != nullptr && mRunnerConfig.sourceDatabase.at("implementation") == "CCDB" && mRunnerConfig.sourceDatabase.count("host") > 0) {
+    // the NewObject triggers list the folders of the objects they watch, these listings spare requests to validate cached objects
+    auto watcher = ListingWatcher::forDatabase(mRunnerConfig.sourceDatabase.at("host"));
+    cachingDatabase->setLatestVersionFcn([watcher](const std::string& path, const std::map<std::string, std::string>& metadata) -> std::optional<uint64_t> {
+      if (auto version = watcher->findRecent(path, metadata); version.has_value()) {
+        return version->lastModified;
+      }
+      return std::nullopt;
+    });
+  }
+  if (!mRunnerConfig.monitoringUrl.empty() && std::dynamic_pointer_cast<CachingDatabase>(mSourceDatabase) != nullptr) {
+    mCollector = monitoring::MonitoringFactory::Get(mRunnerConfig.monitoringUrl);
+    mCollector->addGlobalTag(monitoring::tags::Key::Subsystem, monitoring::tags::Value::QC);
+    mCollector->addGlobalTag("TaskName", mTaskConfig.taskName);
+    mCollector->addGlobalTag("DetectorName", mTaskConfig.detectorName);
+  }
 
   mObjectManager = std::make_shared<ObjectsManager>(mTaskConfig.taskName, mTaskConfig.className, mTaskConfig.detectorName);
   mObjectManager->setActivity(mActivity);
@@ -237,6 +257,7 @@ void PostProcessingRunner::reset()
   mTask.reset();
   mSourceDatabase.reset();
   mDestinationDatabase.reset();
+  mCollector.reset();
   mServices = framework::ServiceRegistry();
   mObjectManager.reset();
 
@@ -298,6 +319,9 @@ void PostProcessingRunner::doUpdate(const Trigger& trigger)
   ILOG(Info, Support) << "Updating the user task due to trigger '" << trigger << "'" << ENDM;
   mTask->update(trigger, mServices);
   updateValidity(trigger);
+  if (auto cachingDatabase = std::dynamic_pointer_cast<CachingDatabase>(mSourceDatabase); cachingDatabase && mCollector) {
+    cachingDatabase->sendMetrics(*mCollector);
+  }
 
   if (mActivity.mValidity.isValid()) {
     mPublicationCallback(mObjectManager->getNonOwningArray());
@@ -348,7 +372,8 @@ PostProcessingRunnerConfig PostProcessingRunner::extractConfig(const CommonSpec&
     commonSpec.infologgerDiscardParameters,
     commonSpec.postprocessingPeriod,
     "",
-    ppTaskSpec.tree
+    ppTaskSpec.tree,
+    commonSpec.monitoringUrl
   };
 }
 
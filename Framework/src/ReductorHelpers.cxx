@@ -23,6 +23,9 @@
 #include "QualityControl/Triggers.h"
 #include "QualityControl/DatabaseInterface.h"
 #include "QualityControl/ConditionAccess.h"
+#include "QualityControl/ObjectFetcher.h"
+#include "QualityControl/MonitorObject.h"
+#include "QualityControl/QualityObject.h"
 
 namespace o2::quality_control::postprocessing::reductor_helpers::implementation
 {
@@ -60,4 +63,39 @@ bool updateReductorImpl(Reductor* r, const Trigger& t, const std::string& path,
   return false;
 }
 
+std::vector<bool> updateReductorsImpl(const std::vector<ReductorSource>& sources, const Trigger& t, repository::DatabaseInterface& qcdb,
+                                      core::ConditionAccess& ccdbAccess, ObjectFetcher& fetcher)
+{
+  std::vector<bool> updated(sources.size(), false);
+
+  std::vector<ObjectFetcher::Request> requests;
+  std::vector<size_t> sourceOfRequest;
+  for (size_t i = 0; i < sources.size(); i++) {
+    const auto& source = sources[i];
+    if (source.reductor == nullptr) {
+      continue;
+    }
+    if (source.type == "repository" || source.type == "repository-quality") {
+      auto type = source.type == "repository" ? ObjectFetcher::Request::Type::MonitorObject : ObjectFetcher::Request::Type::QualityObject;
+      requests.push_back({ source.path, source.name, type });
+      sourceOfRequest.push_back(i);
+    } else {
+      // conditions are retrieved by the task, which is not thread-safe
+      updated[i] = updateReductorImpl(source.reductor, t, source.path, source.name, source.type, qcdb, ccdbAccess);
+    }
+  }
+
+  fetcher.fetch(requests, t.timestamp, t.activity, t.metadata, qcdb, [&](size_t request, ObjectFetcher::Result&& result) {
+    auto i = sourceOfRequest[request];
+    auto reductorTObject = dynamic_cast<ReductorTObject*>(sources[i].reductor);
+    TObject* obj = result.mo ? result.mo->getObject() : result.qo.get();
+    if (obj && reductorTObject) {
+      reductorTObject->update(obj);
+      updated[i] = true;
+    }
+  });
+
+  return updated;
+}
+
 } // namespace o2::quality_control::postprocessing::reductor_helpers::implementation
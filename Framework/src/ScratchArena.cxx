@@ -0,0 +1,93 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    ScratchArena.cxx
+///
+
+#include "QualityControl/ScratchArena.h"
+
+#include <algorithm>
+
+namespace o2::quality_control::core
+{
+
+constexpr size_t chunkAlignment = alignof(std::max_align_t);
+
+ScratchArena::ScratchArena(size_t initialSize, std::pmr::memory_resource* upstream)
+  : mUpstream(upstream), mNextChunkSize(std::max<size_t>(initialSize, 1024))
+{
+}
+
+ScratchArena::~ScratchArena()
+{
+  release();
+}
+
+void* ScratchArena::do_allocate(size_t bytes, size_t alignment)
+{
+  mStats.allocations++;
+  while (true) {
+    for (; mCurrentChunk < mChunks.size(); mCurrentChunk++, mOffset = 0) {
+      const auto& chunk = mChunks[mCurrentChunk];
+      auto address = reinterpret_cast<uintptr_t>(chunk.data + mOffset);
+      size_t padding = (alignment - address % alignment) % alignment;
+      if (mOffset + padding + bytes <= chunk.size) {
+        void* result = chunk.data + mOffset + padding;
+        mOffset += padding + bytes;
+        mStats.bytesInUse += padding + bytes;
+        mStats.highWaterMark = std::max(mStats.highWaterMark, mStats.bytesInUse);
+        return result;
+      }
+    }
+    addChunk(bytes + alignment, alignment);
+  }
+}
+
+void ScratchArena::addChunk(size_t minimumSize, size_t alignment)
+{
+  size_t size = std::max(mNextChunkSize, minimumSize);
+  auto data = static_cast<std::byte*>(mUpstream->allocate(size, std::max(alignment, chunkAlignment)));
+  mChunks.push_back({ data, size, std::max(alignment, chunkAlignment) });
+  mCurrentChunk = mChunks.size() - 1;
+  mOffset = 0;
+  mNextChunkSize = 2 * size;
+  mStats.upstreamAllocations++;
+  mStats.capacity += size;
+}
+
+void ScratchArena::reset()
+{
+  if (mChunks.size() > 1) {
+    // the last time frame did not fit in one chunk, the next ones will
+    size_t total = mStats.capacity;
+    release();
+    mNextChunkSize = total;
+    addChunk(total, chunkAlignment);
+  }
+  mCurrentChunk = 0;
+  mOffset = 0;
+  mStats.bytesInUse = 0;
+}
+
+void ScratchArena::release()
+{
+  for (const auto& chunk : mChunks) {
+    mUpstream->deallocate(chunk.data, chunk.size, chunk.alignment);
+  }
+  mChunks.clear();
+  mCurrentChunk = 0;
+  mOffset = 0;
+  mStats.bytesInUse = 0;
+  mStats.capacity = 0;
+}
+
+} // namespace o2::quality_control::core
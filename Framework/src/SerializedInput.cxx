@@ -0,0 +1,101 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   SerializedInput.cxx
+///
+
+#include "QualityControl/SerializedInput.h"
+
+#include <Framework/DataProcessingHeader.h>
+#include <Framework/DataRef.h>
+#include <Framework/DataRefUtils.h>
+#include <TObject.h>
+
+#include <stdexcept>
+
+using namespace o2::framework;
+
+namespace o2::quality_control::checker
+{
+
+bool SerializedInput::receive(const DataRef& ref)
+{
+  const auto* dataHeader = DataRefUtils::getHeader<header::DataHeader*>(ref);
+  if (dataHeader == nullptr) {
+    throw std::runtime_error("SerializedInput: no DataHeader found in the message");
+  }
+  const auto* processingHeader = DataRefUtils::getHeader<DataProcessingHeader*>(ref);
+  return receive(*dataHeader, processingHeader, ref.payload, DataRefUtils::getPayloadSize(ref));
+}
+
+bool SerializedInput::receive(const header::DataHeader& dataHeader, const DataProcessingHeader* processingHeader, const char* payload, size_t payloadSize)
+{
+  // Without a DataProcessingHeader we cannot tell two messages apart without looking at their content, thus we keep them all.
+  std::optional<MessageIdentity> identity;
+  if (processingHeader != nullptr) {
+    identity = MessageIdentity{ processingHeader->startTime, processingHeader->creation, payload, payloadSize };
+  }
+  if (mReceived && identity.has_value() && identity == mIdentity) {
+    return false;
+  }
+  if (mPending) {
+    mNumberSkipped++;
+  }
+
+  mHeader = dataHeader;
+  mHeader.flagsNextHeader = 0; // only the DataHeader is kept, we need it to know the serialization method
+  mHeader.payloadSize = payloadSize;
+  // the payload is copied only if it is still pending when the DPL message is released, see keepPayload()
+  mPayloadView = payload;
+  mPayloadSize = payloadSize;
+  mIdentity = identity;
+  mReceived = true;
+  mPending = true;
+  return true;
+}
+
+std::unique_ptr<TObject> SerializedInput::deserialize()
+{
+  if (!mPending) {
+    throw std::runtime_error("SerializedInput: no message pending deserialization");
+  }
+  mPending = false;
+  DataRef ref;
+  ref.header = reinterpret_cast<const char*>(&mHeader);
+  ref.payload = mPayloadView;
+  ref.payloadSize = mPayloadSize;
+  return DataRefUtils::as<TObject>(ref);
+}
+
+void SerializedInput::keepPayload()
+{
+  if (!mPending || mPayloadView == mPayload.data()) {
+    return;
+  }
+  mPayload.assign(mPayloadView, mPayloadView + mPayloadSize);
+  mPayloadView = mPayload.data();
+}
+
+void SerializedInput::clear()
+{
+  mPayloadView = nullptr;
+  mPayloadSize = 0;
+  mPayload.clear();
+  mIdentity.reset();
+  mReceived = false;
+  mPending = false;
+  mObjectsKnown = false;
+  mContainsUnchangedMarkers = false;
+  mObjectNames.clear();
+}
+
+} // namespace o2::quality_control::checker
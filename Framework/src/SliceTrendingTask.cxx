@@ -104,6 +104,7 @@ void SliceTrendingTask::initialize(Trigger t, framework::ServiceRegistryRef serv
       source.moduleName, source.reductorName));
     mReductors[source.name] = std::move(reductor);
   }
+  mObjectFetcher = std::make_unique<ObjectFetcher>(mConfig.fetchParallelism, mConfig.repository);
 
   if (mConfig.producePlotsOnUpdate) {
     getObjectsManager()->startPublishing(mTrend.get(), PublicationPolicy::ThroughStop);
@@ -147,29 +148,38 @@ void SliceTrendingTask::trendValues(const Trigger& t,
   mMetaData.runNumber = t.activity.mId;
   std::snprintf(mMetaData.runNumberStr, MaxRunNumberStringLength + 1, "%d", t.activity.mId);
 
+  std::vector<ObjectFetcher::Request> requests;
+  std::vector<const SliceTrendingTaskConfig::DataSource*> requestedSources;
   for (auto& dataSource : mConfig.dataSources) {
     mNumberPads[dataSource.name] = 0;
     mSources[dataSource.name]->clear();
     if (dataSource.type == "repository") {
-      auto mo = qcdb.retrieveMO(dataSource.path, dataSource.name, t.timestamp, t.activity, t.metadata);
-      TObject* obj = mo ? mo->getObject() : nullptr;
-
       mAxisDivision[dataSource.name] = dataSource.axisDivision;
       mSliceLabel[dataSource.name] = dataSource.sliceLabels;
-
-      if (obj) {
-        mReductors[dataSource.name]->update(obj, *mSources[dataSource.name],
-                                            dataSource.axisDivision, mNumberPads[dataSource.name]);
-      } else {
-        ILOG(Error, Support) << "Some objects could not be retrieved, will skip this trending cycle" << ENDM;
-        return;
-      }
-
+      requests.push_back({ dataSource.path, dataSource.name });
+      requestedSources.push_back(&dataSource);
     } else {
       ILOG(Error, Support) << "Data source '" << dataSource.type << "' is not of type repository." << ENDM;
     }
   }
 
+  // the objects are reduced as soon as they are retrieved
+  bool allRetrieved = true;
+  mObjectFetcher->fetch(requests, t.timestamp, t.activity, t.metadata, qcdb, [&](size_t request, ObjectFetcher::Result&& result) {
+    TObject* obj = result.mo ? result.mo->getObject() : nullptr;
+    if (obj == nullptr) {
+      allRetrieved = false;
+      return;
+    }
+    const auto& dataSource = *requestedSources[request];
+    mReductors[dataSource.name]->update(obj, *mSources[dataSource.name],
+                                        dataSource.axisDivision, mNumberPads[dataSource.name]);
+  });
+  if (!allRetrieved) {
+    ILOG(Error, Support) << "Some objects could not be retrieved, will skip this trending cycle" << ENDM;
+    return;
+  }
+
   mTrend->Fill();
 } // void SliceTrendingTask::trendValues(const Trigger& t, repository::DatabaseInterface& qcdb)
 
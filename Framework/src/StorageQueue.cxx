@@ -0,0 +1,255 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   StorageQueue.cxx
+///
+
+#include "QualityControl/StorageQueue.h"
+
+#include <chrono>
+#include <boost/exception/diagnostic_information.hpp>
+#include <Common/Exceptions.h>
+#include <Monitoring/Monitoring.h>
+#include <InfoLogger/InfoLoggerMacros.hxx>
+
+#include "QualityControl/DatabaseInterface.h"
+#include "QualityControl/MonitorObject.h"
+#include "QualityControl/QualityObject.h"
+#include "QualityControl/QcInfoLogger.h"
+
+using namespace o2::monitoring;
+using namespace o2::quality_control::core;
+
+namespace o2::quality_control::repository
+{
+
+StorageQueueConfig StorageQueueConfig::fromDatabaseConfig(const std::unordered_map<std::string, std::string>& databaseConfig)
+{
+  StorageQueueConfig config;
+  auto get = [&databaseConfig](const std::string& key) -> const std::string* {
+    auto it = databaseConfig.find(key);
+    return it != databaseConfig.end() && !it->second.empty() ? &it->second : nullptr;
+  };
+
+  if (auto value = get("asyncStorage")) {
+    config.enabled = *value == "true" || *value == "1";
+  }
+  if (auto value = get("asyncStorageThreads")) {
+    config.threads = std::max(1ul, std::stoul(*value));
+  }
+  if (auto value = get("asyncStorageMaxInFlight")) {
+    config.maxInFlight = std::max(1ul, std::stoul(*value));
+  }
+  if (auto value = get("asyncStorageBatchSize")) {
+    config.batchSize = std::max(1ul, std::stoul(*value));
+  }
+  if (auto value = get("asyncStorageRetries")) {
+    config.retries = std::stoul(*value);
+  }
+  if (auto value = get("asyncStorageOverflowPolicy")) {
+    if (*value == "drop") {
+      config.overflow = OverflowPolicy::Drop;
+    } else if (*value == "block") {
+      config.overflow = OverflowPolicy::Block;
+    } else {
+      BOOST_THROW_EXCEPTION(AliceO2::Common::FatalException() << AliceO2::Common::errinfo_details("Unknown asyncStorageOverflowPolicy '" + *value + "', expected 'drop' or 'block'"));
+    }
+  }
+  return config;
+}
+
+StorageQueue::StorageQueue(StorageQueueConfig config, const DatabaseCreator& databaseCreator)
+  : mConfig(std::move(config))
+{
+  for (size_t i = 0; i < mConfig.threads; i++) {
+    mWorkers.emplace_back(&StorageQueue::workerLoop, this, databaseCreator());
+  }
+  ILOG(Info, Devel) << "Asynchronous storage enabled with " << mConfig.threads << " threads, at most "
+                    << mConfig.maxInFlight << " objects in flight" << ENDM;
+}
+
+StorageQueue::~StorageQueue()
+{
+  flush();
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStopping = true;
+  }
+  mItemAvailable.notify_all();
+  mSpaceAvailable.notify_all();
+  for (auto& worker : mWorkers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+bool StorageQueue::push(std::shared_ptr<const MonitorObject> mo)
+{
+  return pushItem({ std::move(mo) });
+}
+
+bool StorageQueue::push(std::shared_ptr<const QualityObject> qo)
+{
+  return pushItem({ std::move(qo) });
+}
+
+bool StorageQueue::pushAfterPrevious(std::shared_ptr<const MonitorObject> mo)
+{
+  return pushItem({ std::move(mo), true });
+}
+
+bool StorageQueue::canTakeFront() const
+{
+  // the objects before an ordered one have all been dequeued already, we wait until their upload is over
+  return !mQueue.empty() && (!mQueue.front().afterPrevious || mUploading == 0);
+}
+
+bool StorageQueue::pushItem(Item&& item)
+{
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (mConfig.overflow == StorageQueueConfig::OverflowPolicy::Block) {
+      mSpaceAvailable.wait(lock, [this] { return mInFlight < mConfig.maxInFlight || mStopping; });
+    }
+    if (mStopping || mInFlight >= mConfig.maxInFlight) {
+      mTotalDropped++;
+      static AliceO2::InfoLogger::InfoLogger::AutoMuteToken msgLimit(LogWarningSupport, 1, 600); // send it once every 10 minutes
+      ILOG_INST.log(msgLimit, "Storage queue is full (%zu objects in flight), dropping objects", mInFlight);
+      return false;
+    }
+    mQueue.push_back(std::move(item));
+    mInFlight++;
+  }
+  mItemAvailable.notify_one();
+  return true;
+}
+
+void StorageQueue::flush()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  mAllDone.wait(lock, [this] { return mInFlight == 0; });
+}
+
+size_t StorageQueue::getNumberInFlight() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mInFlight;
+}
+
+void StorageQueue::sendMetrics(Monitoring& collector)
+{
+  size_t queueDepth;
+  size_t inFlight;
+  double latencyMean;
+  double latencyMax;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    queueDepth = mQueue.size();
+    inFlight = mInFlight;
+    latencyMean = mLatencyCount > 0 ? mLatencySumMs / mLatencyCount : 0;
+    latencyMax = mLatencyMaxMs;
+    mLatencySumMs = 0;
+    mLatencyMaxMs = 0;
+    mLatencyCount = 0;
+  }
+  collector.send(Metric{ "qc_storage_queue" }
+                   .addValue(queueDepth, "depth")
+                   .addValue(inFlight, "in_flight")
+                   .addValue(mTotalStored.load(), "stored")
+                   .addValue(mTotalDropped.load(), "dropped")
+                   .addValue(mTotalFailed.load(), "failed")
+                   .addValue(mTotalRetried.load(), "retried"));
+  collector.send(Metric{ "qc_storage_upload_latency" }
+                   .addValue(latencyMean, "mean_ms")
+                   .addValue(latencyMax, "max_ms"));
+}
+
+void StorageQueue::workerLoop(std::unique_ptr<DatabaseInterface> database)
+{
+  std::vector<Item> batch;
+  batch.reserve(mConfig.batchSize);
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mItemAvailable.wait(lock, [this] { return canTakeFront() || (mQueue.empty() && mStopping); });
+      if (mQueue.empty() && mStopping) {
+        break;
+      }
+      while (canTakeFront() && batch.size() < mConfig.batchSize) {
+        bool afterPrevious = mQueue.front().afterPrevious;
+        batch.push_back(std::move(mQueue.front()));
+        mQueue.pop_front();
+        mUploading++;
+        if (afterPrevious) {
+          break;
+        }
+      }
+    }
+
+    double latencySumMs = 0;
+    double latencyMaxMs = 0;
+    for (const auto& item : batch) {
+      auto start = std::chrono::steady_clock::now();
+      bool stored = false;
+      for (size_t attempt = 0; attempt <= mConfig.retries && !stored; attempt++) {
+        if (attempt > 0) {
+          mTotalRetried++;
+        }
+        stored = upload(*database, item);
+      }
+      if (stored) {
+        mTotalStored++;
+      } else {
+        mTotalFailed++;
+      }
+      double latencyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      latencySumMs += latencyMs;
+      latencyMaxMs = std::max(latencyMaxMs, latencyMs);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mInFlight -= batch.size();
+      mUploading -= batch.size();
+      mLatencySumMs += latencySumMs;
+      mLatencyMaxMs = std::max(mLatencyMaxMs, latencyMaxMs);
+      mLatencyCount += batch.size();
+      if (mInFlight == 0) {
+        mAllDone.notify_all();
+      }
+    }
+    mSpaceAvailable.notify_all();
+    mItemAvailable.notify_all(); // an ordered object might be waiting for this batch
+    batch.clear();
+  }
+}
+
+bool StorageQueue::upload(DatabaseInterface& database, const Item& item)
+{
+  try {
+    if (auto mo = std::get_if<std::shared_ptr<const MonitorObject>>(&item.object)) {
+      database.storeMO(*mo);
+    } else if (auto qo = std::get_if<std::shared_ptr<const QualityObject>>(&item.object)) {
+      database.storeQO(*qo);
+    }
+    return true;
+  } catch (boost::exception& e) {
+    ILOG(Warning, Support) << "Unable to store an object asynchronously: " << boost::diagnostic_information(e) << ENDM;
+  } catch (std::exception& e) {
+    ILOG(Warning, Support) << "Unable to store an object asynchronously: " << e.what() << ENDM;
+  }
+  return false;
+}
+
+} // namespace o2::quality_control::repository
@@ -0,0 +1,302 @@
+// Copyright 2019-2022 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    TaskProfiler.cxx
+///
+
+#include "QualityControl/TaskProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace o2::quality_control::core
+{
+
+size_t LatencyHistogram::bucketIndex(uint64_t value)
+{
+  constexpr uint64_t subBuckets = 1 << subBucketBits;
+  if (value < subBuckets) {
+    return value;
+  }
+  const size_t exponent = 63 - __builtin_clzll(value);
+  const size_t shift = exponent - subBucketBits;
+  return ((shift + 1) << subBucketBits) + ((value >> shift) & (subBuckets - 1));
+}
+
+uint64_t LatencyHistogram::bucketMiddle(size_t index)
+{
+  constexpr uint64_t subBuckets = 1 << subBucketBits;
+  if (index < subBuckets) {
+    return index;
+  }
+  const size_t shift = (index >> subBucketBits) - 1;
+  const uint64_t low = (subBuckets + (index & (subBuckets - 1))) << shift;
+  return low + ((uint64_t{ 1 } << shift) >> 1);
+}
+
+void LatencyHistogram::add(uint64_t nanoseconds)
+{
+  mCounts[bucketIndex(nanoseconds)]++;
+  mCount++;
+  mMax = std::max(mMax, nanoseconds);
+}
+
+void LatencyHistogram::reset()
+{
+  mCounts.fill(0);
+  mCount = 0;
+  mMax = 0;
+}
+
+uint64_t LatencyHistogram::getPercentile(double fraction) const
+{
+  if (mCount == 0) {
+    return 0;
+  }
+  const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(std::clamp(fraction, 0.0, 1.0) * mCount)));
+  if (rank >= mCount) {
+    return mMax;
+  }
+  uint64_t seen = 0;
+  for (size_t i = 0; i < nBuckets; i++) {
+    seen += mCounts[i];
+    if (seen >= rank) {
+      return std::min(bucketMiddle(i), mMax);
+    }
+  }
+  return mMax;
+}
+
+TaskProfiler::ScopedTimer::ScopedTimer(TaskProfiler* profiler, size_t section, bool measureHeap)
+  : mProfiler(profiler), mSection(section), mMeasureHeap(measureHeap)
+{
+  if (mMeasureHeap) {
+    mHeapStart = heapInUse();
+  }
+  mCpuStart = threadCpuTime();
+  mStart = now();
+}
+
+TaskProfiler::ScopedTimer::ScopedTimer(ScopedTimer&& other) noexcept
+  : mProfiler(other.mProfiler), mSection(other.mSection), mMeasureHeap(other.mMeasureHeap), mStart(other.mStart), mCpuStart(other.mCpuStart), mHeapStart(other.mHeapStart)
+{
+  other.mProfiler = nullptr;
+}
+
+TaskProfiler::ScopedTimer& TaskProfiler::ScopedTimer::operator=(ScopedTimer&& other) noexcept
+{
+  if (this != &other) {
+    stop();
+    mProfiler = other.mProfiler;
+    mSection = other.mSection;
+    mMeasureHeap = other.mMeasureHeap;
+    mStart = other.mStart;
+    mCpuStart = other.mCpuStart;
+    mHeapStart = other.mHeapStart;
+    other.mProfiler = nullptr;
+  }
+  return *this;
+}
+
+double TaskProfiler::ScopedTimer::stop()
+{
+  if (mProfiler == nullptr) {
+    return 0;
+  }
+  const uint64_t duration = now() - mStart;
+  const uint64_t cpuTime = threadCpuTime() - mCpuStart;
+  const int64_t heapGrowth = mMeasureHeap ? heapInUse() - mHeapStart : 0;
+  mProfiler->record(mSection, mStart, duration, cpuTime, heapGrowth);
+  mProfiler = nullptr;
+  return duration * 1e-9;
+}
+
+void TaskProfiler::configure(bool enabled, std::string traceFile, size_t maxTraceEvents)
+{
+  std::lock_guard lock(mMutex);
+  mEnabled = enabled;
+  mTraceFile = enabled ? std::move(traceFile) : "";
+  mMaxTraceEvents = mTraceFile.empty() ? 0 : maxTraceEvents;
+  mTraceEvents.clear();
+  mDroppedTraceEvents = 0;
+}
+
+TaskProfiler::ScopedTimer TaskProfiler::scope(std::string_view name, bool measureHeap)
+{
+  if (!mEnabled) {
+    return {};
+  }
+  return { this, getSection(name), measureHeap };
+}
+
+size_t TaskProfiler::getSection(std::string_view name)
+{
+  std::lock_guard lock(mMutex);
+  // there are only a few sections, a linear search is faster than a map
+  auto it = std::find_if(mSections.begin(), mSections.end(), [&](const Section& section) { return section.name == name; });
+  if (it != mSections.end()) {
+    return it - mSections.begin();
+  }
+  mSections.emplace_back();
+  mSections.back().name = name;
+  return mSections.size() - 1;
+}
+
+void TaskProfiler::record(size_t section, uint64_t start, uint64_t duration, uint64_t cpuTime, int64_t heapGrowth)
+{
+  thread_local const auto thread = static_cast<uint32_t>(syscall(SYS_gettid));
+  std::lock_guard lock(mMutex);
+  auto& stats = mSections.at(section);
+  stats.latency.add(duration);
+  stats.cpuTime += cpuTime;
+  stats.heapGrowth += heapGrowth;
+  if (mTraceEvents.size() < mMaxTraceEvents) {
+    mTraceEvents.push_back({ static_cast<uint32_t>(section), thread, start, duration });
+  } else if (mMaxTraceEvents > 0) {
+    mDroppedTraceEvents++;
+  }
+}
+
+std::vector<TaskProfiler::SectionStats> TaskProfiler::getStats() const
+{
+  std::lock_guard lock(mMutex);
+  std::vector<SectionStats> stats;
+  for (const auto& section : mSections) {
+    if (section.latency.getCount() == 0) {
+      continue;
+    }
+    stats.push_back({ section.name,
+                      section.latency.getCount(),
+                      section.latency.getPercentile(0.5) * 1e-9,
+                      section.latency.getPercentile(0.9) * 1e-9,
+                      section.latency.getPercentile(0.99) * 1e-9,
+                      section.latency.getMax() * 1e-9,
+                      section.cpuTime * 1e-9,
+                      section.heapGrowth });
+  }
+  return stats;
+}
+
+void TaskProfiler::resetCycle()
+{
+  std::lock_guard lock(mMutex);
+  for (auto& section : mSections) {
+    section.latency.reset();
+    section.cpuTime = 0;
+    section.heapGrowth = 0;
+  }
+}
+
+bool TaskProfiler::writeTrace(const std::string& processName) const
+{
+  if (mTraceFile.empty()) {
+    return false;
+  }
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  {
+    std::lock_guard lock(mMutex);
+    const auto pid = static_cast<int>(getpid());
+    writer.StartObject();
+    writer.Key("traceEvents");
+    writer.StartArray();
+    writer.StartObject();
+    writer.Key("name");
+    writer.String("process_name");
+    writer.Key("ph");
+    writer.String("M");
+    writer.Key("pid");
+    writer.Int(pid);
+    writer.Key("args");
+    writer.StartObject();
+    writer.Key("name");
+    writer.String(processName.c_str());
+    writer.EndObject();
+    writer.EndObject();
+    for (const auto& event : mTraceEvents) {
+      writer.StartObject();
+      writer.Key("name");
+      writer.String(mSections[event.section].name.c_str());
+      writer.Key("cat");
+      writer.String("qc");
+      writer.Key("ph");
+      writer.String("X");
+      writer.Key("ts"); // microseconds
+      writer.Double(event.start * 1e-3);
+      writer.Key("dur");
+      writer.Double(event.duration * 1e-3);
+      writer.Key("pid");
+      writer.Int(pid);
+      writer.Key("tid");
+      writer.Uint(event.thread);
+      writer.EndObject();
+    }
+    writer.EndArray();
+    writer.Key("displayTimeUnit");
+    writer.String("ms");
+    writer.Key("droppedEvents");
+    writer.Uint64(mDroppedTraceEvents);
+    writer.EndObject();
+  }
+
+  std::unique_ptr<FILE, decltype(&fclose)> file(fopen(mTraceFile.c_str(), "w"), &fclose);
+  return file && fwrite(buffer.GetString(), 1, buffer.GetSize(), file.get()) == buffer.GetSize();
+}
+
+void TaskProfiler::clearTrace()
+{
+  std::lock_guard lock(mMutex);
+  mTraceEvents.clear();
+  mDroppedTraceEvents = 0;
+}
+
+size_t TaskProfiler::getNumberOfTraceEvents() const
+{
+  std::lock_guard lock(mMutex);
+  return mTraceEvents.size();
+}
+
+uint64_t TaskProfiler::now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t TaskProfiler::threadCpuTime()
+{
+  timespec time{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return static_cast<uint64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+}
+
+int64_t TaskProfiler::heapInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  const auto info = mallinfo2();
+  return static_cast<int64_t>(info.uordblks + info.hblkhd);
+#else
+  return 0;
+#endif
+}
+
+} // namespace o2::quality_control::core
@@ -51,6 +51,9 @@
 #include "QualityControl/WorkflowType.h"
 #include "QualityControl/runnerUtils.h"
 
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
 #include <string>
 #include <TFile.h>
 #include <boost/property_tree/ptree.hpp>
@@ -108,6 +111,9 @@ void TaskRunner::init(InitContext& iCtx)
   // setup publisher
   mObjectsManager = std::make_shared<ObjectsManager>(mTaskConfig.name, mTaskConfig.className, mTaskConfig.detectorName, mTaskConfig.parallelTaskID);
   mObjectsManager->setMovingWindowsList(mTaskConfig.movingWindows);
+  for (const auto& objectName : mTaskConfig.lowPriorityObjects) {
+    mObjectsManager->setLowPriority(objectName);
+  }
 
   // setup timekeeping
   mDeploymentMode = DefaultsHelpers::deploymentMode();
@@ -124,6 +130,10 @@ void TaskRunner::init(InitContext& iCtx)
   mTask->setMonitoring(mCollector);
   mTask->setGlobalTrackingDataRequest(mTaskConfig.globalTrackingDataRequest);
   mTask->setDatabase(mTaskConfig.repository);
+  mTask->getProfiler().configure(mTaskConfig.profiling, getTraceFilePath());
+  if (mTaskConfig.profiling) {
+    mHeapInUseAtCycleStart = TaskProfiler::heapInUse();
+  }
 
   // load config params
   if (!ConfigParamGlo::keyValues.empty()) {
@@ -173,7 +183,11 @@ void TaskRunner::run(ProcessingContext& pCtx)
 
   if (isDataReady(pCtx.inputs())) {
     mTimekeeper->updateByTimeFrameID(pCtx.services().get<TimingInfo>().tfCounter);
-    mTask->monitorData(pCtx);
+    {
+      auto timer = mTask->getProfiler().scope("monitorData");
+      mTask->monitorData(pCtx);
+    }
+    mTask->getScratchArena().reset();
     updateMonitoringStats(pCtx);
   }
 }
@@ -367,6 +381,7 @@ void TaskRunner::startOfActivity()
   // Start activity in module's task and update objectsManager
   ILOG(Info, Support) << "Starting run " << mActivity.mId << ENDM;
   mObjectsManager->setActivity(mActivity);
+  mTask->getProfiler().clearTrace();
 
   auto now = getCurrentTimestamp();
   mTimekeeper->setStartOfActivity(mActivity.mValidity.getMin(), mTaskConfig.fallbackActivity.mValidity.getMin(), now, activity_helpers::getCcdbSorTimeAccessor(mActivity.mId));
@@ -390,6 +405,15 @@ void TaskRunner::endOfActivity()
 
   double rate = mTotalNumberObjectsPublished / mTimerTotalDurationActivity.getTime();
   mCollector->send(Metric{ "qc_objects_published" }.addValue(rate, "per_second_whole_run"));
+
+  const auto& profiler = mTask->getProfiler();
+  if (!profiler.getTraceFile().empty()) {
+    if (profiler.writeTrace(mTaskConfig.deviceName)) {
+      ILOG(Info, Devel) << "Profiling trace of " << profiler.getNumberOfTraceEvents() << " events written to " << profiler.getTraceFile() << ENDM;
+    } else {
+      ILOG(Warning, Devel) << "Could not write the profiling trace to " << profiler.getTraceFile() << ENDM;
+    }
+  }
 }
 
 void TaskRunner::startCycle()
@@ -421,14 +445,20 @@ void TaskRunner::finishCycle(DataAllocator& outputs)
     << "(" << mTimekeeper->getValidity().getMin() << ", " << mTimekeeper->getValidity().getMax() << "), "
     << "(" << mTimekeeper->getSampleTimespan().getMin() << ", " << mTimekeeper->getSampleTimespan().getMax() << "), "
     << "(" << mTimekeeper->getTimerangeIdRange().getMin() << ", " << mTimekeeper->getTimerangeIdRange().getMax() << ")" << ENDM;
-  mTask->endOfCycle();
+  {
+    auto timer = mTask->getProfiler().scope("endOfCycle");
+    mTask->endOfCycle();
+  }
 
   if (mCycleNumber == 0) { // register at the end of the first cycle
     registerToBookkeeping();
   }
 
   mObjectsManager->setValidity(mTimekeeper->getValidity());
-  mNumberObjectsPublishedInCycle += publish(outputs);
+  {
+    auto timer = mTask->getProfiler().scope("publish");
+    mNumberObjectsPublishedInCycle += publish(outputs);
+  }
   mTotalNumberObjectsPublished += mNumberObjectsPublishedInCycle;
   saveToFile();
 
@@ -482,6 +512,57 @@ void TaskRunner::publishCycleStats()
                      .addValue(rate, "per_second")
                      .addValue(mTotalNumberObjectsPublished, "whole_run")
                      .addValue(wholeRunRate, "per_second_whole_run"));
+
+  const auto& scratchStats = mTask->getScratchArena().getStats();
+  mCollector->send(Metric{ "qc_scratch_memory" }
+                     .addValue(static_cast<uint64_t>(scratchStats.highWaterMark), "high_water_mark")
+                     .addValue(static_cast<uint64_t>(scratchStats.capacity), "capacity")
+                     .addValue(scratchStats.allocations, "allocations_whole_run")
+                     .addValue(scratchStats.upstreamAllocations, "upstream_allocations_whole_run"));
+
+  auto& profiler = mTask->getProfiler();
+  if (profiler.isEnabled()) {
+    // The heap is sampled once per cycle, since mallinfo2 walks all the arenas of the process. Its growth includes
+    // everything allocated by the process during the cycle, not only in monitorData, so it is only an approximation.
+    const int64_t heapInUse = TaskProfiler::heapInUse();
+    const int64_t heapGrowth = heapInUse - mHeapInUseAtCycleStart;
+    mHeapInUseAtCycleStart = heapInUse;
+    for (const auto& section : profiler.getStats()) {
+      Metric metric{ "qc_profile_" + section.name };
+      metric.addValue(section.calls, "calls")
+        .addValue(section.p50, "p50")
+        .addValue(section.p90, "p90")
+        .addValue(section.p99, "p99")
+        .addValue(section.max, "max")
+        .addValue(section.cpuTime / section.calls, "cpu_time_per_call");
+      if (section.name == "monitorData") {
+        metric.addValue(static_cast<double>(heapGrowth) / section.calls, "heap_growth_per_tf")
+          .addValue(static_cast<uint64_t>(heapInUse), "heap_in_use");
+      }
+      mCollector->send(std::move(metric));
+    }
+    profiler.resetCycle();
+  }
+
+  if (mTaskConfig.serializationAccounting) {
+    mCollector->send(Metric{ "qc_serialization" }
+                       .addValue(mSerializedBytesInCycle, "bytes_in_cycle")
+                       .addValue(mSerializationTimeInCycle, "streaming_time")
+                       .addValue(mLargestObjectInCycle, "largest_object")
+                       .addValue(mObjectsDroppedInCycle, "objects_dropped"));
+    mSerializedBytesInCycle = 0;
+    mSerializationTimeInCycle = 0;
+    mLargestObjectInCycle = 0;
+    mObjectsDroppedInCycle = 0;
+  }
+
+  if (mTaskConfig.transportEncoding.isEnabled()) {
+    mCollector->send(Metric{ "qc_transport_encoding" }
+                       .addValue(mEncodedBytesInCycle, "bytes_in_cycle")
+                       .addValue(mEncodingTimeInCycle, "encoding_time"));
+    mEncodedBytesInCycle = 0;
+    mEncodingTimeInCycle = 0;
+  }
 }
 
 int TaskRunner::publish(DataAllocator& outputs)
@@ -492,21 +573,90 @@ int TaskRunner::publish(DataAllocator& outputs)
   auto concreteOutput = framework::DataSpecUtils::asConcreteDataMatcher(mTaskConfig.moSpec);
   // getNonOwningArray creates a TObjArray containing the monitoring objects, but not
   // owning them. The array is created by new and must be cleaned up by the caller
-  std::unique_ptr<MonitorObjectCollection> array(mObjectsManager->getNonOwningArray());
+  std::unique_ptr<MonitorObjectCollection> array;
+  size_t objectsUnchanged = 0;
+  if (mTaskConfig.skipUnchangedObjects) {
+    // The cycles of the Mergers are not synchronized with ours, we send two full publications to tolerate a shift of one cycle.
+    if (mTaskConfig.fullPublicationPeriod > 0 && mCycleNumber % mTaskConfig.fullPublicationPeriod <= 1) {
+      mObjectsManager->forceFullPublication();
+    }
+    // When the objects are reset after each cycle, they are deltas which are merged downstream,
+    // so only the ones which are still empty can be safely replaced with markers.
+    array.reset(mObjectsManager->getNonOwningArrayOfChangedObjects(mTaskConfig.resetAfterCycles == 1, objectsUnchanged));
+  } else {
+    array.reset(mObjectsManager->getNonOwningArray());
+  }
   array->addOrUpdateMetadata(repository::metadata_keys::cycleNumber, std::to_string(mCycleNumber));
-  int objectsPublished = array->GetEntries();
+  if (mTaskConfig.serializationAccounting) {
+    accountSerialization(*array);
+  }
+  int objectsPublished = array->GetEntries() - objectsUnchanged;
+
+  std::unique_ptr<MonitorObjectCollection> encoded;
+  if (mTaskConfig.transportEncoding.isEnabled()) {
+    AliceO2::Common::Timer encodingTimer;
+    encoded = array->encode(mTaskConfig.transportEncoding);
+    mEncodingTimeInCycle += encodingTimer.getTime();
+    mEncodedBytesInCycle += encoded->getEncodedBytes();
+  }
 
   outputs.snapshot(
     Output{ concreteOutput.origin,
             concreteOutput.description,
             concreteOutput.subSpec },
-    *array);
+    encoded ? *encoded : *array);
 
   mLastPublicationDuration = publicationDurationTimer.getTime();
   mObjectsManager->stopPublishing(PublicationPolicy::Once);
   return objectsPublished;
 }
 
+void TaskRunner::accountSerialization(MonitorObjectCollection& array)
+{
+  auto costs = ObjectsManager::measureSerialization(array);
+  size_t totalBytes = 0;
+  for (const auto& cost : costs) {
+    totalBytes += cost.bytes;
+    mSerializationTimeInCycle += cost.seconds;
+    mLargestObjectInCycle = std::max<uint64_t>(mLargestObjectInCycle, cost.bytes);
+  }
+
+  const auto budget = mTaskConfig.publicationBudgetBytes;
+  if (budget > 0 && totalBytes > budget) {
+    auto biggest = costs;
+    std::sort(biggest.begin(), biggest.end(), [](const auto& a, const auto& b) { return a.bytes > b.bytes; });
+    std::ostringstream list;
+    for (size_t i = 0; i < std::min<size_t>(biggest.size(), 5); i++) {
+      list << (i > 0 ? ", " : "") << biggest[i].object->GetName() << " (" << biggest[i].bytes << " B)";
+    }
+    ILOG(Warning, Support) << "The publication of the cycle " << mCycleNumber << " takes " << totalBytes
+                           << " bytes, over the budget of " << budget << " bytes. The biggest objects: " << list.str() << ENDM;
+
+    if (mTaskConfig.dropObjectsOverBudget) {
+      auto dropped = mObjectsManager->enforceBudget(array, costs, budget);
+      for (const auto* mo : dropped) {
+        ILOG(Warning, Support) << "Not publishing the low priority object " << mo->GetName() << " in the cycle " << mCycleNumber << ENDM;
+      }
+      mObjectsDroppedInCycle += dropped.size();
+      totalBytes = 0;
+      for (const auto& cost : costs) {
+        totalBytes += cost.bytes;
+      }
+    }
+  }
+  mSerializedBytesInCycle += totalBytes;
+}
+
+std::string TaskRunner::getTraceFilePath() const
+{
+  // parallel tasks would overwrite each other's trace
+  std::filesystem::path path = mTaskConfig.profilingTraceFile;
+  if (path.empty() || mTaskConfig.parallelTaskID == 0) {
+    return path;
+  }
+  return path.replace_filename(path.stem().string() + "_" + std::to_string(mTaskConfig.parallelTaskID) + path.extension().string());
+}
+
 void TaskRunner::saveToFile()
 {
   if (!mTaskConfig.saveToFile.empty()) {
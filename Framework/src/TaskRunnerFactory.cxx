@@ -37,6 +37,8 @@
 
 #include <Framework/TimerParamSpec.h>
 
+#include <algorithm>
+
 namespace o2::quality_control::core
 {
 
@@ -170,6 +172,37 @@ TaskRunnerConfig TaskRunnerFactory::extractConfig(const CommonSpec& globalConfig
 
   o2::globaltracking::RecoContainer rd;
 
+  // Mergers in the "entire" mode keep only the latest object from each producer, thus a marker would replace the actual content.
+  bool skipUnchangedObjects = taskSpec.skipUnchangedObjects;
+  if (skipUnchangedObjects && taskSpec.location == TaskLocationSpec::Local && taskSpec.mergingMode == "entire") {
+    ILOG(Warning, Support) << "skipUnchangedObjects is not supported for local tasks with the 'entire' merging mode, disabling it for the task '"
+                           << taskSpec.taskName << "'" << ENDM;
+    skipUnchangedObjects = false;
+  }
+  if (taskSpec.dropObjectsOverBudget && (taskSpec.publicationBudgetBytes == 0 || taskSpec.lowPriorityObjects.empty())) {
+    ILOG(Warning, Support) << "dropObjectsOverBudget has no effect for the task '" << taskSpec.taskName
+                           << "' without a publicationBudgetBytes and a list of lowPriorityObjects" << ENDM;
+  }
+
+  // Delta Mergers drop their objects when they reset, they should receive full objects in the following cycle,
+  // because they cannot merge markers for objects they do not hold.
+  size_t fullPublicationPeriod = 0;
+  if (skipUnchangedObjects && taskSpec.location == TaskLocationSpec::Local && taskSpec.mergingMode == "delta") {
+    fullPublicationPeriod = taskSpec.resetAfterCycles * static_cast<size_t>(std::max(taskSpec.mergerCycleMultiplier, 1));
+  }
+
+  MonitorObjectCollection::Encoding transportEncoding{
+    MonitorObjectCollection::Encoding::compressionFromString(taskSpec.transportCompression),
+    taskSpec.transportCompressionLevel,
+    taskSpec.transportSparseOccupancy
+  };
+  if (transportEncoding.level < 1 || transportEncoding.level > 9) {
+    throw std::runtime_error("The transport compression level of the task '" + taskSpec.taskName + "' should be between 1 and 9.");
+  }
+  if (transportEncoding.sparseOccupancy < 0 || transportEncoding.sparseOccupancy > 1) {
+    throw std::runtime_error("The transport sparse occupancy of the task '" + taskSpec.taskName + "' should be between 0 and 1.");
+  }
+
   return {
     taskSpec.taskName,
     taskSpec.moduleName,
@@ -198,6 +231,15 @@ TaskRunnerConfig TaskRunnerFactory::extractConfig(const CommonSpec& globalConfig
     globalTrackingDataRequest,
     taskSpec.movingWindows,
     taskSpec.disableLastCycle,
+    skipUnchangedObjects,
+    taskSpec.profiling || !taskSpec.profilingTraceFile.empty(),
+    taskSpec.profilingTraceFile,
+    taskSpec.serializationAccounting || taskSpec.publicationBudgetBytes > 0,
+    taskSpec.publicationBudgetBytes,
+    taskSpec.dropObjectsOverBudget,
+    taskSpec.lowPriorityObjects,
+    transportEncoding,
+    fullPublicationPeriod,
   };
 }
 
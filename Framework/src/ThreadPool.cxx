@@ -0,0 +1,71 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   ThreadPool.cxx
+///
+
+#include "QualityControl/ThreadPool.h"
+
+#include <algorithm>
+
+namespace o2::quality_control::core
+{
+
+ThreadPool::ThreadPool(size_t nThreads)
+{
+  nThreads = std::max<size_t>(nThreads, 1);
+  for (size_t i = 0; i < nThreads; i++) {
+    mWorkers.emplace_back(&ThreadPool::workerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStopping = true;
+  }
+  mTaskAvailable.notify_all();
+  for (auto& worker : mWorkers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+void ThreadPool::enqueue(std::function<void()>&& task)
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mTasks.push_back(std::move(task));
+  }
+  mTaskAvailable.notify_one();
+}
+
+void ThreadPool::workerLoop()
+{
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mTaskAvailable.wait(lock, [this] { return !mTasks.empty() || mStopping; });
+      if (mTasks.empty()) { // thus we are stopping
+        break;
+      }
+      task = std::move(mTasks.front());
+      mTasks.pop_front();
+    }
+    task();
+  }
+}
+
+} // namespace o2::quality_control::core
@@ -22,8 +22,11 @@
 #include "QualityControl/RootClassFactory.h"
 #include "QualityControl/RepoPathUtils.h"
 #include "QualityControl/ActivityHelpers.h"
+#include "QualityControl/DownsampledTrend.h"
 
 #include <TH1.h>
+#include <TH2F.h>
+#include <THLimitsFinder.h>
 #include <TCanvas.h>
 #include <TPaveText.h>
 #include <TGraphErrors.h>
@@ -31,7 +34,12 @@
 #include <TStyle.h>
 #include <TLegend.h>
 
+#include <TROOT.h>
+
 #include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <cctype>
+#include <optional>
 #include <set>
 
 using namespace o2::quality_control;
@@ -43,6 +51,7 @@ void TrendingTask::configure(const boost::property_tree::ptree& config)
   // we clear any existing objects, which would be there only in case of reconfiguration
   // at the time of writing, this not even supported by ECS
   mReductors.clear();
+  mSourceRevisions.clear();
   mTrend.reset();
 
   // configuration
@@ -50,6 +59,13 @@ void TrendingTask::configure(const boost::property_tree::ptree& config)
   for (const auto& source : mConfig.dataSources) {
     auto&& [emplaced, _] = mReductors.emplace(source.name, root_class_factory::create<Reductor>(source.moduleName, source.reductorName));
     emplaced->second->setCustomConfig(source.reductorParameters);
+    mSourceRevisions[source.name] = 0;
+  }
+  if (mConfig.renderPlotsInBackground) {
+    ROOT::EnableThreadSafety();
+    mPlotRenderer = std::make_unique<core::ThreadPool>(1);
+  } else {
+    mPlotRenderer.reset();
   }
 }
 
@@ -91,6 +107,7 @@ bool TrendingTask::canContinueTrend(TTree* tree)
 
 void TrendingTask::initializeTrend(o2::quality_control::repository::DatabaseInterface& qcdb)
 {
+  mEntriesAfterDownsampling = 0;
   // tree exists and we can reuse it
   if (canContinueTrend(mTrend.get())) {
     if (mConfig.resumeTrend == false) {
@@ -179,9 +196,17 @@ void TrendingTask::applyStyleToGraph(TGraph* graph, const TrendingTaskConfig::Gr
 void TrendingTask::initialize(Trigger, framework::ServiceRegistryRef services)
 {
   // removing leftovers from any previous runs
+  if (mRenderedPlots.valid()) {
+    mRenderedPlots.wait();
+    mRenderedPlots = {};
+  }
   mPlots.clear();
+  mDrawnPlotRevisions.clear();
+  mFilledEntries = 0;
 
   initializeTrend(services.get<repository::DatabaseInterface>());
+  mColumns.readFrom(*mTrend);
+  mObjectFetcher = std::make_unique<ObjectFetcher>(mConfig.fetchParallelism, mConfig.repository);
 
   if (mConfig.producePlotsOnUpdate) {
     getObjectsManager()->startPublishing(mTrend.get(), PublicationPolicy::ThroughStop);
@@ -194,8 +219,14 @@ void TrendingTask::update(Trigger t, framework::ServiceRegistryRef services)
   auto& qcdb = services.get<repository::DatabaseInterface>();
 
   const auto allSourcesInvoked = trendValues(t, qcdb);
+  collectRenderedPlots(false);
   if (mConfig.producePlotsOnUpdate && (!mConfig.trendIfAllInputs || allSourcesInvoked)) {
-    generatePlots();
+    if (mRenderedPlots.valid()) {
+      // the renderer is still busy, the changed plots will be generated at the next update
+      ILOG(Debug, Devel) << "The previous plots are still being generated, skipping this update." << ENDM;
+    } else {
+      generatePlots(true);
+    }
   }
 }
 
@@ -204,7 +235,11 @@ void TrendingTask::finalize(Trigger, framework::ServiceRegistryRef)
   if (!mConfig.producePlotsOnUpdate) {
     getObjectsManager()->startPublishing(mTrend.get());
   }
+  collectRenderedPlots(true);
+  // at the end we draw all the plots synchronously, so they are all published in this cycle
+  auto renderer = std::move(mPlotRenderer);
   generatePlots();
+  mPlotRenderer = std::move(renderer);
 }
 
 bool TrendingTask::trendValues(const Trigger& t, repository::DatabaseInterface& qcdb)
@@ -221,8 +256,13 @@ bool TrendingTask::trendValues(const Trigger& t, repository::DatabaseInterface&
   std::snprintf(mMetaData.runNumberStr, MaxRunNumberStringLength + 1, "%d", t.activity.mId);
 
   bool wereAllSourcesInvoked = true;
-  for (auto& dataSource : mConfig.dataSources) {
-    if (!reductor_helpers::updateReductor(mReductors[dataSource.name].get(), t, dataSource, qcdb, *this)) {
+  auto getReductor = [this](const TrendingTaskConfig::DataSource& dataSource) { return mReductors[dataSource.name].get(); };
+  auto updated = reductor_helpers::updateReductors(mConfig.dataSources, getReductor, t, qcdb, *this, *mObjectFetcher);
+  for (size_t i = 0; i < mConfig.dataSources.size(); i++) {
+    if (updated[i]) {
+      mSourceRevisions[mConfig.dataSources[i].name]++;
+    } else {
+      const auto& dataSource = mConfig.dataSources[i];
       wereAllSourcesInvoked = false;
       ILOG(Error, Support) << "Failed to update reductor for data sources with path '" << dataSource.path
                            << "', name '" << dataSource.name
@@ -232,11 +272,50 @@ bool TrendingTask::trendValues(const Trigger& t, repository::DatabaseInterface&
 
   if (!mConfig.trendIfAllInputs || wereAllSourcesInvoked) {
     mTrend->Fill();
+    mFilledEntries++;
+    mColumns.appendCurrent(*mTrend);
+    downsampleTrend();
   }
 
   return wereAllSourcesInvoked;
 }
 
+void TrendingTask::downsampleTrend()
+{
+  // We select the entries to keep once per capacity new entries, so the cost is amortized,
+  // while the size of the trend stays proportional to the capacity.
+  const auto capacity = static_cast<Long64_t>(mConfig.trendCapacity);
+  const auto entries = mTrend->GetEntries();
+  if (capacity == 0 || entries <= capacity || entries < mEntriesAfterDownsampling + capacity) {
+    return;
+  }
+
+  std::vector<double> times(entries);
+  auto* timeBranch = mTrend->GetBranch("time");
+  for (Long64_t i = 0; i < entries; i++) {
+    timeBranch->GetEntry(i);
+    times[i] = mTime;
+  }
+  auto selected = DownsampledTrend::selectSamples(times, mConfig.trendCapacity, mConfig.trendTiers, mConfig.trendDownsamplingFactor);
+
+  // The selected entries are copied aside and filled back, so that the TTree object, which may be already
+  // published, stays the same. The clone shares the branch addresses with the trend.
+  std::unique_ptr<TTree> kept(mTrend->CloneTree(0));
+  for (auto entry : selected) {
+    mTrend->GetEntry(entry);
+    kept->Fill();
+  }
+  mTrend->Reset();
+  for (Long64_t i = 0; i < kept->GetEntries(); i++) {
+    kept->GetEntry(i);
+    mTrend->Fill();
+  }
+  // the newest entry is always selected, thus it is the one left in the branch buffers
+  mEntriesAfterDownsampling = mTrend->GetEntries();
+  mColumns.readFrom(*mTrend);
+  ILOG(Debug, Devel) << "Downsampled the trend from " << entries << " to " << mEntriesAfterDownsampling << " entries" << ENDM;
+}
+
 void TrendingTask::setUserAxesLabels(TAxis* xAxis, TAxis* yAxis, const std::string& graphAxesLabels)
 {
   // todo if we keep adding this method to pp classes we should move it up somewhere
@@ -282,7 +361,70 @@ void TrendingTask::formatTimeXAxis(TH1* background)
   background->GetXaxis()->SetTimeFormat("%Y-%m-%d %H:%M");
 }
 
-void TrendingTask::generatePlots()
+bool TrendingTask::referencesName(const std::string& expression, const std::string& name)
+{
+  auto isIdentifierChar = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; };
+  for (auto pos = expression.find(name); pos != std::string::npos; pos = expression.find(name, pos + 1)) {
+    auto end = pos + name.size();
+    if ((pos == 0 || !isIdentifierChar(expression[pos - 1])) && (end == expression.size() || !isIdentifierChar(expression[end]))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint64_t TrendingTask::getPlotRevision(const TrendingTaskConfig::Plot& plotConfig) const
+{
+  // Revisions of data sources and the number of filled entries only grow, so their sum changes whenever any of them
+  // does. Each new entry adds a point to all the plots, also when some of their sources could not be updated.
+  // The number of entries of the trend is not used, since it is reduced by the downsampling.
+  uint64_t revision = mFilledEntries;
+  for (const auto& [sourceName, sourceRevision] : mSourceRevisions) {
+    for (const auto& graph : plotConfig.graphs) {
+      if (referencesName(graph.varexp, sourceName) || referencesName(graph.selection, sourceName) || referencesName(graph.errors, sourceName)) {
+        revision += sourceRevision;
+        break;
+      }
+    }
+  }
+  return revision;
+}
+
+void TrendingTask::publishPlot(TCanvas* canvas)
+{
+  // Before we publish any new plots, we have to delete existing under the same names.
+  // It seems that ROOT cannot handle an existence of two canvases with a common name in the same process.
+  std::string name = canvas->GetName();
+  mPlots[name].reset(canvas);
+  getObjectsManager()->startPublishing(canvas, PublicationPolicy::Once);
+}
+
+void TrendingTask::collectRenderedPlots(bool wait)
+{
+  if (!mRenderedPlots.valid()) {
+    return;
+  }
+  if (!wait && mRenderedPlots.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    return;
+  }
+  try {
+    for (auto& [name, revision, canvas] : mRenderedPlots.get()) {
+      // The canvases were drawn under temporary names. The previous canvas is deleted before the new one takes its name,
+      // because ROOT cannot handle two canvases with a common name in the same process.
+      if (auto previous = mPlots.find(name); previous != mPlots.end()) {
+        previous->second.reset();
+      }
+      canvas->SetName(name.c_str());
+      publishPlot(canvas.release());
+      // only the plots which were rendered are considered up-to-date, the others are generated again at the next update
+      mDrawnPlotRevisions[name] = revision;
+    }
+  } catch (const std::exception& ex) {
+    ILOG(Error, Support) << "Failed to generate the plots in the background: " << ex.what() << ENDM;
+  }
+}
+
+void TrendingTask::generatePlots(bool onlyChanged)
 {
   if (mTrend == nullptr) {
     ILOG(Info, Support) << "The trend object is not there, won't generate any plots." << ENDM;
@@ -294,18 +436,71 @@ void TrendingTask::generatePlots()
     return;
   }
 
-  ILOG(Info, Support) << "Generating " << mConfig.plots.size() << " plots." << ENDM;
+  std::vector<TrendingTaskConfig::Plot> plots;
   for (const auto& plotConfig : mConfig.plots) {
+    auto drawnRevision = mDrawnPlotRevisions.find(plotConfig.name);
+    if (onlyChanged && drawnRevision != mDrawnPlotRevisions.end() && drawnRevision->second == getPlotRevision(plotConfig)) {
+      continue;
+    }
+    plots.push_back(plotConfig);
+  }
+  if (plots.empty()) {
+    ILOG(Debug, Devel) << "None of the plots' inputs changed, won't generate any plots." << ENDM;
+    return;
+  }
 
+  auto drawNow = [this](const TrendingTaskConfig::Plot& plotConfig) {
     // Before we generate any new plots, we have to delete existing under the same names.
     // It seems that ROOT cannot handle an existence of two canvases with a common name in the same process.
     if (mPlots.count(plotConfig.name)) {
       mPlots[plotConfig.name].reset();
     }
-    auto c = drawPlot(plotConfig);
-    mPlots[plotConfig.name].reset(c);
-    getObjectsManager()->startPublishing(c, PublicationPolicy::Once);
+    selectPalette(plotConfig);
+    publishPlot(drawPlot(*mTrend, &mColumns, plotConfig));
+    mDrawnPlotRevisions[plotConfig.name] = getPlotRevision(plotConfig);
+  };
+
+  if (mPlotRenderer == nullptr) {
+    ILOG(Info, Support) << "Generating " << plots.size() << " plots." << ENDM;
+    for (const auto& plotConfig : plots) {
+      drawNow(plotConfig);
+    }
+    return;
+  }
+
+  // The palette is a global setting of ROOT, which must not be modified by the renderer thread.
+  // The plots with their own palette are thus drawn right away, the others in the background with the default one.
+  std::vector<TrendingTaskConfig::Plot> backgroundPlots;
+  for (auto& plotConfig : plots) {
+    if (plotConfig.colorPalette != 0) {
+      drawNow(plotConfig);
+    } else {
+      backgroundPlots.push_back(std::move(plotConfig));
+    }
+  }
+  gStyle->SetPalette();
+  if (backgroundPlots.empty()) {
+    return;
   }
+
+  // The plots are drawn by the renderer thread out of a copy of the trend, so that the trend can be updated
+  // in the meantime. The canvases are created under temporary names, so they do not replace the published ones
+  // before they are collected by collectRenderedPlots().
+  ILOG(Info, Support) << "Generating " << backgroundPlots.size() << " plots in the background." << ENDM;
+  std::unique_ptr<TTree> snapshot(dynamic_cast<TTree*>(mTrend->Clone()));
+  snapshot->SetDirectory(nullptr);
+  auto canvasPrefix = PostProcessingInterface::getName() + "_rendering_";
+  std::vector<uint64_t> revisions;
+  for (const auto& plotConfig : backgroundPlots) {
+    revisions.push_back(getPlotRevision(plotConfig));
+  }
+  mRenderedPlots = mPlotRenderer->submit([this, snapshot = std::move(snapshot), columns = mColumns, plots = std::move(backgroundPlots), revisions = std::move(revisions), canvasPrefix]() {
+    std::vector<RenderedPlot> rendered;
+    for (size_t i = 0; i < plots.size(); i++) {
+      rendered.push_back({ plots[i].name, revisions[i], std::unique_ptr<TCanvas>(drawPlot(*snapshot, &columns, plots[i], canvasPrefix + plots[i].name)) });
+    }
+    return rendered;
+  });
 }
 
 std::string TrendingTask::deduceGraphLegendOptions(const TrendingTaskConfig::Graph& graphConfig)
@@ -341,9 +536,63 @@ std::string TrendingTask::deduceGraphLegendOptions(const TrendingTaskConfig::Gra
   return out;
 }
 
-TCanvas* TrendingTask::drawPlot(const TrendingTaskConfig::Plot& plotConfig)
+bool TrendingTask::isGraphOption(const std::string& option)
+{
+  auto graphOption = boost::algorithm::to_lower_copy(option);
+  for (const auto& toRemove : { "same", "pmc", "plc", "pfc", " " }) {
+    boost::algorithm::erase_all(graphOption, toRemove);
+  }
+  // these are the options for which TTree::Draw produces a TGraph, which we can draw ourselves
+  return !graphOption.empty() && graphOption.find_first_not_of("lpc*") == std::string::npos;
+}
+
+void TrendingTask::drawSeries(TTree& trend, const ColumnarTrend::Series& series, const std::string& varexp, const std::string& option, bool firstGraphInPlot)
+{
+  // We reproduce what TTree::Draw does for graphs: a histogram called "htemp" is used to draw the axes and
+  // the title, while the points are drawn with a TGraph called "Graph", which has the attributes of the tree.
+  const auto nPoints = static_cast<Int_t>(series.x.size());
+  if (firstGraphInPlot) {
+    auto [xMin, xMax] = std::minmax_element(series.x.begin(), series.x.end());
+    auto [yMin, yMax] = std::minmax_element(series.y.begin(), series.y.end());
+    auto* htemp = new TH2F("htemp", varexp.c_str(), 40, 0, 1, 40, 0, 1);
+    htemp->SetDirectory(nullptr);
+    htemp->SetBit(TObject::kCanDelete);
+    htemp->SetStats(false);
+    if (nPoints > 0) {
+      THLimitsFinder::GetLimitsFinder()->FindGoodLimits(htemp, *xMin, *xMax == *xMin ? *xMin + 1 : *xMax, *yMin, *yMax == *yMin ? *yMin + 1 : *yMax);
+    }
+    htemp->Draw();
+  }
+
+  auto* graph = new TGraph(nPoints, series.x.data(), series.y.data());
+  graph->SetName("Graph");
+  graph->SetTitle(varexp.c_str());
+  graph->SetEditable(false);
+  graph->SetBit(TObject::kCanDelete);
+  trend.TAttLine::Copy(*graph);
+  trend.TAttFill::Copy(*graph);
+  trend.TAttMarker::Copy(*graph);
+  // "same" is not a graph option and its "a" would be understood as "draw the axes"
+  auto graphOption = option;
+  boost::algorithm::ierase_all(graphOption, "same");
+  graph->Draw(graphOption.c_str());
+}
+
+void TrendingTask::selectPalette(const TrendingTaskConfig::Plot& plotConfig)
+{
+  // Keep palette behavior unless user forces explicit colors via per-graph style
+  if (plotConfig.colorPalette != 0) {
+    gStyle->SetPalette(plotConfig.colorPalette);
+    // This makes ROOT store the selected palette for each generated plot.
+    // TColor::DefinedColors(1); // TODO enable when available
+  } else {
+    gStyle->SetPalette(); // default
+  }
+}
+
+TCanvas* TrendingTask::drawPlot(TTree& trend, const ColumnarTrend* columns, const TrendingTaskConfig::Plot& plotConfig, const std::string& canvasName)
 {
-  auto* c = new TCanvas();
+  auto* c = canvasName.empty() ? new TCanvas() : new TCanvas(canvasName.c_str(), plotConfig.title.c_str());
 
   // Legend
   TLegend* legend = nullptr;
@@ -362,15 +611,6 @@ TCanvas* TrendingTask::drawPlot(const TrendingTaskConfig::Plot& plotConfig)
   legend->SetTextSize(0.03);
   legend->SetMargin(0.15);
 
-  // Keep palette behavior unless user forces explicit colors via per-graph style
-  if (plotConfig.colorPalette != 0) {
-    gStyle->SetPalette(plotConfig.colorPalette);
-    // This makes ROOT store the selected palette for each generated plot.
-    // TColor::DefinedColors(1); // TODO enable when available
-  } else {
-    gStyle->SetPalette(); // default
-  }
-
   // regardless whether we draw a graph or a histogram, a histogram is always used by TTree::Draw to draw axes and title
   // we attempt to keep it to do some modifications later
   TH1* background = nullptr;
@@ -383,8 +623,13 @@ TCanvas* TrendingTask::drawPlot(const TrendingTaskConfig::Plot& plotConfig)
     // having "SAME" at the first TTree::Draw() call will not work, we have to add it only in subsequent Draw calls
     std::string option = firstGraphInPlot ? graphConfig.option : "SAME " + graphConfig.option;
 
-    // Draw main series
-    mTrend->Draw(graphConfig.varexp.c_str(), graphConfig.selection.c_str(), option.c_str());
+    // Draw main series. Simple expressions are taken from the columns, instead of evaluating TTree formulas.
+    auto series = columns && isGraphOption(option) ? columns->evaluate(graphConfig.varexp, graphConfig.selection) : std::nullopt;
+    if (series.has_value()) {
+      drawSeries(trend, *series, graphConfig.varexp, option, firstGraphInPlot);
+    } else {
+      trend.Draw(graphConfig.varexp.c_str(), graphConfig.selection.c_str(), option.c_str());
+    }
 
     // For graphs, we allow to draw errors if they are specified.
     TGraphErrors* graphErrors = nullptr;
@@ -394,9 +639,9 @@ TCanvas* TrendingTask::drawPlot(const TrendingTaskConfig::Plot& plotConfig)
       } else {
         // We generate some 4-D points, where 2 dimensions represent graph points and 2 others are the error bars
         std::string varexpWithErrors(graphConfig.varexp + ":" + graphConfig.errors);
-        mTrend->Draw(varexpWithErrors.c_str(), graphConfig.selection.c_str(), "goff");
-        graphErrors = new TGraphErrors(mTrend->GetSelectedRows(), mTrend->GetVal(1), mTrend->GetVal(0),
-                                       mTrend->GetVal(2), mTrend->GetVal(3));
+        trend.Draw(varexpWithErrors.c_str(), graphConfig.selection.c_str(), "goff");
+        graphErrors = new TGraphErrors(trend.GetSelectedRows(), trend.GetVal(1), trend.GetVal(0),
+                                       trend.GetVal(2), trend.GetVal(3));
         graphErrors->SetName((graphConfig.name + "_errors").c_str());
         graphErrors->SetTitle((graphConfig.title + " errors").c_str());
         // We draw on the same plotConfig as the main graphConfig, but only error bars
@@ -443,7 +688,10 @@ TCanvas* TrendingTask::drawPlot(const TrendingTaskConfig::Plot& plotConfig)
     firstGraphInPlot = false;
   }
 
-  c->SetName(plotConfig.name.c_str());
+  // a canvas drawn in the background keeps its temporary name until it is collected
+  if (canvasName.empty()) {
+    c->SetName(plotConfig.name.c_str());
+  }
   c->SetTitle(plotConfig.title.c_str());
 
   // Postprocessing the plotConfig - adding specified titles, configuring time-based plots, flushing buffers.
@@ -26,7 +26,12 @@ TrendingTaskConfig::TrendingTaskConfig(std::string id, const boost::property_tre
   producePlotsOnUpdate = config.get<bool>("qc.postprocessing." + id + ".producePlotsOnUpdate", true);
   resumeTrend = config.get<bool>("qc.postprocessing." + id + ".resumeTrend", false);
   trendIfAllInputs = config.get<bool>("qc.postprocessing." + id + ".trendIfAllInputs", false);
+  renderPlotsInBackground = config.get<bool>("qc.postprocessing." + id + ".renderPlotsInBackground", false);
   trendingTimestamp = config.get<std::string>("qc.postprocessing." + id + ".trendingTimestamp", "validUntil");
+  fetchParallelism = config.get<size_t>("qc.postprocessing." + id + ".fetchParallelism", 1);
+  trendCapacity = config.get<size_t>("qc.postprocessing." + id + ".trendCapacity", 0);
+  trendTiers = config.get<size_t>("qc.postprocessing." + id + ".trendTiers", 3);
+  trendDownsamplingFactor = config.get<size_t>("qc.postprocessing." + id + ".trendDownsamplingFactor", 10);
 
   for (const auto& [_, plotConfig] : config.get_child("qc.postprocessing." + id + ".plots")) {
     // since QC-1155 we allow for more than one graph in a single plot (canvas). we support both the new and old ways
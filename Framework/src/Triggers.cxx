@@ -20,12 +20,18 @@
 #include "QualityControl/CcdbDatabase.h"
 #include "QualityControl/ObjectMetadataKeys.h"
 #include "QualityControl/KafkaPoller.h"
+#include "QualityControl/ListingWatcher.h"
+#include "QualityControl/RepoPathUtils.h"
 
 #include <CCDB/CcdbApi.h>
 #include <Common/Timer.h>
 #include <chrono>
 #include <ostream>
+#include <optional>
+#include <thread>
 #include <tuple>
+#include <vector>
+#include <boost/algorithm/string.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
 
@@ -189,6 +195,58 @@ TriggerFcn Periodic(double seconds, const Activity& activity, std::string config
   };
 }
 
+// How long a NewObject trigger waits for the cycle manifest of a new object before triggering anyway
+constexpr auto newObjectManifestTimeout = std::chrono::seconds{ 30 };
+
+// Returns the path to the cycle manifest of the task which produced the object, if it is a MonitorObject of a QC task.
+std::string cycleManifestPath(const std::string& databaseType, const std::string& objectPath, const std::string& provenance)
+{
+  // <detector>/MO/<task>/<object>
+  std::vector<std::string> parts;
+  boost::split(parts, objectPath, boost::is_any_of("/"));
+  if (databaseType != "qcdb" || parts.size() < 4 || parts[1] != "MO") {
+    return {};
+  }
+  return RepoPathUtils::getMoPath(parts[0], parts[2], RepoPathUtils::cycleManifestName, provenance);
+}
+
+// Tells whether all the objects published together with the new version of the object are available.
+bool isCollectionComplete(ListingWatcher& watcher, ListingWatcher::SubscriptionId* manifestSubscription,
+                          const ListingWatcher::ObjectVersion& version, steady_clock::time_point pendingSince)
+{
+  // The manifest of a cycle is stored after all its objects, so it is at least as recent.
+  auto manifestIsAfterObject = [&]() {
+    auto manifest = watcher.getLatest(*manifestSubscription);
+    return manifest.has_value() && manifest->lastModified >= version.lastModified;
+  };
+
+  if (manifestSubscription == nullptr || !watcher.getLatest(*manifestSubscription).has_value()) {
+    // No manifest is stored for these objects, e.g. they do not come from a QC task or the QCDB is fed by an older
+    // CheckRunner. On rare occasions we might run into the following race condition:
+    // 1) A CheckRunner starts to publish a collection of MOs for a QC Task
+    // 2) A PostProcessing task receives a newobject trigger for a just-published object
+    // 3) The PP task tries to retrieve also other objects normally published by the same QC task, it fails
+    //    because not all were published yet.
+    // 4) The CheckRunner finishes publishing the collection of MOs
+    // To avoid this scenario, a small delay is added before returning the trigger.
+    if (getenv("QC_DISABLE_NEWOBJECT_DELAY") == nullptr) {
+      std::this_thread::sleep_for(std::chrono::seconds{ 1 });
+    }
+    return true;
+  }
+  if (manifestIsAfterObject()) {
+    return true;
+  }
+  // The manifest is usually stored within milliseconds after the objects. We do not wait for it here,
+  // the version stays pending and the manifest is checked again at the next call.
+  if (steady_clock::now() - pendingSince > newObjectManifestTimeout) {
+    ILOG(Warning, Support) << "The cycle manifest of the new version of '" << version.path << "' did not appear after "
+                           << duration_cast<seconds>(newObjectManifestTimeout).count() << "s, triggering anyway" << ENDM;
+    return true;
+  }
+  return false;
+}
+
 TriggerFcn NewObject(const std::string& databaseUrl, const std::string& databaseType, const std::string& objectPath, const Activity& activity, const std::string& config)
 {
   // Key names in the header map.
@@ -198,52 +256,32 @@ TriggerFcn NewObject(const std::string& databaseUrl, const std::string& database
   auto objectActivity = activity;
 
   ILOG(Debug, Support) << "Initializing newObject trigger for the object '" << fullObjectPath << "' and Activity '" << activity << "'" << ENDM;
-  // We support only CCDB here.
-  auto db = std::make_shared<repository::CcdbDatabase>();
-  db->connect(databaseUrl, "", "", "");
-
-  // Returns "Valid-From" of an object if there is a new one, otherwise 0.
-  auto newObjectValidity = [db, fullObjectPath, metadata, databaseUrl, activity, lastModified = validity_time_t{ 0 }]() mutable -> ValidityInterval {
-    const auto listing = db->getListingAsPtree(fullObjectPath, metadata, true);
-    if (listing.count("objects") == 0) {
-      ILOG(Warning, Support) << "Could not get a valid listing from db '" << databaseUrl << "' for object '" << fullObjectPath << "'" << ENDM;
-      return gInvalidValidityInterval;
-    }
-    const auto& objects = listing.get_child("objects");
-    if (objects.empty()) {
-      // We don't make a fuss over it, because we might be just waiting for the first version of such object.
-      // Apparently it happens always for a few iterations at SOR, so Warnings might be too annoying.
-      ILOG(Debug, Devel) << "Could not find the file '" << fullObjectPath << "' in the db '"
-                         << databaseUrl << "' for given Activity settings (" << activity << "). Zeroes and empty strings are treated as wildcards." << ENDM;
-      return gInvalidValidityInterval;
-    } else if (objects.size() > 1) {
-      ILOG(Warning, Support) << "Expected just one metadata entry for object '" << fullObjectPath << "'. Trying to continue by using the first." << ENDM;
-    }
+  // All the NewObject triggers of the process which look at the same database share its listings.
+  // The object version which exists at subscription is not considered as new.
+  auto watcher = ListingWatcher::forDatabase(databaseUrl);
+  auto subscribe = [watcher](const std::string& path, const std::map<std::string, std::string>& metadata) {
+    return std::shared_ptr<ListingWatcher::SubscriptionId>(new ListingWatcher::SubscriptionId(watcher->subscribe(path, metadata)),
+                                                           [watcher](ListingWatcher::SubscriptionId* id) {
+                                                             watcher->unsubscribe(*id);
+                                                             delete id;
+                                                           });
+  };
+  auto subscription = subscribe(fullObjectPath, metadata);
+  // CheckRunners store a manifest in the folder of a task once all its objects of a cycle are stored.
+  std::shared_ptr<ListingWatcher::SubscriptionId> manifestSubscription;
+  if (auto manifestPath = cycleManifestPath(databaseType, objectPath, activity.mProvenance); !manifestPath.empty()) {
+    manifestSubscription = subscribe(manifestPath, metadata);
+  }
 
-    const auto& object = objects.front().second;
-    validity_time_t newLastModified = object.get<uint64_t>(metadata_keys::lastModified, 0);
-    if (newLastModified > lastModified) {
-      lastModified = newLastModified;
-      return { object.get<uint64_t>(metadata_keys::validFrom, 0), object.get<uint64_t>(metadata_keys::validUntil) };
+  return [objectActivity, config, watcher, subscription, manifestSubscription,
+          pending = std::optional<ListingWatcher::ObjectVersion>{}, pendingSince = steady_clock::time_point{}]() mutable -> Trigger {
+    if (auto version = watcher->poll(*subscription); version.has_value()) {
+      pending = version;
+      pendingSince = steady_clock::now();
     }
-    return gInvalidValidityInterval;
-  };
-  // we execute it once before in order to know about the latest existing object.
-  newObjectValidity();
-
-  return [objectActivity, config, newObjectValidity]() mutable -> Trigger {
-    if (auto validity = newObjectValidity(); validity.isValid()) {
-      if (getenv("QC_DISABLE_NEWOBJECT_DELAY") == nullptr) {
-        // On rare occasions we might run into the following race condition:
-        // 1) A CheckRunner starts to publish a collection of MOs for a QC Task
-        // 2) A PostProcessing task receives a newobject trigger for a just-published object
-        // 3) The PP task tries to retrieve also other objects normally published by the same QC task, it fails
-        //    because not all were published yet.
-        // 4) The CheckRunner finishes publishing the collection of MOs
-        // To avoid this scenario, a small delay is added before returning the trigger. Considerations about other
-        // possible solutions are included in the commit message.
-        std::this_thread::sleep_for(std::chrono::seconds{ 1 });
-      }
+    if (pending.has_value() && isCollectionComplete(*watcher, manifestSubscription.get(), *pending, pendingSince)) {
+      ValidityInterval validity{ pending->validFrom, pending->validUntil };
+      pending.reset();
       objectActivity.mValidity = validity;
       auto timestamp = activity_helpers::isLegacyValidity(validity) ? validity.getMin() : (validity.getMax() - 1);
       return { TriggerType::NewObject, false, objectActivity, timestamp, config };
@@ -48,7 +48,7 @@ void UserCodeInterface::setDatabase(std::unordered_map<std::string, std::string>
     throw std::invalid_argument("Cannot set database in UserCodeInterface");
   }
 
-  mDatabase = repository::DatabaseFactory::create(dbConfig.at("implementation"));
+  mDatabase = repository::DatabaseFactory::create(dbConfig);
   mDatabase->connect(dbConfig);
   ILOG(Debug, Devel) << "Database that is going to be used > Implementation : " << dbConfig.at("implementation") << " / Host : " << dbConfig.at("host") << ENDM;
 }
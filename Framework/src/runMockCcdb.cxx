@@ -0,0 +1,79 @@
+// Copyright 2019-2022 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    runMockCcdb.cxx
+///
+/// \brief Run a local mock of the CCDB, to use as the QCDB of a workflow when testing or benchmarking offline.
+///
+/// Example: o2-qc-mock-ccdb --port 8084 --storage-dir /tmp/qcdb --latency-ms 20 --error-rate 0.01
+/// and then use "http://127.0.0.1:8084" as the host of the database in the QC configuration.
+
+#include "QualityControl/MockCcdbServer.h"
+
+#include <csignal>
+#include <iostream>
+#include <thread>
+#include <boost/program_options.hpp>
+
+namespace bpo = boost::program_options;
+using namespace o2::quality_control::repository;
+
+namespace
+{
+volatile std::sig_atomic_t gStop = 0;
+}
+
+int main(int argc, const char* argv[])
+{
+  try {
+    bpo::options_description desc{ "Options" };
+    desc.add_options()("help,h", "Help screen")("port,p", bpo::value<uint16_t>()->default_value(8084), "Port to listen on, on the loopback interface (0 picks a free one)")("storage-dir,d", bpo::value<std::string>()->default_value(""), "Directory where to keep the objects, they are kept in memory if empty")("latency-ms", bpo::value<long>()->default_value(0), "Latency added to each response")("error-rate", bpo::value<double>()->default_value(0), "Fraction of the requests answered with \"503 Service Unavailable\"")("threads", bpo::value<size_t>()->default_value(4), "Number of threads serving the requests");
+
+    bpo::variables_map vm;
+    store(parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help")) {
+      std::cout << desc << std::endl;
+      return 0;
+    }
+    notify(vm);
+
+    MockCcdbServer::Options options;
+    options.port = vm["port"].as<uint16_t>();
+    options.storageDirectory = vm["storage-dir"].as<std::string>();
+    options.latency = std::chrono::milliseconds(vm["latency-ms"].as<long>());
+    options.errorRate = vm["error-rate"].as<double>();
+    options.threads = vm["threads"].as<size_t>();
+
+    MockCcdbServer server(options);
+    server.start();
+    std::cout << "Mock CCDB listening on " << server.getUrl() << " with " << server.getNumberOfObjects() << " objects, stop it with Ctrl-C" << std::endl;
+
+    std::signal(SIGINT, [](int) { gStop = 1; });
+    std::signal(SIGTERM, [](int) { gStop = 1; });
+    while (!gStop) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    server.stop();
+
+    auto statistics = server.getStatistics();
+    std::cout << "Requests: " << statistics.requests << ", stored objects: " << statistics.storedObjects
+              << " (" << statistics.storedBytes << " bytes), retrievals: " << statistics.retrievals
+              << ", listings: " << statistics.listings << ", injected errors: " << statistics.injectedErrors << std::endl;
+    return 0;
+  } catch (const bpo::error& ex) {
+    std::cerr << "Exception caught: " << ex.what() << std::endl;
+    return 1;
+  } catch (const std::exception& ex) {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+}
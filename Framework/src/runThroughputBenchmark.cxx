@@ -0,0 +1,576 @@
+// Copyright 2019-2022 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    runThroughputBenchmark.cxx
+///
+/// \brief Measures the throughput of a complete QC chain on the local machine, without any database or remote host.
+///
+/// For each combination of the parameters, the benchmark runs the following workflow for a given duration:
+///   o2-qc-run-producer -> TH1FTask -> Merger -> CheckRunner (AlwaysGoodCheck x N) -> Aggregator (WorstOfAll)
+/// The QCDB is replaced by a MockCcdbServer running in this process, which accepts and counts the uploads.
+/// The results are written to a JSON file: TF/s, percentiles of the durations of monitorData and of the publication
+/// (from the profiling metrics of the task), bytes stored in the QCDB and the peak resident memory of each device.
+///
+/// Example, from a directory where the configuration files and logs can be written:
+///   o2-qc-throughput-benchmark --producers 1 4 --payload-sizes 256 1048576 --checks 1 10 --duration 60 -o results.json
+
+#include "QualityControl/MockCcdbServer.h"
+
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+
+#include <boost/program_options.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace bpo = boost::program_options;
+namespace fs = std::filesystem;
+using boost::property_tree::ptree;
+using o2::quality_control::repository::MockCcdbServer;
+
+namespace
+{
+
+struct Point {
+  size_t producers;
+  size_t payloadSize;
+  size_t histograms;
+  size_t bins;
+  size_t checks;
+};
+
+struct Settings {
+  size_t cycleSeconds;
+  size_t durationSeconds;
+  size_t warmUpCycles;
+  double maxDataRate;
+  double maxMessageRate;
+  bool fill;
+  std::string qcArguments;
+  fs::path workDirectory;
+};
+
+struct Percentiles {
+  double p50 = 0;
+  double p90 = 0;
+  double p99 = 0;
+  double max = 0;
+};
+
+struct Result {
+  Point point;
+  size_t repetition = 0;
+  size_t cycles = 0;
+  double messagesPerSecond = 0;
+  double dataPerSecond = 0;
+  Percentiles monitorDataLatency; // per TF
+  Percentiles publishLatency;     // per cycle
+  MockCcdbServer::Statistics qcdb;
+  std::map<std::string, size_t> peakRssKB; // per device
+  size_t errors = 0;
+};
+
+Percentiles computePercentiles(std::vector<double> values)
+{
+  Percentiles result;
+  if (values.empty()) {
+    return result;
+  }
+  std::sort(values.begin(), values.end());
+  // nearest rank
+  auto rank = [&](double fraction) { return values[std::max<size_t>(1, std::ceil(fraction * values.size())) - 1]; };
+  result.p50 = rank(0.5);
+  result.p90 = rank(0.9);
+  result.p99 = rank(0.99);
+  result.max = values.back();
+  return result;
+}
+
+// The percentiles of a section with many calls per cycle can not be merged exactly from the per cycle values. The
+// median over the cycles of each percentile is used instead, and the maximum over the cycles.
+Percentiles combinePercentiles(const std::vector<Percentiles>& cycles)
+{
+  Percentiles result;
+  if (cycles.empty()) {
+    return result;
+  }
+  auto median = [&](double Percentiles::*field) {
+    std::vector<double> values;
+    for (const auto& cycle : cycles) {
+      values.push_back(cycle.*field);
+    }
+    return computePercentiles(values).p50;
+  };
+  result.p50 = median(&Percentiles::p50);
+  result.p90 = median(&Percentiles::p90);
+  result.p99 = median(&Percentiles::p99);
+  for (const auto& cycle : cycles) {
+    result.max = std::max(result.max, cycle.max);
+  }
+  return result;
+}
+
+ptree makeDataSource(const std::string& type, const std::string& name)
+{
+  ptree source;
+  source.put("type", type);
+  source.put("name", name);
+  return source;
+}
+
+ptree makeConfiguration(const Point& point, const Settings& settings, const std::string& databaseUrl)
+{
+  ptree config;
+  config.put("qc.config.database.implementation", "CCDB");
+  config.put("qc.config.database.host", databaseUrl);
+  config.put("qc.config.Activity.number", "42");
+  config.put("qc.config.Activity.type", "2");
+  config.put("qc.config.monitoring.url", "stdout://");
+  config.put("qc.config.consul.url", "");
+  config.put("qc.config.conditionDB.url", databaseUrl);
+  config.put("qc.config.infologger.filterDiscardDebug", "true");
+
+  ptree task;
+  task.put("active", "true");
+  task.put("className", "o2::quality_control_modules::benchmark::TH1FTask");
+  task.put("moduleName", "QcBenchmark");
+  task.put("detectorName", "TST");
+  task.put("cycleDurationSeconds", settings.cycleSeconds);
+  task.put("maxNumberCycles", "-1");
+  task.put("dataSource.type", "direct");
+  task.put("dataSource.query", "tst-data:TST/RAWDATA");
+  task.put("taskParameters.histoNumber", point.histograms);
+  task.put("taskParameters.binsNumber", point.bins);
+  task.put("location", "local");
+  task.put("profiling", "true");
+  task.put("mergingMode", "delta");
+  config.put_child("qc.tasks.BenchmarkTask", task);
+
+  ptree aggregatorSources;
+  for (size_t i = 0; i < point.checks; i++) {
+    const std::string checkName = "AlwaysGoodCheck" + std::to_string(i);
+    ptree check;
+    check.put("active", "true");
+    check.put("className", "o2::quality_control_modules::benchmark::AlwaysGoodCheck");
+    check.put("moduleName", "QcBenchmark");
+    check.put("policy", "OnAny");
+    check.put("detectorName", "TST");
+    ptree checkSources;
+    checkSources.push_back({ "", makeDataSource("Task", "BenchmarkTask") });
+    check.add_child("dataSource", checkSources);
+    config.put_child("qc.checks." + checkName, check);
+    aggregatorSources.push_back({ "", makeDataSource("Check", checkName) });
+  }
+
+  ptree aggregator;
+  aggregator.put("active", "true");
+  aggregator.put("className", "o2::quality_control_modules::common::WorstOfAllAggregator");
+  aggregator.put("moduleName", "QcCommon");
+  aggregator.put("policy", "OnAny");
+  aggregator.put("detectorName", "TST");
+  aggregator.add_child("dataSource", aggregatorSources);
+  config.put_child("qc.aggregators.BenchmarkAggregator", aggregator);
+  return config;
+}
+
+std::string makeCommand(const Point& point, const Settings& settings, const fs::path& configPath)
+{
+  // the same trimming of the data rate as in o2-qc-benchmark-tasks.sh, to be gentle with the memory
+  double messageRate = std::min(settings.maxMessageRate, settings.maxDataRate / point.payloadSize / point.producers);
+  std::ostringstream command;
+  command << "o2-qc-run-producer -b" << (settings.fill ? "" : " --empty")
+          << " --min-size " << point.payloadSize << " --max-size " << point.payloadSize
+          << " --timepipeline " << point.producers << " --message-rate " << messageRate
+          << " | o2-qc -b --run --full-chain --no-data-sampling --config json:/" << fs::absolute(configPath).string()
+          << " " << settings.qcArguments;
+  return command.str();
+}
+
+// parent pid and name of each process, the name being the DPL device id if there is one
+struct ProcessInfo {
+  pid_t parent;
+  std::string name;
+};
+
+std::map<pid_t, ProcessInfo> listProcesses()
+{
+  std::map<pid_t, ProcessInfo> processes;
+  for (const auto& entry : fs::directory_iterator("/proc")) {
+    const auto filename = entry.path().filename().string();
+    if (!std::all_of(filename.begin(), filename.end(), ::isdigit)) {
+      continue;
+    }
+    std::ifstream statFile(entry.path() / "stat");
+    std::string stat;
+    std::getline(statFile, stat);
+    // "pid (comm) state ppid ...", comm can contain spaces and parentheses
+    auto commEnd = stat.rfind(')');
+    auto commBegin = stat.find('(');
+    if (commEnd == std::string::npos || commBegin == std::string::npos) {
+      continue;
+    }
+    std::istringstream rest(stat.substr(commEnd + 2));
+    std::string state;
+    pid_t parent = 0;
+    rest >> state >> parent;
+
+    std::string name = stat.substr(commBegin + 1, commEnd - commBegin - 1);
+    std::ifstream cmdlineFile(entry.path() / "cmdline");
+    std::vector<std::string> arguments;
+    for (std::string argument; std::getline(cmdlineFile, argument, '\0');) {
+      arguments.push_back(argument);
+    }
+    if (!arguments.empty()) {
+      name = fs::path(arguments[0]).filename().string(); // comm is truncated to 15 characters
+    }
+    for (size_t i = 0; i + 1 < arguments.size(); i++) {
+      if (arguments[i] == "--id") {
+        name = arguments[i + 1];
+        break;
+      }
+    }
+    processes[std::stoi(filename)] = { parent, name };
+  }
+  return processes;
+}
+
+size_t readPeakRssKB(pid_t pid)
+{
+  std::ifstream status("/proc/" + std::to_string(pid) + "/status");
+  for (std::string line; std::getline(status, line);) {
+    if (line.rfind("VmHWM:", 0) == 0) {
+      return std::stoul(line.substr(6));
+    }
+  }
+  return 0;
+}
+
+// updates the peak memory of all the processes started by root
+void updatePeakRss(pid_t root, std::map<std::string, size_t>& peakRssKB)
+{
+  auto processes = listProcesses();
+  std::set<pid_t> descendants{ root };
+  bool added = true;
+  while (added) {
+    added = false;
+    for (const auto& [pid, info] : processes) {
+      if (descendants.count(info.parent) && descendants.insert(pid).second) {
+        added = true;
+      }
+    }
+  }
+  descendants.erase(root); // the shell
+  for (auto pid : descendants) {
+    auto& peak = peakRssKB[processes[pid].name];
+    peak = std::max(peak, readPeakRssKB(pid));
+  }
+}
+
+pid_t launch(const std::string& command, const fs::path& logPath)
+{
+  pid_t pid = fork();
+  if (pid == 0) {
+    setpgid(0, 0); // so that the whole workflow can be stopped with one signal
+    int log = open(logPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    dup2(log, STDOUT_FILENO);
+    dup2(log, STDERR_FILENO);
+    close(log);
+    execl("/bin/sh", "sh", "-c", command.c_str(), nullptr);
+    _exit(127);
+  }
+  if (pid < 0) {
+    throw std::runtime_error("Could not start the workflow");
+  }
+  setpgid(pid, pid);
+  return pid;
+}
+
+void terminate(pid_t pid, std::chrono::seconds gracePeriod)
+{
+  kill(-pid, SIGINT);
+  auto deadline = std::chrono::steady_clock::now() + gracePeriod;
+  while (std::chrono::steady_clock::now() < deadline) {
+    if (waitpid(pid, nullptr, WNOHANG) == pid) {
+      kill(-pid, SIGKILL); // leftovers which ignored SIGINT
+      return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  kill(-pid, SIGKILL);
+  waitpid(pid, nullptr, 0);
+}
+
+// reads the metrics sent by the task to the stdout monitoring backend, one entry per cycle after the warm up
+void readTaskMetrics(const fs::path& logPath, size_t warmUpCycles, Result& result)
+{
+  static const std::regex valuePattern(R"((\w+)=([-+0-9.eE]+))");
+  std::vector<double> messages, data, cycleDurations, publicationDurations, publishDurations;
+  std::vector<Percentiles> monitorDataLatencies;
+  std::ifstream log(logPath);
+  for (std::string line; std::getline(log, line);) {
+    if (line.find("ERROR") != std::string::npos || line.find("segmentation violation") != std::string::npos) {
+      result.errors++;
+    }
+    auto metric = line.find("[METRIC]");
+    if (metric == std::string::npos) {
+      continue;
+    }
+    std::map<std::string, double> values;
+    for (std::sregex_iterator it(line.begin() + metric, line.end(), valuePattern), end; it != end; ++it) {
+      try {
+        values[(*it)[1]] = std::stod((*it)[2]);
+      } catch (const std::exception&) {
+        // not a number, e.g. a tag
+      }
+    }
+    if (line.find("qc_data_received") != std::string::npos) {
+      messages.push_back(values["messages_in_cycle"]);
+      data.push_back(values["data_in_cycle"]);
+    } else if (line.find("qc_duration") != std::string::npos) {
+      cycleDurations.push_back(values["module_cycle"]);
+      publicationDurations.push_back(values["publication"]);
+    } else if (line.find("qc_profile_monitorData") != std::string::npos) {
+      monitorDataLatencies.push_back({ values["p50"], values["p90"], values["p99"], values["max"] });
+    } else if (line.find("qc_profile_publish") != std::string::npos) {
+      publishDurations.push_back(values["max"]); // one publication per cycle
+    }
+  }
+
+  const size_t cycles = std::min({ messages.size(), cycleDurations.size() });
+  if (cycles <= warmUpCycles) {
+    return;
+  }
+  double totalMessages = 0, totalData = 0, totalTime = 0;
+  for (size_t i = warmUpCycles; i < cycles; i++) {
+    totalMessages += messages[i];
+    totalData += data[i];
+    totalTime += cycleDurations[i] + publicationDurations[i];
+  }
+  result.cycles = cycles - warmUpCycles;
+  result.messagesPerSecond = totalTime > 0 ? totalMessages / totalTime : 0;
+  result.dataPerSecond = totalTime > 0 ? totalData / totalTime : 0;
+  // the task does not publish the profile of a cycle without any call, e.g. no TF at all
+  if (monitorDataLatencies.size() > warmUpCycles) {
+    result.monitorDataLatency = combinePercentiles(std::vector<Percentiles>(monitorDataLatencies.begin() + warmUpCycles, monitorDataLatencies.end()));
+  }
+  if (publishDurations.size() > warmUpCycles) {
+    result.publishLatency = computePercentiles(std::vector<double>(publishDurations.begin() + warmUpCycles, publishDurations.end()));
+  }
+}
+
+Result runPoint(const Point& point, size_t repetition, const Settings& settings, MockCcdbServer& server)
+{
+  const std::string name = "throughput-benchmark-" + std::to_string(point.producers) + "-" + std::to_string(point.payloadSize) + "-" +
+                           std::to_string(point.histograms) + "-" + std::to_string(point.bins) + "-" + std::to_string(point.checks) + "-" + std::to_string(repetition);
+  const auto configPath = settings.workDirectory / (name + ".json");
+  const auto logPath = settings.workDirectory / (name + ".log");
+  boost::property_tree::write_json(configPath.string(), makeConfiguration(point, settings, server.getUrl()));
+  const auto command = makeCommand(point, settings, configPath);
+  std::cout << "Running " << name << ": " << command << std::endl;
+
+  Result result;
+  result.point = point;
+  result.repetition = repetition;
+  server.resetStatistics();
+  pid_t pid = launch(command, logPath);
+  auto end = std::chrono::steady_clock::now() + std::chrono::seconds(settings.durationSeconds);
+  while (std::chrono::steady_clock::now() < end && waitpid(pid, nullptr, WNOHANG) == 0) {
+    updatePeakRss(pid, result.peakRssKB);
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+  }
+  updatePeakRss(pid, result.peakRssKB);
+  terminate(pid, std::chrono::seconds(30));
+  result.qcdb = server.getStatistics();
+
+  readTaskMetrics(logPath, settings.warmUpCycles, result);
+  if (result.cycles == 0) {
+    std::cerr << "No cycle metrics found for " << name << ", see " << logPath << std::endl;
+  }
+  return result;
+}
+
+template <typename Writer>
+void writePercentiles(Writer& writer, const char* key, const Percentiles& percentiles)
+{
+  writer.Key(key);
+  writer.StartObject();
+  writer.Key("p50");
+  writer.Double(percentiles.p50);
+  writer.Key("p90");
+  writer.Double(percentiles.p90);
+  writer.Key("p99");
+  writer.Double(percentiles.p99);
+  writer.Key("max");
+  writer.Double(percentiles.max);
+  writer.EndObject();
+}
+
+void writeResults(const std::string& path, const Settings& settings, const std::vector<Result>& results)
+{
+  rapidjson::StringBuffer buffer;
+  rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+  writer.StartObject();
+  writer.Key("settings");
+  writer.StartObject();
+  writer.Key("cycle_seconds");
+  writer.Uint64(settings.cycleSeconds);
+  writer.Key("duration_seconds");
+  writer.Uint64(settings.durationSeconds);
+  writer.Key("warm_up_cycles");
+  writer.Uint64(settings.warmUpCycles);
+  writer.Key("max_data_rate");
+  writer.Double(settings.maxDataRate);
+  writer.Key("fill");
+  writer.Bool(settings.fill);
+  writer.EndObject();
+
+  writer.Key("results");
+  writer.StartArray();
+  for (const auto& result : results) {
+    writer.StartObject();
+    writer.Key("producers");
+    writer.Uint64(result.point.producers);
+    writer.Key("payload_size");
+    writer.Uint64(result.point.payloadSize);
+    writer.Key("histograms");
+    writer.Uint64(result.point.histograms);
+    writer.Key("bins");
+    writer.Uint64(result.point.bins);
+    writer.Key("checks");
+    writer.Uint64(result.point.checks);
+    writer.Key("repetition");
+    writer.Uint64(result.repetition);
+    writer.Key("cycles");
+    writer.Uint64(result.cycles);
+    writer.Key("tf_per_second");
+    writer.Double(result.messagesPerSecond);
+    writer.Key("data_per_second");
+    writer.Double(result.dataPerSecond);
+    writePercentiles(writer, "monitor_data_seconds", result.monitorDataLatency);
+    writePercentiles(writer, "publish_seconds", result.publishLatency);
+    writer.Key("qcdb_objects_stored");
+    writer.Uint64(result.qcdb.storedObjects);
+    writer.Key("qcdb_bytes_stored");
+    writer.Uint64(result.qcdb.storedBytes);
+    writer.Key("peak_rss_kB");
+    writer.StartObject();
+    for (const auto& [device, rss] : result.peakRssKB) {
+      writer.Key(device.c_str());
+      writer.Uint64(rss);
+    }
+    writer.EndObject();
+    writer.Key("errors");
+    writer.Uint64(result.errors);
+    writer.EndObject();
+  }
+  writer.EndArray();
+  writer.EndObject();
+
+  std::ofstream output(path);
+  output << buffer.GetString() << std::endl;
+}
+
+} // namespace
+
+int main(int argc, const char* argv[])
+{
+  try {
+    using sizes = std::vector<size_t>;
+    bpo::options_description desc{ "Options" };
+    desc.add_options()("help,h", "Help screen")
+      ("producers", bpo::value<sizes>()->multitoken()->default_value({ 1 }, "1"), "Numbers of parallel producers to test")
+      ("payload-sizes", bpo::value<sizes>()->multitoken()->default_value({ 256 }, "256"), "Sizes of the produced messages in bytes")
+      ("histograms", bpo::value<sizes>()->multitoken()->default_value({ 10 }, "10"), "Numbers of histograms published by the task")
+      ("bins", bpo::value<sizes>()->multitoken()->default_value({ 100 }, "100"), "Numbers of bins of the histograms")
+      ("checks", bpo::value<sizes>()->multitoken()->default_value({ 1 }, "1"), "Numbers of checks run on the task objects")
+      ("repetitions", bpo::value<size_t>()->default_value(1), "Repetitions of each test")
+      ("cycle-seconds", bpo::value<size_t>()->default_value(2), "Cycle duration of the task")
+      ("duration", bpo::value<size_t>()->default_value(30), "Duration of each test in seconds")
+      ("warm-up-cycles", bpo::value<size_t>()->default_value(2), "Number of first cycles ignored in the results")
+      ("max-data-rate", bpo::value<double>()->default_value(5e8), "Total data rate of the producers in bytes per second")
+      ("max-message-rate", bpo::value<double>()->default_value(10000), "Maximum message rate of each producer")
+      ("fill", bpo::bool_switch()->default_value(false), "Fill the produced messages, which prevents memory overcommitment but slows producers")
+      ("qc-arguments", bpo::value<std::string>()->default_value("--shm-segment-size 2000000000"), "Additional arguments of o2-qc")
+      ("work-dir", bpo::value<std::string>()->default_value("."), "Directory for the generated configuration files and the logs")
+      ("port", bpo::value<uint16_t>()->default_value(0), "Port of the mock QCDB, 0 to pick any free port")
+      ("output,o", bpo::value<std::string>()->default_value("qc-throughput-benchmark.json"), "Results file");
+
+    bpo::variables_map vm;
+    store(parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help")) {
+      std::cout << desc << std::endl;
+      return 0;
+    }
+    notify(vm);
+
+    Settings settings{
+      vm["cycle-seconds"].as<size_t>(),
+      vm["duration"].as<size_t>(),
+      vm["warm-up-cycles"].as<size_t>(),
+      vm["max-data-rate"].as<double>(),
+      vm["max-message-rate"].as<double>(),
+      vm["fill"].as<bool>(),
+      vm["qc-arguments"].as<std::string>(),
+      vm["work-dir"].as<std::string>()
+    };
+    fs::create_directories(settings.workDirectory);
+
+    MockCcdbServer server(vm["port"].as<uint16_t>());
+    server.start();
+    std::cout << "Mock QCDB listening on " << server.getUrl() << std::endl;
+
+    std::vector<Result> results;
+    for (auto producers : vm["producers"].as<sizes>()) {
+      for (auto payloadSize : vm["payload-sizes"].as<sizes>()) {
+        for (auto histograms : vm["histograms"].as<sizes>()) {
+          for (auto bins : vm["bins"].as<sizes>()) {
+            for (auto checks : vm["checks"].as<sizes>()) {
+              for (size_t repetition = 0; repetition < vm["repetitions"].as<size_t>(); repetition++) {
+                results.push_back(runPoint({ producers, payloadSize, histograms, bins, checks }, repetition, settings, server));
+                // written after each test, so that the results survive an interrupted sweep
+                writeResults(vm["output"].as<std::string>(), settings, results);
+              }
+            }
+          }
+        }
+      }
+    }
+    server.stop();
+    std::cout << "Results written to " << vm["output"].as<std::string>() << std::endl;
+  } catch (const bpo::error& ex) {
+    std::cerr << "Exception caught: " << ex.what() << std::endl;
+    return 1;
+  } catch (const std::exception& ex) {
+    std::cerr << "Benchmark failed: " << ex.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
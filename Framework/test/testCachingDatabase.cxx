@@ -0,0 +1,236 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    testCachingDatabase.cxx
+///
+
+#include "QualityControl/CachingDatabase.h"
+#include "QualityControl/DummyDatabase.h"
+
+#include <TH1F.h>
+#include <filesystem>
+#include <optional>
+
+#include <catch_amalgamated.hpp>
+
+using namespace o2::quality_control::repository;
+
+namespace
+{
+// serves one histogram per path, valid from 1000 until validUntil, whose ETag can be changed to simulate a new version.
+// By default, the validity did not end yet.
+class VersionedDatabase : public DummyDatabase
+{
+ public:
+  TObject* retrieveTObject(std::string path, const std::map<std::string, std::string>& metadata, long timestamp, std::map<std::string, std::string>* headers) override
+  {
+    auto currentHeaders = makeHeaders(timestamp);
+    if (currentHeaders.empty()) {
+      return nullptr;
+    }
+    downloads++;
+    if (headers) {
+      *headers = currentHeaders;
+    }
+    auto* histo = new TH1F(path.c_str(), path.c_str(), 100, 0, 100);
+    histo->Fill(version);
+    return histo;
+  }
+
+  std::map<std::string, std::string> retrieveHeaders(const std::string&, const std::map<std::string, std::string>&, long timestamp) override
+  {
+    headRequests++;
+    return makeHeaders(timestamp);
+  }
+
+  std::map<std::string, std::string> makeHeaders(long timestamp) const
+  {
+    if (timestamp < 1000 || timestamp >= validUntil) {
+      return {};
+    }
+    return { { "ETag", "\"etag-" + std::to_string(version) + "\"" }, { "Last-Modified", "today" }, { "Created", std::to_string(100 * version) },
+             { "Valid-From", "1000" }, { "Valid-Until", std::to_string(validUntil) } };
+  }
+
+  long validUntil = 4000000000000; // year 2096
+  int version = 1; // created at 100 * version
+  size_t downloads = 0;
+  size_t headRequests = 0;
+};
+} // namespace
+
+TEST_CASE("caching_database_config")
+{
+  auto config = CachingDatabaseConfig::fromDatabaseConfig({ { "implementation", "CCDB" } });
+  CHECK(config.enabled == false);
+  CHECK(config.directory.empty());
+
+  config = CachingDatabaseConfig::fromDatabaseConfig({ { "cache", "true" }, { "cacheMaxBytes", "1000" }, { "cacheDirectory", "/tmp/qc" } });
+  CHECK(config.enabled == true);
+  CHECK(config.maxBytes == 1000);
+  CHECK(config.directory == "/tmp/qc");
+}
+
+TEST_CASE("caching_database_memory")
+{
+  auto database = std::make_unique<VersionedDatabase>();
+  auto* source = database.get();
+  CachingDatabase cache(std::move(database), {});
+
+  std::unique_ptr<TObject> obj(cache.retrieveTObject("qc/TST/MO/task/histo", {}, 1500));
+  REQUIRE(obj != nullptr);
+  CHECK(source->downloads == 1);
+
+  // same validity, same version
+  obj.reset(cache.retrieveTObject("qc/TST/MO/task/histo", {}, 1800));
+  REQUIRE(obj != nullptr);
+  CHECK(dynamic_cast<TH1F*>(obj.get())->GetMean() == Catch::Approx(1.5));
+  CHECK(source->downloads == 1);
+  CHECK(cache.getStatistics().hits == 1);
+
+  // the metadata are part of the key
+  obj.reset(cache.retrieveTObject("qc/TST/MO/task/histo", { { "RunNumber", "1" } }, 1800));
+  CHECK(source->downloads == 2);
+
+  // the object was replaced in the database
+  source->version = 2;
+  obj.reset(cache.retrieveTObject("qc/TST/MO/task/histo", {}, 1500));
+  REQUIRE(obj != nullptr);
+  CHECK(dynamic_cast<TH1F*>(obj.get())->GetMean() == Catch::Approx(2.5));
+  CHECK(source->downloads == 3);
+  CHECK(cache.getStatistics().outdated == 1);
+
+  // outside of validity
+  obj.reset(cache.retrieveTObject("qc/TST/MO/task/histo", {}, 500));
+  CHECK(obj == nullptr);
+
+  auto statistics = cache.getStatistics();
+  CHECK(statistics.entries == 2);
+  CHECK(statistics.misses == 4);
+  cache.clear();
+  CHECK(cache.getStatistics().bytes == 0);
+}
+
+TEST_CASE("caching_database_listing")
+{
+  auto database = std::make_unique<VersionedDatabase>();
+  auto* source = database.get();
+  CachingDatabase cache(std::move(database), {});
+  // what the listings of the NewObject triggers would contain
+  std::map<std::string, uint64_t> listing{ { "qc/TST/MO/task/histo", 100 } };
+  cache.setLatestVersionFcn([&listing](const std::string& path, const std::map<std::string, std::string>&) -> std::optional<uint64_t> {
+    auto it = listing.find(path);
+    return it != listing.end() ? std::optional<uint64_t>{ it->second } : std::nullopt;
+  });
+
+  delete cache.retrieveTObject("qc/TST/MO/task/histo", {}, 1500);
+  delete cache.retrieveTObject("qc/TST/MO/task/other", {}, 1500);
+  CHECK(source->downloads == 2);
+
+  // the listing shows no newer version, the database is not asked
+  std::unique_ptr<TObject> obj(cache.retrieveTObject("qc/TST/MO/task/histo", {}, 1800));
+  REQUIRE(obj != nullptr);
+  CHECK(source->headRequests == 0);
+  CHECK(cache.getStatistics().listed == 1);
+
+  // objects which are not listed are validated with their headers
+  obj.reset(cache.retrieveTObject("qc/TST/MO/task/other", {}, 1800));
+  REQUIRE(obj != nullptr);
+  CHECK(source->headRequests == 1);
+
+  // a newer version is listed, the headers tell whether it replaces the cached one
+  source->version = 2;
+  listing["qc/TST/MO/task/histo"] = 200;
+  obj.reset(cache.retrieveTObject("qc/TST/MO/task/histo", {}, 1800));
+  REQUIRE(obj != nullptr);
+  CHECK(dynamic_cast<TH1F*>(obj.get())->GetMean() == Catch::Approx(2.5));
+  CHECK(source->headRequests == 2);
+  CHECK(source->downloads == 3);
+  CHECK(cache.getStatistics().outdated == 1);
+  CHECK(cache.getStatistics().listed == 1);
+}
+
+TEST_CASE("caching_database_closed_validity")
+{
+  auto database = std::make_unique<VersionedDatabase>();
+  auto* source = database.get();
+  source->validUntil = 2000;
+  CachingDatabase cache(std::move(database), {});
+
+  delete cache.retrieveTObject("qc/TST/MO/task/histo", {}, 1500);
+  CHECK(source->downloads == 1);
+
+  // the validity of the object ended, it is not compared with the database anymore
+  source->version = 2;
+  std::unique_ptr<TObject> obj(cache.retrieveTObject("qc/TST/MO/task/histo", {}, 1500));
+  REQUIRE(obj != nullptr);
+  CHECK(dynamic_cast<TH1F*>(obj.get())->GetMean() == Catch::Approx(1.5));
+  CHECK(source->downloads == 1);
+  CHECK(cache.getStatistics().hits == 1);
+  CHECK(cache.getStatistics().outdated == 0);
+}
+
+TEST_CASE("caching_database_eviction")
+{
+  size_t objectSize = 0;
+  {
+    CachingDatabase cache(std::make_unique<VersionedDatabase>(), {});
+    delete cache.retrieveTObject("qc/TST/MO/task/histo1", {}, 1500);
+    objectSize = cache.getStatistics().bytes;
+    REQUIRE(objectSize > 0);
+  }
+
+  auto database = std::make_unique<VersionedDatabase>();
+  auto* source = database.get();
+  CachingDatabaseConfig config;
+  config.maxBytes = objectSize * 3 / 2; // room for one object only
+  CachingDatabase cache(std::move(database), config);
+
+  delete cache.retrieveTObject("qc/TST/MO/task/histo1", {}, 1500);
+  delete cache.retrieveTObject("qc/TST/MO/task/histo2", {}, 1500);
+  CHECK(cache.getStatistics().evictions == 1);
+  CHECK(cache.getStatistics().entries == 1);
+  CHECK(cache.getStatistics().bytes <= config.maxBytes);
+
+  delete cache.retrieveTObject("qc/TST/MO/task/histo1", {}, 1500);
+  CHECK(source->downloads == 3);
+}
+
+TEST_CASE("caching_database_disk")
+{
+  auto directory = std::filesystem::temp_directory_path() / "testCachingDatabase";
+  std::filesystem::remove_all(directory);
+  CachingDatabaseConfig config;
+  config.directory = directory.string();
+
+  {
+    CachingDatabase cache(std::make_unique<VersionedDatabase>(), config);
+    delete cache.retrieveTObject("qc/TST/MO/task/histo", {}, 1500);
+  }
+
+  // another process with an empty memory cache
+  auto database = std::make_unique<VersionedDatabase>();
+  auto* source = database.get();
+  CachingDatabase cache(std::move(database), config);
+  std::unique_ptr<TObject> obj(cache.retrieveTObject("qc/TST/MO/task/histo", {}, 1500));
+  REQUIRE(obj != nullptr);
+  CHECK(source->downloads == 0);
+  CHECK(cache.getStatistics().diskHits == 1);
+
+  // a new version is not in the directory
+  cache.clear();
+  source->version = 2;
+  obj.reset(cache.retrieveTObject("qc/TST/MO/task/histo", {}, 1500));
+  CHECK(source->downloads == 1);
+
+  std::filesystem::remove_all(directory);
+}
@@ -16,14 +16,55 @@
 
 #include "QualityControl/CheckRunnerFactory.h"
 #include "QualityControl/CheckRunner.h"
+#include "QualityControl/CcdbDatabase.h"
 #include "QualityControl/CommonSpec.h"
+#include "QualityControl/MockCcdbServer.h"
+#include "QualityControl/MonitorObjectCollection.h"
+#include "QualityControl/SerializedInput.h"
+#include "QualityControl/MonitorObject.h"
+#include "QualityControl/ObjectMetadataKeys.h"
+#include "QualityControl/RepoPathUtils.h"
+#include <Framework/DataProcessingHeader.h>
+#include <TBufferFile.h>
+#include <TH1F.h>
+#include <TList.h>
+#include <TNamed.h>
+#include <TObjArray.h>
 #include <catch_amalgamated.hpp>
 
+#include <algorithm>
+#include <string_view>
+
 using namespace o2::quality_control::checker;
 using namespace std;
 using namespace o2::framework;
 using namespace o2::header;
 
+// https://stackoverflow.com/questions/424104/can-i-access-private-members-from-outside-the-class-without-using-friends
+template <typename Accessor, typename Accessor::type Member>
+struct DeclareGlobalGet {
+  friend typename Accessor::type get(Accessor) { return Member; }
+};
+
+struct CheckRunnerDatabaseAccessor {
+  using type = std::shared_ptr<o2::quality_control::repository::DatabaseInterface> CheckRunner::*;
+  friend type get(CheckRunnerDatabaseAccessor);
+};
+
+struct CacheMonitorObjectsAccessor {
+  using type = std::vector<std::shared_ptr<MonitorObject>> (CheckRunner::*)(const InputSpec&, TObjArray&, SerializedInput&);
+  friend type get(CacheMonitorObjectsAccessor);
+};
+
+struct StoreMonitorObjectsAccessor {
+  using type = void (CheckRunner::*)(std::vector<std::shared_ptr<MonitorObject>>&, long);
+  friend type get(StoreMonitorObjectsAccessor);
+};
+
+template struct DeclareGlobalGet<CheckRunnerDatabaseAccessor, &CheckRunner::mDatabase>;
+template struct DeclareGlobalGet<CacheMonitorObjectsAccessor, &CheckRunner::cacheMonitorObjects>;
+template struct DeclareGlobalGet<StoreMonitorObjectsAccessor, &CheckRunner::store>;
+
 TEST_CASE("test_check_runner_static")
 {
   // facility name
@@ -47,3 +88,197 @@ TEST_CASE("test_checkRunner_getDetector")
   checks.push_back(config);
   CHECK(CheckRunner::getDetectorName(checks) == "MANY");
 }
+
+TEST_CASE("test_serialized_input")
+{
+  SerializedInput input;
+  DataHeader dataHeader;
+  DataProcessingHeader firstTimeslice{ 1 };
+  DataProcessingHeader secondTimeslice{ 2 };
+  std::string first = "first payload";
+  std::string second = "second payload";
+
+  CHECK(input.isPending() == false);
+  CHECK(input.hasObjectNames() == false);
+  CHECK_THROWS(input.deserialize());
+
+  CHECK(input.receive(dataHeader, &firstTimeslice, first.data(), first.size()) == true);
+  CHECK(input.isPending() == true);
+  // a newer message replaces the pending one
+  CHECK(input.receive(dataHeader, &secondTimeslice, second.data(), second.size()) == true);
+  CHECK(input.getNumberSkipped() == 1);
+  // the same message is not kept again
+  CHECK(input.receive(dataHeader, &secondTimeslice, second.data(), second.size()) == false);
+  CHECK(input.getNumberSkipped() == 1);
+  // the same buffer in another timeslice is a new message
+  CHECK(input.receive(dataHeader, &firstTimeslice, second.data(), second.size()) == true);
+  CHECK(input.getNumberSkipped() == 2);
+  // the payload is copied before the message is released, it is still recognized as the same message
+  input.keepPayload();
+  CHECK(input.isPending() == true);
+  CHECK(input.receive(dataHeader, &firstTimeslice, second.data(), second.size()) == false);
+  // without a DataProcessingHeader, messages are always kept
+  CHECK(input.receive(dataHeader, nullptr, second.data(), second.size()) == true);
+  CHECK(input.receive(dataHeader, nullptr, second.data(), second.size()) == true);
+
+  input.setObjectNames({ "qc/TST/MO/task/histo" });
+  CHECK(input.hasObjectNames() == true);
+  CHECK(input.getObjectNames().size() == 1);
+
+  input.clear();
+  CHECK(input.isPending() == false);
+  CHECK(input.hasObjectNames() == false);
+  CHECK(input.receive(dataHeader, &secondTimeslice, second.data(), second.size()) == true);
+}
+
+TEST_CASE("test_check_runner_group_checks_sharing_objects")
+{
+  auto makeConfig = [](std::vector<std::string> objectNames, bool allowBeautify, bool allObjects = false) {
+    CheckConfig config;
+    config.objectNames = std::move(objectNames);
+    config.allowBeautify = allowBeautify;
+    config.allObjects = allObjects;
+    return config;
+  };
+
+  // only reading the same object, can run concurrently
+  auto groups = CheckRunner::groupChecksSharingObjects({ makeConfig({ "a" }, false), makeConfig({ "a" }, false) });
+  CHECK(groups == std::vector<std::vector<size_t>>{ { 0 }, { 1 } });
+
+  // the first one beautifies an object used by the third one, the second and the fourth one are independent
+  groups = CheckRunner::groupChecksSharingObjects({ makeConfig({ "a", "b" }, true),
+                                                    makeConfig({ "c" }, true),
+                                                    makeConfig({ "b" }, false),
+                                                    makeConfig({ "d" }, false) });
+  CHECK(groups == std::vector<std::vector<size_t>>{ { 0, 2 }, { 1 }, { 3 } });
+
+  // a check of all objects which beautifies conflicts with everything
+  groups = CheckRunner::groupChecksSharingObjects({ makeConfig({ "a" }, false),
+                                                    makeConfig({}, true, true),
+                                                    makeConfig({ "b" }, false) });
+  CHECK(groups == std::vector<std::vector<size_t>>{ { 0, 1, 2 } });
+}
+
+TEST_CASE("test_check_runner_cycle_manifests")
+{
+  using namespace o2::quality_control::core;
+  using namespace o2::quality_control::repository;
+  auto makeMO = [](const std::string& name, const std::string& taskName, ValidityInterval validity) {
+    auto mo = std::make_shared<MonitorObject>(new TH1F(name.c_str(), name.c_str(), 10, 0, 10), taskName, "TestClass", "TST");
+    mo->setIsOwner(true);
+    mo->setValidity(validity);
+    mo->addOrUpdateMetadata(metadata_keys::cycleNumber, "3");
+    return mo;
+  };
+
+  CHECK(CheckRunner::makeCycleManifests({}).empty());
+
+  auto manifests = CheckRunner::makeCycleManifests({ makeMO("a", "task1", { 10, 20 }), makeMO("b", "task1", { 15, 30 }), makeMO("c", "task2", { 10, 20 }) });
+  REQUIRE(manifests.size() == 2);
+
+  auto& manifest = manifests[0];
+  CHECK(manifest->getName() == RepoPathUtils::cycleManifestName);
+  CHECK(manifest->getTaskName() == "task1");
+  CHECK(manifest->getDetectorName() == "TST");
+  CHECK(manifest->getValidity() == ValidityInterval{ 10, 30 });
+  CHECK(manifest->getMetadata(metadata_keys::cycleNumber) == "3");
+  auto* names = dynamic_cast<TList*>(manifest->getObject());
+  REQUIRE(names != nullptr);
+  CHECK(names->GetEntries() == 2);
+  CHECK(names->FindObject("a") != nullptr);
+  CHECK(names->FindObject("b") != nullptr);
+
+  CHECK(manifests[1]->getTaskName() == "task2");
+  CHECK(dynamic_cast<TList*>(manifests[1]->getObject())->GetEntries() == 1);
+}
+
+TEST_CASE("test_check_runner_stores_unchanged_objects")
+{
+  using namespace o2::quality_control::core;
+  using namespace o2::quality_control::repository;
+
+  MockCcdbServer server;
+  server.start();
+  auto database = std::make_shared<CcdbDatabase>();
+  database->connect(server.getUrl(), "", "", "");
+
+  InputSpec input{ "tst", "TST", "MO", 0 };
+  CheckRunner checkRunner(CheckRunnerConfig{}, input);
+  checkRunner.*get(CheckRunnerDatabaseAccessor()) = database;
+  SerializedInput serializedInput;
+
+  auto cycle = [&](MonitorObject* mo) {
+    TObjArray array;
+    array.Add(mo);
+    auto monitorObjects = (checkRunner.*get(CacheMonitorObjectsAccessor()))(input, array, serializedInput);
+    (checkRunner.*get(StoreMonitorObjectsAccessor()))(monitorObjects, 0);
+    return monitorObjects;
+  };
+
+  auto* histogram = new TH1F("histogram", "histogram", 10, 0, 10);
+  histogram->Fill(5);
+  auto* mo = new MonitorObject(histogram, "task", "TestClass", "TST");
+  mo->setIsOwner(true);
+  mo->setValidity({ 1000, 2000 });
+  REQUIRE(cycle(mo).size() == 1);
+
+  // the next cycle contains only a marker, the cached object should be stored again with the extended validity
+  auto* marker = new MonitorObject(new TNamed("histogram", "histogram"), "task", "TestClass", "TST");
+  marker->setIsOwner(true);
+  marker->setValidity({ 2000, 3000 });
+  marker->addOrUpdateMetadata(metadata_keys::qcUnchanged, "1");
+  auto stored = cycle(marker);
+  REQUIRE(stored.size() == 1);
+  CHECK(stored[0]->getValidity() == ValidityInterval{ 1000, 3000 });
+  CHECK(serializedInput.containsUnchangedMarkers());
+  CHECK(server.getNumberOfObjects() == 2);
+
+  auto retrieved = database->retrieveMO("TST/MO/task", "histogram", 2500);
+  REQUIRE(retrieved != nullptr);
+  CHECK(dynamic_cast<TH1*>(retrieved->getObject())->GetEntries() == 1);
+  server.stop();
+}
+
+TEST_CASE("test_check_runner_skips_corrupted_collections")
+{
+  using namespace o2::quality_control::core;
+
+  InputSpec input{ "tst", "TST", "MO", 0 };
+  CheckRunner checkRunner(CheckRunnerConfig{}, input);
+  SerializedInput serializedInput;
+
+  // an encoded collection as sent by a task, optionally with a broken compressed size
+  auto receive = [](bool corrupted) {
+    MonitorObjectCollection moc;
+    moc.SetOwner(true);
+    auto mo = new MonitorObject(new TH1F("histogram", "histogram", 10, 0, 10), "task", "TestClass", "TST");
+    mo->setIsOwner(true);
+    moc.Add(mo);
+    auto encoded = moc.encode({ MonitorObjectCollection::Encoding::Compression::ZSTD, 1, 0 });
+    TBufferFile buffer(TBuffer::kWrite);
+    buffer.WriteObject(encoded.get());
+    std::vector<char> data(buffer.Buffer(), buffer.Buffer() + buffer.Length());
+    if (corrupted) {
+      auto header = std::string_view(data.data(), data.size()).find("ZS");
+      REQUIRE(header != std::string_view::npos);
+      std::fill_n(data.begin() + header + 3, 3, '\xff');
+    }
+    TBufferFile message(TBuffer::kRead, static_cast<Int_t>(data.size()), data.data(), false);
+    std::unique_ptr<MonitorObjectCollection> received(dynamic_cast<MonitorObjectCollection*>(message.ReadObject(MonitorObjectCollection::Class())));
+    REQUIRE(received != nullptr);
+    received->SetOwner(false);
+    return received;
+  };
+
+  auto corrupted = receive(true);
+  std::vector<std::shared_ptr<MonitorObject>> monitorObjects;
+  REQUIRE_NOTHROW(monitorObjects = (checkRunner.*get(CacheMonitorObjectsAccessor()))(input, *corrupted, serializedInput));
+  CHECK(monitorObjects.empty());
+
+  // the next messages are still processed
+  auto valid = receive(false);
+  monitorObjects = (checkRunner.*get(CacheMonitorObjectsAccessor()))(input, *valid, serializedInput);
+  REQUIRE(monitorObjects.size() == 1);
+  CHECK(monitorObjects[0]->getName() == "histogram");
+  CHECK(serializedInput.getObjectNames().size() == 1);
+}
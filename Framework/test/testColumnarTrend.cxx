@@ -0,0 +1,112 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    testColumnarTrend.cxx
+///
+
+#include "QualityControl/ColumnarTrend.h"
+
+#include <TTree.h>
+#include <TBufferFile.h>
+#include <cstdio>
+#include <memory>
+
+#include <catch_amalgamated.hpp>
+
+using namespace o2::quality_control::postprocessing;
+
+namespace
+{
+// the same kinds of branches as in the trends of TrendingTask
+struct Meta {
+  Long64_t runNumber = 0;
+  char runNumberStr[7] = { 0 };
+};
+struct Stats {
+  Double_t mean = 0;
+  Double_t stddev = 0;
+};
+
+std::unique_ptr<TTree> makeTrend(Meta& meta, UInt_t& time, Stats& stats, ColumnarTrend& columns)
+{
+  auto tree = std::make_unique<TTree>("trend", "trend");
+  tree->SetDirectory(nullptr);
+  tree->Branch("meta", &meta, "runNumber/L:runNumberStr/C");
+  tree->Branch("time", &time);
+  tree->Branch("stats", &stats, "mean/D:stddev/D");
+  for (int i = 0; i < 10; i++) {
+    meta.runNumber = 500000 + i / 5;
+    std::snprintf(meta.runNumberStr, sizeof(meta.runNumberStr), "%lld", meta.runNumber);
+    time = 1000 + 60 * i;
+    stats = { 1.5 * i, 0.1 * i };
+    tree->Fill();
+    columns.appendCurrent(*tree);
+  }
+  return tree;
+}
+} // namespace
+
+TEST_CASE("columnar_trend_columns")
+{
+  Meta meta;
+  UInt_t time;
+  Stats stats;
+  ColumnarTrend columns;
+  auto tree = makeTrend(meta, time, stats, columns);
+
+  REQUIRE(columns.size() == 10);
+  REQUIRE(columns.getColumn("time") != nullptr);
+  CHECK(columns.getColumn("time") == columns.getColumn("time.time"));
+  CHECK(columns.getColumn("time")->at(3) == 1180);
+  CHECK(columns.getColumn("meta.runNumber")->at(7) == 500001);
+  CHECK(columns.getColumn("stats.mean")->at(4) == Catch::Approx(6.0));
+  CHECK(columns.getColumn("stats.stddev")->at(9) == Catch::Approx(0.9));
+  // strings are not copied
+  CHECK(columns.getColumn("meta.runNumberStr") == nullptr);
+  CHECK(columns.getColumn("nothing") == nullptr);
+
+  // the columns obtained from a stored tree are the same
+  TBufferFile buffer(TBuffer::kWrite);
+  buffer.WriteObject(tree.get());
+  buffer.SetReadMode();
+  buffer.SetBufferOffset(0);
+  std::unique_ptr<TTree> readTree(static_cast<TTree*>(buffer.ReadObject(TTree::Class())));
+  REQUIRE(readTree != nullptr);
+  ColumnarTrend readColumns;
+  readColumns.readFrom(*readTree);
+  REQUIRE(readColumns.size() == 10);
+  CHECK(*readColumns.getColumn("stats.mean") == *columns.getColumn("stats.mean"));
+  CHECK(*readColumns.getColumn("time") == *columns.getColumn("time"));
+}
+
+TEST_CASE("columnar_trend_evaluate")
+{
+  Meta meta;
+  UInt_t time;
+  Stats stats;
+  ColumnarTrend columns;
+  auto tree = makeTrend(meta, time, stats, columns);
+
+  auto series = columns.evaluate("stats.mean:time", "");
+  REQUIRE(series.has_value());
+  CHECK(&series->y == columns.getColumn("stats.mean"));
+  CHECK(&series->x == columns.getColumn("time"));
+  CHECK(columns.evaluate(" stats.stddev : meta.runNumber ", " ").has_value());
+
+  // anything more complex is left to TTree::Draw
+  CHECK_FALSE(columns.evaluate("stats.mean", "").has_value());
+  CHECK_FALSE(columns.evaluate("stats.mean:time", "meta.runNumber > 0").has_value());
+  CHECK_FALSE(columns.evaluate("stats.mean*2:time", "").has_value());
+  CHECK_FALSE(columns.evaluate("stats.mean:stats.stddev:time", "").has_value());
+  CHECK_FALSE(columns.evaluate("stats.mean:meta.runNumberStr", "").has_value());
+  CHECK_FALSE(columns.evaluate("stats.rms:time", "").has_value());
+}
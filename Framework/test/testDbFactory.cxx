@@ -27,6 +27,7 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <QualityControl/CachingDatabase.h>
 #include <QualityControl/DummyDatabase.h>
 #include <QualityControl/CcdbDatabase.h>
 #include <QualityControl/MonitorObject.h>
@@ -61,6 +62,20 @@ BOOST_AUTO_TEST_CASE(db_factory_test)
   BOOST_CHECK(dynamic_cast<DummyDatabase*>(database4.get()));
 }
 
+BOOST_AUTO_TEST_CASE(db_factory_config_test)
+{
+  std::unordered_map<std::string, std::string> config{ { "implementation", "Dummy" } };
+  auto database = DatabaseFactory::create(config);
+  BOOST_CHECK(dynamic_cast<DummyDatabase*>(database.get()));
+
+  config["cache"] = "true";
+  database = DatabaseFactory::create(config);
+  BOOST_CHECK(dynamic_cast<CachingDatabase*>(database.get()));
+
+  config.erase("implementation");
+  BOOST_CHECK_EXCEPTION(DatabaseFactory::create(config), AliceO2::Common::FatalException, o2::quality_control::test::do_nothing);
+}
+
 BOOST_AUTO_TEST_CASE(db_ccdb_listing)
 {
   std::unique_ptr<DatabaseInterface> database3 = DatabaseFactory::create("CCDB");
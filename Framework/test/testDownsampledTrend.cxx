@@ -0,0 +1,120 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    testDownsampledTrend.cxx
+///
+
+#include "QualityControl/DownsampledTrend.h"
+
+#include <TGraphAsymmErrors.h>
+#include <algorithm>
+
+#include <catch_amalgamated.hpp>
+
+using namespace o2::quality_control::postprocessing;
+
+TEST_CASE("downsampled_trend_unbounded")
+{
+  DownsampledTrend trend;
+  for (int i = 0; i < 1000; i++) {
+    trend.add(i, i);
+  }
+  CHECK(trend.size() == 1000);
+  CHECK(trend.getMaxSize() == 0);
+  auto points = trend.getPoints();
+  CHECK(points.front().timeStart == 0);
+  CHECK(points.back().mean() == 999);
+}
+
+TEST_CASE("downsampled_trend_tiers")
+{
+  DownsampledTrend trend(10, 3, 5);
+  for (int i = 0; i < 100000; i++) {
+    trend.add(i, i % 2 ? 1 : 3);
+  }
+  CHECK(trend.size() <= trend.getMaxSize());
+  CHECK(trend.getMaxSize() == 30);
+
+  auto points = trend.getPoints();
+  // the most recent points are kept as they are
+  CHECK(points.back().count == 1);
+  CHECK(points.back().timeStart == 99999);
+  CHECK(points.back().mean() == 1);
+  // the oldest ones are aggregated
+  const auto& oldest = points.front();
+  CHECK(oldest.count == 25);
+  CHECK(oldest.min == 1);
+  CHECK(oldest.max == 3);
+  CHECK(oldest.mean() == Catch::Approx(2).epsilon(0.05));
+  CHECK(oldest.timeEnd - oldest.timeStart == 24);
+  for (size_t i = 1; i < points.size(); i++) {
+    CHECK(points[i - 1].timeEnd < points[i].timeStart);
+  }
+
+  TGraphAsymmErrors graph;
+  trend.fill(graph);
+  CHECK(graph.GetN() == points.size());
+  CHECK(graph.GetErrorYlow(0) == Catch::Approx(oldest.mean() - 1));
+}
+
+TEST_CASE("downsampled_trend_merge")
+{
+  DownsampledTrend even(10, 2, 5);
+  DownsampledTrend odd(10, 2, 5);
+  for (int i = 0; i < 50; i++) {
+    even.add(2 * i, 1);
+    odd.add(2 * i + 1, 3);
+  }
+  even.merge(odd);
+  CHECK(even.size() <= even.getMaxSize());
+  auto points = even.getPoints();
+  CHECK(points.back().timeStart == 99);
+  CHECK(points.back().mean() == 3);
+  uint64_t count = 0;
+  for (const auto& point : points) {
+    count += point.count;
+  }
+  // the points dropped from the last tier are not counted anymore
+  CHECK(count <= 100);
+  CHECK(count >= 10);
+}
+
+TEST_CASE("downsampled_trend_select_samples")
+{
+  std::vector<double> times;
+  for (int i = 0; i < 1000; i++) {
+    times.push_back(i * 60.0);
+  }
+  CHECK(DownsampledTrend::selectSamples(times, 0, 3, 10).size() == 1000);
+  CHECK(DownsampledTrend::selectSamples(times, 2000, 3, 10).size() == 1000);
+
+  auto selected = DownsampledTrend::selectSamples(times, 20, 3, 10);
+  REQUIRE(selected.size() < 2 * 20 + 3 * 20);
+  CHECK(selected.back() == 999);
+  CHECK(selected[selected.size() - 20] == 980);
+  CHECK(std::is_sorted(selected.begin(), selected.end()));
+
+  // selecting again among the selected samples, extended with new ones, keeps the size bounded
+  for (int round = 0; round < 10; round++) {
+    std::vector<double> kept;
+    for (auto i : selected) {
+      kept.push_back(times[i]);
+    }
+    for (int i = 0; i < 30; i++) {
+      kept.push_back(kept.back() + 60.0);
+    }
+    times = kept;
+    selected = DownsampledTrend::selectSamples(times, 20, 3, 10);
+    CHECK(selected.size() < 2 * 20 + 3 * 20);
+    CHECK(selected.back() == times.size() - 1);
+  }
+}
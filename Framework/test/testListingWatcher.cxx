@@ -0,0 +1,164 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    testListingWatcher.cxx
+///
+
+#include "QualityControl/ListingWatcher.h"
+
+#include <thread>
+
+#include <catch_amalgamated.hpp>
+
+using namespace o2::quality_control::postprocessing;
+
+namespace
+{
+std::string makeListing(const std::map<std::string, uint64_t>& lastModifiedByPath)
+{
+  std::string json = R"({"objects":[)";
+  for (const auto& [path, lastModified] : lastModifiedByPath) {
+    json += R"({"path":")" + path + R"(","createTime":1,"lastModified":)" + std::to_string(lastModified) +
+            R"(,"validFrom":)" + std::to_string(lastModified) + R"(,"validUntil":"9999999999999","replicas":["alien:///x"],)" +
+            R"("metadata":{"lastModified":"1"},"CycleNumber":"3"},)";
+  }
+  if (!lastModifiedByPath.empty()) {
+    json.pop_back();
+  }
+  json += R"(],"subfolders":[]})";
+  return json;
+}
+} // namespace
+
+TEST_CASE("listing_watcher_parse")
+{
+  auto versions = ListingWatcher::parseListing(makeListing({ { "qc/TST/MO/task/a", 10 }, { "qc/TST/MO/task/b", 20 } }));
+  REQUIRE(versions.size() == 2);
+  CHECK(versions[0].path == "qc/TST/MO/task/a");
+  CHECK(versions[0].lastModified == 10);
+  CHECK(versions[0].validFrom == 10);
+  CHECK(versions[0].validUntil == 9999999999999);
+  CHECK(versions[0].cycleNumber == "3");
+  CHECK(versions[1].path == "qc/TST/MO/task/b");
+  CHECK(versions[1].lastModified == 20);
+
+  CHECK(ListingWatcher::parseListing(R"({"objects":[],"subfolders":["qc/TST"]})").empty());
+  CHECK(ListingWatcher::parseListing("not json").empty());
+}
+
+TEST_CASE("listing_watcher_escapes_folder")
+{
+  std::vector<std::string> requestedPatterns;
+  ListingWatcher watcher([&](const std::string& pattern, const std::map<std::string, std::string>&) {
+    requestedPatterns.push_back(pattern);
+    return makeListing({});
+  },
+                         std::chrono::milliseconds{ 0 });
+
+  watcher.subscribe("qc/TST/MO/task+v1.0/a", {});
+  watcher.subscribe("qc/TST/MO/(task)[0]/a", {});
+  REQUIRE(requestedPatterns.size() == 2);
+  CHECK(requestedPatterns[0] == R"(qc/TST/MO/task\+v1\.0/.*)");
+  CHECK(requestedPatterns[1] == R"(qc/TST/MO/\(task\)\[0\]/.*)");
+}
+
+TEST_CASE("listing_watcher_notifications")
+{
+  std::map<std::string, uint64_t> database{ { "qc/TST/MO/task/a", 10 } };
+  std::vector<std::string> requestedPatterns;
+  ListingWatcher watcher([&](const std::string& pattern, const std::map<std::string, std::string>&) {
+    requestedPatterns.push_back(pattern);
+    return makeListing(database);
+  },
+                         std::chrono::milliseconds{ 0 });
+
+  auto a = watcher.subscribe("qc/TST/MO/task/a", {});
+  auto b = watcher.subscribe("qc/TST/MO/task/b", {});
+  auto otherRun = watcher.subscribe("qc/TST/MO/task/a", { { "RunNumber", "2" } });
+  CHECK(requestedPatterns.front() == "qc/TST/MO/task/.*");
+
+  // the existing version is not notified
+  CHECK_FALSE(watcher.poll(a).has_value());
+  CHECK_FALSE(watcher.poll(b).has_value());
+
+  database["qc/TST/MO/task/a"] = 30;
+  database["qc/TST/MO/task/b"] = 40;
+  auto versionA = watcher.poll(a);
+  REQUIRE(versionA.has_value());
+  CHECK(versionA->lastModified == 30);
+  CHECK_FALSE(watcher.poll(a).has_value());
+  auto versionB = watcher.poll(b);
+  REQUIRE(versionB.has_value());
+  CHECK(versionB->lastModified == 40);
+  // the fake database ignores metadata
+  CHECK(watcher.poll(otherRun).has_value());
+
+  watcher.unsubscribe(a);
+  CHECK_FALSE(watcher.poll(a).has_value());
+  watcher.unsubscribe(b);
+  watcher.unsubscribe(otherRun);
+}
+
+TEST_CASE("listing_watcher_shared_refresh")
+{
+  size_t listings = 0;
+  uint64_t lastModified = 10;
+  ListingWatcher watcher([&](const std::string&, const std::map<std::string, std::string>&) {
+    listings++;
+    return makeListing({ { "qc/TST/MO/task/a", lastModified }, { "qc/TST/MO/task/b", lastModified } });
+  },
+                         std::chrono::milliseconds{ 200 });
+
+  std::vector<ListingWatcher::SubscriptionId> subscriptions;
+  for (int i = 0; i < 50; i++) {
+    subscriptions.push_back(watcher.subscribe(i % 2 ? "qc/TST/MO/task/a" : "qc/TST/MO/task/b", {}));
+  }
+  CHECK(listings == 1);
+
+  lastModified = 20;
+  std::this_thread::sleep_for(std::chrono::milliseconds{ 250 });
+  size_t notified = 0;
+  for (auto id : subscriptions) {
+    notified += watcher.poll(id).has_value();
+  }
+  // all the subscribers are notified with one listing of their folder
+  CHECK(notified == subscriptions.size());
+  CHECK(listings == 2);
+  CHECK(watcher.getListingCount() == 2);
+}
+
+TEST_CASE("listing_watcher_find_recent")
+{
+  size_t listings = 0;
+  ListingWatcher watcher([&](const std::string&, const std::map<std::string, std::string>&) {
+    listings++;
+    return makeListing({ { "qc/TST/MO/task/a", 10 } });
+  },
+                         std::chrono::milliseconds{ 200 });
+
+  auto id = watcher.subscribe("qc/TST/MO/task/a", { { "RunNumber", "1" } });
+  REQUIRE(listings == 1);
+
+  auto version = watcher.findRecent("qc/TST/MO/task/a", { { "RunNumber", "1" }, { "PeriodName", "LHC00a" } });
+  REQUIRE(version.has_value());
+  CHECK(version->lastModified == 10);
+  // the listing is filtered with metadata which are not requested, it might not contain all the matching objects
+  CHECK_FALSE(watcher.findRecent("qc/TST/MO/task/a", {}).has_value());
+  CHECK_FALSE(watcher.findRecent("qc/TST/MO/task/c", { { "RunNumber", "1" } }).has_value());
+  CHECK_FALSE(watcher.findRecent("qc/TST/MO/other/a", { { "RunNumber", "1" } }).has_value());
+
+  // an outdated listing is not used and not refreshed
+  std::this_thread::sleep_for(std::chrono::milliseconds{ 250 });
+  CHECK_FALSE(watcher.findRecent("qc/TST/MO/task/a", { { "RunNumber", "1" } }).has_value());
+  CHECK(listings == 1);
+  watcher.unsubscribe(id);
+}
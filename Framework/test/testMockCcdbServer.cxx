@@ -0,0 +1,219 @@
+// Copyright 2019-2022 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    testMockCcdbServer.cxx
+///
+
+#include "QualityControl/MockCcdbServer.h"
+#include "QualityControl/CcdbDatabase.h"
+#include "QualityControl/MonitorObject.h"
+#include "QualityControl/ObjectMetadataKeys.h"
+
+#include <TH1F.h>
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <unistd.h>
+
+#include <catch_amalgamated.hpp>
+
+using namespace o2::quality_control::core;
+using namespace o2::quality_control::repository;
+
+namespace
+{
+std::shared_ptr<MonitorObject> makeMonitorObject(const std::string& name, int entries, const Activity& activity)
+{
+  auto* histogram = new TH1F(name.c_str(), name.c_str(), 100, 0, 100);
+  histogram->FillRandom("gaus", entries);
+  auto mo = std::make_shared<MonitorObject>(histogram, "MockTask", "TestClass", "TST");
+  mo->setIsOwner(true);
+  mo->setActivity(activity);
+  return mo;
+}
+
+double getEntries(const std::shared_ptr<MonitorObject>& mo)
+{
+  return dynamic_cast<TH1*>(mo->getObject())->GetEntries();
+}
+} // namespace
+
+TEST_CASE("mock_ccdb_server_stores_uploads")
+{
+  MockCcdbServer server;
+  server.start();
+  REQUIRE(server.getPort() != 0);
+
+  CcdbDatabase database;
+  database.connect(server.getUrl(), "", "", "");
+
+  auto mo = makeMonitorObject("histogram", 1000, Activity(1, "NONE", "", "", "qc", { 1000, 2000 }));
+  database.storeMO(mo);
+  database.storeMO(mo);
+
+  auto statistics = server.getStatistics();
+  CHECK(statistics.storedObjects == 2);
+  CHECK(statistics.storedBytes > 0);
+  CHECK(server.getNumberOfObjects() == 2);
+  CHECK(database.getPublishedObjectNames("qc/TST/MO/MockTask") == std::vector<std::string>{ "/histogram" });
+
+  server.resetStatistics();
+  CHECK(server.getStatistics().storedObjects == 0);
+  server.stop();
+}
+
+TEST_CASE("mock_ccdb_server_retrieves_by_validity_and_metadata")
+{
+  MockCcdbServer server;
+  server.start();
+  CcdbDatabase database;
+  database.connect(server.getUrl(), "", "", "");
+
+  database.storeMO(makeMonitorObject("histogram", 100, Activity(1, "PHYSICS", "LHC00a", "apass1", "qc", { 1000, 2000 })));
+  database.storeMO(makeMonitorObject("histogram", 200, Activity(2, "PHYSICS", "LHC00a", "apass1", "qc", { 1500, 3000 })));
+
+  // the newest object valid at the timestamp
+  auto mo = database.retrieveMO("TST/MO/MockTask", "histogram", 1200);
+  REQUIRE(mo != nullptr);
+  CHECK(getEntries(mo) == 100);
+  mo = database.retrieveMO("TST/MO/MockTask", "histogram", 1600);
+  REQUIRE(mo != nullptr);
+  CHECK(getEntries(mo) == 200);
+  CHECK(mo->getActivity().mId == 2);
+  CHECK(mo->getActivity().mPeriodName == "LHC00a");
+  CHECK(database.retrieveMO("TST/MO/MockTask", "histogram", 5000) == nullptr);
+
+  // filtered with the metadata
+  mo = database.retrieveMO("TST/MO/MockTask", "histogram", 1600, Activity(1, "PHYSICS"));
+  REQUIRE(mo != nullptr);
+  CHECK(getEntries(mo) == 100);
+  CHECK(database.retrieveMO("TST/MO/MockTask", "histogram", 1600, Activity(3, "PHYSICS")) == nullptr);
+
+  auto headers = database.retrieveHeaders("qc/TST/MO/MockTask/histogram", {}, 1200);
+  CHECK(headers[metadata_keys::validFrom] == "1000");
+  CHECK(headers[metadata_keys::validUntil] == "2000");
+  CHECK(headers[metadata_keys::runNumber] == "1");
+  CHECK(headers.count(metadata_keys::created) == 1);
+
+  CHECK(server.getStatistics().retrievals >= 5);
+  server.stop();
+}
+
+TEST_CASE("mock_ccdb_server_lists_and_truncates")
+{
+  MockCcdbServer server;
+  server.start();
+  CcdbDatabase database;
+  database.connect(server.getUrl(), "", "", "");
+
+  for (int run = 1; run <= 3; run++) {
+    database.storeMO(makeMonitorObject("first", 10, Activity(run, "PHYSICS", "", "", "qc", { 1000L * run, 1000L * run + 500 })));
+    database.storeMO(makeMonitorObject("second", 10, Activity(run, "PHYSICS", "", "", "qc", { 1000L * run, 1000L * run + 500 })));
+  }
+
+  auto listing = database.getListingAsPtree("qc/TST/MO/MockTask/.*");
+  CHECK(listing.get_child("objects").size() == 6);
+  listing = database.getListingAsPtree("qc/TST/MO/MockTask/.*", {}, true);
+  CHECK(listing.get_child("objects").size() == 2);
+  listing = database.getListingAsPtree("qc/TST/MO/MockTask/first", { { metadata_keys::runNumber, "2" } });
+  REQUIRE(listing.get_child("objects").size() == 1);
+  CHECK(listing.get_child("objects").front().second.get<long>("validFrom") == 2000);
+
+  CHECK(database.getTimestampsForObject("qc/TST/MO/MockTask/first") == std::vector<uint64_t>{ 1000, 2000, 3000 });
+  CHECK(database.getLatestObjectValidity("qc/TST/MO/MockTask/second", {}) == ValidityInterval{ 3000, 3500 });
+  CHECK(database.getListing("qc/TST/MO") == std::vector<std::string>{ "qc/TST/MO/MockTask" });
+
+  database.truncate("qc/TST/MO/MockTask", "*");
+  CHECK(server.getNumberOfObjects() == 0);
+  CHECK(database.getPublishedObjectNames("qc/TST/MO/MockTask").empty());
+  server.stop();
+}
+
+TEST_CASE("mock_ccdb_server_keeps_objects_in_storage_directory")
+{
+  const auto directory = std::filesystem::temp_directory_path() / ("testMockCcdbServer_" + std::to_string(getpid()));
+  std::filesystem::remove_all(directory);
+  MockCcdbServer::Options options;
+  options.storageDirectory = directory.string();
+  {
+    MockCcdbServer server(options);
+    server.start();
+    CcdbDatabase database;
+    database.connect(server.getUrl(), "", "", "");
+    database.storeMO(makeMonitorObject("histogram", 123, Activity(1, "PHYSICS", "", "", "qc", { 1000, 2000 })));
+  }
+  {
+    MockCcdbServer server(options);
+    server.start();
+    CHECK(server.getNumberOfObjects() == 1);
+    CcdbDatabase database;
+    database.connect(server.getUrl(), "", "", "");
+    auto mo = database.retrieveMO("TST/MO/MockTask", "histogram", 1500);
+    REQUIRE(mo != nullptr);
+    CHECK(getEntries(mo) == 123);
+  }
+  std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("mock_ccdb_server_injects_errors")
+{
+  MockCcdbServer::Options options;
+  options.errorRate = 1;
+  MockCcdbServer server(options);
+  server.start();
+  CcdbDatabase database;
+  database.connect(server.getUrl(), "", "", "");
+
+  // the database is expected to survive a failing server
+  REQUIRE_NOTHROW(database.storeMO(makeMonitorObject("histogram", 10, Activity(1, "PHYSICS", "", "", "qc", { 1000, 2000 }))));
+  CHECK(database.retrieveMO("TST/MO/MockTask", "histogram", 1500) == nullptr);
+  CHECK(server.getNumberOfObjects() == 0);
+  CHECK(server.getStatistics().injectedErrors > 0);
+  CHECK(server.getStatistics().injectedErrors == server.getStatistics().requests);
+  server.stop();
+}
+
+TEST_CASE("mock_ccdb_server_benchmark", "[.][benchmark]")
+{
+  MockCcdbServer server;
+  server.start();
+  CcdbDatabase database;
+  database.connect(server.getUrl(), "", "", "");
+
+  const int nObjects = 100;
+  const int nVersions = 10;
+  std::vector<std::shared_ptr<MonitorObject>> objects;
+  for (int i = 0; i < nObjects; i++) {
+    objects.push_back(makeMonitorObject("histogram" + std::to_string(i), 1000, Activity(1, "PHYSICS")));
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (int version = 0; version < nVersions; version++) {
+    for (const auto& mo : objects) {
+      mo->setValidity({ 1000L * version, 1000L * (version + 1) });
+      database.storeMO(mo);
+    }
+  }
+  std::chrono::duration<double> storage = std::chrono::steady_clock::now() - start;
+
+  const int nListings = 100;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < nListings; i++) {
+    database.getListingAsPtree("qc/TST/MO/MockTask/.*", { { metadata_keys::runNumber, "1" } }, true);
+  }
+  std::chrono::duration<double> listing = std::chrono::steady_clock::now() - start;
+
+  std::cout << "stored " << nObjects * nVersions / storage.count() << " objects/s, "
+            << nListings / listing.count() << " listings/s of " << nObjects << " objects among " << server.getNumberOfObjects() << std::endl;
+  server.stop();
+}
@@ -22,9 +22,16 @@
 #include <TH1I.h>
 #include <TH2I.h>
 #include <TH2I.h>
+#include <TH1D.h>
+#include <TH2F.h>
+#include <TBufferFile.h>
+#include <TROOT.h>
 #include <Mergers/CustomMergeableTObject.h>
 #include <Mergers/MergerAlgorithm.h>
 
+#include <algorithm>
+#include <string_view>
+
 #include <catch_amalgamated.hpp>
 
 using namespace o2::mergers;
@@ -274,4 +281,353 @@ TEST_CASE("monitor_object_collection_merge_cycle")
   REQUIRE(mergedCycle.value() == "2");
 }
 
+TEST_CASE("monitor_object_collection_merge_unchanged_marker")
+{
+  auto makeMO = [](TObject* obj) {
+    auto mo = new MonitorObject(obj, "task", "class", "DET");
+    mo->setIsOwner(true);
+    return mo;
+  };
+  auto makeMarker = [&](const char* name, ValidityInterval validity) {
+    auto marker = makeMO(new TNamed(name, name));
+    marker->addOrUpdateMetadata(repository::metadata_keys::qcUnchanged, "1");
+    marker->setValidity(validity);
+    return marker;
+  };
+
+  MonitorObjectCollection target;
+  target.SetOwner(true);
+  auto targetHisto = new TH1I("histo", "histo", 10, 0, 10);
+  targetHisto->Fill(5);
+  auto targetMO = makeMO(targetHisto);
+  targetMO->setValidity({ 10, 20 });
+  target.Add(targetMO);
+
+  MonitorObjectCollection other;
+  other.SetOwner(true);
+  other.Add(makeMarker("histo", { 20, 30 }));
+  other.Add(makeMarker("only marker", { 20, 30 }));
+
+  // the content is kept, the validity is extended
+  algorithm::merge(&target, &other);
+  CHECK(targetHisto->GetEntries() == 1);
+  CHECK(targetMO->getValidity() == ValidityInterval{ 10, 30 });
+  auto onlyMarker = dynamic_cast<MonitorObject*>(target.FindObject("only marker"));
+  REQUIRE(onlyMarker != nullptr);
+  CHECK(onlyMarker->isUnchangedMarker());
+
+  // an actual object replaces a marker
+  MonitorObjectCollection other2;
+  other2.SetOwner(true);
+  auto otherHisto = new TH1I("only marker", "only marker", 10, 0, 10);
+  otherHisto->Fill(1);
+  other2.Add(makeMO(otherHisto));
+  algorithm::merge(&target, &other2);
+  auto replaced = dynamic_cast<MonitorObject*>(target.FindObject("only marker"));
+  REQUIRE(replaced != nullptr);
+  CHECK(!replaced->isUnchangedMarker());
+  REQUIRE(dynamic_cast<TH1I*>(replaced->getObject()) != nullptr);
+  CHECK(dynamic_cast<TH1I*>(replaced->getObject())->GetEntries() == 1);
+}
+
+TEST_CASE("monitor_object_collection_name_index")
+{
+  MonitorObjectCollection moc;
+  moc.SetOwner(true);
+  auto makeMO = [](const std::string& name) {
+    auto mo = new MonitorObject(new TH1I(name.c_str(), name.c_str(), 10, 0, 10), "task", "class", "DET");
+    mo->setIsOwner(true);
+    return mo;
+  };
+
+  auto moA = makeMO("a");
+  auto moB = makeMO("b");
+  moc.Add(moA);
+  CHECK(moc.FindObject("a") == moA);
+  CHECK(moc.FindObject("b") == nullptr);
+  moc.Add(moB);
+  CHECK(moc.FindObject("b") == moB);
+
+  // removing
+  moc.Remove(moA);
+  moc.Compress();
+  CHECK(moc.FindObject("a") == nullptr);
+  CHECK(moc.FindObject("b") == moB);
+
+  // duplicates, the first one wins as in TObjArray
+  auto moB2 = makeMO("b");
+  moc.Add(moB2);
+  CHECK(moc.FindObject("b") == moB);
+  delete moc.Remove(moB);
+  CHECK(moc.FindObject("b") == moB2);
+
+  // copies share the objects and can be searched as well
+  MonitorObjectCollection copy(moc);
+  copy.SetOwner(false);
+  CHECK(copy.FindObject("b") == moB2);
+
+  // after streaming, the index has to be rebuilt
+  TBufferFile buffer(TBuffer::kWrite);
+  buffer.WriteObject(&moc);
+  buffer.SetReadMode();
+  buffer.SetBufferOffset(0);
+  std::unique_ptr<MonitorObjectCollection> deserialized(dynamic_cast<MonitorObjectCollection*>(buffer.ReadObject(MonitorObjectCollection::Class())));
+  REQUIRE(deserialized != nullptr);
+  auto deserializedB = deserialized->FindObject("b");
+  REQUIRE(deserializedB != nullptr);
+  CHECK(deserializedB == deserialized->At(0));
+  deserialized->postDeserialization();
+  CHECK(deserialized->FindObject("b") == deserializedB);
+
+  moc.Clear();
+  CHECK(moc.FindObject("b") == nullptr);
+}
+
+TEST_CASE("monitor_object_collection_name_index_ranges")
+{
+  MonitorObjectCollection moc;
+  moc.SetOwner(true);
+  auto makeMO = [](const std::string& name) {
+    auto mo = new MonitorObject(new TH1I(name.c_str(), name.c_str(), 10, 0, 10), "task", "class", "DET");
+    mo->setIsOwner(true);
+    return mo;
+  };
+  for (auto name : { "a", "b", "c", "d", "e" }) {
+    moc.Add(makeMO(name));
+  }
+  REQUIRE(moc.FindObject("a") != nullptr);
+
+  // replacing the content of a slot
+  auto moA2 = makeMO("a2");
+  auto moA = moc.At(0);
+  moc.AddAt(moA2, 0);
+  delete moA;
+  CHECK(moc.FindObject("a") == nullptr);
+  CHECK(moc.FindObject("a2") == moA2);
+
+  // removing a range of slots
+  auto moB = moc.At(1);
+  auto moC = moc.At(2);
+  moc.RemoveRange(1, 2);
+  delete moB;
+  delete moC;
+  CHECK(moc.FindObject("b") == nullptr);
+  CHECK(moc.FindObject("c") == nullptr);
+  CHECK(moc.FindObject("d") != nullptr);
+
+  // hiding the last slot, its object is not managed by the collection anymore
+  moc.Compress();
+  REQUIRE(moc.GetEntriesFast() == 3);
+  auto moE = moc.At(2);
+  REQUIRE(moc.FindObject("e") == moE);
+  moc.SetLast(1);
+  CHECK(moc.FindObject("e") == nullptr);
+  CHECK(moc.FindObject("d") != nullptr);
+  CHECK(moc.FindObject("a2") == moA2);
+  moc.RemoveAt(2);
+  delete moE;
+}
+
+TEST_CASE("monitor_object_collection_name_index_cleanups")
+{
+  MonitorObjectCollection moc;
+  moc.SetOwner(false);
+  auto makeMO = [](const std::string& name) {
+    auto mo = new MonitorObject(new TH1I(name.c_str(), name.c_str(), 10, 0, 10), "task", "class", "DET");
+    mo->setIsOwner(true);
+    mo->SetBit(kMustCleanup);
+    return mo;
+  };
+  auto moA = makeMO("a");
+  std::unique_ptr<MonitorObject> moB(makeMO("b"));
+  moc.Add(moA);
+  moc.Add(moB.get());
+  REQUIRE(moc.FindObject("a") == moA);
+
+  // ROOT removes the deleted objects from the collections in its list of cleanups
+  gROOT->GetListOfCleanups()->Add(&moc);
+  delete moA;
+  CHECK(moc.FindObject("a") == nullptr);
+  CHECK(moc.FindObject("b") == moB.get());
+  CHECK(moc.GetEntries() == 1);
+
+  // it can be called directly as well
+  moc.RecursiveRemove(moB.get());
+  CHECK(moc.FindObject("b") == nullptr);
+  CHECK(moc.GetEntries() == 0);
+  gROOT->GetListOfCleanups()->Remove(&moc);
+}
+
+TEST_CASE("monitor_object_collection_transport_encoding")
+{
+  MonitorObjectCollection moc;
+  moc.SetOwner(true);
+  moc.SetName("collection");
+  moc.setDetector("TST");
+  moc.setTaskName("task");
+  auto add = [&moc](TH1* histo) {
+    auto mo = new MonitorObject(histo, "task", "class", "TST");
+    mo->setIsOwner(true);
+    moc.Add(mo);
+    return histo;
+  };
+  // a mostly empty map, a full histogram and a weighted one
+  auto map = add(new TH2F("map", "map", 200, 0, 200, 200, 0, 200));
+  map->Fill(10, 10);
+  map->Fill(150, 42, 3);
+  auto full = add(new TH1I("full", "full", 100, 0, 100));
+  for (int i = 0; i < 100; i++) {
+    full->Fill(i, i + 1);
+  }
+  auto weighted = add(new TH1D("weighted", "weighted", 1000, 0, 1000));
+  weighted->Sumw2();
+  weighted->Fill(500, 0.5);
+
+  TBufferFile plain(TBuffer::kWrite);
+  plain.WriteObject(&moc);
+
+  auto roundTrip = [&](const MonitorObjectCollection::Encoding& encoding) {
+    auto encoded = moc.encode(encoding);
+    REQUIRE(encoded->isEncoded());
+    CHECK(encoded->GetEntries() == 0);
+    CHECK(std::string(encoded->GetName()) == "collection");
+    CHECK(encoded->getTaskName() == "task");
+
+    TBufferFile buffer(TBuffer::kWrite);
+    buffer.WriteObject(encoded.get());
+    buffer.SetReadMode();
+    buffer.SetBufferOffset(0);
+    std::unique_ptr<MonitorObjectCollection> received(dynamic_cast<MonitorObjectCollection*>(buffer.ReadObject(MonitorObjectCollection::Class())));
+    REQUIRE(received != nullptr);
+    received->postDeserialization();
+    CHECK(!received->isEncoded());
+    REQUIRE(received->GetEntries() == 3);
+    CHECK(received->getDetector() == "TST");
+    for (auto original : { map, full, weighted }) {
+      auto mo = dynamic_cast<MonitorObject*>(received->FindObject(original->GetName()));
+      REQUIRE(mo != nullptr);
+      CHECK(mo->isIsOwner());
+      auto histo = dynamic_cast<TH1*>(mo->getObject());
+      REQUIRE(histo != nullptr);
+      CHECK(histo->GetNcells() == original->GetNcells());
+      CHECK(histo->GetEntries() == original->GetEntries());
+      CHECK(histo->GetSumw2N() == original->GetSumw2N());
+      for (int bin = 0; bin < original->GetNcells(); bin++) {
+        REQUIRE(histo->GetBinContent(bin) == original->GetBinContent(bin));
+        REQUIRE(histo->GetBinError(bin) == Catch::Approx(original->GetBinError(bin)));
+      }
+    }
+    return buffer.Length();
+  };
+
+  SECTION("sparse histograms")
+  {
+    auto size = roundTrip({ MonitorObjectCollection::Encoding::Compression::None, 1, 0.01 });
+    CHECK(size < plain.Length() / 10);
+    // the sent objects are restored after encoding
+    CHECK(map->GetBinContent(map->FindBin(150, 42)) == 3);
+    CHECK(map->GetSize() == 202 * 202);
+    CHECK(weighted->GetSumw2N() == 1002);
+  }
+
+  SECTION("compression algorithms")
+  {
+    using Compression = MonitorObjectCollection::Encoding::Compression;
+    for (auto compression : { Compression::Zlib, Compression::LZMA, Compression::LZ4, Compression::ZSTD }) {
+      auto size = roundTrip({ compression, 1, 0 });
+      CHECK(size < plain.Length());
+    }
+    roundTrip({ Compression::ZSTD, 9, 0.5 });
+  }
+
+  SECTION("compression names")
+  {
+    CHECK(MonitorObjectCollection::Encoding::compressionFromString("zstd") == MonitorObjectCollection::Encoding::Compression::ZSTD);
+    CHECK(MonitorObjectCollection::Encoding::compressionFromString("none") == MonitorObjectCollection::Encoding::Compression::None);
+    CHECK_THROWS(MonitorObjectCollection::Encoding::compressionFromString("gzip"));
+    CHECK(!MonitorObjectCollection::Encoding{}.isEnabled());
+  }
+}
+
+TEST_CASE("monitor_object_collection_corrupted_encoding")
+{
+  MonitorObjectCollection moc;
+  moc.SetOwner(true);
+  auto histo = new TH1I("histo", "histo", 100, 0, 100);
+  histo->Fill(42);
+  auto mo = new MonitorObject(histo, "task", "class", "TST");
+  mo->setIsOwner(true);
+  moc.Add(mo);
+
+  auto encoded = moc.encode({ MonitorObjectCollection::Encoding::Compression::ZSTD, 1, 0 });
+  TBufferFile buffer(TBuffer::kWrite);
+  buffer.WriteObject(encoded.get());
+  std::vector<char> data(buffer.Buffer(), buffer.Buffer() + buffer.Length());
+  // the compressed block starts with the name of the algorithm, its method and its compressed size, which we break
+  auto header = std::string_view(data.data(), data.size()).find("ZS");
+  REQUIRE(header != std::string_view::npos);
+  std::fill_n(data.begin() + header + 3, 3, '\xff');
+
+  auto receive = [&data]() {
+    TBufferFile input(TBuffer::kRead, static_cast<Int_t>(data.size()), data.data(), false);
+    return std::unique_ptr<MonitorObjectCollection>(dynamic_cast<MonitorObjectCollection*>(input.ReadObject(MonitorObjectCollection::Class())));
+  };
+
+  auto received = receive();
+  REQUIRE(received != nullptr);
+  REQUIRE(received->isEncoded());
+  CHECK_THROWS(received->decode());
+  CHECK(!received->isEncoded());
+  CHECK(received->GetEntries() == 0);
+
+  // Mergers lose the objects, but keep running
+  received = receive();
+  REQUIRE(received != nullptr);
+  CHECK_NOTHROW(received->postDeserialization());
+  CHECK(!received->isEncoded());
+  CHECK(received->GetEntries() == 0);
+}
+
+TEST_CASE("monitor_object_collection_benchmark", "[.][benchmark]")
+{
+  // run with: o2-qc-test-core "[benchmark]"
+  constexpr size_t nObjects = 10000;
+  auto makeCollection = [](const std::string& title) {
+    auto moc = std::make_unique<MonitorObjectCollection>();
+    moc->SetOwner(true);
+    for (size_t i = 0; i < nObjects; i++) {
+      auto name = "histo_" + std::to_string(i);
+      auto mo = new MonitorObject(new TH1I(name.c_str(), title.c_str(), 10, 0, 10), "task", "class", "DET");
+      mo->setIsOwner(true);
+      moc->Add(mo);
+    }
+    return moc;
+  };
+  auto target = makeCollection("target");
+  auto other = makeCollection("other");
+
+  BENCHMARK("find 10k objects, name index")
+  {
+    size_t found = 0;
+    for (auto obj : *other) {
+      found += target->FindObject(obj->GetName()) != nullptr;
+    }
+    return found;
+  };
+
+  BENCHMARK("find 10k objects, linear search")
+  {
+    size_t found = 0;
+    for (auto obj : *other) {
+      found += target->TObjArray::FindObject(obj->GetName()) != nullptr;
+    }
+    return found;
+  };
+
+  BENCHMARK("merge 10k objects")
+  {
+    target->merge(other.get());
+  };
+}
+
 } // namespace o2::quality_control::core
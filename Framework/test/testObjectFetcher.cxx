@@ -0,0 +1,98 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    testObjectFetcher.cxx
+///
+
+#include "QualityControl/ObjectFetcher.h"
+#include "QualityControl/DummyDatabase.h"
+#include "QualityControl/MonitorObject.h"
+#include "QualityControl/QualityObject.h"
+#include "QualityControl/Activity.h"
+
+#include <TH1F.h>
+#include <algorithm>
+#include <thread>
+
+#include <catch_amalgamated.hpp>
+
+using namespace o2::quality_control::core;
+using namespace o2::quality_control::repository;
+using namespace o2::quality_control::postprocessing;
+
+namespace
+{
+// returns an MO named as requested, or a QO
+class ReturningDatabase : public DummyDatabase
+{
+ public:
+  std::shared_ptr<MonitorObject> retrieveMO(std::string, std::string objectName, long, const Activity&, const std::map<std::string, std::string>&) override
+  {
+    auto mo = std::make_shared<MonitorObject>(new TH1F(objectName.c_str(), objectName.c_str(), 10, 0, 10), "task", "class", "TST");
+    mo->setIsOwner(true);
+    return mo;
+  }
+  std::shared_ptr<QualityObject> retrieveQO(std::string, long, const Activity&, const std::map<std::string, std::string>&) override
+  {
+    return std::make_shared<QualityObject>(Quality::Good, "check");
+  }
+};
+
+std::vector<ObjectFetcher::Request> makeRequests(size_t n)
+{
+  std::vector<ObjectFetcher::Request> requests;
+  for (size_t i = 0; i < n; i++) {
+    requests.push_back({ "qc/TST/MO/task", "object" + std::to_string(i), i % 2 ? ObjectFetcher::Request::Type::QualityObject : ObjectFetcher::Request::Type::MonitorObject });
+  }
+  return requests;
+}
+} // namespace
+
+TEST_CASE("object_fetcher_sequential")
+{
+  ObjectFetcher fetcher(1, {});
+  ReturningDatabase qcdb;
+  auto requests = makeRequests(4);
+  std::vector<size_t> order;
+  fetcher.fetch(requests, 1000, {}, {}, qcdb, [&](size_t i, ObjectFetcher::Result&& result) {
+    order.push_back(i);
+    if (i % 2) {
+      CHECK(result.qo != nullptr);
+    } else {
+      REQUIRE(result.mo != nullptr);
+      CHECK(result.mo->getName() == requests[i].name);
+    }
+  });
+  CHECK(order == std::vector<size_t>{ 0, 1, 2, 3 });
+}
+
+TEST_CASE("object_fetcher_concurrent")
+{
+  // without a complete database configuration, it falls back to sequential retrieval
+  CHECK(ObjectFetcher(4, {}).getParallelism() == 1);
+
+  ObjectFetcher fetcher(4, { { "implementation", "Dummy" }, { "host", "" } });
+  CHECK(fetcher.getParallelism() == 4);
+  DummyDatabase qcdb;
+  auto requests = makeRequests(50);
+  std::vector<int> calls(requests.size(), 0);
+  auto callingThread = std::this_thread::get_id();
+  fetcher.fetch(requests, 1000, {}, {}, qcdb, [&](size_t i, ObjectFetcher::Result&& result) {
+    CHECK(std::this_thread::get_id() == callingThread);
+    CHECK(result.mo == nullptr);
+    calls[i]++;
+  });
+  CHECK(std::all_of(calls.begin(), calls.end(), [](int c) { return c == 1; }));
+
+  // an exception in the callback is forwarded once all the objects arrived
+  CHECK_THROWS_AS(fetcher.fetch(requests, 1000, {}, {}, qcdb, [](size_t, ObjectFetcher::Result&&) { throw std::runtime_error("failure"); }), std::runtime_error);
+}
@@ -15,6 +15,8 @@
 ///
 
 #include "QualityControl/ObjectsManager.h"
+#include "QualityControl/MonitorObjectCollection.h"
+#include "QualityControl/ObjectMetadataKeys.h"
 
 #define BOOST_TEST_MODULE ObjectManager test
 #define BOOST_TEST_MAIN
@@ -217,4 +219,186 @@ BOOST_AUTO_TEST_CASE(feed_with_nullptr)
   BOOST_CHECK_NO_THROW(objectsManager.stopPublishing(nullptr));
 }
 
+BOOST_AUTO_TEST_CASE(unchanged_objects_test)
+{
+  Config config;
+  ObjectsManager objectsManager(config.taskName, config.taskClass, config.detectorName, 0);
+
+  TH1F h("histo", "h", 100, 0, 99);
+  TObjString s("content");
+  objectsManager.startPublishing(&h, PublicationPolicy::Forever);
+  objectsManager.startPublishing(&s, PublicationPolicy::Forever);
+
+  BOOST_CHECK(ObjectsManager::contentChecksum(&h).has_value());
+  BOOST_CHECK(!ObjectsManager::contentChecksum(&s).has_value());
+  BOOST_CHECK(ObjectsManager::contentSummary(&h).has_value());
+  BOOST_CHECK(!ObjectsManager::contentSummary(&s).has_value());
+
+  // the first publication contains everything
+  size_t unchanged = 0;
+  std::unique_ptr<MonitorObjectCollection> array(objectsManager.getNonOwningArrayOfChangedObjects(false, unchanged));
+  BOOST_CHECK_EQUAL(unchanged, 0);
+  BOOST_CHECK_EQUAL(array->GetEntries(), 2);
+  BOOST_CHECK(!dynamic_cast<MonitorObject*>(array->FindObject("histo"))->isUnchangedMarker());
+
+  // the summary did not change, but the checksum of the previous content is not known, so it is published again
+  array.reset(objectsManager.getNonOwningArrayOfChangedObjects(false, unchanged));
+  BOOST_CHECK_EQUAL(unchanged, 0);
+
+  // the histogram did not change, it is replaced by a marker. The string is always published.
+  array.reset(objectsManager.getNonOwningArrayOfChangedObjects(false, unchanged));
+  BOOST_CHECK_EQUAL(unchanged, 1);
+  BOOST_CHECK_EQUAL(array->GetEntries(), 2);
+  auto marker = dynamic_cast<MonitorObject*>(array->FindObject("histo"));
+  BOOST_REQUIRE(marker != nullptr);
+  BOOST_CHECK(marker->isUnchangedMarker());
+  BOOST_CHECK(marker != objectsManager.getMonitorObject("histo"));
+  BOOST_CHECK(!dynamic_cast<MonitorObject*>(array->FindObject("content"))->isUnchangedMarker());
+
+  h.Fill(5);
+  array.reset(objectsManager.getNonOwningArrayOfChangedObjects(false, unchanged));
+  BOOST_CHECK_EQUAL(unchanged, 0);
+  BOOST_CHECK(array->FindObject("histo") == objectsManager.getMonitorObject("histo"));
+
+  // non-empty objects are published anyway when they are deltas
+  array.reset(objectsManager.getNonOwningArrayOfChangedObjects(true, unchanged));
+  BOOST_CHECK_EQUAL(unchanged, 0);
+  h.Reset();
+  array.reset(objectsManager.getNonOwningArrayOfChangedObjects(true, unchanged));
+  BOOST_CHECK_EQUAL(unchanged, 0);
+  array.reset(objectsManager.getNonOwningArrayOfChangedObjects(true, unchanged));
+  BOOST_CHECK_EQUAL(unchanged, 0);
+  array.reset(objectsManager.getNonOwningArrayOfChangedObjects(true, unchanged));
+  BOOST_CHECK_EQUAL(unchanged, 1);
+
+  // e.g. after the Mergers reset
+  objectsManager.forceFullPublication();
+  array.reset(objectsManager.getNonOwningArrayOfChangedObjects(true, unchanged));
+  BOOST_CHECK_EQUAL(unchanged, 0);
+  array.reset(objectsManager.getNonOwningArrayOfChangedObjects(true, unchanged));
+  BOOST_CHECK_EQUAL(unchanged, 1);
+
+  // a new activity starts with a complete publication
+  objectsManager.setActivity(Activity{});
+  array.reset(objectsManager.getNonOwningArrayOfChangedObjects(false, unchanged));
+  BOOST_CHECK_EQUAL(unchanged, 0);
+}
+
+BOOST_AUTO_TEST_CASE(serialization_cost_test)
+{
+  Config config;
+  ObjectsManager objectsManager(config.taskName, config.taskClass, config.detectorName, 0);
+
+  TH1F small("small", "small", 10, 0, 10);
+  TH1F big("big", "big", 10000, 0, 10000);
+  TObjString s("content");
+  objectsManager.startPublishing(&small, PublicationPolicy::Forever);
+  objectsManager.startPublishing(&big, PublicationPolicy::Forever);
+  objectsManager.startPublishing(&s, PublicationPolicy::Forever);
+
+  std::unique_ptr<MonitorObjectCollection> array(objectsManager.getNonOwningArray());
+  auto costs = ObjectsManager::measureSerialization(*array);
+  BOOST_REQUIRE_EQUAL(costs.size(), 3);
+  BOOST_CHECK_EQUAL(costs[0].object, objectsManager.getMonitorObject("small"));
+  BOOST_CHECK_GT(costs[1].bytes, 10000 * sizeof(float));
+  BOOST_CHECK_GT(costs[1].bytes, costs[0].bytes);
+  for (const auto& cost : costs) {
+    BOOST_CHECK_GT(cost.bytes, 0);
+    BOOST_CHECK_GE(cost.seconds, 0);
+    BOOST_CHECK_EQUAL(cost.object->getMetadataMap().at(repository::metadata_keys::qcSerializedSize), std::to_string(cost.bytes));
+    BOOST_CHECK(cost.object->getMetadataMap().count(repository::metadata_keys::qcStreamingTime) == 1);
+  }
+
+  // unchanged markers are not measured
+  size_t unchanged = 0;
+  array.reset(objectsManager.getNonOwningArrayOfChangedObjects(false, unchanged));
+  array.reset(objectsManager.getNonOwningArrayOfChangedObjects(false, unchanged));
+  BOOST_CHECK_EQUAL(unchanged, 2);
+  BOOST_CHECK_EQUAL(ObjectsManager::measureSerialization(*array).size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(publication_budget_test)
+{
+  Config config;
+  ObjectsManager objectsManager(config.taskName, config.taskClass, config.detectorName, 0);
+
+  TH1F small("small", "small", 10, 0, 10);
+  TH1F big("big", "big", 10000, 0, 10000);
+  TH1F bigger("bigger", "bigger", 20000, 0, 20000);
+  objectsManager.startPublishing(&small, PublicationPolicy::Forever);
+  objectsManager.startPublishing(&big, PublicationPolicy::Forever);
+  objectsManager.startPublishing(&bigger, PublicationPolicy::Forever);
+
+  objectsManager.setLowPriority("small");
+  objectsManager.setLowPriority("big");
+  objectsManager.setLowPriority("bigger");
+  objectsManager.setLowPriority("bigger", false);
+  BOOST_CHECK(objectsManager.isLowPriority("small"));
+  BOOST_CHECK(!objectsManager.isLowPriority("bigger"));
+
+  std::unique_ptr<MonitorObjectCollection> array(objectsManager.getNonOwningArray());
+  auto costs = ObjectsManager::measureSerialization(*array);
+  size_t total = costs[0].bytes + costs[1].bytes + costs[2].bytes;
+
+  // within the budget, nothing is dropped
+  BOOST_CHECK(objectsManager.enforceBudget(*array, costs, total).empty());
+  BOOST_CHECK_EQUAL(array->GetEntries(), 3);
+
+  // the biggest low priority object is dropped first, then the next one
+  auto dropped = objectsManager.enforceBudget(*array, costs, total - 1);
+  BOOST_REQUIRE_EQUAL(dropped.size(), 1);
+  BOOST_CHECK_EQUAL(dropped[0], objectsManager.getMonitorObject("big"));
+  BOOST_CHECK_EQUAL(array->GetEntries(), 2);
+  BOOST_CHECK_EQUAL(array->GetEntriesFast(), 2);
+  BOOST_CHECK(array->FindObject("big") == nullptr);
+  BOOST_CHECK_EQUAL(costs.size(), 2);
+
+  // objects with a normal priority are never dropped
+  dropped = objectsManager.enforceBudget(*array, costs, 1);
+  BOOST_REQUIRE_EQUAL(dropped.size(), 1);
+  BOOST_CHECK_EQUAL(dropped[0], objectsManager.getMonitorObject("small"));
+  BOOST_CHECK_EQUAL(array->GetEntries(), 1);
+  BOOST_CHECK(array->FindObject("bigger") != nullptr);
+  // the objects themselves are still managed
+  BOOST_CHECK_EQUAL(objectsManager.getNumberPublishedObjects(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(publication_budget_with_unchanged_objects_test)
+{
+  Config config;
+  ObjectsManager objectsManager(config.taskName, config.taskClass, config.detectorName, 0);
+
+  TH1F small("small", "small", 10, 0, 10);
+  TH1F big("big", "big", 10000, 0, 10000);
+  small.Fill(1);
+  big.Fill(1);
+  objectsManager.startPublishing(&small, PublicationPolicy::Forever);
+  objectsManager.startPublishing(&big, PublicationPolicy::Forever);
+  objectsManager.setLowPriority("big");
+
+  // the objects are published twice before being replaced by markers, since their checksums are not known yet
+  size_t unchanged = 0;
+  std::unique_ptr<MonitorObjectCollection> array(objectsManager.getNonOwningArrayOfChangedObjects(false, unchanged));
+  array.reset(objectsManager.getNonOwningArrayOfChangedObjects(false, unchanged));
+  BOOST_CHECK_EQUAL(unchanged, 0);
+
+  // the second publication is over budget, the big object is dropped
+  auto costs = ObjectsManager::measureSerialization(*array);
+  BOOST_REQUIRE_EQUAL(costs.size(), 2);
+  auto dropped = objectsManager.enforceBudget(*array, costs, costs[0].bytes);
+  BOOST_REQUIRE_EQUAL(dropped.size(), 1);
+  BOOST_CHECK_EQUAL(dropped[0], objectsManager.getMonitorObject("big"));
+
+  // the last content of the dropped object was not received, thus it is published in full even if it did not change
+  array.reset(objectsManager.getNonOwningArrayOfChangedObjects(false, unchanged));
+  BOOST_CHECK_EQUAL(unchanged, 1);
+  BOOST_CHECK(dynamic_cast<MonitorObject*>(array->FindObject("small"))->isUnchangedMarker());
+  BOOST_CHECK_EQUAL(array->FindObject("big"), objectsManager.getMonitorObject("big"));
+
+  // it is replaced by a marker again once its checksum is known
+  array.reset(objectsManager.getNonOwningArrayOfChangedObjects(false, unchanged));
+  array.reset(objectsManager.getNonOwningArrayOfChangedObjects(false, unchanged));
+  BOOST_CHECK_EQUAL(unchanged, 2);
+}
+
 } // namespace o2::quality_control::core
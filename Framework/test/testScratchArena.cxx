@@ -0,0 +1,176 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    testScratchArena.cxx
+///
+
+#include "QualityControl/ScratchArena.h"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <catch_amalgamated.hpp>
+
+using namespace o2::quality_control::core;
+
+namespace
+{
+// counts the allocations reaching the upstream resource
+class CountingResource : public std::pmr::memory_resource
+{
+ public:
+  size_t allocations = 0;
+  size_t deallocations = 0;
+
+ protected:
+  void* do_allocate(size_t bytes, size_t alignment) override
+  {
+    allocations++;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override
+  {
+    deallocations++;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+// mimics the scratch structures built by the tasks for one time frame
+template <template <typename> typename Vector, typename Set, typename Map>
+size_t processTimeFrame(Vector<Vector<int>>& staves, Set& set, Map& map, size_t size)
+{
+  staves.resize(48);
+  for (size_t i = 0; i < size; i++) {
+    staves[i % staves.size()].push_back(i);
+    set.insert(i % 200);
+    map[i % 200] += i;
+  }
+  return set.size() + map.size() + staves.back().size();
+}
+
+template <typename T>
+using PmrVector = std::pmr::vector<T>;
+template <typename T>
+using StdVector = std::vector<T>;
+} // namespace
+
+TEST_CASE("scratch_arena_alignment")
+{
+  ScratchArena arena(1024);
+  for (size_t alignment : { 1, 2, 4, 8, 16, 32, 64, 4096 }) {
+    void* p = arena.allocate(3, alignment);
+    CHECK(reinterpret_cast<uintptr_t>(p) % alignment == 0);
+  }
+  // bigger than a chunk
+  auto* big = static_cast<char*>(arena.allocate(100000, 64));
+  CHECK(reinterpret_cast<uintptr_t>(big) % 64 == 0);
+  big[0] = big[99999] = 1;
+}
+
+TEST_CASE("scratch_arena_reset")
+{
+  CountingResource upstream;
+  {
+    ScratchArena arena(1024, &upstream);
+    CHECK(arena.getStats().capacity == 0);
+
+    // the first time frame grows the arena over several chunks
+    for (int i = 0; i < 100; i++) {
+      CHECK(arena.allocate(100) != nullptr);
+    }
+    CHECK(upstream.allocations > 1);
+    CHECK(arena.getStats().bytesInUse >= 10000);
+    auto capacity = arena.getStats().capacity;
+    arena.reset();
+    CHECK(arena.getStats().bytesInUse == 0);
+    CHECK(arena.getStats().capacity == capacity);
+    CHECK(arena.getStats().highWaterMark >= 10000);
+    CHECK(upstream.allocations == upstream.deallocations + 1);
+
+    // the next ones fit in the single coalesced chunk
+    auto upstreamAllocations = upstream.allocations;
+    for (int tf = 0; tf < 10; tf++) {
+      for (int i = 0; i < 100; i++) {
+        CHECK(arena.allocate(100) != nullptr);
+      }
+      arena.reset();
+    }
+    CHECK(upstream.allocations == upstreamAllocations);
+    CHECK(arena.getStats().allocations == 1100);
+
+    arena.release();
+    CHECK(arena.getStats().capacity == 0);
+    CHECK(upstream.allocations == upstream.deallocations);
+    CHECK(arena.allocate(10) != nullptr);
+  }
+  // everything is returned in the destructor
+  CHECK(upstream.allocations == upstream.deallocations);
+}
+
+TEST_CASE("scratch_arena_containers")
+{
+  ScratchArena arena;
+  {
+    std::pmr::unsynchronized_pool_resource pool(&arena);
+    std::pmr::vector<std::pmr::vector<int>> staves(&arena);
+    std::pmr::set<int> set(&pool);
+    std::pmr::map<int, size_t> map(&pool);
+    CHECK(processTimeFrame<PmrVector>(staves, set, map, 10000) == 400 + 10000 / 48);
+    // the inner vectors use the allocator of the outer one
+    CHECK(staves[0].get_allocator().resource() == &arena);
+    CHECK(map.at(0) == 200 * (49 * 50 / 2));
+  }
+  arena.reset();
+  CHECK(arena.getStats().bytesInUse == 0);
+}
+
+TEST_CASE("scratch_arena_benchmark", "[.][benchmark]")
+{
+  const size_t timeFrames = 1000;
+  const size_t size = 20000;
+  size_t result = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t tf = 0; tf < timeFrames; tf++) {
+    std::vector<std::vector<int>> staves;
+    std::set<int> set;
+    std::map<int, size_t> map;
+    result += processTimeFrame<StdVector>(staves, set, map, size);
+  }
+  auto heap = std::chrono::steady_clock::now() - start;
+
+  CountingResource upstream;
+  ScratchArena arena(64 * 1024, &upstream);
+  start = std::chrono::steady_clock::now();
+  for (size_t tf = 0; tf < timeFrames; tf++) {
+    {
+      std::pmr::unsynchronized_pool_resource pool(&arena);
+      std::pmr::vector<std::pmr::vector<int>> staves(&arena);
+      std::pmr::set<int> set(&pool);
+      std::pmr::map<int, size_t> map(&pool);
+      result -= processTimeFrame<PmrVector>(staves, set, map, size);
+    }
+    arena.reset();
+  }
+  auto scratch = std::chrono::steady_clock::now() - start;
+  CHECK(result == 0);
+
+  using std::chrono::microseconds;
+  std::cout << "heap:  " << std::chrono::duration_cast<microseconds>(heap).count() / timeFrames << " us per TF\n"
+            << "arena: " << std::chrono::duration_cast<microseconds>(scratch).count() / timeFrames << " us per TF, "
+            << arena.getStats().allocations << " allocations served with " << upstream.allocations << " upstream allocations, high water mark "
+            << arena.getStats().highWaterMark << " B" << std::endl;
+}
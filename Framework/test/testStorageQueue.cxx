@@ -0,0 +1,226 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    testStorageQueue.cxx
+///
+
+#include "QualityControl/StorageQueue.h"
+#include "QualityControl/DummyDatabase.h"
+#include "QualityControl/MonitorObject.h"
+#include "QualityControl/QualityObject.h"
+
+#include <TH1F.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include <catch_amalgamated.hpp>
+
+using namespace o2::quality_control::core;
+using namespace o2::quality_control::repository;
+
+namespace
+{
+
+// Counts the stored objects, optionally waits before returning or throws for the first attempts.
+class CountingDatabase : public DummyDatabase
+{
+ public:
+  CountingDatabase(std::atomic<int>& stored, std::atomic<int>& failuresLeft, std::chrono::milliseconds delay)
+    : mStored(stored), mFailuresLeft(failuresLeft), mDelay(delay) {}
+
+  void storeMO(std::shared_ptr<const MonitorObject>) override { store(); }
+  void storeQO(std::shared_ptr<const QualityObject>) override { store(); }
+
+ private:
+  void store()
+  {
+    std::this_thread::sleep_for(mDelay);
+    if (mFailuresLeft.fetch_sub(1) > 0) {
+      throw std::runtime_error("injected failure");
+    }
+    mStored++;
+  }
+
+  std::atomic<int>& mStored;
+  std::atomic<int>& mFailuresLeft;
+  std::chrono::milliseconds mDelay;
+};
+
+std::shared_ptr<MonitorObject> makeMO(const std::string& name)
+{
+  auto mo = std::make_shared<MonitorObject>(new TH1F(name.c_str(), name.c_str(), 10, 0, 10), "task", "class", "TST");
+  mo->setIsOwner(true);
+  return mo;
+}
+
+} // namespace
+
+TEST_CASE("storage_queue_config")
+{
+  auto defaultConfig = StorageQueueConfig::fromDatabaseConfig({ { "implementation", "CCDB" }, { "host", "localhost:8080" } });
+  CHECK(defaultConfig.enabled == false);
+
+  auto config = StorageQueueConfig::fromDatabaseConfig({ { "asyncStorage", "true" },
+                                                         { "asyncStorageThreads", "4" },
+                                                         { "asyncStorageMaxInFlight", "10" },
+                                                         { "asyncStorageBatchSize", "0" },
+                                                         { "asyncStorageRetries", "2" },
+                                                         { "asyncStorageOverflowPolicy", "block" } });
+  CHECK(config.enabled == true);
+  CHECK(config.threads == 4);
+  CHECK(config.maxInFlight == 10);
+  CHECK(config.batchSize == 1);
+  CHECK(config.retries == 2);
+  CHECK(config.overflow == StorageQueueConfig::OverflowPolicy::Block);
+
+  CHECK_THROWS(StorageQueueConfig::fromDatabaseConfig({ { "asyncStorageOverflowPolicy", "wait" } }));
+}
+
+TEST_CASE("storage_queue_stores_everything")
+{
+  std::atomic<int> stored = 0;
+  std::atomic<int> failuresLeft = 0;
+  StorageQueueConfig config;
+  config.enabled = true;
+  config.threads = 3;
+  config.maxInFlight = 100;
+  config.overflow = StorageQueueConfig::OverflowPolicy::Block;
+  StorageQueue queue(config, [&]() { return std::make_unique<CountingDatabase>(stored, failuresLeft, std::chrono::milliseconds(1)); });
+
+  for (int i = 0; i < 250; i++) {
+    CHECK(queue.push(std::shared_ptr<const MonitorObject>(makeMO("histo" + std::to_string(i)))));
+  }
+  CHECK(queue.push(std::make_shared<const QualityObject>(Quality::Good, "check")));
+  queue.flush();
+
+  CHECK(stored == 251);
+  CHECK(queue.getNumberInFlight() == 0);
+  CHECK(queue.getTotalStored() == 251);
+  CHECK(queue.getTotalDropped() == 0);
+}
+
+TEST_CASE("storage_queue_drops_when_full")
+{
+  std::atomic<int> stored = 0;
+  std::atomic<int> failuresLeft = 0;
+  StorageQueueConfig config;
+  config.enabled = true;
+  config.threads = 1;
+  config.maxInFlight = 2;
+  config.overflow = StorageQueueConfig::OverflowPolicy::Drop;
+  StorageQueue queue(config, [&]() { return std::make_unique<CountingDatabase>(stored, failuresLeft, std::chrono::milliseconds(100)); });
+
+  size_t accepted = 0;
+  for (int i = 0; i < 10; i++) {
+    accepted += queue.push(std::shared_ptr<const MonitorObject>(makeMO("histo" + std::to_string(i))));
+  }
+  queue.flush();
+
+  CHECK(accepted == 2);
+  CHECK(stored == 2);
+  CHECK(queue.getTotalDropped() == 8);
+}
+
+TEST_CASE("storage_queue_retries")
+{
+  std::atomic<int> stored = 0;
+  std::atomic<int> failuresLeft = 2;
+  StorageQueueConfig config;
+  config.enabled = true;
+  config.threads = 1;
+  config.retries = 1;
+  StorageQueue queue(config, [&]() { return std::make_unique<CountingDatabase>(stored, failuresLeft, std::chrono::milliseconds(0)); });
+
+  // the first object fails twice and exhausts its retries, the second one goes through at the first attempt
+  queue.push(std::shared_ptr<const MonitorObject>(makeMO("first")));
+  queue.flush();
+  queue.push(std::shared_ptr<const MonitorObject>(makeMO("second")));
+  queue.flush();
+
+  CHECK(stored == 1);
+  CHECK(queue.getTotalFailed() == 1);
+  CHECK(queue.getTotalStored() == 1);
+}
+
+TEST_CASE("storage_queue_after_previous")
+{
+  std::mutex mutex;
+  std::vector<std::string> order;
+  class RecordingDatabase : public DummyDatabase
+  {
+   public:
+    RecordingDatabase(std::mutex& mutex, std::vector<std::string>& order) : mMutex(mutex), mOrder(order) {}
+    void storeMO(std::shared_ptr<const MonitorObject> mo) override
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      std::lock_guard lock(mMutex);
+      mOrder.push_back(mo->getName());
+    }
+
+   private:
+    std::mutex& mMutex;
+    std::vector<std::string>& mOrder;
+  };
+
+  StorageQueueConfig config;
+  config.enabled = true;
+  config.threads = 4;
+  config.batchSize = 2;
+  config.maxInFlight = 100;
+  StorageQueue queue(config, [&]() { return std::make_unique<RecordingDatabase>(mutex, order); });
+
+  for (int i = 0; i < 20; i++) {
+    CHECK(queue.push(std::shared_ptr<const MonitorObject>(makeMO("before" + std::to_string(i)))));
+  }
+  CHECK(queue.pushAfterPrevious(makeMO("barrier")));
+  for (int i = 0; i < 20; i++) {
+    CHECK(queue.push(std::shared_ptr<const MonitorObject>(makeMO("after" + std::to_string(i)))));
+  }
+  queue.flush();
+
+  REQUIRE(order.size() == 41);
+  auto barrier = std::find(order.begin(), order.end(), "barrier");
+  REQUIRE(barrier != order.end());
+  // the objects pushed afterwards may be uploaded at the same time as the barrier, but not earlier
+  CHECK(std::all_of(order.begin(), barrier, [](const std::string& name) { return name.rfind("before", 0) == 0; }));
+  CHECK(std::distance(order.begin(), barrier) == 20);
+}
+
+TEST_CASE("storage_queue_after_previous_failures")
+{
+  std::atomic<int> stored = 0;
+  std::atomic<int> failuresLeft = 0;
+  StorageQueueConfig config;
+  config.enabled = true;
+  config.threads = 2;
+  config.maxInFlight = 2;
+  StorageQueue queue(config, [&]() { return std::make_unique<CountingDatabase>(stored, failuresLeft, std::chrono::milliseconds(50)); });
+
+  // nothing to wait for
+  CHECK(queue.pushAfterPrevious(makeMO("barrier1")));
+  queue.flush();
+
+  // the previous object fails, the barrier is uploaded anyway once it is done
+  failuresLeft = 1;
+  CHECK(queue.push(std::shared_ptr<const MonitorObject>(makeMO("failing"))));
+  CHECK(queue.pushAfterPrevious(makeMO("barrier2")));
+  // the queue is full, a barrier is dropped like any other object
+  CHECK_FALSE(queue.pushAfterPrevious(makeMO("barrier3")));
+  queue.flush();
+
+  CHECK(stored == 2);
+  CHECK(queue.getTotalFailed() == 1);
+  CHECK(queue.getTotalDropped() == 1);
+}
@@ -0,0 +1,187 @@
+// Copyright 2019-2022 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    testTaskProfiler.cxx
+///
+
+#include "QualityControl/TaskProfiler.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include <catch_amalgamated.hpp>
+
+using namespace o2::quality_control::core;
+
+TEST_CASE("latency_histogram_percentiles")
+{
+  LatencyHistogram histogram;
+  CHECK(histogram.getPercentile(0.5) == 0);
+
+  for (uint64_t i = 1; i <= 1000; i++) {
+    histogram.add(i * 1000);
+  }
+  CHECK(histogram.getCount() == 1000);
+  CHECK(histogram.getMax() == 1000000);
+  CHECK(histogram.getPercentile(0.5) == Catch::Approx(500000).epsilon(0.07));
+  CHECK(histogram.getPercentile(0.9) == Catch::Approx(900000).epsilon(0.07));
+  CHECK(histogram.getPercentile(0.99) == Catch::Approx(990000).epsilon(0.07));
+  CHECK(histogram.getPercentile(1) == 1000000);
+
+  // small and huge values
+  histogram.reset();
+  histogram.add(3);
+  CHECK(histogram.getPercentile(0.5) == 3);
+  histogram.add(UINT64_MAX);
+  CHECK(histogram.getMax() == UINT64_MAX);
+  CHECK(histogram.getPercentile(1) > UINT64_MAX / 2);
+}
+
+TEST_CASE("task_profiler_disabled")
+{
+  TaskProfiler profiler;
+  {
+    auto timer = profiler.scope("section");
+    CHECK(timer.stop() == 0);
+  }
+  CHECK(profiler.getStats().empty());
+}
+
+TEST_CASE("task_profiler_sections")
+{
+  TaskProfiler profiler;
+  profiler.configure(true);
+
+  for (int i = 0; i < 10; i++) {
+    auto timer = profiler.scope("outer");
+    {
+      auto inner = profiler.scope("inner", true);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  {
+    auto timer = profiler.scope("stopped");
+    CHECK(timer.stop() > 0);
+    CHECK(timer.stop() == 0); // recorded only once
+  }
+
+  auto stats = profiler.getStats();
+  REQUIRE(stats.size() == 3);
+  CHECK(stats[0].name == "outer");
+  CHECK(stats[1].name == "inner");
+  CHECK(stats[2].name == "stopped");
+  CHECK(stats[0].calls == 10);
+  CHECK(stats[1].calls == 10);
+  CHECK(stats[2].calls == 1);
+  CHECK(stats[1].p50 >= 0.001);
+  CHECK(stats[0].p50 >= stats[1].p50 * 0.9);
+  CHECK(stats[1].p50 <= stats[1].p90);
+  CHECK(stats[1].p90 <= stats[1].p99);
+  CHECK(stats[1].p99 <= stats[1].max);
+  // sleeping does not use the CPU
+  CHECK(stats[1].cpuTime < stats[1].p50 * 10);
+
+  profiler.resetCycle();
+  CHECK(profiler.getStats().empty());
+  {
+    auto timer = profiler.scope("inner");
+  }
+  REQUIRE(profiler.getStats().size() == 1);
+  CHECK(profiler.getStats()[0].calls == 1);
+}
+
+TEST_CASE("task_profiler_measures_heap")
+{
+  if (TaskProfiler::heapInUse() == 0) {
+    WARN("the heap usage is not available on this platform");
+    return;
+  }
+  TaskProfiler profiler;
+  profiler.configure(true);
+  std::vector<char> kept;
+  {
+    auto timer = profiler.scope("allocation", true);
+    kept.resize(10 * 1024 * 1024, 1);
+  }
+  CHECK(profiler.getStats()[0].heapGrowth >= 10 * 1024 * 1024);
+}
+
+TEST_CASE("task_profiler_threads")
+{
+  TaskProfiler profiler;
+  profiler.configure(true);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&profiler]() {
+      for (int i = 0; i < 1000; i++) {
+        auto timer = profiler.scope("work");
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  REQUIRE(profiler.getStats().size() == 1);
+  CHECK(profiler.getStats()[0].calls == 4000);
+}
+
+TEST_CASE("task_profiler_chrome_trace")
+{
+  const auto file = std::filesystem::temp_directory_path() / ("testTaskProfiler_" + std::to_string(getpid()) + ".json");
+  TaskProfiler profiler;
+  profiler.configure(true, file.string(), 3);
+  for (int i = 0; i < 5; i++) {
+    auto timer = profiler.scope(i % 2 ? "odd" : "even");
+  }
+  CHECK(profiler.getNumberOfTraceEvents() == 3);
+  REQUIRE(profiler.writeTrace("task \"name\""));
+
+  std::ifstream input(file);
+  std::string trace{ std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>() };
+  CHECK(trace.find(R"("traceEvents":[)") != std::string::npos);
+  CHECK(trace.find(R"("name":"task \"name\"")") != std::string::npos);
+  CHECK(trace.find(R"("name":"even","cat":"qc","ph":"X")") != std::string::npos);
+  CHECK(trace.find(R"("droppedEvents":2)") != std::string::npos);
+
+  profiler.clearTrace();
+  CHECK(profiler.getNumberOfTraceEvents() == 0);
+  std::filesystem::remove(file);
+
+  // no trace file, no events
+  profiler.configure(true);
+  {
+    auto timer = profiler.scope("section");
+  }
+  CHECK(profiler.getNumberOfTraceEvents() == 0);
+  CHECK_FALSE(profiler.writeTrace("task"));
+}
+
+TEST_CASE("task_profiler_benchmark", "[.][benchmark]")
+{
+  TaskProfiler profiler;
+  const int iterations = 1000000;
+  for (bool enabled : { false, true }) {
+    profiler.configure(enabled);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+      auto timer = profiler.scope("section");
+    }
+    std::chrono::duration<double, std::nano> duration = std::chrono::steady_clock::now() - start;
+    std::cout << "scoped timer " << (enabled ? "enabled" : "disabled") << ": " << duration.count() / iterations << " ns" << std::endl;
+  }
+}
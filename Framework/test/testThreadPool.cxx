@@ -0,0 +1,59 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    testThreadPool.cxx
+///
+
+#include "QualityControl/ThreadPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+
+#include <catch_amalgamated.hpp>
+
+using namespace o2::quality_control::core;
+
+TEST_CASE("thread_pool_executes_everything")
+{
+  std::atomic<int> executed = 0;
+  std::vector<std::future<int>> futures;
+  {
+    ThreadPool pool(4);
+    CHECK(pool.getNThreads() == 4);
+    for (int i = 0; i < 100; i++) {
+      futures.push_back(pool.submit([i, &executed]() {
+        executed++;
+        return i * i;
+      }));
+    }
+    for (int i = 0; i < 100; i++) {
+      CHECK(futures[i].get() == i * i);
+    }
+    // the remaining functions are executed before the destruction
+    for (int i = 0; i < 10; i++) {
+      pool.submit([&executed]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        executed++;
+      });
+    }
+  }
+  CHECK(executed == 110);
+}
+
+TEST_CASE("thread_pool_forwards_exceptions")
+{
+  ThreadPool pool(0); // at least one thread is created
+  CHECK(pool.getNThreads() == 1);
+  auto future = pool.submit([]() { throw std::runtime_error("failure"); });
+  CHECK_THROWS_AS(future.get(), std::runtime_error);
+}
@@ -68,8 +68,89 @@ struct ReductorConfigAccessor {
   friend type get(ReductorConfigAccessor);
 };
 
+struct ReferencesNameAccessor {
+  using type = bool (*)(const std::string&, const std::string&);
+  friend type get(ReferencesNameAccessor);
+};
+
+struct PlotRevisionAccessor {
+  using type = uint64_t (TrendingTask::*)(const TrendingTaskConfig::Plot&) const;
+  friend type get(PlotRevisionAccessor);
+};
+
+struct SourceRevisionsAccessor {
+  using type = std::unordered_map<std::string, uint64_t> TrendingTask::*;
+  friend type get(SourceRevisionsAccessor);
+};
+
+struct FilledEntriesAccessor {
+  using type = uint64_t TrendingTask::*;
+  friend type get(FilledEntriesAccessor);
+};
+
 template struct DeclareGlobalGet<TrendingTaskReductorAccessor, &TrendingTask::mReductors>;
 template struct DeclareGlobalGet<ReductorConfigAccessor, &Reductor::mCustomParameters>;
+template struct DeclareGlobalGet<ReferencesNameAccessor, &TrendingTask::referencesName>;
+template struct DeclareGlobalGet<PlotRevisionAccessor, &TrendingTask::getPlotRevision>;
+template struct DeclareGlobalGet<SourceRevisionsAccessor, &TrendingTask::mSourceRevisions>;
+template struct DeclareGlobalGet<FilledEntriesAccessor, &TrendingTask::mFilledEntries>;
+
+TEST_CASE("test_trending_task_references_name")
+{
+  auto referencesName = get(ReferencesNameAccessor{});
+  CHECK(referencesName("histo.mean:time", "histo"));
+  CHECK(referencesName("time:histo.mean", "histo"));
+  CHECK(referencesName("other.mean+histo.mean", "histo"));
+  CHECK(referencesName("histo", "histo"));
+  CHECK_FALSE(referencesName("", "histo"));
+  CHECK_FALSE(referencesName("histogram.mean:time", "histo"));
+  CHECK_FALSE(referencesName("myhisto.mean:time", "histo"));
+  CHECK_FALSE(referencesName("my_histo.mean:time", "histo"));
+  // the first occurrence is a part of another name, the second one is not
+  CHECK(referencesName("histo2.mean:histo.mean", "histo"));
+}
+
+TEST_CASE("test_trending_task_plot_revision")
+{
+  TrendingTask task;
+  auto getPlotRevision = get(PlotRevisionAccessor{});
+  auto& sourceRevisions = task.*get(SourceRevisionsAccessor{});
+  auto& filledEntries = task.*get(FilledEntriesAccessor{});
+
+  filledEntries = 2;
+  sourceRevisions = { { "a", 2 }, { "b", 5 } };
+
+  TrendingTaskConfig::Plot plot;
+  plot.graphs.push_back({});
+  auto& graph = plot.graphs.back();
+
+  graph.varexp = "a.mean:time";
+  CHECK((task.*getPlotRevision)(plot) == 4);
+  graph.varexp = "a.mean:b.mean";
+  CHECK((task.*getPlotRevision)(plot) == 9);
+  // the sources can also be used in the selection and in the errors
+  graph.varexp = "a.mean:time";
+  graph.selection = "b.entries > 0";
+  CHECK((task.*getPlotRevision)(plot) == 9);
+  graph.selection = "";
+  graph.errors = "b.stddev:0";
+  CHECK((task.*getPlotRevision)(plot) == 9);
+
+  // a source update changes the revision of the plots which use it
+  graph.errors = "";
+  sourceRevisions["b"]++;
+  CHECK((task.*getPlotRevision)(plot) == 4);
+  sourceRevisions["a"]++;
+  CHECK((task.*getPlotRevision)(plot) == 5);
+
+  // a new entry adds a point to all the plots, also when their sources were not updated (trendIfAllInputs: false)
+  filledEntries++;
+  CHECK((task.*getPlotRevision)(plot) == 6);
+  graph.varexp = "runNumber:time";
+  CHECK((task.*getPlotRevision)(plot) == 3);
+  filledEntries++;
+  CHECK((task.*getPlotRevision)(plot) == 4);
+}
 
 TEST_CASE("test_trending_task")
 {
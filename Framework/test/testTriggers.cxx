@@ -16,6 +16,7 @@
 
 #include "QualityControl/ObjectMetadataKeys.h"
 #include "QualityControl/Triggers.h"
+#include "QualityControl/ListingWatcher.h"
 
 #define BOOST_TEST_MODULE Triggers test
 #define BOOST_TEST_MAIN
@@ -24,20 +25,40 @@
 #include "QualityControl/MonitorObject.h"
 #include "QualityControl/DatabaseFactory.h"
 #include "QualityControl/CcdbDatabase.h"
+#include "QualityControl/MockCcdbServer.h"
 #include "QualityControl/RepoPathUtils.h"
 
 #include <CCDB/CcdbApi.h>
 #include <boost/test/unit_test.hpp>
 #include <TH1F.h>
+#include <TList.h>
 #include <cstdlib>
 #include <chrono>
+#include <memory>
+#include <thread>
 using namespace std::chrono;
 
 using namespace o2::quality_control::postprocessing;
 using namespace o2::quality_control::core;
 using namespace o2::quality_control::repository;
 
-const std::string CCDB_ENDPOINT = "ccdb-test.cern.ch:8080";
+// The triggers are tested against a QCDB served by this process, so that the tests do not depend on a remote host.
+std::unique_ptr<MockCcdbServer> gMockQcdb;
+std::string CCDB_ENDPOINT;
+
+struct MockQcdbFixture {
+  void setup()
+  {
+    gMockQcdb = std::make_unique<MockCcdbServer>();
+    gMockQcdb->start();
+    CCDB_ENDPOINT = gMockQcdb->getUrl();
+  }
+  void teardown()
+  {
+    gMockQcdb.reset();
+  }
+};
+BOOST_TEST_GLOBAL_FIXTURE(MockQcdbFixture);
 
 BOOST_AUTO_TEST_CASE(test_casting_triggers)
 {
@@ -112,6 +133,8 @@ BOOST_AUTO_TEST_CASE(test_trigger_new_object)
   validity_time_t currentTimestamp = CcdbDatabase::getCurrentTimestamp();
   mo->setValidity({ currentTimestamp, gInvalidValidityInterval.getMax() });
   repository->storeMO(mo);
+  // the listings are shared and refreshed at most once per period
+  std::this_thread::sleep_for(ListingWatcher::defaultRefreshPeriod);
 
   // Check after sending
   BOOST_CHECK_EQUAL(newObjectTrigger(), Trigger(TriggerType::NewObject, currentTimestamp));
@@ -123,6 +146,7 @@ BOOST_AUTO_TEST_CASE(test_trigger_new_object)
   currentTimestamp = CcdbDatabase::getCurrentTimestamp();
   mo->setValidity({ currentTimestamp, gInvalidValidityInterval.getMax() });
   repository->storeMO(mo);
+  std::this_thread::sleep_for(ListingWatcher::defaultRefreshPeriod);
 
   // Check after the update
   BOOST_CHECK_EQUAL(newObjectTrigger(), Trigger(TriggerType::NewObject, currentTimestamp));
@@ -133,6 +157,49 @@ BOOST_AUTO_TEST_CASE(test_trigger_new_object)
   directDBAPI->truncate(fullObjectPath);
 }
 
+BOOST_AUTO_TEST_CASE(test_trigger_new_object_waits_for_cycle_manifest)
+{
+  CcdbDatabase repository;
+  repository.connect(CCDB_ENDPOINT, "", "", "");
+
+  const std::string taskName = "testTriggersCycleManifest";
+  auto* obj = new TH1I("histo", "histo", 10, 0, 10.0);
+  auto mo = std::make_shared<MonitorObject>(obj, taskName, "TestClass", "TST");
+  mo->setIsOwner(true);
+  auto* names = new TList();
+  names->SetName(RepoPathUtils::cycleManifestName);
+  auto manifest = std::make_shared<MonitorObject>(names, taskName, "TestClass", "TST");
+  manifest->setIsOwner(true);
+
+  // the first cycle is stored before the trigger is created
+  validity_time_t currentTimestamp = CcdbDatabase::getCurrentTimestamp();
+  mo->setValidity({ currentTimestamp, gInvalidValidityInterval.getMax() });
+  repository.storeMO(mo);
+  manifest->setValidity({ currentTimestamp, gInvalidValidityInterval.getMax() });
+  repository.storeMO(manifest);
+
+  auto newObjectTrigger = triggers::NewObject(CCDB_ENDPOINT, "qcdb", RepoPathUtils::getMoPath(mo.get(), false));
+  BOOST_CHECK_EQUAL(newObjectTrigger(), TriggerType::No);
+
+  // the object of the next cycle is stored, but its manifest not yet
+  currentTimestamp = CcdbDatabase::getCurrentTimestamp();
+  mo->setValidity({ currentTimestamp, gInvalidValidityInterval.getMax() });
+  repository.storeMO(mo);
+  std::this_thread::sleep_for(ListingWatcher::defaultRefreshPeriod);
+  auto before = steady_clock::now();
+  BOOST_CHECK_EQUAL(newObjectTrigger(), TriggerType::No);
+  // the trigger does not wait for the manifest
+  BOOST_CHECK(steady_clock::now() - before < ListingWatcher::defaultRefreshPeriod);
+  BOOST_CHECK_EQUAL(newObjectTrigger(), TriggerType::No);
+
+  // once the manifest is stored, the pending version triggers
+  manifest->setValidity({ currentTimestamp, gInvalidValidityInterval.getMax() });
+  repository.storeMO(manifest);
+  std::this_thread::sleep_for(ListingWatcher::defaultRefreshPeriod);
+  BOOST_CHECK_EQUAL(newObjectTrigger(), Trigger(TriggerType::NewObject, currentTimestamp));
+  BOOST_CHECK_EQUAL(newObjectTrigger(), TriggerType::No);
+}
+
 BOOST_AUTO_TEST_CASE(test_trigger_for_each_object)
 {
   // Setup and initialise objects
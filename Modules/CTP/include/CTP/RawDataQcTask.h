@@ -54,6 +54,9 @@ class CTPRawDataReaderTask final : public TaskInterface
 
  private:
   o2::ctp::RawDataDecoder mDecoder;                              // ctp raw data decoder
+  std::vector<o2::framework::InputSpec> mDecoderFilter;          // inputs read by the decoder
+  std::vector<o2::ctp::LumiInfo> mLumiPointsHBF1;                // decoder output, cleared and reused at each TF
+  std::vector<o2::ctp::CTPDigit> mOutputDigits;                  // decoder output, cleared and reused at each TF
   std::unique_ptr<TH1DRatio> mHistoInputs = nullptr;             // histogram with ctp inputs
   std::unique_ptr<TH1DRatio> mHistoClasses = nullptr;            // histogram with ctp classes
   std::unique_ptr<TH1DRatio> mHistoInputRatios = nullptr;        // histogram with ctp input ratios to MB
@@ -299,9 +299,12 @@ void CTPRawDataReaderTask::monitorData(o2::framework::ProcessingContext& ctx)
   static constexpr double sOrbitLengthInMS = o2::constants::lhc::LHCOrbitMUS / 1000;
   auto nOrbitsPerTF = 32.;
   //   get the input
-  std::vector<o2::framework::InputSpec> filter{ o2::framework::InputSpec{ "filter", o2::framework::ConcreteDataTypeMatcher{ "DS", "CTPRAWDATA" }, o2::framework::Lifetime::Timeframe } };
-  std::vector<o2::ctp::LumiInfo> lumiPointsHBF1;
-  std::vector<o2::ctp::CTPDigit> outputDigits;
+  // the decoder needs std::vectors, they are kept across TFs so that their memory is reused
+  if (mDecoderFilter.empty()) {
+    mDecoderFilter.emplace_back("filter", o2::framework::ConcreteDataTypeMatcher{ "DS", "CTPRAWDATA" }, o2::framework::Lifetime::Timeframe);
+  }
+  mLumiPointsHBF1.clear();
+  mOutputDigits.clear();
 
   if (mReadCTPconfigInMonitorData) {
     if (mCTPconfig == nullptr) {
@@ -338,7 +341,7 @@ void CTPRawDataReaderTask::monitorData(o2::framework::ProcessingContext& ctx)
   }
 
   o2::framework::InputRecord& inputs = ctx.inputs();
-  int ret = mDecoder.decodeRaw(inputs, filter, outputDigits, lumiPointsHBF1);
+  int ret = mDecoder.decodeRaw(inputs, mDecoderFilter, mOutputDigits, mLumiPointsHBF1);
   mClassErrorsA = mDecoder.getClassErrorsA();
   if (mPerformConsistencyCheck) {
     for (size_t i = 0; i < o2::ctp::CTP_NCLASSES; i++) {
@@ -349,7 +352,7 @@ void CTPRawDataReaderTask::monitorData(o2::framework::ProcessingContext& ctx)
   }
 
   // reading the ctp inputs and ctp classes
-  for (auto const digit : outputDigits) {
+  for (const auto& digit : mOutputDigits) {
     uint16_t bcid = digit.intRecord.bc;
     if (digit.CTPInputMask.count()) {
       for (int i = 0; i < o2::ctp::CTP_NINPUTS; i++) {
@@ -0,0 +1,103 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   HistogramComparatorKernels.h
+/// \brief  Comparison kernels working directly on the bin storage of one and two dimensional histograms
+///
+
+#ifndef QC_MODULE_COMMON_HISTOGRAMCOMPARATORKERNELS_H
+#define QC_MODULE_COMMON_HISTOGRAMCOMPARATORKERNELS_H
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+class TAxis;
+class TH1;
+
+namespace o2::quality_control_modules::common::comparator_kernels
+{
+
+/// \brief Inclusive range of bins along one axis
+struct BinRange {
+  int first = 1;
+  int last = 0;
+};
+
+/// \brief Rectangle of bins on which a comparison is performed
+struct BinSelection {
+  BinRange x;
+  BinRange y;
+};
+
+/// \brief Caches the bins corresponding to a range in axis coordinates.
+///
+/// The bins are resolved when the range or the binning of the axis differ from the previous call, i.e. typically
+/// once for all the cycles of a run, instead of for each comparison. Extendable axes are resolved at each call,
+/// since resolving the range might extend them.
+class AxisRangeCache
+{
+ public:
+  /// \param resolve returns the bins of the range on the axis
+  template <typename Resolver>
+  BinRange get(TAxis& axis, const std::pair<double, double>& range, Resolver&& resolve)
+  {
+    if (!matches(axis, range)) {
+      mBins = resolve(axis, range);
+      store(axis, range);
+    }
+    return mBins;
+  }
+
+  void clear() { mValid = false; }
+
+ private:
+  bool matches(const TAxis& axis, const std::pair<double, double>& range) const;
+  void store(const TAxis& axis, const std::pair<double, double>& range);
+
+  bool mValid = false;
+  std::pair<double, double> mRange;
+  int mNBins = 0;
+  double mMin = 0;
+  double mMax = 0;
+  std::vector<double> mEdges; // only for variable bins
+  BinRange mBins;
+};
+
+/// \brief Tells if the kernels can be used with these histograms.
+/// It requires exactly TH1F, TH1D, TH2F or TH2D, the same class for both and identical axes.
+bool isSupported(const TH1* histogram, const TH1* reference);
+
+/// \brief Counts the bins of the selection where |(value - reference) / reference| > threshold.
+/// The bins where the reference is zero have no deviation. Like TH1::GetBin, one-dimensional histograms
+/// ignore the Y bin, so each of their bins is counted once per Y bin of the selection.
+/// \return the count, nothing if the histograms are not supported
+std::optional<int> countDeviatingBins(TH1* histogram, TH1* reference, const BinSelection& bins, double threshold);
+
+/// \brief Performs the same computation as histogram->Chi2Test(reference, "UU NORM") when the axis ranges of the
+/// histogram are the bins of the selection, and returns the same value, bit for bit.
+///
+/// The effective counts are computed in a first pass over the contiguous bin storage, then the chi2 is accumulated
+/// in the order used by ROOT (X bins in the outer loop), so that the rounding of the sum is the same.
+/// \return the chi2 probability, nothing if the histograms are not supported
+std::optional<double> chi2TestUUNorm(TH1* histogram, TH1* reference, const BinSelection& bins);
+
+/// \brief Returns the same value as histogram->KolmogorovTest(reference, option), bit for bit, for the options
+/// which request the maximum distance ("M"), possibly with the underflow ("U") and overflow ("O") bins.
+/// For two-dimensional histograms, the distance is the average of the ones obtained by accumulating first
+/// along X and first along Y, as in TH2::KolmogorovTest.
+/// \return the Kolmogorov distance, nothing if the histograms or the option are not supported
+std::optional<double> kolmogorovTest(TH1* histogram, TH1* reference, const char* option);
+
+} // namespace o2::quality_control_modules::common::comparator_kernels
+
+#endif // QC_MODULE_COMMON_HISTOGRAMCOMPARATORKERNELS_H
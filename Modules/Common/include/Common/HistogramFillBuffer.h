@@ -0,0 +1,116 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   HistogramFillBuffer.h
+///
+
+#ifndef QC_MODULE_COMMON_HISTOGRAMFILLBUFFER_H
+#define QC_MODULE_COMMON_HISTOGRAMFILLBUFFER_H
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+class TH1;
+class TH2;
+class THnBase;
+class TObject;
+
+namespace o2::quality_control_modules::common
+{
+
+/// \brief Per-thread buffers of histogram fills, to be used in parallel (e.g. OpenMP) loops.
+///
+/// ROOT histograms cannot be filled concurrently. Instead, each thread fills its own slot of the buffer,
+/// which keeps dense bin-count arrays (and the statistics needed to reproduce TH1::Fill) for TH1 and TH2,
+/// while THnBase fills are recorded and replayed. The buffers are then added to the histograms with reduce(),
+/// typically at the end of monitorData(), which distributes the histograms among the threads.
+///
+/// Only the histograms with fixed axes are supported, i.e. the axes are not extended when filling out of range.
+/// Filling the same slot from several threads at once is not allowed, while the histograms must not be modified
+/// by anything else between the first fill and reduce(). The buffers are kept between the reductions to avoid
+/// allocations, clear() should be called when the histograms are deleted.
+///
+/// Example:
+/// \code
+/// HistogramFillBuffer buffer(nThreads);
+/// #pragma omp parallel for num_threads(nThreads)
+/// for (int i = 0; i < n; i++) {
+///   buffer.fill(omp_get_thread_num(), histo, values[i]);
+/// }
+/// buffer.reduce();
+/// \endcode
+class HistogramFillBuffer
+{
+ public:
+  explicit HistogramFillBuffer(size_t nThreads = 1);
+  ~HistogramFillBuffer() = default;
+
+  /// \brief Changes the number of slots. Pending fills are reduced first.
+  void setNThreads(size_t nThreads);
+  size_t getNThreads() const { return mSlots.size(); }
+
+  /// \brief Fills a TH1 (or the x axis of any histogram), equivalent to histo->Fill(x, w)
+  void fill(size_t thread, TH1* histo, double x, double w = 1.);
+  /// \brief Fills a TH2, equivalent to histo->Fill(x, y, w)
+  void fill(size_t thread, TH2* histo, double x, double y, double w = 1.);
+  /// \brief Fills a THnBase, equivalent to histo->Fill(coordinates, w)
+  void fill(size_t thread, THnBase* histo, const double* coordinates, double w = 1.);
+
+  /// \brief Adds the content of all the slots to the histograms and clears the slots.
+  /// The histograms are distributed among the threads, each of them is modified by one thread only.
+  void reduce();
+  /// \brief Discards the pending fills.
+  void clear();
+
+  /// \brief Returns the number of fills not reduced yet.
+  size_t getNumberPendingFills() const;
+
+ private:
+  // Dense content of one TH1 or TH2 in one slot. Only the touched bins are visited during the reduction.
+  struct BinnedBuffer {
+    std::vector<double> content;
+    std::vector<double> sumw2; // allocated only when needed, i.e. the histogram has it or a weight is not 1
+    std::vector<char> isTouched;
+    std::vector<int> touchedBins;
+    double stats[7] = { 0 }; // sumw, sumw2, sumwx, sumwx2, sumwy, sumwy2, sumwxy, as in TH1::GetStats
+    double entries = 0;
+  };
+  // Recorded THnBase fills, since THnSparse allocates bins when they are filled.
+  struct RecordedBuffer {
+    std::vector<double> coordinates; // nDimensions values per fill
+    std::vector<double> weights;
+  };
+  struct Buffer {
+    TObject* target = nullptr;
+    bool isTHn = false;
+    size_t pendingFills = 0;
+    BinnedBuffer binned;
+    RecordedBuffer recorded;
+  };
+  struct alignas(64) Slot {
+    std::vector<Buffer> buffers;
+    std::unordered_map<const TObject*, size_t> index;
+    const TObject* lastTarget = nullptr;
+    size_t lastBuffer = 0;
+  };
+
+  Buffer& getBuffer(size_t thread, TObject* target, bool isTHn, size_t nCells, bool withSumw2);
+  static void addToBin(BinnedBuffer& binned, int bin, double w);
+  static void reduceInto(TObject* target, const std::vector<Buffer*>& buffers);
+
+  std::vector<Slot> mSlots;
+};
+
+} // namespace o2::quality_control_modules::common
+
+#endif // QC_MODULE_COMMON_HISTOGRAMFILLBUFFER_H
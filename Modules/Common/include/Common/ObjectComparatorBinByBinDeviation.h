@@ -19,6 +19,7 @@
 #define QUALITYCONTROL_ObjectComparatorBinByBinDeviation_H
 
 #include "Common/ObjectComparatorInterface.h"
+#include "Common/HistogramComparatorKernels.h"
 
 namespace o2::quality_control_modules::common
 {
@@ -40,7 +41,13 @@ class ObjectComparatorBinByBinDeviation : public ObjectComparatorInterface
   o2::quality_control::core::Quality compare(TObject* object, TObject* referenceObject, std::string& message) override;
 
  private:
+  /// bin-by-bin comparison through the generic histogram interface, for the histograms not supported by the kernels
+  int countDeviatingBins(TH1* histogram, TH1* referenceHistogram, const comparator_kernels::BinSelection& bins);
+
   int mMaxAllowedBadBins{ 0 };
+  /// bins corresponding to the X and Y ranges, for the current binning of the histograms
+  comparator_kernels::AxisRangeCache mBinsX; //!
+  comparator_kernels::AxisRangeCache mBinsY; //!
 };
 
 } // namespace o2::quality_control_modules::common
@@ -19,6 +19,7 @@
 #define QUALITYCONTROL_ObjectComparatorChi2_H
 
 #include "Common/ObjectComparatorInterface.h"
+#include "Common/HistogramComparatorKernels.h"
 
 namespace o2::quality_control_modules::common
 {
@@ -35,6 +36,11 @@ class ObjectComparatorChi2 : public ObjectComparatorInterface
   /// \brief objects comparison function
   /// \return the quality resulting from the object comparison
   o2::quality_control::core::Quality compare(TObject* object, TObject* referenceObject, std::string& message) override;
+
+ private:
+  /// bins corresponding to the X and Y ranges, for the current binning of the histograms
+  comparator_kernels::AxisRangeCache mBinsX; //!
+  comparator_kernels::AxisRangeCache mBinsY; //!
 };
 
 } // namespace o2::quality_control_modules::common
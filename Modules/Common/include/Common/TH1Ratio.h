@@ -66,7 +66,13 @@ class TH1Ratio : public T, public o2::mergers::MergeInterface
   void setHasBinominalErrors(bool flag = true) { mBinominalErrors = flag; }
   bool hasBinominalErrors() const { return mBinominalErrors; }
 
+  /// \brief Recomputes the ratio from the numerator and the denominator.
   void update();
+  /// \brief Recomputes the ratio only if the numerator or the denominator were merged since the last update.
+  /// merge() does not recompute the ratio, so that a merger combining N inputs divides the histograms once instead of
+  /// N times. The ratio is brought up to date automatically when the object is streamed or painted.
+  void updateIfNeeded();
+  bool isUpdateNeeded() const { return mUpdateNeeded; }
 
   // functions inherited from TH1x
   void Reset(Option_t* option = "") override;
@@ -77,6 +83,7 @@ class TH1Ratio : public T, public o2::mergers::MergeInterface
   Bool_t Add(const TH1* h1, Double_t c1 = 1) override;
   void SetBins(Int_t nx, Double_t xmin, Double_t xmax) override;
   void Sumw2(Bool_t flag = kTRUE) override;
+  void Paint(Option_t* option = "") override;
 
  private:
   T* mHistoNum{ nullptr };
@@ -85,6 +92,7 @@ class TH1Ratio : public T, public o2::mergers::MergeInterface
   bool mBinominalErrors{ false };
   Bool_t mSumw2Enabled{ kTRUE };
   std::string mTreatMeAs{ T::Class_Name() };
+  bool mUpdateNeeded{ false }; //! the numerator or the denominator changed after the last update()
 
   ClassDefOverride(TH1Ratio, 3);
 };
@@ -15,6 +15,7 @@
 /// \author Piotr Konopka, piotr.jan.konopka@cern.ch, Andrea Ferrero
 
 #include "QualityControl/QcInfoLogger.h"
+#include <TBuffer.h>
 
 namespace o2::quality_control_modules::common
 {
@@ -207,12 +208,21 @@ void TH1Ratio<T>::merge(MergeInterface* const other)
 
   mHistoNum->Add(dynamic_cast<const TH1Ratio* const>(other)->getNum());
   mHistoDen->Add(dynamic_cast<const TH1Ratio* const>(other)->getDen());
-  update();
+  mUpdateNeeded = true;
+}
+
+template<class T>
+void TH1Ratio<T>::updateIfNeeded()
+{
+  if (mUpdateNeeded) {
+    update();
+  }
 }
 
 template<class T>
 void TH1Ratio<T>::update()
 {
+  mUpdateNeeded = false;
   if (!mHistoNum || !mHistoDen) {
     return;
   }
@@ -261,6 +271,7 @@ void TH1Ratio<T>::Reset(Option_t* option)
   }
 
   T::Reset(option);
+  mUpdateNeeded = false;
 }
 
 template<class T>
@@ -375,4 +386,25 @@ void TH1Ratio<T>::Sumw2(Bool_t flag)
   }
 }
 
+template<class T>
+void TH1Ratio<T>::Paint(Option_t* option)
+{
+  updateIfNeeded();
+  T::Paint(option);
+}
+
+template<class T>
+void TH1Ratio<T>::Streamer(TBuffer& buffer)
+{
+  // The ratio is stored together with the numerator and the denominator, so that it can be displayed
+  // without the QC libraries. Thus, we make sure it is up to date before writing it.
+  if (buffer.IsReading()) {
+    buffer.ReadClassBuffer(TH1Ratio<T>::Class(), this);
+    mUpdateNeeded = false;
+  } else {
+    updateIfNeeded();
+    buffer.WriteClassBuffer(TH1Ratio<T>::Class(), this);
+  }
+}
+
 } // namespace o2::quality_control_modules::common
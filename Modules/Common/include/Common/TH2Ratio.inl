@@ -15,6 +15,7 @@
 /// \author Piotr Konopka, piotr.jan.konopka@cern.ch, Andrea Ferrero
 
 #include "QualityControl/QcInfoLogger.h"
+#include <TBuffer.h>
 
 namespace o2::quality_control_modules::common
 {
@@ -266,12 +267,21 @@ void TH2Ratio<T>::merge(MergeInterface* const other)
 
   mHistoNum->Add(dynamic_cast<const TH2Ratio* const>(other)->getNum());
   mHistoDen->Add(dynamic_cast<const TH2Ratio* const>(other)->getDen());
-  update();
+  mUpdateNeeded = true;
+}
+
+template<class T>
+void TH2Ratio<T>::updateIfNeeded()
+{
+  if (mUpdateNeeded) {
+    update();
+  }
 }
 
 template<class T>
 void TH2Ratio<T>::update()
 {
+  mUpdateNeeded = false;
   if (!mHistoNum || !mHistoDen) {
     return;
   }
@@ -325,6 +335,7 @@ void TH2Ratio<T>::Reset(Option_t* option)
   }
 
   T::Reset(option);
+  mUpdateNeeded = false;
 }
 
 template<class T>
@@ -435,4 +446,25 @@ void TH2Ratio<T>::Sumw2(Bool_t flag)
   T::Sumw2(flag);
 }
 
+template<class T>
+void TH2Ratio<T>::Paint(Option_t* option)
+{
+  updateIfNeeded();
+  T::Paint(option);
+}
+
+template<class T>
+void TH2Ratio<T>::Streamer(TBuffer& buffer)
+{
+  // The ratio is stored together with the numerator and the denominator, so that it can be displayed
+  // without the QC libraries. Thus, we make sure it is up to date before writing it.
+  if (buffer.IsReading()) {
+    buffer.ReadClassBuffer(TH2Ratio<T>::Class(), this);
+    mUpdateNeeded = false;
+  } else {
+    updateIfNeeded();
+    buffer.WriteClassBuffer(TH2Ratio<T>::Class(), this);
+  }
+}
+
 } // namespace o2::quality_control_modules::common
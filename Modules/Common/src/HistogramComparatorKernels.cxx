@@ -0,0 +1,334 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   HistogramComparatorKernels.cxx
+///
+
+#include "Common/HistogramComparatorKernels.h"
+//  ROOT
+#include <TAxis.h>
+#include <TH1D.h>
+#include <TH1F.h>
+#include <TH2D.h>
+#include <TH2F.h>
+#include <TMath.h>
+#include <TString.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace o2::quality_control_modules::common::comparator_kernels
+{
+
+namespace
+{
+// scratch memory of the kernels, the comparators of a check are called sequentially
+thread_local std::vector<double> scratch;
+
+bool isSupportedClass(const TH1* histogram)
+{
+  auto* cl = histogram->IsA();
+  return cl == TH1F::Class() || cl == TH1D::Class() || cl == TH2F::Class() || cl == TH2D::Class();
+}
+
+bool haveSameBinning(const TAxis& axis, const TAxis& otherAxis)
+{
+  if (axis.GetNbins() != otherAxis.GetNbins() || axis.GetXmin() != otherAxis.GetXmin() || axis.GetXmax() != otherAxis.GetXmax()) {
+    return false;
+  }
+  const auto* edges = axis.GetXbins();
+  const auto* otherEdges = otherAxis.GetXbins();
+  if (edges->GetSize() != otherEdges->GetSize()) {
+    return false;
+  }
+  for (int i = 0; i < edges->GetSize(); i++) {
+    if (edges->GetAt(i) != otherEdges->GetAt(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// empties the fill buffers, as GetBinContent() would do
+bool prepare(TH1* histogram, TH1* reference)
+{
+  if (!isSupported(histogram, reference)) {
+    return false;
+  }
+  if (histogram->GetBufferLength() > 0) {
+    histogram->BufferEmpty();
+  }
+  if (reference->GetBufferLength() > 0) {
+    reference->BufferEmpty();
+  }
+  return true;
+}
+
+// distance between consecutive Y bins in the storage, 0 for one-dimensional histograms, whose GetBin() ignores Y
+int getStrideY(const TH1* histogram)
+{
+  return histogram->GetDimension() == 1 ? 0 : histogram->GetXaxis()->GetNbins() + 2;
+}
+
+bool isInside(const TH1* histogram, const BinSelection& bins)
+{
+  auto inside = [](const BinRange& range, int nBins) {
+    return range.first > range.last || (range.first >= 0 && range.last <= nBins + 1);
+  };
+  return inside(bins.x, histogram->GetXaxis()->GetNbins()) && (histogram->GetDimension() == 1 || inside(bins.y, histogram->GetYaxis()->GetNbins()));
+}
+
+const double* getSumw2(const TH1* histogram)
+{
+  return histogram->GetSumw2N() > 0 ? histogram->GetSumw2()->GetArray() : nullptr;
+}
+
+// calls the kernel with the bin contents of the two histograms, stored as float or double
+template <typename Kernel>
+auto withContents(TH1* histogram, TH1* reference, Kernel&& kernel)
+{
+  if (auto* contents = dynamic_cast<TArrayF*>(histogram)) {
+    return kernel(static_cast<const float*>(contents->GetArray()), static_cast<const float*>(dynamic_cast<TArrayF*>(reference)->GetArray()));
+  }
+  return kernel(static_cast<const double*>(dynamic_cast<TArrayD*>(histogram)->GetArray()), static_cast<const double*>(dynamic_cast<TArrayD*>(reference)->GetArray()));
+}
+} // namespace
+
+bool AxisRangeCache::matches(const TAxis& axis, const std::pair<double, double>& range) const
+{
+  if (!mValid || axis.CanExtend() || range != mRange || axis.GetNbins() != mNBins || axis.GetXmin() != mMin || axis.GetXmax() != mMax) {
+    return false;
+  }
+  const auto* edges = axis.GetXbins();
+  if (static_cast<size_t>(edges->GetSize()) != mEdges.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < mEdges.size(); i++) {
+    if (edges->GetAt(i) != mEdges[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void AxisRangeCache::store(const TAxis& axis, const std::pair<double, double>& range)
+{
+  mValid = true;
+  mRange = range;
+  mNBins = axis.GetNbins();
+  mMin = axis.GetXmin();
+  mMax = axis.GetXmax();
+  const auto* edges = axis.GetXbins();
+  mEdges.assign(edges->GetArray(), edges->GetArray() + edges->GetSize());
+}
+
+bool isSupported(const TH1* histogram, const TH1* reference)
+{
+  if (!histogram || !reference || histogram->IsA() != reference->IsA() || !isSupportedClass(histogram)) {
+    return false;
+  }
+  return haveSameBinning(*histogram->GetXaxis(), *reference->GetXaxis()) && haveSameBinning(*histogram->GetYaxis(), *reference->GetYaxis());
+}
+
+std::optional<int> countDeviatingBins(TH1* histogram, TH1* reference, const BinSelection& bins, double threshold)
+{
+  if (!prepare(histogram, reference) || !isInside(histogram, bins)) {
+    return std::nullopt;
+  }
+  const size_t strideY = getStrideY(histogram);
+
+  // the bins with a zero reference have no deviation, which is above negative thresholds
+  const bool zeroDeviationAbove = 0 > threshold;
+
+  return withContents(histogram, reference, [&](const auto* values, const auto* referenceValues) {
+    int count = 0;
+    for (int binY = bins.y.first; binY <= bins.y.last; binY++) {
+      const auto* row = values + strideY * binY;
+      const auto* referenceRow = referenceValues + strideY * binY;
+      // All the terms are evaluated for each bin, without branches, so that the loop is vectorized.
+      // The result is the same as when the division is skipped for the zero references.
+      for (int binX = bins.x.first; binX <= bins.x.last; binX++) {
+        double value = row[binX];
+        double referenceValue = referenceRow[binX];
+        double deviation = std::abs((value - referenceValue) / referenceValue);
+        count += ((referenceValue != 0) & (deviation > threshold)) | ((referenceValue == 0) & zeroDeviationAbove);
+      }
+    }
+    return count;
+  });
+}
+
+std::optional<double> chi2TestUUNorm(TH1* histogram, TH1* reference, const BinSelection& bins)
+{
+  if (!prepare(histogram, reference) || !isInside(histogram, bins)) {
+    return std::nullopt;
+  }
+  const size_t strideY = getStrideY(histogram);
+  const double* errors = getSumw2(histogram);
+  const double* referenceErrors = getSumw2(reference);
+
+  const int nBinsX = std::max(bins.x.last - bins.x.first + 1, 0);
+  const int nBinsY = std::max(bins.y.last - bins.y.first + 1, 0);
+  const size_t nBins = static_cast<size_t>(nBinsX) * nBinsY;
+  int ndf = (bins.x.last - bins.x.first + 1) * (bins.y.last - bins.y.first + 1) - 1;
+
+  // the effective counts, stored in the order in which ROOT visits the bins, i.e. with X in the outer loop
+  scratch.resize(2 * nBins);
+  double* counts = scratch.data();
+  double* referenceCounts = scratch.data() + nBins;
+
+  // The sums of the effective counts are exact, whatever the order, since the counts are integers.
+  // The sums of the squared errors are only tested for positivity, which does not depend on the order
+  // as long as they are not negative, i.e. with Sumw2 or for positive bin contents.
+  double sum = 0, referenceSum = 0;
+  double sumw = 0, referenceSumw = 0;
+  withContents(histogram, reference, [&](const auto* values, const auto* referenceValues) {
+    for (int binY = bins.y.first; binY <= bins.y.last; binY++) {
+      const size_t rowStart = strideY * binY;
+      const size_t column = binY - bins.y.first;
+      for (int binX = bins.x.first; binX <= bins.x.last; binX++) {
+        const size_t bin = rowStart + binX;
+        double value = values[bin];
+        double referenceValue = referenceValues[bin];
+        double error2 = errors ? errors[bin] : value;
+        double referenceError2 = referenceErrors ? referenceErrors[bin] : referenceValue;
+        // scale the bin contents to effective entries, as done by ROOT for the NORM option
+        double count = (error2 > 0) ? std::floor(value * value / error2 + 0.5) : 0;
+        double referenceCount = (referenceError2 > 0) ? std::floor(referenceValue * referenceValue / referenceError2 + 0.5) : 0;
+        const size_t index = static_cast<size_t>(binX - bins.x.first) * nBinsY + column;
+        counts[index] = count;
+        referenceCounts[index] = referenceCount;
+        sum += count;
+        referenceSum += referenceCount;
+        sumw += error2;
+        referenceSumw += referenceError2;
+      }
+    }
+  });
+
+  // the conditions in which ROOT refuses to perform the test
+  if (sumw <= 0 || referenceSumw <= 0 || sum == 0 || referenceSum == 0) {
+    return 0.0;
+  }
+
+  double chi2 = 0;
+  for (size_t index = 0; index < nBins; index++) {
+    double count = counts[index];
+    double referenceCount = referenceCounts[index];
+    if (Int_t(count) == 0 && Int_t(referenceCount) == 0) {
+      // no data means one degree of freedom less
+      --ndf;
+    } else {
+      double countSum = count + referenceCount;
+      double delta = referenceSum * count - sum * referenceCount;
+      chi2 += delta * delta / countSum;
+    }
+  }
+  chi2 /= sum * referenceSum;
+
+  return TMath::Prob(chi2, ndf);
+}
+
+std::optional<double> kolmogorovTest(TH1* histogram, TH1* reference, const char* option)
+{
+  TString opt = option;
+  opt.ToUpper();
+  // without "M" the probability is computed, "X" runs pseudo-experiments, we leave them to ROOT
+  if (!opt.Contains("M") || opt.Contains("X")) {
+    return std::nullopt;
+  }
+  if (!prepare(histogram, reference) || histogram->GetBinErrorOption() != TH1::kNormal || reference->GetBinErrorOption() != TH1::kNormal) {
+    return std::nullopt;
+  }
+
+  const int nBinsX = histogram->GetXaxis()->GetNbins();
+  const int nBinsY = histogram->GetDimension() == 1 ? 1 : histogram->GetYaxis()->GetNbins();
+  const bool underflow = opt.Contains("U");
+  const bool overflow = opt.Contains("O");
+  const BinRange rangeX{ underflow ? 0 : 1, overflow ? nBinsX + 1 : nBinsX };
+  // one-dimensional histograms have a single row
+  const BinRange rangeY = histogram->GetDimension() == 1 ? BinRange{ 0, 0 } : BinRange{ underflow ? 0 : 1, overflow ? nBinsY + 1 : nBinsY };
+  const size_t strideY = getStrideY(histogram);
+  const int rowLength = rangeX.last - rangeX.first + 1;
+  const int columnLength = rangeY.last - rangeY.first + 1;
+  const size_t nBins = static_cast<size_t>(rowLength) * columnLength;
+
+  const double* errors = getSumw2(histogram);
+  const double* referenceErrors = getSumw2(reference);
+
+  // the contents, stored in the order of the first loop of ROOT, i.e. with X in the outer loop for 2D histograms
+  scratch.resize(2 * nBins);
+  double* contents = scratch.data();
+  double* referenceContents = scratch.data() + nBins;
+
+  // The sums of the squared errors are only tested for positivity, so they do not depend on the order.
+  double w = 0, referenceW = 0;
+  withContents(histogram, reference, [&](const auto* values, const auto* referenceValues) {
+    for (int binY = rangeY.first; binY <= rangeY.last; binY++) {
+      const size_t rowStart = strideY * binY;
+      const size_t column = binY - rangeY.first;
+      for (int binX = rangeX.first; binX <= rangeX.last; binX++) {
+        const size_t bin = rowStart + binX;
+        double value = values[bin];
+        double referenceValue = referenceValues[bin];
+        double error = std::sqrt(errors ? errors[bin] : std::abs(value));
+        double referenceError = std::sqrt(referenceErrors ? referenceErrors[bin] : std::abs(referenceValue));
+        w += error * error;
+        referenceW += referenceError * referenceError;
+        const size_t index = static_cast<size_t>(binX - rangeX.first) * columnLength + column;
+        contents[index] = value;
+        referenceContents[index] = referenceValue;
+      }
+    }
+  });
+
+  double sum = 0, referenceSum = 0;
+  for (size_t index = 0; index < nBins; index++) {
+    sum += contents[index];
+    referenceSum += referenceContents[index];
+  }
+  // the conditions in which ROOT refuses to perform the test
+  if (sum == 0 || referenceSum == 0 || (!(w > 0) && !(referenceW > 0))) {
+    return 0.0;
+  }
+
+  const double scale = 1 / sum;
+  const double referenceScale = 1 / referenceSum;
+  double distance = 0, cumulative = 0, referenceCumulative = 0;
+  for (size_t index = 0; index < nBins; index++) {
+    cumulative += scale * contents[index];
+    referenceCumulative += referenceScale * referenceContents[index];
+    distance = TMath::Max(distance, TMath::Abs(cumulative - referenceCumulative));
+  }
+  if (histogram->GetDimension() == 1) {
+    return distance;
+  }
+
+  // the second distance accumulates first along X, which is the order of the storage
+  double secondDistance = 0;
+  cumulative = 0;
+  referenceCumulative = 0;
+  withContents(histogram, reference, [&](const auto* values, const auto* referenceValues) {
+    for (int binY = rangeY.first; binY <= rangeY.last; binY++) {
+      const size_t rowStart = strideY * binY;
+      for (int binX = rangeX.first; binX <= rangeX.last; binX++) {
+        cumulative += scale * values[rowStart + binX];
+        referenceCumulative += referenceScale * referenceValues[rowStart + binX];
+        secondDistance = TMath::Max(secondDistance, TMath::Abs(cumulative - referenceCumulative));
+      }
+    }
+  });
+
+  return 0.5 * (distance + secondDistance);
+}
+
+} // namespace o2::quality_control_modules::common::comparator_kernels
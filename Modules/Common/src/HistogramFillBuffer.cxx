@@ -0,0 +1,236 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   HistogramFillBuffer.cxx
+///
+
+#include "Common/HistogramFillBuffer.h"
+
+#include <TH1.h>
+#include <TH2.h>
+#include <THnBase.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+namespace o2::quality_control_modules::common
+{
+
+HistogramFillBuffer::HistogramFillBuffer(size_t nThreads)
+  : mSlots(std::max<size_t>(nThreads, 1))
+{
+}
+
+void HistogramFillBuffer::setNThreads(size_t nThreads)
+{
+  reduce();
+  mSlots.clear();
+  mSlots.resize(std::max<size_t>(nThreads, 1));
+}
+
+HistogramFillBuffer::Buffer& HistogramFillBuffer::getBuffer(size_t thread, TObject* target, bool isTHn, size_t nCells, bool withSumw2)
+{
+  if (thread >= mSlots.size()) {
+    throw std::out_of_range("HistogramFillBuffer: thread slot " + std::to_string(thread) + " is out of range, the buffer has " + std::to_string(mSlots.size()) + " slots");
+  }
+  auto& slot = mSlots[thread];
+  if (slot.lastTarget == target) {
+    auto& buffer = slot.buffers[slot.lastBuffer];
+    buffer.pendingFills++;
+    return buffer;
+  }
+
+  auto [it, inserted] = slot.index.try_emplace(target, slot.buffers.size());
+  if (inserted) {
+    auto& buffer = slot.buffers.emplace_back();
+    buffer.target = target;
+    buffer.isTHn = isTHn;
+  }
+  auto& buffer = slot.buffers[it->second];
+  if (!isTHn && buffer.binned.content.size() != nCells) {
+    // first use, or the histogram has been rebinned or replaced by another one at the same address
+    buffer.binned = BinnedBuffer{};
+    buffer.binned.content.resize(nCells, 0);
+    buffer.binned.isTouched.resize(nCells, 0);
+  }
+  if (withSumw2 && buffer.binned.sumw2.empty()) {
+    buffer.binned.sumw2 = buffer.binned.content;
+  }
+  slot.lastTarget = target;
+  slot.lastBuffer = it->second;
+  buffer.pendingFills++;
+  return buffer;
+}
+
+void HistogramFillBuffer::addToBin(BinnedBuffer& binned, int bin, double w)
+{
+  if (!binned.isTouched[bin]) {
+    binned.isTouched[bin] = 1;
+    binned.touchedBins.push_back(bin);
+  }
+  if (w != 1. && binned.sumw2.empty()) {
+    // until now all the weights were 1, thus the sum of squares of weights equals the content
+    binned.sumw2 = binned.content;
+  }
+  binned.content[bin] += w;
+  if (!binned.sumw2.empty()) {
+    binned.sumw2[bin] += w * w;
+  }
+}
+
+void HistogramFillBuffer::fill(size_t thread, TH1* histo, double x, double w)
+{
+  auto& binned = getBuffer(thread, histo, false, histo->GetNcells(), histo->GetSumw2N() > 0).binned;
+  binned.entries++;
+  auto* axis = histo->GetXaxis();
+  int bin = axis->FindFixBin(x);
+  addToBin(binned, bin, w);
+  if ((bin == 0 || bin > axis->GetNbins()) && !histo->GetStatOverflowsBehaviour()) {
+    return;
+  }
+  binned.stats[0] += w;
+  binned.stats[1] += w * w;
+  binned.stats[2] += w * x;
+  binned.stats[3] += w * x * x;
+}
+
+void HistogramFillBuffer::fill(size_t thread, TH2* histo, double x, double y, double w)
+{
+  auto& binned = getBuffer(thread, histo, false, histo->GetNcells(), histo->GetSumw2N() > 0).binned;
+  binned.entries++;
+  auto* xAxis = histo->GetXaxis();
+  auto* yAxis = histo->GetYaxis();
+  int binx = xAxis->FindFixBin(x);
+  int biny = yAxis->FindFixBin(y);
+  addToBin(binned, histo->GetBin(binx, biny), w);
+  if ((binx == 0 || binx > xAxis->GetNbins() || biny == 0 || biny > yAxis->GetNbins()) && !histo->GetStatOverflowsBehaviour()) {
+    return;
+  }
+  binned.stats[0] += w;
+  binned.stats[1] += w * w;
+  binned.stats[2] += w * x;
+  binned.stats[3] += w * x * x;
+  binned.stats[4] += w * y;
+  binned.stats[5] += w * y * y;
+  binned.stats[6] += w * x * y;
+}
+
+void HistogramFillBuffer::fill(size_t thread, THnBase* histo, const double* coordinates, double w)
+{
+  auto& recorded = getBuffer(thread, histo, true, 0, false).recorded;
+  recorded.coordinates.insert(recorded.coordinates.end(), coordinates, coordinates + histo->GetNdimensions());
+  recorded.weights.push_back(w);
+}
+
+void HistogramFillBuffer::reduceInto(TObject* target, const std::vector<Buffer*>& buffers)
+{
+  if (buffers.front()->isTHn) {
+    auto histo = static_cast<THnBase*>(target);
+    const auto nDimensions = histo->GetNdimensions();
+    for (auto* buffer : buffers) {
+      auto& recorded = buffer->recorded;
+      for (size_t i = 0; i < recorded.weights.size(); i++) {
+        histo->Fill(recorded.coordinates.data() + i * nDimensions, recorded.weights[i]);
+      }
+      recorded.coordinates.clear();
+      recorded.weights.clear();
+    }
+    return;
+  }
+
+  auto histo = static_cast<TH1*>(target);
+  bool anyWeighted = std::any_of(buffers.begin(), buffers.end(), [](const Buffer* b) { return !b->binned.sumw2.empty(); });
+  if (anyWeighted && histo->GetSumw2N() == 0 && !histo->TestBit(TH1::kIsNotW)) {
+    histo->Sumw2(); // as TH1::Fill does with the first weight different from 1
+  }
+  const bool histoHasSumw2 = histo->GetSumw2N() > 0;
+
+  double stats[TH1::kNstat] = { 0 };
+  histo->GetStats(stats);
+  double entries = histo->GetEntries();
+  for (auto* buffer : buffers) {
+    auto& binned = buffer->binned;
+    for (auto bin : binned.touchedBins) {
+      histo->AddBinContent(bin, binned.content[bin]);
+      if (histoHasSumw2) {
+        histo->GetSumw2()->fArray[bin] += binned.sumw2.empty() ? binned.content[bin] : binned.sumw2[bin];
+      }
+      binned.content[bin] = 0;
+      if (!binned.sumw2.empty()) {
+        binned.sumw2[bin] = 0;
+      }
+      binned.isTouched[bin] = 0;
+    }
+    binned.touchedBins.clear();
+    for (int i = 0; i < 7; i++) {
+      stats[i] += binned.stats[i];
+      binned.stats[i] = 0;
+    }
+    entries += binned.entries;
+    binned.entries = 0;
+  }
+  histo->PutStats(stats);
+  histo->SetEntries(entries);
+}
+
+void HistogramFillBuffer::reduce()
+{
+  // group the buffers of all the slots by histogram
+  std::vector<TObject*> targets;
+  std::unordered_map<TObject*, std::vector<Buffer*>> buffersPerTarget;
+  for (auto& slot : mSlots) {
+    for (auto& buffer : slot.buffers) {
+      if (buffer.pendingFills == 0) {
+        // it might belong to a histogram which does not exist anymore
+        continue;
+      }
+      auto [it, inserted] = buffersPerTarget.try_emplace(buffer.target);
+      if (inserted) {
+        targets.push_back(buffer.target);
+      }
+      it->second.push_back(&buffer);
+      buffer.pendingFills = 0;
+    }
+  }
+
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(mSlots.size())
+#endif
+  for (size_t i = 0; i < targets.size(); i++) {
+    reduceInto(targets[i], buffersPerTarget.at(targets[i]));
+  }
+}
+
+void HistogramFillBuffer::clear()
+{
+  for (auto& slot : mSlots) {
+    slot = Slot{};
+  }
+}
+
+size_t HistogramFillBuffer::getNumberPendingFills() const
+{
+  size_t pending = 0;
+  for (const auto& slot : mSlots) {
+    for (const auto& buffer : slot.buffers) {
+      pending += buffer.pendingFills;
+    }
+  }
+  return pending;
+}
+
+} // namespace o2::quality_control_modules::common
@@ -47,6 +47,27 @@ void ObjectComparatorBinByBinDeviation::configure(const CustomParameters& custom
   }
 }
 
+int ObjectComparatorBinByBinDeviation::countDeviatingBins(TH1* histogram, TH1* referenceHistogram, const comparator_kernels::BinSelection& bins)
+{
+  int binRangeZ[2] = { 1, histogram->GetZaxis()->GetNbins() };
+
+  int numberOfBadBins = 0;
+  for (int binX = bins.x.first; binX <= bins.x.last; binX++) {
+    for (int binY = bins.y.first; binY <= bins.y.last; binY++) {
+      for (int binZ = binRangeZ[0]; binZ <= binRangeZ[1]; binZ++) {
+        int bin = histogram->GetBin(binX, binY, binZ);
+        double val = histogram->GetBinContent(bin);
+        double refVal = referenceHistogram->GetBinContent(bin);
+        double deviation = (refVal == 0) ? 0 : std::abs((val - refVal) / refVal);
+        if (deviation > getThreshold()) {
+          numberOfBadBins += 1;
+        }
+      }
+    }
+  }
+  return numberOfBadBins;
+}
+
 Quality ObjectComparatorBinByBinDeviation::compare(TObject* object, TObject* referenceObject, std::string& message)
 {
   auto checkResult = checkInputObjects(object, referenceObject, message);
@@ -57,40 +78,26 @@ Quality ObjectComparatorBinByBinDeviation::compare(TObject* object, TObject* ref
   auto* histogram = std::get<0>(checkResult);
   auto* referenceHistogram = std::get<1>(checkResult);
 
-  int binRangeX[2] = { 1, histogram->GetXaxis()->GetNbins() };
+  comparator_kernels::BinSelection bins{ { 1, histogram->GetXaxis()->GetNbins() }, { 1, histogram->GetYaxis()->GetNbins() } };
+  auto findBins = [](TAxis& axis, const std::pair<double, double>& range) {
+    return comparator_kernels::BinRange{ axis.FindBin(range.first), axis.FindBin(range.second) };
+  };
   if (getXRange().has_value()) {
-    binRangeX[0] = histogram->GetXaxis()->FindBin(getXRange()->first);
-    binRangeX[1] = histogram->GetXaxis()->FindBin(getXRange()->second);
+    bins.x = mBinsX.get(*histogram->GetXaxis(), getXRange().value(), findBins);
   }
-
-  int binRangeY[2] = { 1, histogram->GetYaxis()->GetNbins() };
   if (getYRange().has_value()) {
-    binRangeY[0] = histogram->GetYaxis()->FindBin(getYRange()->first);
-    binRangeY[1] = histogram->GetYaxis()->FindBin(getYRange()->second);
+    bins.y = mBinsY.get(*histogram->GetYaxis(), getYRange().value(), findBins);
   }
 
-  int binRangeZ[2] = { 1, histogram->GetZaxis()->GetNbins() };
-
-  // compute the average relative deviation between the bins
-  double averageDeviation = 0;
-  int numberOfBadBins = 0;
-  for (int binX = binRangeX[0]; binX <= binRangeX[1]; binX++) {
-    for (int binY = binRangeY[0]; binY <= binRangeY[1]; binY++) {
-      for (int binZ = binRangeZ[0]; binZ <= binRangeZ[1]; binZ++) {
-        int bin = histogram->GetBin(binX, binY, binZ);
-        double val = histogram->GetBinContent(bin);
-        double refVal = referenceHistogram->GetBinContent(bin);
-        double deviation = (refVal == 0) ? 0 : std::abs((val - refVal) / refVal);
-        if (deviation > getThreshold()) {
-          numberOfBadBins += 1;
-        }
-      }
-    }
+  // count the bins with a relative deviation above the threshold, directly on the bins storage if possible
+  auto numberOfBadBins = comparator_kernels::countDeviatingBins(histogram, referenceHistogram, bins, getThreshold());
+  if (!numberOfBadBins.has_value()) {
+    numberOfBadBins = countDeviatingBins(histogram, referenceHistogram, bins);
   }
 
   // compare the average deviation with the maximum allowed value
-  if (numberOfBadBins > mMaxAllowedBadBins) {
-    message = fmt::format("bins above {:.2f}: {} > {}", getThreshold(), numberOfBadBins, mMaxAllowedBadBins);
+  if (numberOfBadBins.value() > mMaxAllowedBadBins) {
+    message = fmt::format("bins above {:.2f}: {} > {}", getThreshold(), numberOfBadBins.value(), mMaxAllowedBadBins);
     return Quality::Bad;
   }
 
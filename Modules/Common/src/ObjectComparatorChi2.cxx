@@ -40,28 +40,48 @@ Quality ObjectComparatorChi2::compare(TObject* object, TObject* referenceObject,
   // if X and/or Y ranges are specified, set the appropriate bin range in the corresponding axis
   // to restrict the histogram area where the test is applied
   const double epsilon = 1.0e-6;
-  if (getXRange().has_value()) {
-    int binMin = histogram->GetXaxis()->FindBin(getXRange()->first);
+  auto setRange = [epsilon](TAxis& axis, TAxis& referenceAxis, const std::pair<double, double>& range) {
+    int binMin = axis.FindBin(range.first);
     // subtract a small amount to the upper edge to avoid getting the next bin
-    int binMax = histogram->GetXaxis()->FindBin(getXRange()->second - epsilon);
+    int binMax = axis.FindBin(range.second - epsilon);
 
-    histogram->GetXaxis()->SetRange(binMin, binMax);
-    referenceHistogram->GetXaxis()->SetRange(binMin, binMax);
-  }
+    axis.SetRange(binMin, binMax);
+    referenceAxis.SetRange(binMin, binMax);
+    return comparator_kernels::BinRange{ axis.GetFirst(), axis.GetLast() };
+  };
 
+  // the bins on which ROOT would perform the test, the ranges being resolved only when the binning changes
+  comparator_kernels::BinSelection bins{ { histogram->GetXaxis()->GetFirst(), histogram->GetXaxis()->GetLast() },
+                                         { histogram->GetYaxis()->GetFirst(), histogram->GetYaxis()->GetLast() } };
+  if (getXRange().has_value()) {
+    bins.x = mBinsX.get(*histogram->GetXaxis(), getXRange().value(), [&](TAxis& axis, const std::pair<double, double>& range) {
+      return setRange(axis, *referenceHistogram->GetXaxis(), range);
+    });
+  }
   if (getYRange().has_value()) {
-    int binMin = histogram->GetYaxis()->FindBin(getYRange()->first);
-    // subtract a small amount to the upper edge to avoid getting the next bin
-    int binMax = histogram->GetYaxis()->FindBin(getYRange()->second - epsilon);
-
-    histogram->GetYaxis()->SetRange(binMin, binMax);
-    referenceHistogram->GetYaxis()->SetRange(binMin, binMax);
+    bins.y = mBinsY.get(*histogram->GetYaxis(), getYRange().value(), [&](TAxis& axis, const std::pair<double, double>& range) {
+      return setRange(axis, *referenceHistogram->GetYaxis(), range);
+    });
   }
 
   // perform a chi2 compatibility test between the two histograms
   // it assumes that both histigrams represent counts, but the reference might
   // have been rescaled to match the integral of the current histogram
-  double testProbability = histogram->Chi2Test(referenceHistogram, "UU NORM");
+  std::optional<double> testProbability;
+  // ranges on the Y axis of 1D histograms and on the Z axis are left to ROOT
+  bool useKernel = histogram->GetDimension() == 2 || (!getYRange().has_value() && !histogram->GetYaxis()->TestBit(TAxis::kAxisRange));
+  if (useKernel && !histogram->GetZaxis()->TestBit(TAxis::kAxisRange)) {
+    testProbability = comparator_kernels::chi2TestUUNorm(histogram, referenceHistogram, bins);
+  }
+  if (!testProbability.has_value()) {
+    if (getXRange().has_value()) {
+      setRange(*histogram->GetXaxis(), *referenceHistogram->GetXaxis(), getXRange().value());
+    }
+    if (getYRange().has_value()) {
+      setRange(*histogram->GetYaxis(), *referenceHistogram->GetYaxis(), getYRange().value());
+    }
+    testProbability = histogram->Chi2Test(referenceHistogram, "UU NORM");
+  }
 
   // reset the axis ranges
   histogram->GetXaxis()->SetRange(0, 0);
@@ -70,8 +90,8 @@ Quality ObjectComparatorChi2::compare(TObject* object, TObject* referenceObject,
   referenceHistogram->GetYaxis()->SetRange(0, 0);
 
   // compare the chi2 probability with the minimum allowed value
-  if (testProbability < getThreshold()) {
-    message = fmt::format("chi2 test failed: {:.2f} < {:.2f}", testProbability, getThreshold());
+  if (testProbability.value() < getThreshold()) {
+    message = fmt::format("chi2 test failed: {:.2f} < {:.2f}", testProbability.value(), getThreshold());
     return Quality::Bad;
   }
 
@@ -16,6 +16,7 @@
 ///
 
 #include "Common/ObjectComparatorKolmogorov.h"
+#include "Common/HistogramComparatorKernels.h"
 //  ROOT
 #include <TH1.h>
 
@@ -40,11 +41,16 @@ Quality ObjectComparatorKolmogorov::compare(TObject* object, TObject* referenceO
   // perform a Kolmogorov compatibility test between the two histograms
   // it assumes that both histigrams represent counts, but the reference might
   // have been rescaled to match the integral of the current histogram
-  double testProbability = histogram->KolmogorovTest(referenceHistogram, "UU NORM");
+  // ROOT reads the options letter by letter, the result is the one of the "UU", "N", "O" and "M" options.
+  // The kernel reproduces it directly from the bins storage, ROOT is called for the histograms it does not support.
+  auto testProbability = comparator_kernels::kolmogorovTest(histogram, referenceHistogram, "UU NORM");
+  if (!testProbability.has_value()) {
+    testProbability = histogram->KolmogorovTest(referenceHistogram, "UU NORM");
+  }
 
   // compare the Kolmogorov probability with the minimum allowed value
-  if (testProbability < getThreshold()) {
-    message = fmt::format("Kolmogorov test failed: {:.2f} < {:.2f}", testProbability, getThreshold());
+  if (testProbability.value() < getThreshold()) {
+    message = fmt::format("Kolmogorov test failed: {:.2f} < {:.2f}", testProbability.value(), getThreshold());
     return Quality::Bad;
   }
 
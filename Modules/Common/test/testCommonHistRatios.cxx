@@ -18,6 +18,9 @@
 #include "Common/TH1Ratio.h"
 #include "Common/TH2Ratio.h"
 
+#include <TBufferFile.h>
+#include <chrono>
+
 #define BOOST_TEST_MODULE CommonHistRatios test
 #define BOOST_TEST_MAIN
 #define BOOST_TEST_DYN_LINK
@@ -47,6 +50,8 @@ BOOST_AUTO_TEST_CASE(test_TH1FRatioUniform)
 
   histoMerged->merge(histo1.get());
   histoMerged->merge(histo2.get());
+  BOOST_REQUIRE(histoMerged->isUpdateNeeded());
+  histoMerged->updateIfNeeded();
 
   for (int bin = 1; bin <= 10; bin++) {
     float value = 9.0 * bin / 5.0;
@@ -73,6 +78,8 @@ BOOST_AUTO_TEST_CASE(test_TH1FRatio)
 
   histoMerged->merge(histo1.get());
   histoMerged->merge(histo2.get());
+  BOOST_REQUIRE(histoMerged->isUpdateNeeded());
+  histoMerged->updateIfNeeded();
 
   for (int bin = 1; bin <= 10; bin++) {
     float value = 9.0 * bin / 7.0;
@@ -173,6 +180,8 @@ BOOST_AUTO_TEST_CASE(test_TH2FRatioUniform)
 
   histoMerged->merge(histo1.get());
   histoMerged->merge(histo2.get());
+  BOOST_REQUIRE(histoMerged->isUpdateNeeded());
+  histoMerged->updateIfNeeded();
 
   for (int ybin = 1; ybin <= 10; ybin++) {
     for (int xbin = 1; xbin <= 10; xbin++) {
@@ -203,6 +212,8 @@ BOOST_AUTO_TEST_CASE(test_TH2FRatio)
 
   histoMerged->merge(histo1.get());
   histoMerged->merge(histo2.get());
+  BOOST_REQUIRE(histoMerged->isUpdateNeeded());
+  histoMerged->updateIfNeeded();
 
   for (int ybin = 1; ybin <= 10; ybin++) {
     for (int xbin = 1; xbin <= 10; xbin++) {
@@ -303,3 +314,75 @@ BOOST_AUTO_TEST_CASE(test_TH2FRatioClone)
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(test_TH2FRatioLazyUpdate)
+{
+  auto histo1 = std::make_unique<TH2FRatio>("test1", "test1", 10, 0, 10.0, 10, 0, 10.0, false);
+  auto histoMerged = std::make_unique<TH2FRatio>("testMerged", "testMerged", 10, 0, 10.0, 10, 0, 10.0, false);
+
+  for (int ybin = 1; ybin <= 10; ybin++) {
+    for (int xbin = 1; xbin <= 10; xbin++) {
+      histo1->getNum()->SetBinContent(xbin, ybin, xbin * ybin * 4);
+      histo1->getDen()->SetBinContent(xbin, ybin, 2);
+    }
+  }
+  histo1->update();
+
+  histoMerged->merge(histo1.get());
+  histoMerged->merge(histo1.get());
+  BOOST_REQUIRE(histoMerged->isUpdateNeeded());
+  BOOST_REQUIRE_EQUAL(histoMerged->GetEntries(), 0);
+
+  // the ratio is brought up to date when the object is serialized, like mergers do before publishing it
+  TBufferFile buffer(TBuffer::kWrite);
+  buffer.WriteObject(histoMerged.get());
+  BOOST_REQUIRE(!histoMerged->isUpdateNeeded());
+
+  buffer.SetReadMode();
+  buffer.SetBufferOffset(0);
+  std::unique_ptr<TH2FRatio> histoRead(static_cast<TH2FRatio*>(buffer.ReadObject(TH2FRatio::Class())));
+  BOOST_REQUIRE(histoRead != nullptr);
+  BOOST_REQUIRE(!histoRead->isUpdateNeeded());
+  for (int ybin = 1; ybin <= 10; ybin++) {
+    for (int xbin = 1; xbin <= 10; xbin++) {
+      float value = xbin * ybin * 2;
+      BOOST_REQUIRE_EQUAL(histoMerged->GetBinContent(xbin, ybin), value);
+      BOOST_REQUIRE_EQUAL(histoRead->GetBinContent(xbin, ybin), value);
+    }
+  }
+}
+
+// Compares merging 100 large TH2Ratios with a division after each input (the former behaviour of merge())
+// and with a single division before publication. Disabled by default, run with:
+// testCommonHistRatios --run_test=benchmark_TH2FRatioMerge
+BOOST_AUTO_TEST_CASE(benchmark_TH2FRatioMerge, *boost::unit_test::disabled())
+{
+  constexpr int inputs = 100;
+  constexpr int bins = 1000;
+  // merging the same input repeatedly costs as much as merging different ones, and keeps the memory usage reasonable
+  auto input = std::make_unique<TH2FRatio>("input", "input", bins, 0, bins, bins, 0, bins, false);
+  for (int bin = 0; bin < 10 * bins; bin++) {
+    input->getNum()->Fill(bin % bins, bin / 10, 2);
+    input->getDen()->Fill(bin % bins, bin / 10, 3);
+  }
+  input->update();
+
+  auto benchmark = [&](bool updateEachTime) {
+    auto merged = std::make_unique<TH2FRatio>("merged", "merged", bins, 0, bins, bins, 0, bins, false);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < inputs; i++) {
+      merged->merge(input.get());
+      if (updateEachTime) {
+        merged->update();
+      }
+    }
+    merged->updateIfNeeded();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  };
+
+  auto eager = benchmark(true);
+  auto lazy = benchmark(false);
+  BOOST_TEST_MESSAGE("merging " << inputs << " TH2FRatios with " << bins << "x" << bins << " bins: "
+                                << eager << " ms with an update per input, " << lazy << " ms with one update");
+  BOOST_CHECK_LT(lazy, eager);
+}
@@ -0,0 +1,409 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    testHistogramComparatorKernels.cxx
+///
+
+#include "Common/HistogramComparatorKernels.h"
+#include "Common/ObjectComparatorBinByBinDeviation.h"
+#include "Common/ObjectComparatorChi2.h"
+#include "Common/ObjectComparatorKolmogorov.h"
+
+#include <TH1D.h>
+#include <TH1F.h>
+#include <TH2D.h>
+#include <TH2F.h>
+#include <TH3F.h>
+#include <TRandom3.h>
+#include <fmt/core.h>
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+#define BOOST_TEST_MODULE HistogramComparatorKernels test
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+using namespace o2::quality_control::core;
+using namespace o2::quality_control_modules::common;
+using namespace o2::quality_control_modules::common::comparator_kernels;
+
+namespace
+{
+using Range = std::optional<std::pair<double, double>>;
+
+template <typename H>
+std::unique_ptr<H> makeHistogram(const char* name, int nBins)
+{
+  if constexpr (std::is_base_of_v<TH2, H>) {
+    return std::make_unique<H>(name, name, nBins, 0, 10, nBins / 2, 0, 5);
+  } else {
+    return std::make_unique<H>(name, name, nBins, 0, 10);
+  }
+}
+
+// fills with a gaussian peak, weighted fills enable the sum of squared weights
+template <typename H>
+void fill(H& histogram, TRandom3& random, int entries, bool weighted)
+{
+  if (weighted) {
+    histogram.Sumw2();
+  }
+  for (int i = 0; i < entries; i++) {
+    double weight = weighted ? random.Uniform(0.5, 1.5) : 1;
+    if constexpr (std::is_base_of_v<TH2, H>) {
+      histogram.Fill(random.Gaus(5, 2.5), random.Gaus(2.5, 1.5), weight);
+    } else {
+      histogram.Fill(random.Gaus(5, 2.5), weight);
+    }
+  }
+}
+
+// a histogram and a reference with a slightly different shape and a different normalization
+template <typename H>
+std::pair<std::unique_ptr<H>, std::unique_ptr<H>> makePair(unsigned int seed, int nBins, bool weighted)
+{
+  TRandom3 random(seed);
+  auto histogram = makeHistogram<H>("histogram", nBins);
+  auto reference = makeHistogram<H>("reference", nBins);
+  fill(*histogram, random, 20 * nBins, weighted);
+  fill(*reference, random, 50 * nBins, weighted);
+  // a few empty and shifted bins
+  histogram->SetBinContent(3, 0);
+  reference->SetBinContent(3, 0);
+  reference->SetBinContent(5, 0);
+  histogram->SetBinContent(7, histogram->GetBinContent(7) * 1.5);
+  return { std::move(histogram), std::move(reference) };
+}
+
+// the implementations of the comparators before the kernels, which are the references for the equivalence
+
+Quality legacyBinByBin(TH1* histogram, TH1* referenceHistogram, Range xRange, Range yRange, double threshold, int maxAllowedBadBins, std::string& message)
+{
+  int binRangeX[2] = { 1, histogram->GetXaxis()->GetNbins() };
+  if (xRange.has_value()) {
+    binRangeX[0] = histogram->GetXaxis()->FindBin(xRange->first);
+    binRangeX[1] = histogram->GetXaxis()->FindBin(xRange->second);
+  }
+  int binRangeY[2] = { 1, histogram->GetYaxis()->GetNbins() };
+  if (yRange.has_value()) {
+    binRangeY[0] = histogram->GetYaxis()->FindBin(yRange->first);
+    binRangeY[1] = histogram->GetYaxis()->FindBin(yRange->second);
+  }
+  int binRangeZ[2] = { 1, histogram->GetZaxis()->GetNbins() };
+
+  int numberOfBadBins = 0;
+  for (int binX = binRangeX[0]; binX <= binRangeX[1]; binX++) {
+    for (int binY = binRangeY[0]; binY <= binRangeY[1]; binY++) {
+      for (int binZ = binRangeZ[0]; binZ <= binRangeZ[1]; binZ++) {
+        int bin = histogram->GetBin(binX, binY, binZ);
+        double val = histogram->GetBinContent(bin);
+        double refVal = referenceHistogram->GetBinContent(bin);
+        double deviation = (refVal == 0) ? 0 : std::abs((val - refVal) / refVal);
+        if (deviation > threshold) {
+          numberOfBadBins += 1;
+        }
+      }
+    }
+  }
+  if (numberOfBadBins > maxAllowedBadBins) {
+    message = fmt::format("bins above {:.2f}: {} > {}", threshold, numberOfBadBins, maxAllowedBadBins);
+    return Quality::Bad;
+  }
+  return Quality::Good;
+}
+
+double legacyChi2Probability(TH1* histogram, TH1* referenceHistogram, Range xRange, Range yRange)
+{
+  const double epsilon = 1.0e-6;
+  if (xRange.has_value()) {
+    int binMin = histogram->GetXaxis()->FindBin(xRange->first);
+    int binMax = histogram->GetXaxis()->FindBin(xRange->second - epsilon);
+    histogram->GetXaxis()->SetRange(binMin, binMax);
+    referenceHistogram->GetXaxis()->SetRange(binMin, binMax);
+  }
+  if (yRange.has_value()) {
+    int binMin = histogram->GetYaxis()->FindBin(yRange->first);
+    int binMax = histogram->GetYaxis()->FindBin(yRange->second - epsilon);
+    histogram->GetYaxis()->SetRange(binMin, binMax);
+    referenceHistogram->GetYaxis()->SetRange(binMin, binMax);
+  }
+  double testProbability = histogram->Chi2Test(referenceHistogram, "UU NORM");
+  histogram->GetXaxis()->SetRange(0, 0);
+  histogram->GetYaxis()->SetRange(0, 0);
+  referenceHistogram->GetXaxis()->SetRange(0, 0);
+  referenceHistogram->GetYaxis()->SetRange(0, 0);
+  return testProbability;
+}
+
+Quality legacyChi2(TH1* histogram, TH1* referenceHistogram, Range xRange, Range yRange, double threshold, std::string& message)
+{
+  double testProbability = legacyChi2Probability(histogram, referenceHistogram, xRange, yRange);
+  if (testProbability < threshold) {
+    message = fmt::format("chi2 test failed: {:.2f} < {:.2f}", testProbability, threshold);
+    return Quality::Bad;
+  }
+  return Quality::Good;
+}
+
+Quality legacyKolmogorov(TH1* histogram, TH1* referenceHistogram, double threshold, std::string& message)
+{
+  double testProbability = histogram->KolmogorovTest(referenceHistogram, "UU NORM");
+  if (testProbability < threshold) {
+    message = fmt::format("Kolmogorov test failed: {:.2f} < {:.2f}", testProbability, threshold);
+    return Quality::Bad;
+  }
+  return Quality::Good;
+}
+
+const std::vector<Range> xRanges{ std::nullopt, std::make_pair(2.0, 7.5), std::make_pair(-1.0, 3.0), std::make_pair(8.0, 12.0) };
+const std::vector<Range> yRanges{ std::nullopt, std::make_pair(1.0, 3.5) };
+
+template <typename H>
+void checkKernels(int nBins, bool weighted)
+{
+  for (unsigned int seed = 1; seed <= 3; seed++) {
+    auto [histogram, reference] = makePair<H>(seed, nBins, weighted);
+    BOOST_REQUIRE(isSupported(histogram.get(), reference.get()));
+
+    for (const auto& xRange : xRanges) {
+      for (const auto& yRange : yRanges) {
+        if (yRange.has_value() && histogram->GetDimension() == 1) {
+          continue;
+        }
+        // chi2, with the ranges set on the axes as the comparator does
+        double expected = legacyChi2Probability(histogram.get(), reference.get(), xRange, yRange);
+        BinSelection bins{ { 1, histogram->GetXaxis()->GetNbins() }, { 1, histogram->GetYaxis()->GetNbins() } };
+        if (xRange.has_value()) {
+          histogram->GetXaxis()->SetRange(histogram->GetXaxis()->FindBin(xRange->first), histogram->GetXaxis()->FindBin(xRange->second - 1.0e-6));
+          bins.x = { histogram->GetXaxis()->GetFirst(), histogram->GetXaxis()->GetLast() };
+          histogram->GetXaxis()->SetRange(0, 0);
+        }
+        if (yRange.has_value()) {
+          histogram->GetYaxis()->SetRange(histogram->GetYaxis()->FindBin(yRange->first), histogram->GetYaxis()->FindBin(yRange->second - 1.0e-6));
+          bins.y = { histogram->GetYaxis()->GetFirst(), histogram->GetYaxis()->GetLast() };
+          histogram->GetYaxis()->SetRange(0, 0);
+        }
+        auto chi2 = chi2TestUUNorm(histogram.get(), reference.get(), bins);
+        BOOST_REQUIRE(chi2.has_value());
+        BOOST_CHECK_EQUAL(chi2.value(), expected);
+
+        // bin-by-bin deviations
+        for (double threshold : { 0.0, 0.1, 0.5, -1.0 }) {
+          BinSelection deviationBins{ { 1, histogram->GetXaxis()->GetNbins() }, { 1, histogram->GetYaxis()->GetNbins() } };
+          if (xRange.has_value()) {
+            deviationBins.x = { histogram->GetXaxis()->FindBin(xRange->first), histogram->GetXaxis()->FindBin(xRange->second) };
+          }
+          if (yRange.has_value()) {
+            deviationBins.y = { histogram->GetYaxis()->FindBin(yRange->first), histogram->GetYaxis()->FindBin(yRange->second) };
+          }
+          std::string message;
+          auto count = countDeviatingBins(histogram.get(), reference.get(), deviationBins, threshold);
+          BOOST_REQUIRE(count.has_value());
+          // with no allowed bad bins, the legacy message contains the count
+          legacyBinByBin(histogram.get(), reference.get(), xRange, yRange, threshold, -1, message);
+          BOOST_CHECK_EQUAL(message, fmt::format("bins above {:.2f}: {} > {}", threshold, count.value(), -1));
+        }
+      }
+    }
+
+    // Kolmogorov, with and without the underflow and overflow bins
+    for (const char* option : { "UU NORM", "M", "UM", "OM" }) {
+      auto distance = kolmogorovTest(histogram.get(), reference.get(), option);
+      BOOST_REQUIRE(distance.has_value());
+      BOOST_CHECK_EQUAL(distance.value(), histogram->KolmogorovTest(reference.get(), option));
+    }
+  }
+}
+
+template <typename H>
+void checkComparators(int nBins, bool weighted)
+{
+  for (unsigned int seed = 1; seed <= 3; seed++) {
+    auto [histogram, reference] = makePair<H>(seed, nBins, weighted);
+    for (const auto& xRange : xRanges) {
+      for (const auto& yRange : yRanges) {
+        for (double threshold : { 0.01, 0.1, 0.3, 0.5, 0.9 }) {
+          std::string message, expectedMessage;
+
+          ObjectComparatorBinByBinDeviation binByBin;
+          binByBin.setThreshold(threshold);
+          ObjectComparatorChi2 chi2;
+          chi2.setThreshold(threshold);
+          if (xRange.has_value()) {
+            binByBin.setXRange(xRange.value());
+            chi2.setXRange(xRange.value());
+          }
+          if (yRange.has_value()) {
+            binByBin.setYRange(yRange.value());
+            chi2.setYRange(yRange.value());
+          }
+          // the comparators are called twice, to use the cached bin ranges
+          for (int i = 0; i < 2; i++) {
+            message.clear();
+            expectedMessage.clear();
+            BOOST_CHECK_EQUAL(binByBin.compare(histogram.get(), reference.get(), message),
+                              legacyBinByBin(histogram.get(), reference.get(), xRange, yRange, threshold, 0, expectedMessage));
+            BOOST_CHECK_EQUAL(message, expectedMessage);
+
+            message.clear();
+            expectedMessage.clear();
+            BOOST_CHECK_EQUAL(chi2.compare(histogram.get(), reference.get(), message),
+                              legacyChi2(histogram.get(), reference.get(), xRange, yRange, threshold, expectedMessage));
+            BOOST_CHECK_EQUAL(message, expectedMessage);
+          }
+
+          ObjectComparatorKolmogorov kolmogorov;
+          kolmogorov.setThreshold(threshold);
+          message.clear();
+          expectedMessage.clear();
+          BOOST_CHECK_EQUAL(kolmogorov.compare(histogram.get(), reference.get(), message),
+                            legacyKolmogorov(histogram.get(), reference.get(), threshold, expectedMessage));
+          BOOST_CHECK_EQUAL(message, expectedMessage);
+        }
+      }
+    }
+  }
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_kernels_TH1)
+{
+  checkKernels<TH1F>(100, false);
+  checkKernels<TH1F>(100, true);
+  checkKernels<TH1D>(100, false);
+  checkKernels<TH1D>(100, true);
+}
+
+BOOST_AUTO_TEST_CASE(test_kernels_TH2)
+{
+  checkKernels<TH2F>(40, false);
+  checkKernels<TH2F>(40, true);
+  checkKernels<TH2D>(40, false);
+  checkKernels<TH2D>(40, true);
+}
+
+BOOST_AUTO_TEST_CASE(test_comparators)
+{
+  checkComparators<TH1F>(100, false);
+  checkComparators<TH1D>(100, true);
+  checkComparators<TH2F>(40, false);
+  checkComparators<TH2D>(40, true);
+}
+
+BOOST_AUTO_TEST_CASE(test_unsupported)
+{
+  TH1F histogram("histogram", "histogram", 10, 0, 10);
+  TH1F otherBinning("otherBinning", "otherBinning", 10, 0, 20);
+  TH1D otherClass("otherClass", "otherClass", 10, 0, 10);
+  TH3F histogram3D("histogram3D", "histogram3D", 10, 0, 10, 10, 0, 10, 10, 0, 10);
+  histogram.Fill(1);
+  otherBinning.Fill(1);
+  otherClass.Fill(1);
+  histogram3D.Fill(1, 1, 1);
+
+  BOOST_CHECK(!isSupported(&histogram, &otherBinning));
+  BOOST_CHECK(!isSupported(&histogram, &otherClass));
+  BOOST_CHECK(!isSupported(&histogram3D, &histogram3D));
+  BOOST_CHECK(!countDeviatingBins(&histogram3D, &histogram3D, {}, 0.1).has_value());
+  BOOST_CHECK(!chi2TestUUNorm(&histogram, &otherBinning, {}).has_value());
+  // the probability is not computed by the kernel
+  BOOST_CHECK(!kolmogorovTest(&histogram, &histogram, "UU").has_value());
+
+  // the comparators fall back to ROOT
+  ObjectComparatorBinByBinDeviation binByBin;
+  binByBin.setThreshold(0.1);
+  std::string message;
+  BOOST_CHECK_EQUAL(binByBin.compare(&histogram3D, &histogram3D, message), Quality::Good);
+}
+
+BOOST_AUTO_TEST_CASE(test_AxisRangeCache)
+{
+  TH1F histogram("histogram", "histogram", 10, 0, 10);
+  AxisRangeCache cache;
+  int resolutions = 0;
+  auto resolve = [&](TAxis& axis, const std::pair<double, double>& range) {
+    resolutions++;
+    return BinRange{ axis.FindBin(range.first), axis.FindBin(range.second) };
+  };
+
+  auto bins = cache.get(*histogram.GetXaxis(), { 2.5, 4.5 }, resolve);
+  BOOST_CHECK_EQUAL(bins.first, 3);
+  BOOST_CHECK_EQUAL(bins.last, 5);
+  cache.get(*histogram.GetXaxis(), { 2.5, 4.5 }, resolve);
+  BOOST_CHECK_EQUAL(resolutions, 1);
+
+  // a different range or binning is resolved again
+  bins = cache.get(*histogram.GetXaxis(), { 2.5, 5.5 }, resolve);
+  BOOST_CHECK_EQUAL(bins.last, 6);
+  BOOST_CHECK_EQUAL(resolutions, 2);
+  TH1F rebinned("rebinned", "rebinned", 20, 0, 10);
+  bins = cache.get(*rebinned.GetXaxis(), { 2.5, 5.5 }, resolve);
+  BOOST_CHECK_EQUAL(bins.first, 6);
+  BOOST_CHECK_EQUAL(resolutions, 3);
+}
+
+// The comparison of the kernels with the previous implementations of the comparators. It is not run by default:
+// testHistogramComparatorKernels --run_test=benchmark_comparators
+BOOST_AUTO_TEST_CASE(benchmark_comparators, *boost::unit_test::disabled())
+{
+  constexpr int bins = 1000;
+  constexpr int repetitions = 10;
+  TRandom3 random(42);
+  TH2F histogram("histogram", "histogram", bins, 0, bins, bins, 0, bins);
+  TH2F reference("reference", "reference", bins, 0, bins, bins, 0, bins);
+  for (int binX = 1; binX <= bins; binX++) {
+    for (int binY = 1; binY <= bins; binY++) {
+      histogram.SetBinContent(binX, binY, random.Poisson(100));
+      reference.SetBinContent(binX, binY, random.Poisson(100));
+    }
+  }
+
+  auto measure = [&](auto&& function) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; i++) {
+      function();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / repetitions;
+  };
+  std::string message;
+  const Range xRange = std::make_pair(100.0, 900.0);
+
+  ObjectComparatorBinByBinDeviation binByBin;
+  binByBin.setThreshold(0.2);
+  binByBin.setXRange(xRange.value());
+  auto legacyBinByBinTime = measure([&] { legacyBinByBin(&histogram, &reference, xRange, std::nullopt, 0.2, 0, message); });
+  auto binByBinTime = measure([&] { binByBin.compare(&histogram, &reference, message); });
+
+  ObjectComparatorChi2 chi2;
+  chi2.setThreshold(0.05);
+  chi2.setXRange(xRange.value());
+  auto legacyChi2Time = measure([&] { legacyChi2(&histogram, &reference, xRange, std::nullopt, 0.05, message); });
+  auto chi2Time = measure([&] { chi2.compare(&histogram, &reference, message); });
+
+  ObjectComparatorKolmogorov kolmogorov;
+  kolmogorov.setThreshold(0.05);
+  auto legacyKolmogorovTime = measure([&] { legacyKolmogorov(&histogram, &reference, 0.05, message); });
+  auto kolmogorovTime = measure([&] { kolmogorov.compare(&histogram, &reference, message); });
+
+  BOOST_TEST_MESSAGE("comparing " << bins << "x" << bins << " TH2F, ms per comparison (previous implementation / kernel):"
+                                  << " bin-by-bin " << legacyBinByBinTime << " / " << binByBinTime
+                                  << ", chi2 " << legacyChi2Time << " / " << chi2Time
+                                  << ", Kolmogorov " << legacyKolmogorovTime << " / " << kolmogorovTime);
+  BOOST_CHECK_LT(binByBinTime, legacyBinByBinTime);
+  BOOST_CHECK_LT(chi2Time, legacyChi2Time);
+  BOOST_CHECK_LT(kolmogorovTime, legacyKolmogorovTime);
+}
@@ -0,0 +1,195 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    testHistogramFillBuffer.cxx
+///
+
+#include "Common/HistogramFillBuffer.h"
+
+#include <TH1F.h>
+#include <TH2F.h>
+#include <THnSparse.h>
+#include <TRandom3.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE HistogramFillBuffer test
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+using namespace o2::quality_control_modules::common;
+
+namespace
+{
+// runs the function for each slot in its own thread
+template <typename F>
+void runInThreads(size_t nThreads, F&& function)
+{
+  std::vector<std::thread> threads;
+  for (size_t thread = 0; thread < nThreads; thread++) {
+    threads.emplace_back(function, thread);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+std::vector<double> generate(size_t n, unsigned int seed)
+{
+  TRandom3 random(seed);
+  std::vector<double> values(n);
+  for (auto& value : values) {
+    value = random.Gaus(0, 3);
+  }
+  return values;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_fill_buffer_th1)
+{
+  constexpr size_t nThreads = 4;
+  const auto xs = generate(10000, 1);
+  TH1F expected("expected", "expected", 20, -5, 5);
+  TH1F actual("actual", "actual", 20, -5, 5);
+  for (auto x : xs) {
+    expected.Fill(x);
+  }
+
+  HistogramFillBuffer buffer(nThreads);
+  runInThreads(nThreads, [&](size_t thread) {
+    for (size_t i = thread; i < xs.size(); i += nThreads) {
+      buffer.fill(thread, &actual, xs[i]);
+    }
+  });
+  BOOST_CHECK_EQUAL(buffer.getNumberPendingFills(), xs.size());
+  BOOST_CHECK_EQUAL(actual.GetEntries(), 0);
+  buffer.reduce();
+  BOOST_CHECK_EQUAL(buffer.getNumberPendingFills(), 0);
+
+  BOOST_CHECK_EQUAL(actual.GetEntries(), expected.GetEntries());
+  BOOST_CHECK_CLOSE(actual.GetMean(), expected.GetMean(), 1e-6);
+  BOOST_CHECK_CLOSE(actual.GetStdDev(), expected.GetStdDev(), 1e-6);
+  for (int bin = 0; bin < expected.GetNcells(); bin++) {
+    BOOST_CHECK_EQUAL(actual.GetBinContent(bin), expected.GetBinContent(bin));
+  }
+
+  // the buffers can be reused
+  runInThreads(nThreads, [&](size_t thread) {
+    buffer.fill(thread, &actual, 0.1);
+  });
+  buffer.reduce();
+  BOOST_CHECK_EQUAL(actual.GetEntries(), expected.GetEntries() + nThreads);
+}
+
+BOOST_AUTO_TEST_CASE(test_fill_buffer_weights)
+{
+  HistogramFillBuffer buffer(2);
+  TH1F expected("expected", "expected", 10, 0, 10);
+  TH1F actual("actual", "actual", 10, 0, 10);
+
+  expected.Fill(1.5);
+  expected.Fill(2.5, 3.);
+  expected.Fill(2.5);
+  buffer.fill(0, &actual, 1.5);
+  buffer.fill(1, &actual, 2.5, 3.);
+  buffer.fill(0, &actual, 2.5);
+  buffer.reduce();
+
+  BOOST_REQUIRE(actual.GetSumw2N() > 0);
+  BOOST_CHECK_EQUAL(actual.GetEntries(), expected.GetEntries());
+  for (int bin = 0; bin < expected.GetNcells(); bin++) {
+    BOOST_CHECK_EQUAL(actual.GetBinContent(bin), expected.GetBinContent(bin));
+    BOOST_CHECK_EQUAL(actual.GetBinError(bin), expected.GetBinError(bin));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_fill_buffer_th2_thnsparse)
+{
+  constexpr size_t nThreads = 3;
+  const auto xs = generate(3000, 2);
+  const auto ys = generate(3000, 3);
+
+  TH2F expected2D("expected2D", "expected2D", 10, -5, 5, 10, -5, 5);
+  TH2F actual2D("actual2D", "actual2D", 10, -5, 5, 10, -5, 5);
+  int bins[2] = { 10, 10 };
+  double mins[2] = { -5, -5 };
+  double maxs[2] = { 5, 5 };
+  THnSparseF expectedSparse("expectedSparse", "expectedSparse", 2, bins, mins, maxs);
+  THnSparseF actualSparse("actualSparse", "actualSparse", 2, bins, mins, maxs);
+  for (size_t i = 0; i < xs.size(); i++) {
+    expected2D.Fill(xs[i], ys[i]);
+    double coordinates[2] = { xs[i], ys[i] };
+    expectedSparse.Fill(coordinates);
+  }
+
+  HistogramFillBuffer buffer(nThreads);
+  runInThreads(nThreads, [&](size_t thread) {
+    for (size_t i = thread; i < xs.size(); i += nThreads) {
+      buffer.fill(thread, &actual2D, xs[i], ys[i]);
+      double coordinates[2] = { xs[i], ys[i] };
+      buffer.fill(thread, &actualSparse, coordinates);
+    }
+  });
+  buffer.reduce();
+
+  BOOST_CHECK_EQUAL(actual2D.GetEntries(), expected2D.GetEntries());
+  BOOST_CHECK_CLOSE(actual2D.GetMean(2), expected2D.GetMean(2), 1e-6);
+  BOOST_CHECK_CLOSE(actual2D.GetCorrelationFactor(), expected2D.GetCorrelationFactor(), 1e-6);
+  for (int bin = 0; bin < expected2D.GetNcells(); bin++) {
+    BOOST_CHECK_EQUAL(actual2D.GetBinContent(bin), expected2D.GetBinContent(bin));
+  }
+  BOOST_CHECK_EQUAL(actualSparse.GetEntries(), expectedSparse.GetEntries());
+  BOOST_CHECK_EQUAL(actualSparse.GetNbins(), expectedSparse.GetNbins());
+}
+
+BOOST_AUTO_TEST_CASE(test_fill_buffer_invalid_slot)
+{
+  HistogramFillBuffer buffer(2);
+  TH1F histo("histo", "histo", 10, 0, 10);
+  BOOST_CHECK_THROW(buffer.fill(2, &histo, 1.), std::out_of_range);
+}
+
+// Measures the time to fill many histograms with an increasing number of threads. Run it explicitly with:
+// testHistogramFillBuffer --run_test=test_fill_buffer_scaling
+BOOST_AUTO_TEST_CASE(test_fill_buffer_scaling, *boost::unit_test::disabled())
+{
+  constexpr size_t nHistograms = 200;
+  constexpr size_t nFills = 20000000;
+  std::vector<std::unique_ptr<TH2F>> histograms;
+  for (size_t i = 0; i < nHistograms; i++) {
+    auto name = "histo" + std::to_string(i);
+    histograms.emplace_back(std::make_unique<TH2F>(name.c_str(), name.c_str(), 100, 0, 1, 100, 0, 1));
+  }
+
+  for (size_t nThreads : { 1, 2, 4, 8 }) {
+    HistogramFillBuffer buffer(nThreads);
+    auto start = std::chrono::steady_clock::now();
+    runInThreads(nThreads, [&](size_t thread) {
+      TRandom3 random(thread + 1);
+      for (size_t i = thread; i < nFills; i += nThreads) {
+        buffer.fill(thread, histograms[i % nHistograms].get(), random.Rndm(), random.Rndm());
+      }
+    });
+    auto filled = std::chrono::steady_clock::now();
+    buffer.reduce();
+    auto reduced = std::chrono::steady_clock::now();
+    std::cout << nThreads << " threads: fill " << std::chrono::duration<double, std::milli>(filled - start).count() << " ms, reduce "
+              << std::chrono::duration<double, std::milli>(reduced - filled).count() << " ms" << std::endl;
+  }
+}
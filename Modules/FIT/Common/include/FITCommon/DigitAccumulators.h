@@ -0,0 +1,158 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   DigitAccumulators.h
+/// \brief  Fixed-size accumulators for the processing of FIT digits
+///
+
+#ifndef QC_MODULE_FIT_DIGITACCUMULATORS_H
+#define QC_MODULE_FIT_DIGITACCUMULATORS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <TH1.h>
+#include <TH2.h>
+
+namespace o2::quality_control_modules::fit
+{
+
+/// \brief Set of PM (FEE module) hashes, stored as a bitset. It is iterated in increasing order, like a std::set<uint8_t>.
+class PMHashSet
+{
+ public:
+  void insert(uint8_t hash) { mWords[hash >> 6] |= uint64_t{ 1 } << (hash & 63); }
+  bool contains(uint8_t hash) const { return mWords[hash >> 6] & (uint64_t{ 1 } << (hash & 63)); }
+  void clear() { mWords = {}; }
+
+  template <typename Function>
+  void forEach(Function&& function) const
+  {
+    for (size_t word = 0; word < mWords.size(); word++) {
+      for (auto bits = mWords[word]; bits != 0; bits &= bits - 1) {
+        function(static_cast<uint8_t>(64 * word + __builtin_ctzll(bits)));
+      }
+    }
+  }
+
+ private:
+  std::array<uint64_t, 4> mWords{};
+};
+
+/// \brief Sums of the amplitudes per PM within one digit, in dense arrays indexed by the PM hash.
+///
+/// It replaces the std::map<uint8_t, int> and std::set<uint8_t> which used to be built for each digit, so that
+/// processing a digit does not allocate anything. The PMs are split into two groups (A and C sides, inner and outer
+/// rings), given once with setGroups(). clear() only resets the PMs touched by the previous digit.
+/// \tparam NSums number of independent sums kept for each PM (e.g. all channels and alive channels only)
+template <size_t NSums = 1>
+class PMAccumulator
+{
+ public:
+  static constexpr size_t sNHashes = 256;
+
+  /// \brief Sets the group of each PM, from a map of the PM hashes to true for the first group (e.g. A side).
+  /// The hashes absent from the map belong to the second group.
+  void setGroups(const std::map<uint8_t, bool>& hash2isFirstGroup)
+  {
+    mFirstGroup.clear();
+    for (const auto& [hash, isFirstGroup] : hash2isFirstGroup) {
+      if (isFirstGroup) {
+        mFirstGroup.insert(hash);
+      }
+    }
+  }
+  bool isFirstGroup(uint8_t hash) const { return mFirstGroup.contains(hash); }
+
+  /// \brief Records that the FEE module sent data for this digit
+  void addModule(uint8_t hash) { mModules.insert(hash); }
+  const PMHashSet& getModules() const { return mModules; }
+
+  void addAmplitude(uint8_t hash, int amplitude, size_t sum = 0)
+  {
+    mSums[sum][hash] += amplitude;
+    mTouched.insert(hash);
+  }
+  int getAmplitude(uint8_t hash, size_t sum = 0) const { return mSums[sum][hash]; }
+
+  /// \brief Returns the sums of the amplitudes of the PMs of the first and the second group, each PM contributing
+  /// its sum divided by 8 (as in the TCM).
+  std::pair<int, int> getGroupSumsBy8(size_t sum = 0) const
+  {
+    std::pair<int, int> result{ 0, 0 };
+    mTouched.forEach([&](uint8_t hash) {
+      (mFirstGroup.contains(hash) ? result.first : result.second) += mSums[sum][hash] >> 3;
+    });
+    return result;
+  }
+
+  /// \brief Resets the modules and the sums, to be called before each digit
+  void clear()
+  {
+    mTouched.forEach([this](uint8_t hash) {
+      for (auto& sums : mSums) {
+        sums[hash] = 0;
+      }
+    });
+    mTouched.clear();
+    mModules.clear();
+  }
+
+ private:
+  std::array<std::array<int, sNHashes>, NSums> mSums{};
+  PMHashSet mTouched;
+  PMHashSet mModules;
+  PMHashSet mFirstGroup;
+};
+
+/// \brief Channel data of one TF, kept in contiguous arrays to fill the per-channel histograms in one go at the end
+/// of the TF, one histogram after the other, instead of alternating between all of them for each channel.
+/// The histograms are filled in the same order as with one Fill() per channel, thus with the same results.
+/// The arrays are kept from one TF to the next one to avoid allocations.
+class ChannelDataBatch
+{
+ public:
+  void add(double channel, double time, double amplitude)
+  {
+    mChannels.push_back(channel);
+    mTimes.push_back(time);
+    mAmplitudes.push_back(amplitude);
+  }
+  size_t size() const { return mChannels.size(); }
+  void clear()
+  {
+    mChannels.clear();
+    mTimes.clear();
+    mAmplitudes.clear();
+  }
+
+  /// \brief Equivalent to histogram->Fill(channel) for each channel data
+  void fillChannels(TH1* histogram) const { histogram->FillN(static_cast<int>(size()), mChannels.data(), nullptr); }
+  /// \brief Equivalent to histogram->Fill(channel, time) for each channel data
+  void fillTimes(TH2* histogram) const { histogram->FillN(static_cast<int>(size()), mChannels.data(), mTimes.data(), nullptr); }
+  /// \brief Equivalent to histogram->Fill(channel, amplitude) for each channel data
+  void fillAmplitudes(TH2* histogram) const { histogram->FillN(static_cast<int>(size()), mChannels.data(), mAmplitudes.data(), nullptr); }
+
+ private:
+  std::vector<double> mChannels;
+  std::vector<double> mTimes;
+  std::vector<double> mAmplitudes;
+};
+
+} // namespace o2::quality_control_modules::fit
+
+#endif // QC_MODULE_FIT_DIGITACCUMULATORS_H
@@ -0,0 +1,238 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    testDigitAccumulators.cxx
+///
+
+#include "FITCommon/DigitAccumulators.h"
+
+#include <TH1F.h>
+#include <TH2F.h>
+#include <TRandom3.h>
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+
+#define BOOST_TEST_MODULE DigitAccumulators test
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+using namespace o2::quality_control_modules::fit;
+
+namespace
+{
+struct Channel {
+  uint8_t id;
+  int16_t time;
+  int16_t amplitude;
+};
+
+// a configuration similar to FT0: 208 channels read by 18 PMs, the TCM hash coming after them
+struct Setup {
+  std::array<uint8_t, 208> chID2PMhash;
+  std::map<uint8_t, bool> pmHash2isAside;
+  uint8_t tcmHash = 18;
+
+  Setup()
+  {
+    for (size_t ch = 0; ch < chID2PMhash.size(); ch++) {
+      chID2PMhash[ch] = ch / 12;
+    }
+    for (uint8_t pm = 0; pm < 18; pm++) {
+      pmHash2isAside[pm] = pm < 8;
+    }
+  }
+};
+
+std::vector<std::vector<Channel>> makeDigits(size_t nDigits, TRandom3& random)
+{
+  std::vector<std::vector<Channel>> digits(nDigits);
+  for (auto& digit : digits) {
+    int nChannels = random.Integer(40);
+    for (int i = 0; i < nChannels; i++) {
+      digit.push_back({ static_cast<uint8_t>(random.Integer(208)), static_cast<int16_t>(random.Gaus(0, 100)), static_cast<int16_t>(random.Integer(4096) - 100) });
+    }
+  }
+  return digits;
+}
+
+struct Result {
+  int sumA = 0;
+  int sumC = 0;
+  uint64_t modules = 0;
+
+  bool operator==(const Result& other) const { return sumA == other.sumA && sumC == other.sumC && modules == other.modules; }
+};
+
+// the way the DigitQcTasks used to process a digit
+Result processWithMaps(const std::vector<Channel>& digit, Setup& setup)
+{
+  std::set<uint8_t> setFEEmodules{};
+  std::map<uint8_t, int> mapPMhash2sumAmpl;
+  for (const auto& entry : setup.pmHash2isAside) {
+    mapPMhash2sumAmpl.insert({ entry.first, 0 });
+  }
+  for (const auto& chData : digit) {
+    setFEEmodules.insert(setup.chID2PMhash[chData.id]);
+    mapPMhash2sumAmpl[setup.chID2PMhash[chData.id]] += chData.amplitude;
+  }
+  setFEEmodules.insert(setup.tcmHash);
+  Result result;
+  for (const auto& entry : mapPMhash2sumAmpl) {
+    if (setup.pmHash2isAside[entry.first]) {
+      result.sumA += entry.second >> 3;
+    } else {
+      result.sumC += entry.second >> 3;
+    }
+  }
+  for (const auto& feeHash : setFEEmodules) {
+    result.modules = result.modules * 31 + feeHash;
+  }
+  return result;
+}
+
+Result processWithAccumulator(const std::vector<Channel>& digit, const Setup& setup, PMAccumulator<1>& accumulator)
+{
+  accumulator.clear();
+  for (const auto& chData : digit) {
+    const auto pmHash = setup.chID2PMhash[chData.id];
+    accumulator.addModule(pmHash);
+    accumulator.addAmplitude(pmHash, chData.amplitude);
+  }
+  accumulator.addModule(setup.tcmHash);
+  Result result;
+  std::tie(result.sumA, result.sumC) = accumulator.getGroupSumsBy8();
+  accumulator.getModules().forEach([&](uint8_t feeHash) {
+    result.modules = result.modules * 31 + feeHash;
+  });
+  return result;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_PMHashSet)
+{
+  PMHashSet set;
+  std::set<uint8_t> reference;
+  for (uint8_t hash : { 200, 3, 64, 63, 0, 255, 3, 128 }) {
+    set.insert(hash);
+    reference.insert(hash);
+  }
+  std::vector<uint8_t> result;
+  set.forEach([&](uint8_t hash) { result.push_back(hash); });
+  BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), reference.begin(), reference.end());
+  BOOST_CHECK(set.contains(255));
+  BOOST_CHECK(!set.contains(1));
+
+  set.clear();
+  result.clear();
+  set.forEach([&](uint8_t hash) { result.push_back(hash); });
+  BOOST_CHECK(result.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_PMAccumulator)
+{
+  Setup setup;
+  PMAccumulator<2> accumulator;
+  accumulator.setGroups(setup.pmHash2isAside);
+  BOOST_CHECK(accumulator.isFirstGroup(0));
+  BOOST_CHECK(!accumulator.isFirstGroup(8));
+  BOOST_CHECK(!accumulator.isFirstGroup(100)); // unknown hashes are in the second group
+
+  accumulator.addAmplitude(0, 17);
+  accumulator.addAmplitude(0, 8);
+  accumulator.addAmplitude(9, -20);
+  accumulator.addAmplitude(9, 80, 1);
+  BOOST_CHECK_EQUAL(accumulator.getAmplitude(0), 25);
+  BOOST_CHECK(accumulator.getGroupSumsBy8() == std::make_pair(3, -3));
+  BOOST_CHECK(accumulator.getGroupSumsBy8(1) == std::make_pair(0, 10));
+
+  accumulator.clear();
+  BOOST_CHECK_EQUAL(accumulator.getAmplitude(0), 0);
+  BOOST_CHECK_EQUAL(accumulator.getAmplitude(9, 1), 0);
+  BOOST_CHECK(accumulator.getGroupSumsBy8() == std::make_pair(0, 0));
+}
+
+BOOST_AUTO_TEST_CASE(test_PMAccumulator_same_as_maps)
+{
+  Setup setup;
+  TRandom3 random(42);
+  PMAccumulator<1> accumulator;
+  accumulator.setGroups(setup.pmHash2isAside);
+  for (const auto& digit : makeDigits(10000, random)) {
+    BOOST_REQUIRE(processWithAccumulator(digit, setup, accumulator) == processWithMaps(digit, setup));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_ChannelDataBatch)
+{
+  TH1F channels("channels", "channels", 208, 0, 208);
+  TH2F times("times", "times", 208, 0, 208, 100, -200, 200);
+  TH1F channelsBatch("channelsBatch", "channels", 208, 0, 208);
+  TH2F timesBatch("timesBatch", "times", 208, 0, 208, 100, -200, 200);
+
+  TRandom3 random(1);
+  ChannelDataBatch batch;
+  for (int tf = 0; tf < 3; tf++) {
+    batch.clear();
+    for (const auto& digit : makeDigits(1000, random)) {
+      for (const auto& chData : digit) {
+        channels.Fill(chData.id);
+        times.Fill(chData.id, chData.time);
+        batch.add(chData.id, chData.time, chData.amplitude);
+      }
+    }
+    batch.fillChannels(&channelsBatch);
+    batch.fillTimes(&timesBatch);
+  }
+
+  BOOST_CHECK_EQUAL(channels.GetEntries(), channelsBatch.GetEntries());
+  BOOST_CHECK_EQUAL(times.GetEntries(), timesBatch.GetEntries());
+  BOOST_CHECK_EQUAL(channels.GetMean(), channelsBatch.GetMean());
+  BOOST_CHECK_EQUAL(times.GetMean(2), timesBatch.GetMean(2));
+  for (int bin = 0; bin < times.GetNcells(); bin++) {
+    BOOST_REQUIRE_EQUAL(times.GetBinContent(bin), timesBatch.GetBinContent(bin));
+  }
+  for (int bin = 0; bin < channels.GetNcells(); bin++) {
+    BOOST_REQUIRE_EQUAL(channels.GetBinContent(bin), channelsBatch.GetBinContent(bin));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(benchmark_digits, *boost::unit_test::disabled())
+{
+  Setup setup;
+  TRandom3 random(7);
+  const auto digits = makeDigits(200000, random);
+  const int repetitions = 10;
+
+  auto measure = [&](const char* name, auto&& process) {
+    uint64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; i++) {
+      for (const auto& digit : digits) {
+        auto result = process(digit);
+        checksum += result.sumA + result.sumC + result.modules;
+      }
+    }
+    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << repetitions * digits.size() / duration.count() / 1e6 << " M digits/s (checksum " << checksum << ")" << std::endl;
+  };
+
+  measure("std::map and std::set", [&](const auto& digit) { return processWithMaps(digit, setup); });
+  PMAccumulator<1> accumulator;
+  accumulator.setGroups(setup.pmHash2isAside);
+  measure("PMAccumulator", [&](const auto& digit) { return processWithAccumulator(digit, setup, accumulator); });
+}
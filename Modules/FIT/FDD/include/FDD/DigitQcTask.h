@@ -41,6 +41,7 @@
 #include "QualityControl/TaskInterface.h"
 #include "FDDBase/Constants.h"
 #include "FITCommon/DetectorFIT.h"
+#include "FITCommon/DigitAccumulators.h"
 
 using namespace o2::quality_control::core;
 
@@ -124,6 +125,9 @@ class DigitQcTask final : public TaskInterface
   std::array<uint8_t, sNCHANNELS_PM> mChID2PMhash; // map chID->hashed PM value
   uint8_t mTCMhash;                                // hash value for TCM, and bin position in hist
   std::map<uint8_t, bool> mMapPMhash2isAside;
+  // per-digit amplitude sums of the PMs, the first group being the A side
+  o2::quality_control_modules::fit::PMAccumulator<1> mPMAccumulator;    //!
+  o2::quality_control_modules::fit::ChannelDataBatch mChannelDataBatch; //! filled in the histograms at the end of each TF
 
   typename Detector_t::TrgMap_t mMapPMbits = Detector_t::sMapPMbits;
   typename Detector_t::TrgMap_t mMapTechTrgBits = Detector_t::sMapTechTrgBits;
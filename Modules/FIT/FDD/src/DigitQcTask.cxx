@@ -288,6 +288,7 @@ void DigitQcTask::initialize(o2::framework::InitContext& /*ctx*/)
       mTCMhash = mapFEE2hash[moduleName];
     }
   }
+  mPMAccumulator.setGroups(mMapPMhash2isAside);
 
   mHistBCvsFEEmodules = std::make_unique<TH2F>("BCvsFEEmodules", "BC vs FEE module;BC;FEE", sBCperOrbit, 0, sBCperOrbit, mapFEE2hash.size(), 0, mapFEE2hash.size());
   mHistOrbitVsFEEmodules = std::make_unique<TH2F>("OrbitVsFEEmodules", "Orbit vs FEE module;Orbit;FEE", sOrbitsPerTF, 0, sOrbitsPerTF, mapFEE2hash.size(), 0, mapFEE2hash.size());
@@ -493,6 +494,7 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
     mTimeSum += timeMaxNS - timeMinNS;
   }
   int mPMChargeTotalAside, mPMChargeTotalCside;
+  mChannelDataBatch.clear();
   for (auto& digit : digits) {
     // Exclude all BCs, in which laser signals are expected (and trigger outputs are blocked)
     if (digit.mTriggers.getOutputsAreBlocked()) {
@@ -518,7 +520,7 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
       }
     } // ak
 
-    std::set<uint8_t> setFEEmodules{};
+    mPMAccumulator.clear();
     // reset triggers
     for (auto& entry : mMapTrgSoftware) {
       mMapTrgSoftware[entry.first] = false;
@@ -538,25 +540,18 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
     // Initialize array elements to zero using std::fill
     std::fill(ChVertexArray.begin(), ChVertexArray.end(), 0);
 
-    std::map<uint8_t, int> mapPMhash2sumAmpl;
-    for (const auto& entry : mMapPMhash2isAside) {
-      mapPMhash2sumAmpl.insert({ entry.first, 0 });
-    }
     for (const auto& chData : vecChData) {
       if (static_cast<int>(chData.mPMNumber) < sNCHANNELS_C)
         mPMChargeTotalCside += chData.mChargeADC;
       else
         mPMChargeTotalAside += chData.mChargeADC;
 
-      mHistTime2Ch->Fill(static_cast<Double_t>(chData.mPMNumber), static_cast<Double_t>(chData.mTime));
-      mHistAmp2Ch->Fill(static_cast<Double_t>(chData.mPMNumber), static_cast<Double_t>(chData.mChargeADC));
+      mChannelDataBatch.add(chData.mPMNumber, chData.mTime, chData.mChargeADC);
       mHistEventDensity2Ch->Fill(static_cast<Double_t>(chData.mPMNumber), static_cast<Double_t>(digit.mIntRecord.differenceInBC(mStateLastIR2Ch[chData.mPMNumber])));
       mStateLastIR2Ch[chData.mPMNumber] = digit.mIntRecord;
-      mHistChannelID->Fill(chData.mPMNumber);
       if (chData.mChargeADC > 0) {
         mHistNumADC->Fill(chData.mPMNumber);
       }
-      mHistNumCFD->Fill(chData.mPMNumber);
       if (mSetAllowedChIDs.size() != 0 && mSetAllowedChIDs.find(static_cast<unsigned int>(chData.mPMNumber)) != mSetAllowedChIDs.end()) {
         if (static_cast<int>(chData.mPMNumber) == 0 && hasData[4]) {
           mMapHistAmp1DCoincidence[0]->Fill(chData.mChargeADC);
@@ -614,15 +609,16 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
         mHistChDataBits->Fill(chData.mPMNumber, binPos);
       }
 
-      setFEEmodules.insert(mChID2PMhash[chData.mPMNumber]);
+      const auto pmHash = mChID2PMhash[static_cast<uint8_t>(chData.mPMNumber)];
+      mPMAccumulator.addModule(pmHash);
 
       if (chIsVertexEvent(chData, true)) {
-        if (!mMapPMhash2isAside[mChID2PMhash[static_cast<uint8_t>(chData.mPMNumber)]]) {
+        if (!mPMAccumulator.isFirstGroup(pmHash)) {
           pmSumTimeC += chData.mTime;
           pmNChanC++;
           if ((int)chData.mPMNumber < sNCHANNELS_Physics)
             ChVertexArray[chData.mPMNumber] = 1;
-        } else if (mMapPMhash2isAside[mChID2PMhash[static_cast<uint8_t>(chData.mPMNumber)]]) {
+        } else {
           pmSumTimeA += chData.mTime;
           pmNChanA++;
           if ((int)chData.mPMNumber < sNCHANNELS_Physics)
@@ -639,16 +635,11 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
       }
 
       if (chData.getFlag(o2::fdd::ChannelData::kIsCFDinADCgate)) {
-        mapPMhash2sumAmpl[mChID2PMhash[static_cast<uint8_t>(chData.mPMNumber)]] += static_cast<Int_t>(chData.mChargeADC);
+        mPMAccumulator.addAmplitude(pmHash, static_cast<Int_t>(chData.mChargeADC));
       }
     }
 
-    for (const auto& entry : mapPMhash2sumAmpl) {
-      if (mMapPMhash2isAside[entry.first])
-        pmSumAmplA += static_cast<int>(entry.second >> 3);
-      else
-        pmSumAmplC += static_cast<int>(entry.second >> 3);
-    }
+    std::tie(pmSumAmplA, pmSumAmplC) = mPMAccumulator.getGroupSumsBy8();
     auto pmNChan = pmNChanA + pmNChanC;
     auto pmSumAmpl = pmSumAmplA + pmSumAmplC;
     if (isTCM) {
@@ -671,15 +662,15 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
     mPMChargeTotalCside = static_cast<int>(mPMChargeTotalCside >> 3);
 
     if (isTCM) {
-      setFEEmodules.insert(mTCMhash);
+      mPMAccumulator.addModule(mTCMhash);
       mHist2CorrTCMchAndPMch->Fill(digit.mTriggers.getAmplA() + digit.mTriggers.getAmplC(), (digit.mTriggers.getAmplA() + digit.mTriggers.getAmplC()) - (mPMChargeTotalAside + mPMChargeTotalCside));
     }
-    for (const auto& feeHash : setFEEmodules) {
+    mPMAccumulator.getModules().forEach([&](uint8_t feeHash) {
       mHistBCvsFEEmodules->Fill(static_cast<double>(digit.getIntRecord().bc), static_cast<double>(feeHash));
       mHistOrbitVsFEEmodules->Fill(static_cast<double>(digit.getIntRecord().orbit % sOrbitsPerTF), static_cast<double>(feeHash));
       if (digit.mTriggers.getVertex())
         mHistBcVsFeeForVtxTrg->Fill(static_cast<double>(digit.getIntRecord().bc), static_cast<double>(feeHash));
-    }
+    });
 
     if (isTCM && digit.mTriggers.getDataIsValid() && !digit.mTriggers.getOutputsAreBlocked()) {
       if (digit.mTriggers.getNChanA() > 0) {
@@ -828,6 +819,10 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
     }
     // end of triggers re-computation
   }
+  mChannelDataBatch.fillTimes(mHistTime2Ch.get());
+  mChannelDataBatch.fillAmplitudes(mHistAmp2Ch.get());
+  mChannelDataBatch.fillChannels(mHistChannelID.get());
+  mChannelDataBatch.fillChannels(mHistNumCFD.get());
 }
 
 void DigitQcTask::endOfCycle()
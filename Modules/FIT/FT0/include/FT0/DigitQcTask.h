@@ -44,6 +44,7 @@
 #include "DataFormatsFT0/ChannelData.h"
 #include "FITCommon/DetectorFIT.h"
 #include "FITCommon/HelperFIT.h"
+#include "FITCommon/DigitAccumulators.h"
 
 using namespace o2::quality_control::core;
 
@@ -106,6 +107,11 @@ class DigitQcTask final : public TaskInterface
   std::array<uint8_t, sNCHANNELS_PM> mChID2PMhash; // map chID->hashed PM value
   uint8_t mTCMhash;                                // hash value for TCM, and bin position in hist
   std::map<uint8_t, bool> mMapPMhash2isAside;
+  // per-digit amplitude sums of the PMs, the first group being the A side
+  static constexpr size_t sSumAll = 0;
+  static constexpr size_t sSumAliveChannels = 1;
+  o2::quality_control_modules::fit::PMAccumulator<2> mPMAccumulator;    //!
+  o2::quality_control_modules::fit::ChannelDataBatch mChannelDataBatch; //! filled in the histograms at the end of each TF
   typename Detector_t::TrgMap_t mMapPMbits = Detector_t::sMapPMbits;
   typename Detector_t::TrgMap_t mMapTechTrgBitsExtra = Detector_t::sMapTechTrgBitsExtra;
   typename Detector_t::TrgMap_t mMapTrgBits = Detector_t::sMapTrgBits;
@@ -160,6 +160,7 @@ void DigitQcTask::initialize(o2::framework::InitContext& /*ctx*/)
       mTCMhash = mapFEE2hash[moduleName];
     }
   }
+  mPMAccumulator.setGroups(mMapPMhash2isAside);
 
   std::map<unsigned int, std::string> mapBin2ModuleName;
   std::transform(mapFEE2hash.begin(), mapFEE2hash.end(), std::inserter(mapBin2ModuleName, std::end(mapBin2ModuleName)), [](const auto& entry) { return std::pair<unsigned int, std::string>{ static_cast<unsigned int>(entry.second), entry.first }; });
@@ -377,6 +378,7 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
     mTimeMaxNS = std::max(mTimeMaxNS, timeMaxNS);
     mTimeSum += timeMaxNS - timeMinNS;
   }
+  mChannelDataBatch.clear();
   for (auto& digit : digits) {
     // Exclude all BCs, in which laser signals are expected (and trigger outputs are blocked)
     const auto& vecChData = digit.getBunchChannelData(channels);
@@ -393,7 +395,7 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
       mHistBCBeamBeam->Fill(digit.getBC());
     }
 
-    std::set<uint8_t> setFEEmodules{};
+    mPMAccumulator.clear();
 
     int32_t pmSumAmplA = 0;
     int32_t pmSumAmplC = 0;
@@ -404,23 +406,14 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
     int pmAverTimeA{ 0 };
     int pmAverTimeC{ 0 };
 
-    std::map<uint8_t, int> mapPMhash2sumAmpl;
-    std::map<uint8_t, int> mapPMhash2sumAmplAliveChannels;
-    for (const auto& entry : mMapPMhash2isAside) {
-      mapPMhash2sumAmpl.insert({ entry.first, 0 });
-      mapPMhash2sumAmplAliveChannels.insert({ entry.first, 0 });
-    }
-
     int32_t sumampAVTXBeamBeam = 0;
     int32_t sumampCVTXBeamBeam = 0;
     int32_t sumampAVTXBeamBeam_by8 = 0;
     int32_t sumampCVTXBeamBeam_by8 = 0;
 
     for (const auto& chData : vecChData) {
-      mHistTime2Ch->Fill(static_cast<Double_t>(chData.ChId), static_cast<Double_t>(chData.CFDTime));
-      mHistAmp2Ch->Fill(static_cast<Double_t>(chData.ChId), static_cast<Double_t>(chData.QTCAmpl));
+      mChannelDataBatch.add(chData.ChId, chData.CFDTime, chData.QTCAmpl);
       mStateLastIR2Ch[chData.ChId] = digit.mIntRecord;
-      mHistChannelID->Fill(chData.ChId);
       if (mSetAllowedChIDs.size() != 0 && mSetAllowedChIDs.find(static_cast<unsigned int>(chData.ChId)) != mSetAllowedChIDs.end()) {
         mMapHistAmp1D[chData.ChId]->Fill(chData.QTCAmpl);
         mMapHistTime1D[chData.ChId]->Fill(chData.CFDTime);
@@ -437,20 +430,21 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
         mHistChDataBits->Fill(chData.ChId, binPos);
       }
 
-      setFEEmodules.insert(mChID2PMhash[chData.ChId]);
+      const auto pmHash = mChID2PMhash[static_cast<uint8_t>(chData.ChId)];
+      mPMAccumulator.addModule(pmHash);
 
       if (((chData.ChainQTC & mPMbitsToCheck_ChID) == mGoodPMbits_ChID) && std::abs(static_cast<Int_t>(chData.CFDTime)) < mTrgValidation.mTrgOrGate) {
-        if (!mMapPMhash2isAside[mChID2PMhash[static_cast<uint8_t>(chData.ChId)]]) {
+        if (!mPMAccumulator.isFirstGroup(pmHash)) {
           pmSumTimeC += chData.CFDTime;
           pmNChanC++;
-        } else if (mMapPMhash2isAside[mChID2PMhash[static_cast<uint8_t>(chData.ChId)]]) {
+        } else {
           pmSumTimeA += chData.CFDTime;
           pmNChanA++;
         }
         mHistChIDperBC->Fill(digit.getBC(), chData.ChId);
       }
       if (chData.getFlag(o2::ft0::ChannelData::kIsCFDinADCgate)) {
-        mapPMhash2sumAmpl[mChID2PMhash[static_cast<uint8_t>(chData.ChId)]] += static_cast<Int_t>(chData.QTCAmpl);
+        mPMAccumulator.addAmplitude(pmHash, static_cast<Int_t>(chData.QTCAmpl), sSumAll);
       }
 
       const auto chId = static_cast<uint8_t>(chData.ChId);
@@ -458,13 +452,13 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
         continue;
       }
       if (chData.getFlag(o2::ft0::ChannelData::kIsCFDinADCgate) && digit.mTriggers.getVertex() && isCollidingBC) {
-        mapPMhash2sumAmplAliveChannels[mChID2PMhash[chId]] += static_cast<Int_t>(chData.QTCAmpl);
+        mPMAccumulator.addAmplitude(pmHash, static_cast<Int_t>(chData.QTCAmpl), sSumAliveChannels);
       }
 
       if (digit.mTriggers.getVertex() && chData.getFlag(o2::ft0::ChannelData::kIsCFDinADCgate) && isCollidingBC) {
-        if (!mMapPMhash2isAside[mChID2PMhash[static_cast<uint8_t>(chData.ChId)]]) {
+        if (!mPMAccumulator.isFirstGroup(pmHash)) {
           sumampCVTXBeamBeam += chData.QTCAmpl;
-        } else if (mMapPMhash2isAside[mChID2PMhash[static_cast<uint8_t>(chData.ChId)]]) {
+        } else {
           sumampAVTXBeamBeam += chData.QTCAmpl;
         }
       }
@@ -473,22 +467,12 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
     mHistSumAmpCVTXBeamBeam->Fill(sumampCVTXBeamBeam);
     mHistSumAmpACVTXBeamBeam->Fill(sumampAVTXBeamBeam + sumampCVTXBeamBeam);
 
-    for (const auto& entry : mapPMhash2sumAmplAliveChannels) {
-      if (mMapPMhash2isAside[entry.first]) {
-        sumampAVTXBeamBeam_by8 += (entry.second >> 3);
-      } else
-        sumampCVTXBeamBeam_by8 += (entry.second >> 3);
-    }
+    std::tie(sumampAVTXBeamBeam_by8, sumampCVTXBeamBeam_by8) = mPMAccumulator.getGroupSumsBy8(sSumAliveChannels);
     mHistSumAmpAVTXBeamBeam_by8->Fill(sumampAVTXBeamBeam_by8);
     mHistSumAmpCVTXBeamBeam_by8->Fill(sumampCVTXBeamBeam_by8);
     mHistSumAmpACVTXBeamBeam_by8->Fill(sumampAVTXBeamBeam_by8 + sumampCVTXBeamBeam_by8);
 
-    for (const auto& entry : mapPMhash2sumAmpl) {
-      if (mMapPMhash2isAside[entry.first])
-        pmSumAmplA += (entry.second >> 3);
-      else
-        pmSumAmplC += (entry.second >> 3);
-    }
+    std::tie(pmSumAmplA, pmSumAmplC) = mPMAccumulator.getGroupSumsBy8(sSumAll);
 
     if (isTCM) {
       if (pmNChanA > 1) {
@@ -505,7 +489,7 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
       } else {
         pmAverTimeC = 0;
       }
-      setFEEmodules.insert(mTCMhash);
+      mPMAccumulator.addModule(mTCMhash);
 
     } else {
       pmAverTimeA = o2::fit::Triggers::DEFAULT_TIME;
@@ -513,10 +497,10 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
     }
     auto vtxPos = (pmNChanA && pmNChanC) ? (pmAverTimeC - pmAverTimeA) / 2 : 0;
 
-    for (const auto& feeHash : setFEEmodules) {
+    mPMAccumulator.getModules().forEach([&](uint8_t feeHash) {
       mHistBCvsFEEmodules->Fill(static_cast<double>(digit.getIntRecord().bc), static_cast<double>(feeHash));
       mHistOrbitVsFEEmodules->Fill(static_cast<double>(digit.getIntRecord().orbit % sOrbitsPerTF), static_cast<double>(feeHash));
-    }
+    });
 
     if (isTCM && digit.mTriggers.getDataIsValid() && !digit.mTriggers.getOutputsAreBlocked()) {
       if (digit.mTriggers.getNChanA() > 0) {
@@ -565,6 +549,9 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
     }
     // end of triggers re-computation
   }
+  mChannelDataBatch.fillTimes(mHistTime2Ch.get());
+  mChannelDataBatch.fillAmplitudes(mHistAmp2Ch.get());
+  mChannelDataBatch.fillChannels(mHistChannelID.get());
 }
 
 void DigitQcTask::endOfCycle()
@@ -43,6 +43,7 @@
 #include "DataFormatsFV0/ChannelData.h"
 
 #include "FITCommon/DetectorFIT.h"
+#include "FITCommon/DigitAccumulators.h"
 
 using namespace o2::quality_control::core;
 
@@ -132,6 +133,11 @@ class DigitQcTask final : public TaskInterface
   std::array<uint8_t, sNCHANNELS_FV0_PLUSREF> mChID2PMhash; // map chID->hashed PM value
   uint8_t mTCMhash;                                         // hash value for TCM, and bin position in hist
   std::map<uint8_t, bool> mMapPMhash2isInner;
+  // per-digit amplitude sums of the PMs, the first group being the inner rings
+  static constexpr size_t sSumAll = 0;
+  static constexpr size_t sSumAliveChannels = 1;
+  o2::quality_control_modules::fit::PMAccumulator<2> mPMAccumulator;    //!
+  o2::quality_control_modules::fit::ChannelDataBatch mChannelDataBatch; //! filled in the histograms at the end of each TF
 
   typename Detector_t::TrgMap_t mMapPMbits = Detector_t::sMapPMbits;
   typename Detector_t::TrgMap_t mMapTechTrgBits = Detector_t::sMapTechTrgBits;
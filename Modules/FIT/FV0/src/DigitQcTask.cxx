@@ -258,6 +258,7 @@ void DigitQcTask::initialize(o2::framework::InitContext& /*ctx*/)
       mTCMhash = mapFEE2hash[moduleName];
     }
   }
+  mPMAccumulator.setGroups(mMapPMhash2isInner);
 
   mHistBCvsFEEmodules = std::make_unique<TH2F>("BCvsFEEmodules", "BC vs FEE module;BC;FEE", sBCperOrbit, 0, sBCperOrbit, mapFEE2hash.size(), 0, mapFEE2hash.size());
   mHistBcVsFeeForOrATrg = std::make_unique<TH2F>("BCvsFEEmodulesForOrATrg", "BC vs FEE module for OrA trigger;BC;FEE", sBCperOrbit, 0, sBCperOrbit, mapFEE2hash.size(), 0, mapFEE2hash.size());
@@ -505,6 +506,7 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
     mTimeMaxNS = std::max(mTimeMaxNS, timeMaxNS);
     mTimeSum += timeMaxNS - timeMinNS;
   }
+  mChannelDataBatch.clear();
   for (auto& digit : digits) {
     // Exclude all BCs, in which laser signals are expected (and trigger outputs are blocked)
     if (digit.mTriggers.getOutputsAreBlocked()) {
@@ -524,7 +526,7 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
       mHistBCBeamBeam->Fill(digit.getBC());
     }
 
-    std::set<uint8_t> setFEEmodules{};
+    mPMAccumulator.clear();
     // reset triggers
     for (auto& entry : mMapTrgSoftware) {
       mMapTrgSoftware[entry.first] = false;
@@ -536,27 +538,17 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
     Int_t pmSumTime = 0;
     Int_t pmAverTime = 0;
 
-    std::map<uint8_t, int> mapPMhash2sumAmpl;
-    std::map<uint8_t, int> mapPMhash2sumAmplAliveChannels;
-    for (const auto& entry : mMapPMhash2isInner) {
-      mapPMhash2sumAmpl.insert({ entry.first, 0 });
-      mapPMhash2sumAmplAliveChannels.insert({ entry.first, 0 });
-    }
-
     int32_t sumampAOrABeamBeam = 0;
     int32_t sumampAOrABeamBeam_by8_inner = 0;
     int32_t sumampAOrABeamBeam_by8_outer = 0;
 
     for (const auto& chData : vecChData) {
-      mHistTime2Ch->Fill(static_cast<Double_t>(chData.ChId), static_cast<Double_t>(chData.CFDTime));
-      mHistAmp2Ch->Fill(static_cast<Double_t>(chData.ChId), static_cast<Double_t>(chData.QTCAmpl));
+      mChannelDataBatch.add(chData.ChId, chData.CFDTime, chData.QTCAmpl);
       mHistEventDensity2Ch->Fill(static_cast<Double_t>(chData.ChId), static_cast<Double_t>(digit.mIntRecord.differenceInBC(mStateLastIR2Ch[chData.ChId])));
       mStateLastIR2Ch[chData.ChId] = digit.mIntRecord;
-      mHistChannelID->Fill(chData.ChId);
       if (chData.QTCAmpl > 0) {
         mHistNumADC->Fill(chData.ChId);
       }
-      mHistNumCFD->Fill(chData.ChId);
       if (mSetAllowedChIDsAmpVsTime.size() != 0 && mSetAllowedChIDsAmpVsTime.find(static_cast<unsigned int>(chData.ChId)) != mSetAllowedChIDsAmpVsTime.end()) {
         mMapHistAmpVsTime[chData.ChId]->Fill(chData.QTCAmpl, chData.CFDTime);
       }
@@ -564,7 +556,8 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
         mHistChDataBits->Fill(chData.ChId, binPos);
       }
 
-      setFEEmodules.insert(mChID2PMhash[chData.ChId]);
+      const auto pmHash = mChID2PMhash[static_cast<uint8_t>(chData.ChId)];
+      mPMAccumulator.addModule(pmHash);
 
       if (chData.ChId >= sNCHANNELS_FV0) { // skip reference PMT
         continue;
@@ -579,7 +572,7 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
         }
       }
       if (chData.getFlag(o2::fv0::ChannelData::kIsCFDinADCgate)) {
-        mapPMhash2sumAmpl[mChID2PMhash[static_cast<uint8_t>(chData.ChId)]] += static_cast<Int_t>(chData.QTCAmpl);
+        mPMAccumulator.addAmplitude(pmHash, static_cast<Int_t>(chData.QTCAmpl), sSumAll);
       }
 
       const auto chId = static_cast<uint8_t>(chData.ChId);
@@ -588,7 +581,7 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
       }
 
       if (chData.getFlag(o2::fv0::ChannelData::kIsCFDinADCgate) && digit.mTriggers.getOrA() && isCollidingBC) {
-        mapPMhash2sumAmplAliveChannels[mChID2PMhash[chId]] += static_cast<Int_t>(chData.QTCAmpl);
+        mPMAccumulator.addAmplitude(pmHash, static_cast<Int_t>(chData.QTCAmpl), sSumAliveChannels);
       }
 
       if (digit.mTriggers.getOrA() && chData.getFlag(o2::fv0::ChannelData::kIsCFDinADCgate) && isCollidingBC) {
@@ -597,20 +590,10 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
     } // channel data loop
     mHistSumAmpAOrABeamBeam->Fill(sumampAOrABeamBeam);
 
-    for (const auto& entry : mapPMhash2sumAmplAliveChannels) {
-      if (mMapPMhash2isInner[entry.first]) {
-        sumampAOrABeamBeam_by8_inner += (entry.second >> 3);
-      } else
-        sumampAOrABeamBeam_by8_outer += (entry.second >> 3);
-    }
+    std::tie(sumampAOrABeamBeam_by8_inner, sumampAOrABeamBeam_by8_outer) = mPMAccumulator.getGroupSumsBy8(sSumAliveChannels);
     mHistSumAmpAOrABeamBeam_by8->Fill(sumampAOrABeamBeam_by8_inner + sumampAOrABeamBeam_by8_outer);
 
-    for (const auto& entry : mapPMhash2sumAmpl) {
-      if (mMapPMhash2isInner[entry.first])
-        pmSumAmplIn += static_cast<int>(entry.second >> 3);
-      else
-        pmSumAmplOut += static_cast<int>(entry.second >> 3);
-    }
+    std::tie(pmSumAmplIn, pmSumAmplOut) = mPMAccumulator.getGroupSumsBy8(sSumAll);
 
     auto pmNChan = pmNChanIn + pmNChanOut;
     auto pmSumAmpl = pmSumAmplIn + pmSumAmplOut;
@@ -621,9 +604,9 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
     }
 
     if (isTCM) {
-      setFEEmodules.insert(mTCMhash);
+      mPMAccumulator.addModule(mTCMhash);
     }
-    for (const auto& feeHash : setFEEmodules) {
+    mPMAccumulator.getModules().forEach([&](uint8_t feeHash) {
       mHistBCvsFEEmodules->Fill(static_cast<double>(digit.getIntRecord().bc), static_cast<double>(feeHash));
       if (digit.mTriggers.getOrA())
         mHistBcVsFeeForOrATrg->Fill(static_cast<double>(digit.getIntRecord().bc), static_cast<double>(feeHash));
@@ -636,7 +619,7 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
       if (digit.mTriggers.getOrAIn())
         mHistBcVsFeeForOrAInTrg->Fill(static_cast<double>(digit.getIntRecord().bc), static_cast<double>(feeHash));
       mHistOrbitVsFEEmodules->Fill(static_cast<double>(digit.getIntRecord().orbit % sOrbitsPerTF), static_cast<double>(feeHash));
-    }
+    });
 
     if (isTCM && digit.mTriggers.getDataIsValid() && !digit.mTriggers.getOutputsAreBlocked()) {
       if (digit.mTriggers.getNChanA() > 0) {
@@ -715,6 +698,10 @@ void DigitQcTask::monitorData(o2::framework::ProcessingContext& ctx)
       // end of triggers re-computation
     }
   } // digit loop
+  mChannelDataBatch.fillTimes(mHistTime2Ch.get());
+  mChannelDataBatch.fillAmplitudes(mHistAmp2Ch.get());
+  mChannelDataBatch.fillChannels(mHistChannelID.get());
+  mChannelDataBatch.fillChannels(mHistNumCFD.get());
 }
 
 void DigitQcTask::endOfCycle()
@@ -0,0 +1,165 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   ChipHitCounter.h
+/// \brief  Per-pixel hit counters of an ALPIDE chip
+///
+
+#ifndef QC_MODULE_ITS_CHIPHITCOUNTER_H
+#define QC_MODULE_ITS_CHIPHITCOUNTER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace o2::quality_control_modules::its
+{
+
+/// \brief Number of hits of each fired pixel of one chip.
+///
+/// The counters of the fired pixels are kept in one contiguous open-addressing table (linear probing), instead of the
+/// nodes of a std::unordered_map, so that counting a hit neither allocates nor follows pointers. A dense array of the
+/// 512x1024 pixels is not an option, 2 MB per chip would not fit in memory for the outer barrel layers, while only a
+/// small fraction of the pixels ever fire. The memory is kept by clear() and by eraseIf().
+class ChipHitCounter
+{
+ public:
+  /// \brief Adds hits to the pixel
+  void add(uint16_t row, uint16_t column, uint32_t hits = 1)
+  {
+    if (2 * (mSize + 1) > mSlots.size()) {
+      grow();
+    }
+    const uint32_t key = makeKey(row, column);
+    size_t slot = find(key);
+    if (mSlots[slot].key == sEmpty) {
+      mSlots[slot].key = key;
+      mSize++;
+    }
+    mSlots[slot].hits += hits;
+  }
+
+  /// \brief Returns the number of hits of the pixel, 0 if it never fired
+  uint32_t get(uint16_t row, uint16_t column) const
+  {
+    if (mSize == 0) {
+      return 0;
+    }
+    const auto& slot = mSlots[find(makeKey(row, column))];
+    return slot.key == sEmpty ? 0 : slot.hits;
+  }
+
+  /// \brief Number of pixels which fired
+  size_t size() const { return mSize; }
+  bool empty() const { return mSize == 0; }
+
+  /// \brief Forgets all the pixels, keeping the memory
+  void clear()
+  {
+    if (mSize > 0) {
+      std::fill(mSlots.begin(), mSlots.end(), Slot{});
+      mSize = 0;
+    }
+  }
+
+  /// \brief Calls function(row, column, hits) for each fired pixel, in no particular order
+  template <typename Function>
+  void forEach(Function&& function) const
+  {
+    for (const auto& slot : mSlots) {
+      if (slot.key != sEmpty) {
+        function(static_cast<uint16_t>(slot.key >> 10), static_cast<uint16_t>(slot.key & 1023), slot.hits);
+      }
+    }
+  }
+
+  /// \brief Forgets the pixels for which predicate(hits) is true, returns how many were removed
+  template <typename Predicate>
+  size_t eraseIf(Predicate&& predicate)
+  {
+    size_t erased = 0;
+    for (size_t slot = 0; slot < mSlots.size();) {
+      if (mSlots[slot].key != sEmpty && predicate(mSlots[slot].hits)) {
+        erase(slot);
+        erased++;
+        // another pixel may have been moved to this slot, it has to be checked as well
+      } else {
+        slot++;
+      }
+    }
+    return erased;
+  }
+
+ private:
+  struct Slot {
+    uint32_t key = sEmpty;
+    uint32_t hits = 0;
+  };
+  static constexpr uint32_t sEmpty = ~uint32_t{ 0 };
+
+  static uint32_t makeKey(uint16_t row, uint16_t column) { return (uint32_t{ row } << 10) | column; }
+  // Fibonacci hashing: the high bits of the product depend on all the bits of the key. The low bits would only depend
+  // on the low bits of the key, i.e. on the column, so the pixels of a column would all compete for the same slots.
+  size_t home(uint32_t key) const { return static_cast<uint32_t>(key * 2654435769u) >> mShift; }
+
+  // slot of the key, or the empty slot where it would be inserted
+  size_t find(uint32_t key) const
+  {
+    const size_t mask = mSlots.size() - 1;
+    size_t slot = home(key);
+    while (mSlots[slot].key != key && mSlots[slot].key != sEmpty) {
+      slot = (slot + 1) & mask;
+    }
+    return slot;
+  }
+
+  // removes the pixel in the slot, moving back the following pixels of the probe sequence to keep it unbroken
+  void erase(size_t hole)
+  {
+    const size_t mask = mSlots.size() - 1;
+    for (size_t slot = (hole + 1) & mask; mSlots[slot].key != sEmpty; slot = (slot + 1) & mask) {
+      const size_t wanted = home(mSlots[slot].key);
+      // the pixel can fill the hole only if its home slot is not cyclically in ]hole, slot]
+      const bool stays = hole <= slot ? (hole < wanted && wanted <= slot) : (hole < wanted || wanted <= slot);
+      if (!stays) {
+        mSlots[hole] = mSlots[slot];
+        hole = slot;
+      }
+    }
+    mSlots[hole] = Slot{};
+    mSize--;
+  }
+
+  void grow()
+  {
+    std::vector<Slot> old(mSlots.empty() ? 16 : 2 * mSlots.size());
+    old.swap(mSlots);
+    mShift = 32;
+    for (size_t size = mSlots.size(); size > 1; size >>= 1) {
+      mShift--;
+    }
+    for (const auto& slot : old) {
+      if (slot.key != sEmpty) {
+        mSlots[find(slot.key)] = slot;
+      }
+    }
+  }
+
+  std::vector<Slot> mSlots;
+  size_t mSize = 0;
+  unsigned mShift = 32; // 32 - log2 of the number of slots
+};
+
+} // namespace o2::quality_control_modules::its
+
+#endif // QC_MODULE_ITS_CHIPHITCOUNTER_H
@@ -19,6 +19,7 @@
 
 #include "QualityControl/TaskInterface.h"
 #include "Common/TH2Ratio.h"
+#include "Common/HistogramFillBuffer.h"
 
 #include <DataFormatsITSMFT/TopologyDictionary.h>
 #include <ITSBase/GeometryTGeo.h>
@@ -68,6 +69,7 @@ class ITSClusterTask : public TaskInterface
   void getJsonParameters();
   void createAllHistos();
   void addLines();
+  void buildLookupTables(); // to be called whenever the geometry or the dictionary change
 
   float getHorizontalBin(float z, int chip, int layer, int lane = 0);
   float getVerticalBin(float rphi, int stave, int layer);
@@ -140,6 +142,7 @@ class ITSClusterTask : public TaskInterface
   const int mNLanes[4] = { 432, 864, 2520, 3816 }; // IB, ML, OL, TOTAL lane
   int mDoPublish1DSummary = 0;
   int mNThreads = 1;
+  HistogramFillBuffer mFillBuffer; //! one slot per thread, reduced at the end of monitorData
   int nBCbins = 103;
   long int mTimestamp = -1;
   TString xLabel;
@@ -164,6 +167,23 @@ class ITSClusterTask : public TaskInterface
   o2::itsmft::TopologyDictionary* mDict = nullptr;
   o2::its::GeometryTGeo* mGeom = nullptr;
 
+  // Properties of the chips and of the dictionary patterns, looked up for each cluster
+  struct ChipInfo {
+    uint8_t layer = 0;
+    uint8_t stave = 0;
+    uint8_t module = 0; // HIC in the stave, counting both half staves
+    uint8_t chip = 0;   // chip in the HIC
+    uint8_t lane = 0;   // meaningful for OB only
+  };
+  struct PatternInfo {
+    uint16_t npix = 0;
+    uint8_t colspan = 0;
+    uint8_t rowspan = 0;
+    bool isGroup = false;
+  };
+  std::vector<ChipInfo> mChipInfos;       //! indexed by chip ID, from mGeom
+  std::vector<PatternInfo> mPatternInfos; //! indexed by pattern ID, from mDict
+
   const char* OBLabel34[16] = { "HIC1L_B0_ln7", "HIC1L_A8_ln6", "HIC2L_B0_ln8", "HIC2L_A8_ln5", "HIC3L_B0_ln9", "HIC3L_A8_ln4", "HIC4L_B0_ln10", "HIC4L_A8_ln3", "HIC1U_B0_ln21", "HIC1U_A8_ln20", "HIC2U_B0_ln22", "HIC2U_A8_ln19", "HIC3U_B0_ln23", "HIC3U_A8_ln18", "HIC4U_B0_ln24", "HIC4U_A8_ln17" };
   const char* OBLabel56[28] = { "HIC1L_B0_ln7", "HIC1L_A8_ln6", "HIC2L_B0_ln8", "HIC2L_A8_ln5", "HIC3L_B0_ln9", "HIC3L_A8_ln4", "HIC4L_B0_ln10", "HIC4L_A8_ln3", "HIC5L_B0_ln11", "HIC5L_A8_ln2", "HIC6L_B0_ln12", "HIC6L_A8_ln1", "HIC7L_B0_ln13", "HIC7L_A8_ln0", "HIC1U_B0_ln21", "HIC1U_A8_ln20", "HIC2U_B0_ln22", "HIC2U_A8_ln19", "HIC3U_B0_ln23", "HIC3U_A8_ln18", "HIC4U_B0_ln24", "HIC4U_A8_ln17", "HIC5U_B0_ln25", "HIC5U_A8_ln16", "HIC6U_B0_ln26", "HIC6U_A8_ln15", "HIC7U_B0_ln27", "HIC7U_A8_ln14" };
 };
@@ -19,6 +19,8 @@
 #define QC_MODULE_ITS_ITSFHRTASK_H
 
 #include "QualityControl/TaskInterface.h"
+#include "Common/HistogramFillBuffer.h"
+#include "ITS/ChipHitCounter.h"
 #include <ITSMFTReconstruction/ChipMappingITS.h>
 #include <ITSMFTReconstruction/PixelData.h>
 #include <ITSBase/GeometryTGeo.h>
@@ -70,6 +72,9 @@ class ITSFhrTask final : public TaskInterface
   void resetOccupancyPlots();
   void resetObject(TH1* obj);
   void getStavePoint(int layer, int stave, double* px, double* py); // prepare for fill TH2Poly, get all point for add TH2Poly bin
+  void fillStaveHitmaps();                                          // move the hits counted in mHitmapCounters to mStaveHitmap
+  // index in mHitCounters and mHitmapCounters, IB : chipInStave = chip; OB : chipInStave = hic * 14 + chip
+  size_t getCounterIndex(int stave, int chipInStave) const { return stave * nHicPerStave[mLayer] * nChipsPerHic[mLayer] + chipInStave; }
   // detector information
   static constexpr int NCols = 1024; // column number in Alpide chip
   static constexpr int NRows = 512;  // row number in Alpide chip
@@ -91,7 +96,7 @@ class ITSFhrTask final : public TaskInterface
   const float MidPointRad[7] = { 23.49, 31.586, 39.341, 197.598, 246.944, 345.348, 394.883 };                                                                                                                                                                               // mid point radius
 
   int mNThreads = 1;
-  std::unordered_map<unsigned int, int> mHitPixelID_Hash[7][48][2][14][14]; // layer, stave, substave, hic, chip
+  o2::quality_control_modules::common::HistogramFillBuffer mFillBuffer; //! one slot per thread, reduced in monitorData
 
   o2::itsmft::RawPixelDecoder<o2::itsmft::ChipMappingITS>* mDecoder = nullptr;
   ChipPixelData* mChipDataBuffer = nullptr;
@@ -107,7 +112,8 @@ class ITSFhrTask final : public TaskInterface
   float mPhysicalOccupancyOB = 4.3e-5;
   double mCutTFForSparse = 1; // cut to stop THnSparse filling after mCutTrgForSparse triggers
   int mDoHitmapFilter = 1;    // do filtering of noise pixel vector
-  std::unordered_map<unsigned int, int>*** mHitPixelID_InStave = nullptr /* = new std::unordered_map<unsigned int, int>**[NStaves[lay]]*/;
+  std::vector<ChipHitCounter> mHitCounters;    //! hits per pixel since the last reset, for each chip of the layer
+  std::vector<ChipHitCounter> mHitmapCounters; //! hits per pixel of the first CutSparseTF TFs, moved to mStaveHitmap at the end of each cycle
   int** mHitnumberLane = nullptr /* = new int*[NStaves[lay]]*/; // IB : hitnumber[stave][chip]; OB : hitnumber[stave][lane]
   double** mOccupancyLane /* = new double*[NStaves[lay]]*/;     // IB : occupancy[stave][chip]; OB : occupancy[stave][Lane]
   int*** mErrorCount = nullptr /* = new int**[NStaves[lay]]*/;  // IB : errorcount[stave][FEE][errorid]
@@ -92,6 +92,7 @@ void ITSClusterTask::initialize(o2::framework::InitContext& /*ctx*/)
   ILOG(Debug, Devel) << "initialize ITSClusterTask" << ENDM;
 
   getJsonParameters();
+  mFillBuffer.setNThreads(mNThreads);
 
   // Create binning for fine checks
   setRphiBinningIB();
@@ -138,17 +139,29 @@ void ITSClusterTask::monitorData(o2::framework::ProcessingContext& ctx)
     o2::its::GeometryTGeo::adopt(TaskInterface::retrieveConditionAny<o2::its::GeometryTGeo>("ITS/Config/Geometry", metadata, ts));
     mGeom = o2::its::GeometryTGeo::Instance();
     ILOG(Debug, Devel) << "Loaded new instance of mGeom" << ENDM;
+    buildLookupTables();
   }
 
-  std::chrono::time_point<std::chrono::high_resolution_clock> start;
-  std::chrono::time_point<std::chrono::high_resolution_clock> end;
-  int difference;
-  start = std::chrono::high_resolution_clock::now();
+  auto timer = profile("clusters");
   ILOG(Debug, Devel) << "START DOING QC General" << ENDM;
   auto clusArr = ctx.inputs().get<gsl::span<o2::itsmft::CompClusterExt>>("compclus");
   auto clusRofArr = ctx.inputs().get<gsl::span<o2::itsmft::ROFRecord>>("clustersrof");
   auto clusPatternArr = ctx.inputs().get<gsl::span<unsigned char>>("patterns");
-  auto pattIt = clusPatternArr.begin();
+
+  // The patterns of the clusters which are not in the dictionary follow each other in one array,
+  // thus we find where each ROF starts before processing the ROFs in parallel.
+  std::vector<decltype(clusPatternArr.begin())> pattItPerROF;
+  pattItPerROF.reserve(clusRofArr.size());
+  auto pattItStart = clusPatternArr.begin();
+  for (const auto& ROF : clusRofArr) {
+    pattItPerROF.push_back(pattItStart);
+    for (int icl = ROF.getFirstEntry(); icl < ROF.getFirstEntry() + ROF.getNEntries(); icl++) {
+      auto patternID = clusArr[icl].getPatternID();
+      if (patternID == o2::itsmft::CompCluster::InvalidPatternID || mPatternInfos[patternID].isGroup) {
+        o2::itsmft::ClusterPattern::skipPattern(pattItStart);
+      }
+    }
+  }
 
   // Reset this histo to have the latest picture
   hEmptyLaneFractionGlobal->Reset("ICES");
@@ -158,9 +171,15 @@ void ITSClusterTask::monitorData(o2::framework::ProcessingContext& ctx)
 #pragma omp parallel for schedule(dynamic)
 #endif
 
-  // Filling cluster histogram for each ROF by open_mp
+  // Filling cluster histogram for each ROF by open_mp.
+  // The histograms are filled through mFillBuffer, each thread uses its own slot.
   for (unsigned int iROF = 0; iROF < clusRofArr.size(); iROF++) {
 
+    int thread = 0;
+#ifdef WITH_OPENMP
+    thread = omp_get_thread_num();
+#endif
+    auto pattIt = pattItPerROF[iROF];
     const auto& ROF = clusRofArr[iROF];
     const auto bcdata = ROF.getBCData();
     int nDigits3pixLay[7] = { 0 };
@@ -175,13 +194,11 @@ void ITSClusterTask::monitorData(o2::framework::ProcessingContext& ctx)
       auto& cluster = clusArr[icl];
       auto ChipID = cluster.getSensorID();
       int ClusterID = cluster.getPatternID(); // used for normal (frequent) cluster shapes
-      int lay, sta, ssta, mod, chip, lane;
-
-      // TODO: avoid call Geom if ChipID is the same as previous cluster
-      mGeom->getChipId(ChipID, lay, sta, ssta, mod, chip);
-      mod = mod + (ssta * (mNHicPerStave[lay] / 2));
-      int chipIdLocal = (ChipID - ChipBoundary[lay]) % (14 * mNHicPerStave[lay]);
-      lane = (chipIdLocal % (14 * mNHicPerStave[lay])) / (14 / 2);
+      const auto& chipInfo = mChipInfos[ChipID];
+      int lay = chipInfo.layer;
+      int sta = chipInfo.stave;
+      int chip = chipInfo.chip;
+      int lane = chipInfo.lane;
 
       int npix = -1;
       int colspan = -1;
@@ -191,12 +208,11 @@ void ITSClusterTask::monitorData(o2::framework::ProcessingContext& ctx)
       o2::math_utils::Point3D<float> locC; // local coordinates
 
       if (ClusterID != o2::itsmft::CompCluster::InvalidPatternID) { // Normal (frequent) cluster shapes
-        if (!mDict->isGroup(ClusterID)) {
-          npix = mDict->getNpixels(ClusterID);
-
-          // TODO: is there way other than calling the pattern?
-          colspan = mDict->getPattern(ClusterID).getColumnSpan();
-          rowspan = mDict->getPattern(ClusterID).getRowSpan();
+        const auto& patternInfo = mPatternInfos[ClusterID];
+        if (!patternInfo.isGroup) {
+          npix = patternInfo.npix;
+          colspan = patternInfo.colspan;
+          rowspan = patternInfo.rowspan;
 
           if (mDoPublishDetailedSummary == 1) {
             locC = mDict->getClusterCoordinates(cluster);
@@ -244,42 +260,42 @@ void ITSClusterTask::monitorData(o2::framework::ProcessingContext& ctx)
       }
 
       if (lay < NLayerIB) {
-        hAverageClusterOccupancySummaryIB[lay]->getNum()->Fill(chip, sta);
-        hAverageClusterSizeSummaryIB[lay]->getNum()->Fill(chip, sta, (double)npix);
-        hAverageClusterSizeSummaryIB[lay]->getDen()->Fill(chip, sta, 1.);
-        hClusterCenterMap[lay]->Fill(cluster.getCol(), cluster.getRow());
+        mFillBuffer.fill(thread, hAverageClusterOccupancySummaryIB[lay]->getNum(), chip, sta);
+        mFillBuffer.fill(thread, hAverageClusterSizeSummaryIB[lay]->getNum(), chip, sta, (double)npix);
+        mFillBuffer.fill(thread, hAverageClusterSizeSummaryIB[lay]->getDen(), chip, sta, 1.);
+        mFillBuffer.fill(thread, hClusterCenterMap[lay], cluster.getCol(), cluster.getRow());
         if (mDoPublish1DSummary == 1) {
-          hClusterTopologySummaryIB[lay][sta][chip]->Fill(ClusterID);
+          mFillBuffer.fill(thread, hClusterTopologySummaryIB[lay][sta][chip], ClusterID);
         }
 
-        hClusterSizeLayerSummary[lay]->Fill(npix);
-        hClusterTopologyLayerSummary[lay]->Fill(ClusterID);
+        mFillBuffer.fill(thread, hClusterSizeLayerSummary[lay], npix);
+        mFillBuffer.fill(thread, hClusterTopologyLayerSummary[lay], ClusterID);
 
         if (mDoPublish1DSummary) {
-          hClusterSizeSummaryIB[lay][sta][chip]->Fill(npix);
+          mFillBuffer.fill(thread, hClusterSizeSummaryIB[lay][sta][chip], npix);
         }
 
         if (isGrouped) {
           if (mDoPublish1DSummary == 1) {
-            hGroupedClusterSizeSummaryIB[lay][sta][chip]->Fill(npix);
+            mFillBuffer.fill(thread, hGroupedClusterSizeSummaryIB[lay][sta][chip], npix);
           }
-          hGroupedClusterSizeLayerSummary[lay]->Fill(npix);
+          mFillBuffer.fill(thread, hGroupedClusterSizeLayerSummary[lay], npix);
         }
       } else {
-        hAverageClusterOccupancySummaryOB[lay]->getNum()->Fill(lane, sta, 1. / (mNChipsPerHic[lay] / mNLanePerHic[lay])); // 14 To have occupation per chip -> 7 because we're considering lanes
-        hAverageClusterSizeSummaryOB[lay]->getNum()->Fill(lane, sta, (double)npix);
-        hAverageClusterSizeSummaryOB[lay]->getDen()->Fill(lane, sta, 1);
+        mFillBuffer.fill(thread, hAverageClusterOccupancySummaryOB[lay]->getNum(), lane, sta, 1. / (mNChipsPerHic[lay] / mNLanePerHic[lay])); // 14 To have occupation per chip -> 7 because we're considering lanes
+        mFillBuffer.fill(thread, hAverageClusterSizeSummaryOB[lay]->getNum(), lane, sta, (double)npix);
+        mFillBuffer.fill(thread, hAverageClusterSizeSummaryOB[lay]->getDen(), lane, sta, 1);
         if (mDoPublish1DSummary == 1) {
-          hClusterTopologySummaryOB[lay][sta]->Fill(ClusterID);
-          hClusterSizeSummaryOB[lay][sta]->Fill(npix);
+          mFillBuffer.fill(thread, hClusterTopologySummaryOB[lay][sta], ClusterID);
+          mFillBuffer.fill(thread, hClusterSizeSummaryOB[lay][sta], npix);
         }
-        hClusterSizeLayerSummary[lay]->Fill(npix);
-        hClusterTopologyLayerSummary[lay]->Fill(ClusterID);
+        mFillBuffer.fill(thread, hClusterSizeLayerSummary[lay], npix);
+        mFillBuffer.fill(thread, hClusterTopologyLayerSummary[lay], ClusterID);
         if (isGrouped) {
           if (mDoPublish1DSummary == 1) {
-            hGroupedClusterSizeSummaryOB[lay][sta]->Fill(npix);
+            mFillBuffer.fill(thread, hGroupedClusterSizeSummaryOB[lay][sta], npix);
           }
-          hGroupedClusterSizeLayerSummary[lay]->Fill(npix);
+          mFillBuffer.fill(thread, hGroupedClusterSizeLayerSummary[lay], npix);
         }
       }
 
@@ -289,18 +305,18 @@ void ITSClusterTask::monitorData(o2::framework::ProcessingContext& ctx)
         float phi = (float)TMath::ATan2(gloC.Y(), gloC.X());
 
         phi = (float)(phi * 180 / TMath::Pi());
-        hAverageClusterOccupancySummaryZPhi[lay]->getNum()->Fill(gloC.Z(), phi);
-        hAverageClusterSizeSummaryZPhi[lay]->getNum()->Fill(gloC.Z(), phi, (float)npix);
+        mFillBuffer.fill(thread, hAverageClusterOccupancySummaryZPhi[lay]->getNum(), gloC.Z(), phi);
+        mFillBuffer.fill(thread, hAverageClusterSizeSummaryZPhi[lay]->getNum(), gloC.Z(), phi, (float)npix);
 
-        hAverageClusterOccupancySummaryFine[lay]->getNum()->Fill(getHorizontalBin(locC.Z(), chip, lay, lane), getVerticalBin(locC.X(), sta, lay));
-        hAverageClusterSizeSummaryFine[lay]->getNum()->Fill(getHorizontalBin(locC.Z(), chip, lay, lane), getVerticalBin(locC.X(), sta, lay), (float)npix);
+        mFillBuffer.fill(thread, hAverageClusterOccupancySummaryFine[lay]->getNum(), getHorizontalBin(locC.Z(), chip, lay, lane), getVerticalBin(locC.X(), sta, lay));
+        mFillBuffer.fill(thread, hAverageClusterSizeSummaryFine[lay]->getNum(), getHorizontalBin(locC.Z(), chip, lay, lane), getVerticalBin(locC.X(), sta, lay), (float)npix);
       }
     }
-    hClusterVsBunchCrossing->Fill(bcdata.bc, nClusters3pix); // we count only the number of clusters, not their sizes
+    mFillBuffer.fill(thread, hClusterVsBunchCrossing, bcdata.bc, nClusters3pix); // we count only the number of clusters, not their sizes
     for (int lay = 0; lay < 7; lay++) {
       if (nClusters3pixLay[lay] > 0) {
         int nchips = mNStaves[lay] * mNHicPerStave[lay] * mNChipsPerHic[lay];
-        hClusterOccupancyDistribution[lay]->Fill(1. * nClusters3pixLay[lay] / nchips, 1. * nDigits3pixLay[lay] / nchips);
+        mFillBuffer.fill(thread, hClusterOccupancyDistribution[lay], 1. * nClusters3pixLay[lay] / nchips, 1. * nDigits3pixLay[lay] / nchips);
       }
     }
 
@@ -315,8 +331,8 @@ void ITSClusterTask::monitorData(o2::framework::ProcessingContext& ctx)
       while (ichip >= ChipBoundary[ilayer + 1]) {
         ilayer++;
       }
-      hLongClustersPerChip[ilayer]->Fill(ichip, nLong);
-      hMultPerChipWhenLongClusters[ilayer]->Fill(ichip, nHitsFromClusters[ichip]);
+      mFillBuffer.fill(thread, hLongClustersPerChip[ilayer], ichip, nLong);
+      mFillBuffer.fill(thread, hMultPerChipWhenLongClusters[ilayer], ichip, nHitsFromClusters[ichip]);
     }
     // filling anomaly plots once per ROF, ignoring staves w/o long clusters -- OB
     for (int ilay = 3; ilay < 7; ilay++) {
@@ -326,11 +342,13 @@ void ITSClusterTask::monitorData(o2::framework::ProcessingContext& ctx)
         if (nLong < 1) {
           continue;
         }
-        hLongClustersPerStave[ilay - NLayerIB]->Fill(ist, nLong);
+        mFillBuffer.fill(thread, hLongClustersPerStave[ilay - NLayerIB], ist, nLong);
       }
     }
   }
 
+  mFillBuffer.reduce();
+
   if ((int)clusRofArr.size() > 0) {
 
     mGeneralOccupancy->getDen()->Fill(0., 0., (double)(clusRofArr.size()));
@@ -400,9 +418,42 @@ void ITSClusterTask::monitorData(o2::framework::ProcessingContext& ctx)
 
   hTFCounter->Fill(0);
 
-  end = std::chrono::high_resolution_clock::now();
-  difference = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-  ILOG(Debug, Devel) << "Time in QC Cluster Task:  " << difference << ENDM;
+  // the duration is known only if the profiling is enabled for the task
+  double duration = timer.stop();
+  if (duration > 0) {
+    ILOG(Debug, Devel) << "Time in QC Cluster Task:  " << duration * 1e6 << ENDM;
+    ILOG(Debug, Devel) << "Clusters per second in QC Cluster Task: " << clusArr.size() / duration << ENDM;
+  }
+}
+
+void ITSClusterTask::buildLookupTables()
+{
+  // the geometry calls and the pattern decoding are done once per chip and per pattern instead of once per cluster
+  mChipInfos.assign(ChipBoundary[NLayer], ChipInfo{});
+  for (int chipID = 0; chipID < ChipBoundary[NLayer]; chipID++) {
+    int lay, sta, ssta, mod, chip;
+    mGeom->getChipId(chipID, lay, sta, ssta, mod, chip);
+    int chipIdLocal = (chipID - ChipBoundary[lay]) % (14 * mNHicPerStave[lay]);
+    auto& info = mChipInfos[chipID];
+    info.layer = lay;
+    info.stave = sta;
+    info.module = mod + (ssta * (mNHicPerStave[lay] / 2));
+    info.chip = chip;
+    info.lane = (chipIdLocal % (14 * mNHicPerStave[lay])) / (14 / 2);
+  }
+
+  mPatternInfos.assign(mDict->getSize(), PatternInfo{});
+  for (int patternID = 0; patternID < mDict->getSize(); patternID++) {
+    auto& info = mPatternInfos[patternID];
+    info.isGroup = mDict->isGroup(patternID);
+    if (!info.isGroup) {
+      const auto& pattern = mDict->getPattern(patternID);
+      info.npix = mDict->getNpixels(patternID);
+      info.colspan = pattern.getColumnSpan();
+      info.rowspan = pattern.getRowSpan();
+    }
+  }
+  ILOG(Debug, Devel) << "Lookup tables built for " << mChipInfos.size() << " chips and " << mPatternInfos.size() << " patterns" << ENDM;
 }
 
 void ITSClusterTask::endOfCycle()
@@ -70,10 +70,6 @@ ITSFhrTask::~ITSFhrTask()
       delete[] mErrorCount[istave][ilink];
     }
     delete[] mErrorCount[istave];
-    for (int ihic = 0; ihic < nHicPerStave[mLayer]; ihic++) {
-      delete[] mHitPixelID_InStave[istave][ihic];
-    }
-    delete[] mHitPixelID_InStave[istave];
   }
   delete[] mHitnumberLane;
   delete[] mOccupancyLane;
@@ -81,7 +77,6 @@ ITSFhrTask::~ITSFhrTask()
   delete[] mChipZ;
   delete[] mChipStat;
   delete[] mErrorCount;
-  delete[] mHitPixelID_InStave;
 }
 
 void ITSFhrTask::initialize(o2::framework::InitContext& /*ctx*/)
@@ -105,6 +100,7 @@ void ITSFhrTask::initialize(o2::framework::InitContext& /*ctx*/)
   createGeneralPlots();
   createOccupancyPlots();
   setPlotsFormat();
+  mFillBuffer.setNThreads(mNThreads);
   mDecoder = new o2::itsmft::RawPixelDecoder<o2::itsmft::ChipMappingITS>();
   mDecoder->init();
   mDecoder->setSkipRampUpData(mIgnoreRampUpData);
@@ -115,7 +111,8 @@ void ITSFhrTask::initialize(o2::framework::InitContext& /*ctx*/)
 
   if (mLayer != -1) {
     // define the hitnumber, occupancy, errorcount array
-    mHitPixelID_InStave = new std::unordered_map<unsigned int, int>**[NStaves[mLayer]];
+    mHitCounters.resize(ChipBoundary[mLayer + 1] - ChipBoundary[mLayer]);
+    mHitmapCounters.resize(ChipBoundary[mLayer + 1] - ChipBoundary[mLayer]);
     mHitnumberLane = new int*[NStaves[mLayer]];
     mOccupancyLane = new double*[NStaves[mLayer]];
     mChipPhi = new double*[NStaves[mLayer]];
@@ -176,10 +173,6 @@ void ITSFhrTask::initialize(o2::framework::InitContext& /*ctx*/)
         mChipZ[istave] = new double[nChipsPerHic[mLayer]];
 
         mChipStat[istave] = new int[nChipsPerHic[mLayer]];
-        mHitPixelID_InStave[istave] = new std::unordered_map<unsigned int, int>*[nHicPerStave[mLayer]];
-        for (int ihic = 0; ihic < nHicPerStave[mLayer]; ihic++) {
-          mHitPixelID_InStave[istave][ihic] = new std::unordered_map<unsigned int, int>[nChipsPerHic[mLayer]];
-        }
         for (int ichip = 0; ichip < nChipsPerHic[mLayer]; ichip++) {
           mHitnumberLane[istave][ichip] = 0;
           mOccupancyLane[istave][ichip] = 0;
@@ -199,10 +192,6 @@ void ITSFhrTask::initialize(o2::framework::InitContext& /*ctx*/)
         mChipZ[istave] = new double[nHicPerStave[mLayer] * nChipsPerHic[mLayer]];
 
         mChipStat[istave] = new int[nHicPerStave[mLayer] * nChipsPerHic[mLayer]];
-        mHitPixelID_InStave[istave] = new std::unordered_map<unsigned int, int>*[nHicPerStave[mLayer]];
-        for (int ihic = 0; ihic < nHicPerStave[mLayer]; ihic++) {
-          mHitPixelID_InStave[istave][ihic] = new std::unordered_map<unsigned int, int>[nChipsPerHic[mLayer]];
-        }
         for (int ichip = 0; ichip < nHicPerStave[mLayer] * nChipsPerHic[mLayer]; ichip++) {
           mChipPhi[istave][ichip] = 0;
           mChipZ[istave][ichip] = 0;
@@ -393,31 +382,17 @@ void ITSFhrTask::monitorData(o2::framework::ProcessingContext& ctx)
     mGeom = o2::its::GeometryTGeo::Instance();
     ILOG(Debug, Devel) << "Loaded new instance of mGeom" << ENDM;
   }
-  // set timer
-  std::chrono::time_point<std::chrono::high_resolution_clock> start;
-  std::chrono::time_point<std::chrono::high_resolution_clock> end;
-  int difference;
-  start = std::chrono::high_resolution_clock::now();
-
   // set Decoder
   mDecoder->startNewTF(ctx.inputs());
   mDecoder->setDecodeNextAuto(true);
 
-  // define digit hit vector
-  std::vector<Digit>** digVec = new std::vector<Digit>*[NStaves[mLayer]]; // IB : digVec[stave][0]; OB : digVec[stave][hic]
+  // hits of each GBT link of the layer, in the scratch memory released after each TF
+  // each hit is packed as (chipInStave << 19) | (row << 10) | column, IB : chipInStave = chip; OB : chipInStave = hic * 14 + chip
+  const int nLinks = mLayer < NLayerIB ? 3 : 2;
+  const int nHicPerLink = nHicPerStave[mLayer] / NSubStave[mLayer]; // OB only
+  std::pmr::vector<std::pmr::vector<uint32_t>> linkHits(NStaves[mLayer] * nLinks, getScratchMemory()); // linkHits[stave * nLinks + link]
   const math_utils::Point3D<float> loc(0., 0., 0.);
 
-  if (mLayer < NLayerIB) {
-    for (int istave = 0; istave < NStaves[mLayer]; istave++) {
-      digVec[istave] = new std::vector<Digit>[nHicPerStave[mLayer]];
-    }
-  } else {
-    for (int istave = 0; istave < NStaves[mLayer]; istave++) {
-      digVec[istave] = new std::vector<Digit>[nHicPerStave[mLayer]];
-    }
-  }
-
-  // decode raw data and save digit hit to digit hit vector, and save hitnumber per chip/hic
   // get the position of all chips in this layer
   for (int ichip = ChipBoundary[mLayer]; ichip < ChipBoundary[mLayer + 1]; ichip++) {
     int stave = 0, chip = 0;
@@ -435,108 +410,86 @@ void ITSFhrTask::monitorData(o2::framework::ProcessingContext& ctx)
     }
   }
 
+  // decode raw data (the decoder processes the GBT links with decoderThreads threads), save the hits to the vector of their
+  // GBT link, and save hitnumber per chip/hic
+  auto decodingTimer = profile("decoding");
   while ((mChipDataBuffer = mDecoder->getNextChipData(mChipsBuffer))) {
-    if (mChipDataBuffer) {
-      int stave = 0, chip = 0;
-      int hic = 0;
-      int lane = 0;
-
-      const auto& pixels = mChipDataBuffer->getData();
-      if (mChipDataBuffer->getChipID() < ChipBoundary[mLayer] || mChipDataBuffer->getChipID() >= ChipBoundary[mLayer + 1]) { // useful for data replay
-        continue;
-      }
-      for (auto& pixel : pixels) {
-        if (mLayer < NLayerIB) {
-          stave = mChipDataBuffer->getChipID() / 9 - StaveBoundary[mLayer];
-          chip = mChipDataBuffer->getChipID() % 9;
-          hic = 0;
-          mHitnumberLane[stave][chip]++;
-          mChipStat[stave][chip]++;
-        } else {
-          stave = (mChipDataBuffer->getChipID() - ChipBoundary[mLayer]) / (14 * nHicPerStave[mLayer]);
-          int chipIdLocal = (mChipDataBuffer->getChipID() - ChipBoundary[mLayer]) % (14 * nHicPerStave[mLayer]);
-          chip = chipIdLocal % 14;
-          hic = (chipIdLocal % (14 * nHicPerStave[mLayer])) / 14;
-          lane = (chipIdLocal % (14 * nHicPerStave[mLayer])) / (14 / 2);
-
-          mHitnumberLane[stave][lane]++;
-          mChipStat[stave][chipIdLocal]++;
-        }
-        digVec[stave][hic].emplace_back(mChipDataBuffer->getChipID(), pixel.getRow(), pixel.getCol());
+    int chipID = mChipDataBuffer->getChipID();
+    if (chipID < ChipBoundary[mLayer] || chipID >= ChipBoundary[mLayer + 1]) { // useful for data replay
+      continue;
+    }
+    const auto& pixels = mChipDataBuffer->getData();
+    int stave = 0, chipInStave = 0, link = 0;
+    if (mLayer < NLayerIB) {
+      stave = chipID / 9 - StaveBoundary[mLayer];
+      chipInStave = chipID % 9;
+      link = chipInStave / 3;
+      mHitnumberLane[stave][chipInStave] += pixels.size();
+      mChipStat[stave][chipInStave] += pixels.size();
+      if (pixels.size() > (unsigned int)mHitCutForCheck) {
+        mChipStaveEventHitCheck->Fill(chipInStave, stave);
       }
-      if (mLayer < NLayerIB) {
-        if (pixels.size() > (unsigned int)mHitCutForCheck) {
-          mChipStaveEventHitCheck->Fill(chip, stave);
-        }
-      } else {
-        if (pixels.size() > (unsigned int)mHitCutForCheck) {
-          mChipStaveEventHitCheck->Fill(lane, stave);
-        }
+    } else {
+      stave = (chipID - ChipBoundary[mLayer]) / (14 * nHicPerStave[mLayer]);
+      chipInStave = (chipID - ChipBoundary[mLayer]) % (14 * nHicPerStave[mLayer]);
+      int lane = chipInStave / (14 / 2);
+      link = chipInStave / 14 / nHicPerLink;
+      mHitnumberLane[stave][lane] += pixels.size();
+      mChipStat[stave][chipInStave] += pixels.size();
+      if (pixels.size() > (unsigned int)mHitCutForCheck) {
+        mChipStaveEventHitCheck->Fill(lane, stave);
       }
     }
+    auto& hits = linkHits[stave * nLinks + link];
+    for (const auto& pixel : pixels) {
+      hits.push_back((uint32_t(chipInStave) << 19) | (uint32_t(pixel.getRow()) << 10) | pixel.getCol());
+    }
   }
 
-  // calculate active staves according digit hit vector
-  std::vector<int> activeStaves;
+  decodingTimer.stop();
+
+  // calculate active staves according to the hits of their links
+  std::pmr::vector<int> activeStaves(getScratchMemory());
   for (int i = 0; i < NStaves[mLayer]; i++) {
-    for (int j = 0; j < nHicPerStave[mLayer]; j++) {
-      if (digVec[i][j].size() != 0) {
+    for (int j = 0; j < nLinks; j++) {
+      if (linkHits[i * nLinks + j].size() != 0) {
         activeStaves.push_back(i);
         break;
       }
     }
   }
 
+  // counting the hits and filling the plots, until the end of the TF
+  auto fillingTimer = profile("filling");
+  unsigned long nHitsInTF = 0;
+  const bool fillHitmap = mTFCount <= mCutTFForSparse;
 #ifdef WITH_OPENMP
   omp_set_num_threads(mNThreads);
-#pragma omp parallel for schedule(dynamic)
+#pragma omp parallel for schedule(dynamic) reduction(+ \
+                                                     : nHitsInTF)
 #endif
-  // save digit hit vector to unordered_map by openMP multiple threads
-  // the reason of this step is: it will spend many time If we THnSparse::Fill the THnspase hit by hit.
-  // So we want save hit information to undordered_map and fill THnSparse by THnSparse::SetBinContent (pixel by pixel)
-  for (int i = 0; i < (int)activeStaves.size(); i++) {
-    int istave = activeStaves[i];
-    if (mLayer < NLayerIB) {
-      for (auto& digit : digVec[istave][0]) {
-        int chip = digit.getChipIndex() % 9;
-        mHitPixelID_InStave[istave][0][chip][1000 * digit.getColumn() + digit.getRow()]++;
-        nHitsTotal++;
-        if (mTFCount <= mCutTFForSparse) {
-          Double_t pixelPos[2] = { 1. * (digit.getColumn() + (1024 * chip)), 1. * digit.getRow() };
-          mStaveHitmap[istave]->Fill(pixelPos);
-        }
-      }
-    } else {
-      for (int ihic = 0; ihic < nHicPerStave[mLayer]; ihic++) {
-        for (auto& digit : digVec[istave][ihic]) {
-          int chip = ((digit.getChipIndex() - ChipBoundary[mLayer]) % (14 * nHicPerStave[mLayer])) % 14;
-          mHitPixelID_InStave[istave][ihic][chip][1000 * digit.getColumn() + digit.getRow()]++;
-          nHitsTotal++;
-          int ilink = ihic / (nHicPerStave[mLayer] / 2);
-          if (mTFCount <= mCutTFForSparse) {
-            if (chip < 7) {
-              Double_t pixelPos[2] = { 1. * ((ihic % (nHicPerStave[mLayer] / NSubStave[mLayer]) * ((nChipsPerHic[mLayer] / 2) * NCols)) + chip * NCols + digit.getColumn()), 1. * (NRows - digit.getRow() - 1 + (1024 * ilink)) };
-              mStaveHitmap[istave]->Fill(pixelPos);
-            } else {
-              Double_t pixelPos[2] = { 1. * ((ihic % (nHicPerStave[mLayer] / NSubStave[mLayer]) * ((nChipsPerHic[mLayer] / 2) * NCols)) + (nChipsPerHic[mLayer] / 2) * NCols - (chip - 7) * NCols - digit.getColumn() * 1.), 1. * (NRows + digit.getRow() + (1024 * ilink)) };
-              mStaveHitmap[istave]->Fill(pixelPos);
-            }
-          }
-        }
+  // count the hits per pixel by openMP multiple threads, one GBT link at a time.
+  // The links read disjoint sets of chips, so their counters can be filled directly by the thread processing the link.
+  // The stave hit maps are filled from mHitmapCounters at the end of the cycle, THnSparse::Fill hit by hit is too slow.
+  for (int ishard = 0; ishard < (int)linkHits.size(); ishard++) {
+    int istave = ishard / nLinks;
+    for (auto hit : linkHits[ishard]) {
+      auto index = getCounterIndex(istave, hit >> 19);
+      uint16_t row = (hit >> 10) & 511;
+      uint16_t column = hit & 1023;
+      mHitCounters[index].add(row, column);
+      if (fillHitmap) {
+        mHitmapCounters[index].add(row, column);
       }
     }
+    nHitsInTF += linkHits[ishard].size();
   }
+  nHitsTotal += nHitsInTF;
 
   // Reset Error plots
   mErrorPlots->Reset();
   mErrorVsFeeid->Reset(); // Error is   statistic by decoder so if we didn't reset decoder, then we need reset Error plots, and use TH::SetBinContent function
 
-  // define tmp occupancy plot, which will use for multiple threads
-  TH1D** occupancyPlotTmp = new TH1D*[(int)activeStaves.size()];
-  for (int i = 0; i < (int)activeStaves.size(); i++) {
-    occupancyPlotTmp[i] = new TH1D("", "", 300, -15, 0);
-  }
-
   int totalhit = 0;
 
 #ifdef WITH_OPENMP
@@ -544,12 +497,14 @@ void ITSFhrTask::monitorData(o2::framework::ProcessingContext& ctx)
 #pragma omp parallel for schedule(dynamic) reduction(+ \
                                                      : totalhit)
 #endif
-  // fill Monitor Objects use openMP multiple threads, and calculate the occupancy
+  // fill Monitor Objects use openMP multiple threads, and calculate the occupancy.
+  // The occupancy plot is shared by all the staves, thus it is filled through mFillBuffer, each thread uses its own slot.
   for (int i = 0; i < (int)activeStaves.size(); i++) {
+    int thread = 0;
+#ifdef WITH_OPENMP
+    thread = omp_get_thread_num();
+#endif
     int istave = activeStaves[i];
-    if (digVec[istave][0].size() < 1 && mLayer < NLayerIB) {
-      continue;
-    }
     const auto* DecoderTmp = mDecoder;
     int RUid = StaveBoundary[mLayer] + istave;
     const o2::itsmft::RUDecodeData* RUdecode = DecoderTmp->getRUDecode(RUid);
@@ -565,27 +520,23 @@ void ITSFhrTask::monitorData(o2::framework::ProcessingContext& ctx)
 
         mNoisyPixelNumber[mLayer][istave] = 0;
         for (int ichip = 0 + (ilink * 3); ichip < (ilink * 3) + 3; ichip++) {
-          std::unordered_map<unsigned int, int>::iterator iter;
+          auto& hitCounter = mHitCounters[getCounterIndex(istave, ichip)];
 
           if (mDoHitmapFilter == 1) {
-            for (auto iter = mHitPixelID_InStave[istave][0][ichip].begin(); iter != mHitPixelID_InStave[istave][0][ichip].end();) {
-              if ((double)iter->second / 10 < (double)nHitsTotal / ((ChipBoundary[mLayer + 1] - ChipBoundary[mLayer]) * 1024 * 512)) { // noisy if more than 3x of averaged per chip
-                mHitPixelID_InStave[istave][0][ichip].erase(iter++);
-              } else {
-                ++iter;
-              }
-            }
+            hitCounter.eraseIf([&](uint32_t hits) {
+              return (double)hits / 10 < (double)nHitsTotal / ((ChipBoundary[mLayer + 1] - ChipBoundary[mLayer]) * 1024 * 512); // noisy if more than 3x of averaged per chip
+            });
           }
 
-          for (auto iter = mHitPixelID_InStave[istave][0][ichip].begin(); iter != mHitPixelID_InStave[istave][0][ichip].end(); iter++) {
-            if ((iter->second > mHitCutForNoisyPixel) &&
-                (iter->second / (double)GBTLinkInfo->statistics.nTriggers) > mOccupancyCutForNoisyPixel) {
+          hitCounter.forEach([&](uint16_t, uint16_t, uint32_t hits) {
+            if (((int)hits > mHitCutForNoisyPixel) &&
+                (hits / (double)GBTLinkInfo->statistics.nTriggers) > mOccupancyCutForNoisyPixel) {
               mNoisyPixelNumber[mLayer][istave]++; // count only in 10000 events as soon as nTriggers is 1e6
-              occupancyPlotTmp[i]->Fill(log10((double)iter->second / GBTLinkInfo->statistics.nTriggers));
+              mFillBuffer.fill(thread, mOccupancyPlot, log10((double)hits / GBTLinkInfo->statistics.nTriggers));
             }
 
-            totalhit += (int)iter->second;
-          }
+            totalhit += (int)hits;
+          });
 
           mOccupancyLane[istave][ichip] = mHitnumberLane[istave][ichip] / (GBTLinkInfo->statistics.nTriggers * 1024. * 512.);
         }
@@ -608,24 +559,20 @@ void ITSFhrTask::monitorData(o2::framework::ProcessingContext& ctx)
         for (int ihic = 0; ihic < ((nHicPerStave[mLayer] / NSubStave[mLayer])); ihic++) {
           for (int ichip = 0; ichip < nChipsPerHic[mLayer]; ichip++) {
             if (GBTLinkInfo->statistics.nTriggers > 0) {
+              auto& hitCounter = mHitCounters[getCounterIndex(istave, (ihic + ilink * ((nHicPerStave[mLayer] / NSubStave[mLayer]))) * nChipsPerHic[mLayer] + ichip)];
 
               if (mDoHitmapFilter == 1) {
-                for (auto iter = mHitPixelID_InStave[istave][ihic + ilink * ((nHicPerStave[mLayer] / NSubStave[mLayer]))][ichip].begin(); iter != mHitPixelID_InStave[istave][ihic + ilink * ((nHicPerStave[mLayer] / NSubStave[mLayer]))][ichip].end();) {
-                  if ((double)iter->second / 100 < (double)nHitsTotal / ((ChipBoundary[mLayer + 1] - ChipBoundary[mLayer]) * 1024 * 512)) { // noisy if more than 3x of averaged per chip
-                    mHitPixelID_InStave[istave][ihic + ilink * ((nHicPerStave[mLayer] / NSubStave[mLayer]))][ichip].erase(iter++);
-
-                  } else {
-                    ++iter;
-                  }
-                }
+                hitCounter.eraseIf([&](uint32_t hits) {
+                  return (double)hits / 100 < (double)nHitsTotal / ((ChipBoundary[mLayer + 1] - ChipBoundary[mLayer]) * 1024 * 512); // noisy if more than 3x of averaged per chip
+                });
               }
-              for (auto iter = mHitPixelID_InStave[istave][ihic + ilink * ((nHicPerStave[mLayer] / NSubStave[mLayer]))][ichip].begin(); iter != mHitPixelID_InStave[istave][ihic + ilink * ((nHicPerStave[mLayer] / NSubStave[mLayer]))][ichip].end(); iter++) {
-                if ((iter->second > mHitCutForNoisyPixel) &&
-                    (iter->second / (double)GBTLinkInfo->statistics.nTriggers) > mOccupancyCutForNoisyPixel) {
+              hitCounter.forEach([&](uint16_t, uint16_t, uint32_t hits) {
+                if (((int)hits > mHitCutForNoisyPixel) &&
+                    (hits / (double)GBTLinkInfo->statistics.nTriggers) > mOccupancyCutForNoisyPixel) {
                   mNoisyPixelNumber[mLayer][istave]++;
-                  occupancyPlotTmp[i]->Fill(log10((double)iter->second / GBTLinkInfo->statistics.nTriggers));
+                  mFillBuffer.fill(thread, mOccupancyPlot, log10((double)hits / GBTLinkInfo->statistics.nTriggers));
                 }
-              }
+              });
             }
           }
 
@@ -646,10 +593,11 @@ void ITSFhrTask::monitorData(o2::framework::ProcessingContext& ctx)
       }
     }
   }
-  // fill Occupancy plots, chip stave occupancy plots and error statistic plots
+  mFillBuffer.reduce();
+
+  // fill chip stave occupancy plots and error statistic plots
   for (int i = 0; i < (int)activeStaves.size(); i++) {
     int istave = activeStaves[i];
-    mOccupancyPlot->Add(occupancyPlotTmp[i]);
     if (mLayer < NLayerIB) {
       for (int ichip = 0; ichip < nChipsPerHic[mLayer]; ichip++) {
         mChipStaveOccupancy->SetBinContent(ichip + 1, istave + 1, mOccupancyLane[istave][ichip]);
@@ -709,20 +657,6 @@ void ITSFhrTask::monitorData(o2::framework::ProcessingContext& ctx)
     mErrorPlots->SetBinContent(ierror + 1, feeError);
   }
 
-  // delete pointor in monitorData()
-  for (int istave = 0; istave < NStaves[mLayer]; istave++) {
-    delete[] digVec[istave];
-  }
-  delete[] digVec;
-
-  for (int i = 0; i < (int)activeStaves.size(); i++) {
-    delete occupancyPlotTmp[i];
-  }
-  delete[] occupancyPlotTmp;
-
-  end = std::chrono::high_resolution_clock::now();
-  difference = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-
   mTFCount++;
 }
 
@@ -749,6 +683,36 @@ void ITSFhrTask::getParameters()
 void ITSFhrTask::endOfCycle()
 {
   ILOG(Debug, Devel) << "endOfCycle" << ENDM;
+  fillStaveHitmaps();
+}
+
+void ITSFhrTask::fillStaveHitmaps()
+{
+  // one THnSparse::Fill per fired pixel, weighted by its number of hits, rather than one per hit
+  for (int istave = 0; istave < NStaves[mLayer]; istave++) {
+    double entries = mStaveHitmap[istave]->GetEntries();
+    for (int ihic = 0; ihic < nHicPerStave[mLayer]; ihic++) {
+      for (int chip = 0; chip < nChipsPerHic[mLayer]; chip++) {
+        auto& counter = mHitmapCounters[getCounterIndex(istave, ihic * nChipsPerHic[mLayer] + chip)];
+        int ilink = ihic / (nHicPerStave[mLayer] / NSubStave[mLayer]);
+        counter.forEach([&](uint16_t row, uint16_t column, uint32_t hits) {
+          if (mLayer < NLayerIB) {
+            Double_t pixelPos[2] = { 1. * (column + (1024 * chip)), 1. * row };
+            mStaveHitmap[istave]->Fill(pixelPos, hits);
+          } else if (chip < 7) {
+            Double_t pixelPos[2] = { 1. * ((ihic % (nHicPerStave[mLayer] / NSubStave[mLayer]) * ((nChipsPerHic[mLayer] / 2) * NCols)) + chip * NCols + column), 1. * (NRows - row - 1 + (1024 * ilink)) };
+            mStaveHitmap[istave]->Fill(pixelPos, hits);
+          } else {
+            Double_t pixelPos[2] = { 1. * ((ihic % (nHicPerStave[mLayer] / NSubStave[mLayer]) * ((nChipsPerHic[mLayer] / 2) * NCols)) + (nChipsPerHic[mLayer] / 2) * NCols - (chip - 7) * NCols - column * 1.), 1. * (NRows + row + (1024 * ilink)) };
+            mStaveHitmap[istave]->Fill(pixelPos, hits);
+          }
+          entries += hits;
+        });
+        counter.clear();
+      }
+    }
+    mStaveHitmap[istave]->SetEntries(entries); // as if filled hit by hit
+  }
 }
 
 void ITSFhrTask::endOfActivity(const Activity& /*activity*/)
@@ -801,7 +765,6 @@ void ITSFhrTask::reset()
       for (int ichip = 0; ichip < nChipsPerHic[mLayer]; ichip++) {
         mHitnumberLane[istave][ichip] = 0;
         mOccupancyLane[istave][ichip] = 0;
-        mHitPixelID_InStave[istave][0][ichip].clear();
         mChipStat[istave][ichip] = 0;
       }
     }
@@ -818,12 +781,17 @@ void ITSFhrTask::reset()
         mOccupancyLane[istave][2 * ihic] = 0;
         mOccupancyLane[istave][2 * ihic + 1] = 0;
         for (int ichip = 0; ichip < nChipsPerHic[mLayer]; ichip++) {
-          mHitPixelID_InStave[istave][ihic][ichip].clear();
           mChipStat[istave][ihic * nChipsPerHic[mLayer] + ichip] = 0;
         }
       }
     }
   }
+  for (auto& counter : mHitCounters) {
+    counter.clear();
+  }
+  for (auto& counter : mHitmapCounters) {
+    counter.clear();
+  }
   std::fill(&mNoisyPixelNumber[0][0], &mNoisyPixelNumber[0][0] + 7 * 48, 0);
   ILOG(Debug, Devel) << "Reset" << ENDM;
 }
@@ -0,0 +1,185 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    testChipHitCounter.cxx
+///
+
+#include "ITS/ChipHitCounter.h"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#define BOOST_TEST_MODULE ChipHitCounter test
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+using namespace o2::quality_control_modules::its;
+
+namespace
+{
+struct Pixel {
+  uint16_t row;
+  uint16_t column;
+};
+
+// a few hot pixels firing often on top of uniformly distributed noise
+std::vector<Pixel> makeHits(size_t nHits, std::mt19937& generator)
+{
+  std::uniform_int_distribution<uint16_t> row(0, 511);
+  std::uniform_int_distribution<uint16_t> column(0, 1023);
+  std::uniform_int_distribution<int> hot(0, 9);
+  std::vector<Pixel> hits;
+  for (size_t i = 0; i < nHits; i++) {
+    if (hot(generator) == 0) {
+      hits.push_back({ static_cast<uint16_t>(row(generator) % 4), static_cast<uint16_t>(column(generator) % 4) });
+    } else {
+      hits.push_back({ row(generator), column(generator) });
+    }
+  }
+  return hits;
+}
+
+// all the pixels of a few columns, like a faulty double column firing on top of the noise
+std::vector<Pixel> makeColumnHits(size_t nHits, std::mt19937& generator)
+{
+  std::uniform_int_distribution<uint16_t> row(0, 511);
+  std::uniform_int_distribution<uint16_t> column(500, 503);
+  std::vector<Pixel> hits;
+  for (size_t i = 0; i < nHits; i++) {
+    hits.push_back({ row(generator), column(generator) });
+  }
+  return hits;
+}
+
+std::map<uint32_t, uint32_t> toMap(const ChipHitCounter& counter)
+{
+  std::map<uint32_t, uint32_t> result;
+  counter.forEach([&](uint16_t row, uint16_t column, uint32_t hits) {
+    BOOST_REQUIRE(result.emplace(1000 * column + row, hits).second);
+  });
+  return result;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_ChipHitCounter)
+{
+  ChipHitCounter counter;
+  BOOST_CHECK(counter.empty());
+  BOOST_CHECK_EQUAL(counter.get(0, 0), 0);
+
+  counter.add(0, 0);
+  counter.add(511, 1023);
+  counter.add(511, 1023, 4);
+  BOOST_CHECK_EQUAL(counter.size(), 2);
+  BOOST_CHECK_EQUAL(counter.get(0, 0), 1);
+  BOOST_CHECK_EQUAL(counter.get(511, 1023), 5);
+  BOOST_CHECK_EQUAL(counter.get(1, 0), 0);
+
+  BOOST_CHECK_EQUAL(counter.eraseIf([](uint32_t hits) { return hits < 2; }), 1);
+  BOOST_CHECK_EQUAL(counter.size(), 1);
+  BOOST_CHECK_EQUAL(counter.get(0, 0), 0);
+  BOOST_CHECK_EQUAL(counter.get(511, 1023), 5);
+
+  counter.clear();
+  BOOST_CHECK(counter.empty());
+  BOOST_CHECK_EQUAL(counter.get(511, 1023), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_ChipHitCounter_same_as_unordered_map)
+{
+  std::mt19937 generator(42);
+  ChipHitCounter counter;
+  std::unordered_map<unsigned int, int> reference;
+  for (int tf = 0; tf < 20; tf++) {
+    for (const auto& pixel : makeHits(5000, generator)) {
+      counter.add(pixel.row, pixel.column);
+      reference[1000 * pixel.column + pixel.row]++;
+    }
+    // the filter of the ITSFhrTask
+    const uint32_t threshold = tf;
+    counter.eraseIf([&](uint32_t hits) { return hits < threshold; });
+    for (auto iter = reference.begin(); iter != reference.end();) {
+      if ((uint32_t)iter->second < threshold) {
+        reference.erase(iter++);
+      } else {
+        ++iter;
+      }
+    }
+
+    BOOST_REQUIRE_EQUAL(counter.size(), reference.size());
+    auto result = toMap(counter);
+    for (const auto& [key, hits] : reference) {
+      BOOST_REQUIRE_EQUAL(result[key], (uint32_t)hits);
+      BOOST_REQUIRE_EQUAL(counter.get(key % 1000, key / 1000), (uint32_t)hits);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_ChipHitCounter_full_columns)
+{
+  ChipHitCounter counter;
+  for (uint16_t column = 500; column < 504; column++) {
+    for (uint16_t row = 0; row < 512; row++) {
+      counter.add(row, column, row + 1);
+    }
+  }
+  BOOST_REQUIRE_EQUAL(counter.size(), 4 * 512u);
+  for (uint16_t column = 500; column < 504; column++) {
+    for (uint16_t row = 0; row < 512; row++) {
+      BOOST_REQUIRE_EQUAL(counter.get(row, column), row + 1u);
+    }
+  }
+  BOOST_CHECK_EQUAL(counter.get(0, 499), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(benchmark_hits, *boost::unit_test::disabled())
+{
+  std::mt19937 generator(7);
+  const int repetitions = 20;
+
+  auto measure = [&](const char* name, const std::vector<Pixel>& hits, auto&& count) {
+    auto start = std::chrono::steady_clock::now();
+    size_t checksum = 0;
+    for (int i = 0; i < repetitions; i++) {
+      checksum += count();
+    }
+    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << repetitions * hits.size() / duration.count() / 1e6 << " M hits/s (checksum " << checksum << ")" << std::endl;
+  };
+
+  for (const auto& [scenario, hits] : { std::make_pair("noise", makeHits(1000000, generator)),
+                                        std::make_pair("columns", makeColumnHits(1000000, generator)) }) {
+    std::cout << scenario << std::endl;
+    std::unordered_map<unsigned int, int> map;
+    measure("std::unordered_map", hits, [&]() {
+      map.clear();
+      for (const auto& pixel : hits) {
+        map[1000 * pixel.column + pixel.row]++;
+      }
+      return map.size();
+    });
+    ChipHitCounter counter;
+    measure("ChipHitCounter", hits, [&]() {
+      counter.clear();
+      for (const auto& pixel : hits) {
+        counter.add(pixel.row, pixel.column);
+      }
+      return counter.size();
+    });
+  }
+}
@@ -68,6 +68,7 @@ class DigitsPostProcessing : public ReferenceComparatorTask
   bool mFullHistos{ false };
   bool mEnableLastCycleHistos{ false };
   bool mEnableTrending{ false };
+  size_t mTrendCapacity{ 0 }; // 0 means that the trends grow without limits
 
   float mChannelRateMin{ 0 };
   float mChannelRateMax{ 100 };
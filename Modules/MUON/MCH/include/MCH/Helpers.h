@@ -20,6 +20,7 @@
 #include "QualityControl/DatabaseInterface.h"
 #include "QualityControl/Quality.h"
 #include "QualityControl/CustomParameters.h"
+#include "QualityControl/DownsampledTrend.h"
 #include "MCHConstants/DetectionElements.h"
 #include <TCanvas.h>
 #include <TH1F.h>
@@ -165,8 +166,11 @@ class TrendGraph : public TCanvas
   TrendGraph(std::string name, std::string title, std::string label, std::optional<float> refValue = {});
 
   void update(uint64_t time, float val);
+  /// keep at most capacity * tiers points, the older ones being averaged
+  void enableDownsampling(size_t capacity, size_t tiers = 3, size_t factor = 10);
 
  private:
+  std::optional<o2::quality_control::postprocessing::DownsampledTrend> mDownsampledTrend;
   std::optional<float> mRefValue;
   std::string mAxisLabel;
   std::unique_ptr<TGraph> mGraph;
@@ -183,8 +187,11 @@ class QualityTrendGraph : public TCanvas
   QualityTrendGraph(std::string name, std::string title);
 
   void update(uint64_t time, o2::quality_control::core::Quality q);
+  /// keep at most capacity * tiers points, the older ones showing the worst quality of the period
+  void enableDownsampling(size_t capacity, size_t tiers = 3, size_t factor = 10);
 
  private:
+  std::optional<o2::quality_control::postprocessing::DownsampledTrend> mDownsampledTrend;
   std::unique_ptr<TGraph> mGraph;
   std::unique_ptr<TGraph> mGraphHist;
   std::array<std::unique_ptr<TText>, 4> mLabels;
@@ -200,6 +207,8 @@ class TrendMultiGraph : public TCanvas
   void addGraph(std::string name, std::string title, std::optional<float> refValue = {});
   void addLegends();
   void update(long time, gsl::span<double> values);
+  /// keep at most capacity * tiers points per graph, the older ones being averaged
+  void enableDownsampling(size_t capacity, size_t tiers = 3, size_t factor = 10);
 
   void setRange(float min, float max)
   {
@@ -218,6 +227,7 @@ class TrendMultiGraph : public TCanvas
   std::array<std::optional<float>, 10> mRefValues;
   std::array<std::unique_ptr<TGraph>, 10> mGraphs;
   std::array<std::unique_ptr<TGraph>, 10> mGraphsRef;
+  std::array<std::optional<o2::quality_control::postprocessing::DownsampledTrend>, 10> mDownsampledTrends;
   std::array<std::unique_ptr<TLegend>, 5> mLegends;
 };
 
@@ -36,7 +36,8 @@ namespace muonchambers
 class RatesTrendsPlotter : public HistPlotter
 {
  public:
-  RatesTrendsPlotter(std::string path, bool fullPlots = false);
+  /// \param trendCapacity if not zero, the trends keep at most this many points at full resolution, see DownsampledTrend
+  RatesTrendsPlotter(std::string path, bool fullPlots = false, size_t trendCapacity = 0);
 
   void update(long time, TH2F* hEfficiency);
 
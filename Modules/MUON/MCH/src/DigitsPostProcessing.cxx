@@ -111,11 +111,11 @@ void DigitsPostProcessing::createRatesHistos(Trigger t, repository::DatabaseInte
 
   if (mEnableTrending) {
     mRatesTrendsPlotter.reset();
-    mRatesTrendsPlotter = std::make_unique<RatesTrendsPlotter>("Trends/Rates/", mFullHistos);
+    mRatesTrendsPlotter = std::make_unique<RatesTrendsPlotter>("Trends/Rates/", mFullHistos, mTrendCapacity);
     mRatesTrendsPlotter->publish(getObjectsManager(), core::PublicationPolicy::ThroughStop);
 
     mRatesTrendsPlotterSignal.reset();
-    mRatesTrendsPlotterSignal = std::make_unique<RatesTrendsPlotter>("Trends/RatesSignal/", mFullHistos);
+    mRatesTrendsPlotterSignal = std::make_unique<RatesTrendsPlotter>("Trends/RatesSignal/", mFullHistos, mTrendCapacity);
     mRatesTrendsPlotterSignal->publish(getObjectsManager(), core::PublicationPolicy::ThroughStop);
   }
 }
@@ -204,6 +204,7 @@ void DigitsPostProcessing::initialize(Trigger t, framework::ServiceRegistryRef s
   mFullHistos = getConfigurationParameter<bool>(mCustomParameters, "FullHistos", mFullHistos, activity);
   mEnableLastCycleHistos = getConfigurationParameter<bool>(mCustomParameters, "EnableLastCycleHistos", mEnableLastCycleHistos, activity);
   mEnableTrending = getConfigurationParameter<bool>(mCustomParameters, "EnableTrending", mEnableTrending, activity);
+  mTrendCapacity = getConfigurationParameter<size_t>(mCustomParameters, "TrendCapacity", mTrendCapacity, activity);
 
   mChannelRateMin = getConfigurationParameter<float>(mCustomParameters, "ChannelRateMin", mChannelRateMin, activity);
   mChannelRateMax = getConfigurationParameter<float>(mCustomParameters, "ChannelRateMax", mChannelRateMax, activity);
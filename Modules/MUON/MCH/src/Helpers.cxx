@@ -33,6 +33,7 @@
 
 using namespace o2::quality_control;
 using namespace o2::quality_control::core;
+using namespace o2::quality_control::postprocessing;
 
 namespace o2
 {
@@ -41,6 +42,20 @@ namespace quality_control_modules
 namespace muonchambers
 {
 
+namespace
+{
+// sets the points of the graph at the times of the source graph, all with the same value
+void setPointsAtTimesOf(const TGraph& source, TGraph& graph, double value)
+{
+  graph.Set(source.GetN());
+  for (int i = 0; i < source.GetN(); i++) {
+    graph.SetPoint(i, source.GetX()[i], value);
+  }
+}
+} // namespace
+
+//_________________________________________________________________________________________
+
 std::string getHistoPath(int deId)
 {
   return fmt::format("ST{}/DE{}/", (deId - 100) / 200 + 1, deId);
@@ -850,12 +865,28 @@ TrendGraph::TrendGraph(std::string name, std::string title, std::string label, s
 
 //_________________________________________________________________________________________
 
+void TrendGraph::enableDownsampling(size_t capacity, size_t tiers, size_t factor)
+{
+  mDownsampledTrend.emplace(capacity, tiers, factor);
+}
+
+//_________________________________________________________________________________________
+
 void TrendGraph::update(uint64_t time, float val)
 {
-  mGraph->AddPoint(time, val);
-  mGraphHist->AddPoint(time, 0);
-  if (mRefValue && mGraphRef) {
-    mGraphRef->AddPoint(time, mRefValue.value());
+  if (mDownsampledTrend) {
+    mDownsampledTrend->add(time, val);
+    mDownsampledTrend->fill(*mGraph);
+    setPointsAtTimesOf(*mGraph, *mGraphHist, 0);
+    if (mRefValue && mGraphRef) {
+      setPointsAtTimesOf(*mGraph, *mGraphRef, mRefValue.value());
+    }
+  } else {
+    mGraph->AddPoint(time, val);
+    mGraphHist->AddPoint(time, 0);
+    if (mRefValue && mGraphRef) {
+      mGraphRef->AddPoint(time, mRefValue.value());
+    }
   }
 
   Clear();
@@ -925,6 +956,13 @@ QualityTrendGraph::QualityTrendGraph(std::string name, std::string title) : TCan
 
 //_________________________________________________________________________________________
 
+void QualityTrendGraph::enableDownsampling(size_t capacity, size_t tiers, size_t factor)
+{
+  mDownsampledTrend.emplace(capacity, tiers, factor);
+}
+
+//_________________________________________________________________________________________
+
 void QualityTrendGraph::update(uint64_t time, Quality q)
 {
   float val = 0.5;
@@ -937,8 +975,19 @@ void QualityTrendGraph::update(uint64_t time, Quality q)
   if (q == Quality::Good) {
     val = 3.5;
   }
-  mGraph->AddPoint(time, val);
-  mGraphHist->AddPoint(time, 0);
+  if (mDownsampledTrend) {
+    mDownsampledTrend->add(time, val);
+    // an aggregated period is shown with its worst quality
+    auto points = mDownsampledTrend->getPoints();
+    mGraph->Set(points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+      mGraph->SetPoint(i, points[i].time(), points[i].min);
+    }
+    setPointsAtTimesOf(*mGraph, *mGraphHist, 0);
+  } else {
+    mGraph->AddPoint(time, val);
+    mGraphHist->AddPoint(time, 0);
+  }
 
   Clear();
   cd();
@@ -1054,15 +1103,37 @@ void TrendMultiGraph::addLegends()
 
 //_________________________________________________________________________________________
 
+void TrendMultiGraph::enableDownsampling(size_t capacity, size_t tiers, size_t factor)
+{
+  for (auto& trend : mDownsampledTrends) {
+    trend.emplace(capacity, tiers, factor);
+  }
+}
+
+//_________________________________________________________________________________________
+
 void TrendMultiGraph::update(long time, gsl::span<double> values)
 {
   if (values.size() > mNGraphs) {
     return;
   }
 
-  mGraphHist->AddPoint(time, 0);
+  if (!mDownsampledTrends[0]) {
+    mGraphHist->AddPoint(time, 0);
+  }
   for (int i = 0; i < values.size(); i++) {
     auto& gr = mGraphs[i];
+    if (mDownsampledTrends[i]) {
+      mDownsampledTrends[i]->add(time, values[i]);
+      mDownsampledTrends[i]->fill(*gr);
+      if (i == 0) {
+        setPointsAtTimesOf(*gr, *mGraphHist, 0);
+      }
+      if (mRefValues[i] && mGraphsRef[i]) {
+        setPointsAtTimesOf(*gr, *mGraphsRef[i], mRefValues[i].value());
+      }
+      continue;
+    }
     gr->AddPoint(time, values[i]);
     if (mRefValues[i] && mGraphsRef[i]) {
       auto& grref = mGraphsRef[i];
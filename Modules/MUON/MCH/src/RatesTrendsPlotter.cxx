@@ -27,7 +27,7 @@ namespace quality_control_modules
 namespace muonchambers
 {
 
-RatesTrendsPlotter::RatesTrendsPlotter(std::string path, bool fullPlots) : mPath(path)
+RatesTrendsPlotter::RatesTrendsPlotter(std::string path, bool fullPlots, size_t trendCapacity) : mPath(path)
 {
   mReductor = std::make_unique<TH2ElecMapReductor>();
 
@@ -63,6 +63,19 @@ RatesTrendsPlotter::RatesTrendsPlotter(std::string path, bool fullPlots) : mPath
   mTrends->addLegends();
   // mTrends->setRange(0, 1.2);
   addCanvas(mTrends.get(), "");
+
+  if (trendCapacity > 0) {
+    mOrbits->enableDownsampling(trendCapacity);
+    for (auto& trend : mTrendsDE) {
+      if (trend) {
+        trend->enableDownsampling(trendCapacity);
+      }
+    }
+    for (auto& trend : mTrendsChamber) {
+      trend->enableDownsampling(trendCapacity);
+    }
+    mTrends->enableDownsampling(trendCapacity);
+  }
 }
 
 //_________________________________________________________________________________________
@@ -61,6 +61,7 @@ struct TrendingTaskConfigTPC : public quality_control::postprocessing::PostProce
 
   bool producePlotsOnUpdate;
   bool resumeTrend;
+  size_t fetchParallelism = 1; // maximum number of objects retrieved concurrently from the QCDB
   std::vector<Plot> plots;
   std::vector<DataSource> dataSources;
 };
@@ -20,6 +20,7 @@
 #define QUALITYCONTROL_TRENDINGTASKTPC_H
 
 #include "QualityControl/PostProcessingInterface.h"
+#include "QualityControl/ObjectFetcher.h"
 #include "TPC/ReductorTPC.h"
 #include "TPC/SliceInfo.h"
 #include "TPC/TrendingTaskConfigTPC.h"
@@ -93,6 +94,7 @@ class TrendingTaskTPC : public PostProcessingInterface
   std::unordered_map<std::string, bool> mIsMoObject;
   std::unordered_map<std::string, int> mNumberPads;
   std::unordered_map<std::string, std::vector<std::vector<float>>> mAxisDivision;
+  std::unique_ptr<o2::quality_control::postprocessing::ObjectFetcher> mObjectFetcher;
 };
 
 } // namespace o2::quality_control_modules::tpc
@@ -28,6 +28,7 @@ TrendingTaskConfigTPC::TrendingTaskConfigTPC(const std::string& id,
 {
   producePlotsOnUpdate = config.get<bool>("qc.postprocessing." + id + ".producePlotsOnUpdate", true);
   resumeTrend = config.get<bool>("qc.postprocessing." + id + ".resumeTrend", false);
+  fetchParallelism = config.get<size_t>("qc.postprocessing." + id + ".fetchParallelism", 1);
   for (const auto& plotConfig : config.get_child("qc.postprocessing." + id + ".plots")) {
     plots.push_back({ plotConfig.second.get<std::string>("name"),
                       plotConfig.second.get<std::string>("title", ""),
@@ -18,6 +18,7 @@
 
 #include "QualityControl/DatabaseInterface.h"
 #include "QualityControl/MonitorObject.h"
+#include "QualityControl/QualityObject.h"
 #include "QualityControl/RootClassFactory.h"
 #include "QualityControl/QcInfoLogger.h"
 #include "QualityControl/ActivityHelpers.h"
@@ -118,6 +119,7 @@ void TrendingTaskTPC::initialize(Trigger, framework::ServiceRegistryRef services
       mIsMoObject[source.name] = false;
     }
   }
+  mObjectFetcher = std::make_unique<ObjectFetcher>(mConfig.fetchParallelism, mConfig.repository);
 
   if (mConfig.producePlotsOnUpdate) {
     getObjectsManager()->startPublishing(mTrend.get(), PublicationPolicy::ThroughStop);
@@ -155,31 +157,38 @@ void TrendingTaskTPC::trendValues(const Trigger& t,
             : t.activity.mValidity.getMax() / 1000; // ROOT expects seconds since epoch.
   mMetaData.runNumber = t.activity.mId;
 
+  std::vector<ObjectFetcher::Request> requests;
+  std::vector<const TrendingTaskConfigTPC::DataSource*> requestedSources;
   for (auto& dataSource : mConfig.dataSources) {
     mNumberPads[dataSource.name] = 0;
     if (dataSource.type == "repository") {
       mSources[dataSource.name]->clear(); // reset
-      auto mo = qcdb.retrieveMO(dataSource.path, dataSource.name, t.timestamp, t.activity);
-      TObject* obj = mo ? mo->getObject() : nullptr;
-
       mAxisDivision[dataSource.name] = dataSource.axisDivision;
-      if (obj) {
-        mReductors[dataSource.name]->update(obj, *mSources[dataSource.name],
-                                            dataSource.axisDivision, mNumberPads[dataSource.name]);
-      }
+      requests.push_back({ dataSource.path, dataSource.name, ObjectFetcher::Request::Type::MonitorObject });
+      requestedSources.push_back(&dataSource);
     } else if (dataSource.type == "repository-quality") {
       // reset
       mSourcesQuality[dataSource.name]->qualitylevel = 0;
       mSourcesQuality[dataSource.name]->title = "";
-      if (auto qo = qcdb.retrieveQO(dataSource.path + "/" + dataSource.name, t.timestamp, t.activity)) {
-        mReductors[dataSource.name]->updateQuality(qo.get(), *mSourcesQuality[dataSource.name]);
-        mNumberPads[dataSource.name] = 1;
-      }
+      requests.push_back({ dataSource.path, dataSource.name, ObjectFetcher::Request::Type::QualityObject });
+      requestedSources.push_back(&dataSource);
     } else {
       ILOG(Error, Support) << "Data source '" << dataSource.type << "' unknown." << ENDM;
     }
   }
 
+  // the objects are reduced as soon as they are retrieved
+  mObjectFetcher->fetch(requests, t.timestamp, t.activity, {}, qcdb, [&](size_t request, ObjectFetcher::Result&& result) {
+    const auto& dataSource = *requestedSources[request];
+    if (TObject* obj = result.mo ? result.mo->getObject() : nullptr) {
+      mReductors[dataSource.name]->update(obj, *mSources[dataSource.name],
+                                          dataSource.axisDivision, mNumberPads[dataSource.name]);
+    } else if (result.qo) {
+      mReductors[dataSource.name]->updateQuality(result.qo.get(), *mSourcesQuality[dataSource.name]);
+      mNumberPads[dataSource.name] = 1;
+    }
+  });
+
   mTrend->Fill();
 } // void TrendingTaskTPC::trendValues(uint64_t timestamp, repository::DatabaseInterface& qcdb)
 
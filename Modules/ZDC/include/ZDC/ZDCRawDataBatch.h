@@ -0,0 +1,209 @@
+// Copyright 2019-2022 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   ZDCRawDataBatch.h
+/// \brief  Scanning of the ZDC raw pages and batches of decoded channel records
+///
+
+#ifndef QC_MODULE_ZDC_ZDCRAWDATABATCH_H
+#define QC_MODULE_ZDC_ZDCRAWDATABATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <TH2.h>
+
+#include "ZDCBase/Constants.h"
+#include "DataFormatsZDC/RawEventData.h"
+
+namespace o2::quality_control_modules::zdc
+{
+
+/// \brief Returns the position of the first byte which is not 0xff in data[position, size), or size if there is none.
+/// The bytes are compared 32 at a time, which the compiler turns into vector instructions.
+inline size_t findNonIdleByte(const uint8_t* data, size_t position, size_t size)
+{
+  constexpr uint64_t allSet = ~uint64_t{ 0 };
+  for (; position + 32 <= size; position += 32) {
+    uint64_t words[4];
+    std::memcpy(words, data + position, sizeof(words));
+    if ((words[0] & words[1] & words[2] & words[3]) != allSet) {
+      break;
+    }
+  }
+  while (position < size && data[position] == 0xff) {
+    position++;
+  }
+  return position;
+}
+
+/// \brief Calls function(word) for each GBT word of a payload in the packed format (wordSize bytes per word),
+/// except the idle words, which have all their bits set. Consecutive idle words are skipped in bulk.
+template <typename Function>
+void forEachNonIdleWord(const uint8_t* payload, size_t size, size_t wordSize, Function&& function)
+{
+  size_t position = 0;
+  while (position + wordSize <= size) {
+    size_t nonIdle = findNonIdleByte(payload, position, size);
+    position += (nonIdle - position) / wordSize * wordSize; // start of the word containing the non idle byte
+    if (position + wordSize > size) {
+      break;
+    }
+    function(payload + position);
+    position += wordSize;
+  }
+}
+
+/// \brief The channel records of one TF, decoded once from their bit fields into a structure of arrays.
+class ChannelRecordBatch
+{
+ public:
+  static constexpr int NSamples = 12;
+  /// Trigger bits, bit i corresponds to the bin i + 1 of the trigger bit histograms
+  enum Trigger : uint16_t {
+    AutoM = 1 << 0,
+    Auto0 = 1 << 1,
+    Auto1 = 1 << 2,
+    Auto2 = 1 << 3,
+    Auto3 = 1 << 4,
+    Alice0 = 1 << 5,
+    Alice1 = 1 << 6,
+    Alice2 = 1 << 7,
+    Alice3 = 1 << 8,
+  };
+  static constexpr int NTriggers = 9;
+
+  /// \brief Decodes a complete channel record (the three GBT words)
+  void add(const o2::zdc::EventChData& record)
+  {
+    const auto& f = record.f;
+    mBoard.push_back(f.board);
+    mChannel.push_back(f.ch);
+    mBc.push_back(f.bc);
+    mOffset.push_back(f.offset);
+    mHits.push_back(f.hits);
+    mTriggers.push_back((f.Auto_m ? AutoM : 0) | (f.Auto_0 ? Auto0 : 0) | (f.Auto_1 ? Auto1 : 0) | (f.Auto_2 ? Auto2 : 0) | (f.Auto_3 ? Auto3 : 0) |
+                        (f.Alice_0 ? Alice0 : 0) | (f.Alice_1 ? Alice1 : 0) | (f.Alice_2 ? Alice2 : 0) | (f.Alice_3 ? Alice3 : 0));
+    mHit.push_back(f.Hit);
+    mDataLoss.push_back(f.dLoss);
+    mError.push_back(f.error);
+    const unsigned samples[NSamples] = { f.s00, f.s01, f.s02, f.s03, f.s04, f.s05, f.s06, f.s07, f.s08, f.s09, f.s10, f.s11 };
+    for (auto sample : samples) {
+      mSamples.push_back(sample > o2::zdc::ADCMax ? sample - o2::zdc::ADCRange : sample);
+    }
+  }
+
+  size_t size() const { return mBoard.size(); }
+  void clear()
+  {
+    mBoard.clear();
+    mChannel.clear();
+    mBc.clear();
+    mOffset.clear();
+    mHits.clear();
+    mTriggers.clear();
+    mHit.clear();
+    mDataLoss.clear();
+    mError.clear();
+    mSamples.clear();
+  }
+
+  uint8_t getBoard(size_t i) const { return mBoard[i]; }
+  uint8_t getChannel(size_t i) const { return mChannel[i]; }
+  uint16_t getBc(size_t i) const { return mBc[i]; }
+  uint16_t getOffset(size_t i) const { return mOffset[i]; }
+  uint16_t getHits(size_t i) const { return mHits[i]; }
+  uint16_t getTriggers(size_t i) const { return mTriggers[i]; }
+  bool isHit(size_t i) const { return mHit[i]; }
+  bool isDataLoss(size_t i) const { return mDataLoss[i]; }
+  bool isError(size_t i) const { return mError[i]; }
+  /// \brief The NSamples samples of the record, as signed values
+  const int16_t* getSamples(size_t i) const { return mSamples.data() + NSamples * i; }
+
+  /// \brief Calls function(bin) for each trigger bit of the record, from Alice3 (bin 9) down to AutoM (bin 1),
+  /// or once with the bin 0 if no trigger bit is set. These are the y bins of the trigger bit histograms.
+  template <typename Function>
+  void forEachTriggerBin(size_t i, Function&& function) const
+  {
+    const uint16_t triggers = mTriggers[i];
+    if (!triggers) {
+      function(0);
+      return;
+    }
+    for (int bit = NTriggers - 1; bit >= 0; bit--) {
+      if (triggers & (1 << bit)) {
+        function(bit + 1);
+      }
+    }
+  }
+
+  /// \brief Calls function(x, y) for each entry of the record in a signal histogram ("AoT" condition): each sample
+  /// is entered once per triggered level (Alice or Auto), at x = sample - 12 * level, from the level 3 down to 0.
+  template <typename Function>
+  void forEachSignalEntry(size_t i, Function&& function) const
+  {
+    const uint16_t triggers = mTriggers[i];
+    const bool levels[4] = { (triggers & (Alice0 | Auto0)) != 0, (triggers & (Alice1 | Auto1)) != 0,
+                             (triggers & (Alice2 | Auto2)) != 0, (triggers & (Alice3 | Auto3)) != 0 };
+    const int16_t* s = getSamples(i);
+    for (int sample = 0; sample < NSamples; sample++) {
+      for (int level = 3; level >= 0; level--) {
+        if (levels[level]) {
+          function(sample - 12. * level, double(s[sample]));
+        }
+      }
+    }
+  }
+
+ private:
+  std::vector<uint8_t> mBoard;
+  std::vector<uint8_t> mChannel;
+  std::vector<uint16_t> mBc;
+  std::vector<uint16_t> mOffset;
+  std::vector<uint16_t> mHits;
+  std::vector<uint16_t> mTriggers;
+  std::vector<uint8_t> mHit;
+  std::vector<uint8_t> mDataLoss;
+  std::vector<uint8_t> mError;
+  std::vector<int16_t> mSamples;
+};
+
+/// \brief Fills of a TH2 kept in contiguous arrays, added to the histogram with one TH2::FillN in the same order.
+/// The arrays are kept after flush() to avoid allocations.
+class PendingFills2D
+{
+ public:
+  void add(double x, double y)
+  {
+    mX.push_back(x);
+    mY.push_back(y);
+  }
+  size_t size() const { return mX.size(); }
+  void flush(TH2* histogram)
+  {
+    if (histogram && !mX.empty()) {
+      histogram->FillN(static_cast<int>(mX.size()), mX.data(), mY.data(), nullptr);
+    }
+    mX.clear();
+    mY.clear();
+  }
+
+ private:
+  std::vector<double> mX;
+  std::vector<double> mY;
+};
+
+} // namespace o2::quality_control_modules::zdc
+
+#endif // QC_MODULE_ZDC_ZDCRAWDATABATCH_H
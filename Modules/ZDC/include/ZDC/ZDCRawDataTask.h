@@ -23,6 +23,7 @@
 #include "ZDCBase/Constants.h"
 #include "ZDCSimulation/ZDCSimParam.h"
 #include "DataFormatsZDC/RawEventData.h"
+#include "ZDC/ZDCRawDataBatch.h"
 #include <string>
 #include <vector>
 
@@ -87,7 +88,10 @@ class ZDCRawDataTask final : public TaskInterface
   void init();
   void initHisto();
   int process(const o2::zdc::EventData& ev);
+  /// \brief Adds a channel record to the batch, the histograms are filled by processBatch()
   int process(const o2::zdc::EventChData& ch);
+  /// \brief Fills the histograms with the channel records of the batch and clears it
+  void processBatch();
   int processWord(const uint32_t* word);
   int getHPos(uint32_t board, uint32_t ch, int matrix[o2::zdc::NModules][o2::zdc::NChPerModule]);
   std::string getNameChannel(int imod, int ich);
@@ -181,6 +185,14 @@ class ZDCRawDataTask final : public TaskInterface
   // End Stefan addition
 
   sAlignment fMatrixAlign[o2::zdc::NModules][o2::zdc::NChPerModule];
+
+  ChannelRecordBatch mBatch;                                                            //! channel records of the current TF
+  std::vector<PendingFills2D> mPendingSignal[o2::zdc::NModules][o2::zdc::NChPerModule]; //! one per histogram of fMatrixHistoSignal
+  std::vector<PendingFills2D> mPendingBunch[o2::zdc::NModules][o2::zdc::NChPerModule];  //! one per histogram of fMatrixHistoBunch
+  PendingFills2D mPendingFireChannel;                                                   //!
+  PendingFills2D mPendingTrasmChannel;                                                  //!
+  PendingFills2D mPendingTriggerBits;                                                   //!
+  PendingFills2D mPendingTriggerBitsHits;                                               //!
 };
 
 } // namespace o2::quality_control_modules::zdc
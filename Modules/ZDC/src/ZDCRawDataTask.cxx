@@ -94,7 +94,6 @@ void ZDCRawDataTask::monitorData(o2::framework::ProcessingContext& ctx)
   o2::framework::DPLRawParser parser(ctx.inputs());
   int PayloadPerGBTW = 10;
   int dataFormat;
-  const uint32_t* gbtw;
   uint64_t count = 0;
   size_t payloadSize;
   size_t offset;
@@ -119,12 +118,10 @@ void ZDCRawDataTask::monitorData(o2::framework::ProcessingContext& ctx)
         offset = it.offset();
         dataFormat = o2::raw::RDHUtils::getDataFormat(rdhPtr);
         if (dataFormat == 2) {
-          for (int32_t ip = 0; (ip + PayloadPerGBTW) <= payloadSize; ip += PayloadPerGBTW) {
-            gbtw = (const uint32_t*)&payload[ip];
-            if (gbtw[0] != 0xffffffff || gbtw[1] != 0xffffffff || (gbtw[2] & 0xffff) != 0xffff) {
-              processWord(gbtw);
-            }
-          }
+          // the idle GBT words have all their bits set, they are skipped in bulk
+          forEachNonIdleWord(reinterpret_cast<const uint8_t*>(payload), payloadSize, PayloadPerGBTW, [this](const uint8_t* gbtw) {
+            processWord(reinterpret_cast<const uint32_t*>(gbtw));
+          });
         } else if (dataFormat == 0) {
           for (int32_t ip = 0; ip < (int32_t)payloadSize; ip += 16) {
             processWord((const uint32_t*)&payload[ip]);
@@ -133,6 +130,7 @@ void ZDCRawDataTask::monitorData(o2::framework::ProcessingContext& ctx)
       }
     }
   }
+  processBatch();
 }
 
 void ZDCRawDataTask::endOfCycle()
@@ -633,233 +631,183 @@ int ZDCRawDataTask::processWord(const uint32_t* word)
 
 int ZDCRawDataTask::process(const o2::zdc::EventChData& ch)
 {
-  int flag_reset = 0;
+  mBatch.add(ch);
+  return 0;
+}
+
+void ZDCRawDataTask::processBatch()
+{
   static constexpr int last_bc = o2::constants::lhc::LHCMaxBunches - 1;
+  using Batch = ChannelRecordBatch;
   union {
     uint16_t uns;
     int16_t sig;
   } word16;
-  int flag = 0;
-  // Not empty event
-  auto f = ch.f;
-  uint16_t us[12];
-  int16_t s[12];
-  us[0] = f.s00;
-  us[1] = f.s01;
-  us[2] = f.s02;
-  us[3] = f.s03;
-  us[4] = f.s04;
-  us[5] = f.s05;
-  us[6] = f.s06;
-  us[7] = f.s07;
-  us[8] = f.s08;
-  us[9] = f.s09;
-  us[10] = f.s10;
-  us[11] = f.s11;
-  int itb = 4 * (int)f.board + (int)f.ch;
-  if (f.Hit == 1 && fFireChannel) {
-    fFireChannel->Fill(f.board, f.ch);
-  }
-  if (fTrasmChannel) {
-    fTrasmChannel->Fill(f.board, f.ch);
+  bool updateSummary[o2::zdc::NModules][o2::zdc::NChPerModule] = {};
+  for (int im = 0; im < o2::zdc::NModules; im++) {
+    for (int ic = 0; ic < o2::zdc::NChPerModule; ic++) {
+      mPendingSignal[im][ic].resize(fMatrixHistoSignal[im][ic].size());
+      mPendingBunch[im][ic].resize(fMatrixHistoBunch[im][ic].size());
+    }
   }
 
-  if (f.Alice_0 || f.Auto_0 || f.Alice_1 || f.Auto_1 || f.Alice_2 || f.Auto_2 || f.Alice_3 || f.Auto_3) {
-    for (int j = 0; j < (int)fMatrixHistoSignal[f.board][f.ch].size(); j++) {
-      for (int32_t i = 0; i < 12; i++) {
-        if (us[i] > o2::zdc::ADCMax) {
-          s[i] = us[i] - o2::zdc::ADCRange;
-        } else {
-          s[i] = us[i];
-        }
-        if ((fMatrixHistoSignal[f.board][f.ch].at(j).condHisto.at(0) == "AoT") && (f.Alice_3 || f.Auto_3)) {
-          fMatrixHistoSignal[f.board][f.ch].at(j).histo->Fill(i - 36., double(s[i]));
-        }
-        if ((fMatrixHistoSignal[f.board][f.ch].at(j).condHisto.at(0) == "AoT") && (f.Alice_2 || f.Auto_2)) {
-          fMatrixHistoSignal[f.board][f.ch].at(j).histo->Fill(i - 24., double(s[i]));
-        }
-        if ((fMatrixHistoSignal[f.board][f.ch].at(j).condHisto.at(0) == "AoT") && (f.Alice_1 || f.Auto_1)) {
-          fMatrixHistoSignal[f.board][f.ch].at(j).histo->Fill(i - 12., double(s[i]));
+  // The records are processed in their order. The 2D histograms are filled at the end from the pending fills, in
+  // the same order, while the histograms which are read or reset on the way are filled directly.
+  for (size_t r = 0; r < mBatch.size(); r++) {
+    const int board = mBatch.getBoard(r);
+    const int ch = mBatch.getChannel(r);
+    const int bc = mBatch.getBc(r);
+    const uint16_t triggers = mBatch.getTriggers(r);
+    const bool hit = mBatch.isHit(r);
+    const int16_t* s = mBatch.getSamples(r);
+    int itb = 4 * board + ch;
+    if (hit && fFireChannel) {
+      mPendingFireChannel.add(board, ch);
+    }
+    if (fTrasmChannel) {
+      mPendingTrasmChannel.add(board, ch);
+    }
+
+    const bool level0 = triggers & (Batch::Alice0 | Batch::Auto0);
+    if (triggers & ~Batch::AutoM) { // any trigger of the levels 0 to 3
+      for (int j = 0; j < (int)fMatrixHistoSignal[board][ch].size(); j++) {
+        if (fMatrixHistoSignal[board][ch].at(j).condHisto.at(0) != "AoT") {
+          continue;
         }
-        if ((fMatrixHistoSignal[f.board][f.ch].at(j).condHisto.at(0) == "AoT") && (f.Alice_0 || f.Auto_0)) {
-          fMatrixHistoSignal[f.board][f.ch].at(j).histo->Fill(i + 0., double(s[i]));
-          if (f.Auto_0) {
-            fMatrixAlign[f.board][f.ch].minSample.vSamples[i].num_entry += 1;
-            fMatrixAlign[f.board][f.ch].minSample.vSamples[i].sum += (int)s[i];
-            fMatrixAlign[f.board][f.ch].minSample.vSamples[i].mean = (double)fMatrixAlign[f.board][f.ch].minSample.vSamples[i].sum / (double)fMatrixAlign[f.board][f.ch].minSample.vSamples[i].num_entry;
-            if (fMatrixAlign[f.board][f.ch].minSample.vSamples[0].num_entry > fAlignNumEntries && fMatrixAlign[f.board][f.ch].minSample.vSamples[i].mean < fMatrixAlign[f.board][f.ch].minSample.min_mean) {
-              fMatrixAlign[f.board][f.ch].minSample.id_min_sample = i;
-              fMatrixAlign[f.board][f.ch].minSample.min_mean = fMatrixAlign[f.board][f.ch].minSample.vSamples[i].mean;
-              fMatrixAlign[f.board][f.ch].minSample.num_entry = fMatrixAlign[f.board][f.ch].minSample.vSamples[i].num_entry;
+        auto& pending = mPendingSignal[board][ch][j];
+        mBatch.forEachSignalEntry(r, [&pending](double x, double y) { pending.add(x, y); });
+        if (triggers & Batch::Auto0) {
+          for (int32_t i = 0; i < Batch::NSamples; i++) {
+            fMatrixAlign[board][ch].minSample.vSamples[i].num_entry += 1;
+            fMatrixAlign[board][ch].minSample.vSamples[i].sum += (int)s[i];
+            fMatrixAlign[board][ch].minSample.vSamples[i].mean = (double)fMatrixAlign[board][ch].minSample.vSamples[i].sum / (double)fMatrixAlign[board][ch].minSample.vSamples[i].num_entry;
+            if (fMatrixAlign[board][ch].minSample.vSamples[0].num_entry > fAlignNumEntries && fMatrixAlign[board][ch].minSample.vSamples[i].mean < fMatrixAlign[board][ch].minSample.min_mean) {
+              fMatrixAlign[board][ch].minSample.id_min_sample = i;
+              fMatrixAlign[board][ch].minSample.min_mean = fMatrixAlign[board][ch].minSample.vSamples[i].mean;
+              fMatrixAlign[board][ch].minSample.num_entry = fMatrixAlign[board][ch].minSample.vSamples[i].num_entry;
             }
           }
         }
       }
     }
-  }
 
-  if (fNumCycle == fAlignCycle) {
-    fSummaryAlignShift->Reset();
-    for (int i_mod = 0; i_mod < o2::zdc::NModules; i_mod++) {
-      for (int i_ch = 0; i_ch < o2::zdc::NChPerModule; i_ch++) {
-        if (fMatrixAlign[i_mod][i_ch].minSample.vSamples[0].num_entry > 0) {
-          fSummaryAlign->Fill(fMatrixAlign[i_mod][i_ch].bin, fMatrixAlign[i_mod][i_ch].minSample.id_min_sample);
-          fSummaryAlignShift->Fill(fMatrixAlign[i_mod][i_ch].bin, fMatrixAlign[i_mod][i_ch].minSample.id_min_sample);
+    if (fNumCycle == fAlignCycle) {
+      fSummaryAlignShift->Reset();
+      for (int i_mod = 0; i_mod < o2::zdc::NModules; i_mod++) {
+        for (int i_ch = 0; i_ch < o2::zdc::NChPerModule; i_ch++) {
+          if (fMatrixAlign[i_mod][i_ch].minSample.vSamples[0].num_entry > 0) {
+            fSummaryAlign->Fill(fMatrixAlign[i_mod][i_ch].bin, fMatrixAlign[i_mod][i_ch].minSample.id_min_sample);
+            fSummaryAlignShift->Fill(fMatrixAlign[i_mod][i_ch].bin, fMatrixAlign[i_mod][i_ch].minSample.id_min_sample);
+          }
         }
       }
+      resetAlign();
+      fNumCycle = 0;
     }
-    resetAlign();
-    fNumCycle = 0;
-  }
 
-  // Begin Stefan addiiton
-  if (fBCalignment && (f.bc > (FirstEventBC - 7)) && (f.bc < (FirstEventBC + 6))) {
-    if (f.Hit) {
-      fBCalignment->Fill(fMatrixAlign[f.board][f.ch].bin, f.bc);
-      // fBCalignment->Fill(fMatrixAlign[f.board][f.ch].bin -1, f.bc);
+    // Begin Stefan addiiton
+    if (fBCalignment && (bc > (FirstEventBC - 7)) && (bc < (FirstEventBC + 6))) {
+      if (hit) {
+        fBCalignment->Fill(fMatrixAlign[board][ch].bin, bc);
+      }
     }
-  }
-  // End Stefan addition
+    // End Stefan addition
 
-  if ((f.Alice_0 || f.Auto_0 || f.Alice_1 || f.Auto_1 || f.Alice_2 || f.Auto_2 || f.Alice_3 || f.Auto_3 || f.Auto_m) && fTriggerBits && fTriggerBitsHits) {
-    if (f.Alice_3) {
-      fTriggerBits->Fill(itb, 9);
-      if (f.Hit) {
-        if (f.Hit) {
-          fTriggerBitsHits->Fill(itb, 9);
+    if (fTriggerBits && fTriggerBitsHits) {
+      mBatch.forEachTriggerBin(r, [&](int bin) {
+        mPendingTriggerBits.add(itb, bin);
+        if (hit) {
+          mPendingTriggerBitsHits.add(itb, bin);
         }
-      }
+      });
     }
-    if (f.Alice_2) {
-      fTriggerBits->Fill(itb, 8);
-      if (f.Hit) {
-        fTriggerBitsHits->Fill(itb, 8);
-      }
+    // Bunch
+    if (fNumCycleErr == fErrorCycle) {
+      fSummaryError->Reset();
+      fNumCycleErr = 0;
     }
-    if (f.Alice_1) {
-      fTriggerBits->Fill(itb, 7);
-      if (f.Hit) {
-        fTriggerBitsHits->Fill(itb, 7);
+    if ((fOverBc) && bc >= o2::constants::lhc::LHCMaxBunches) {
+      fOverBc->Fill(itb);
+      if (fSummaryError) {
+        fSummaryError->Fill(fMatrixAlign[board][ch].bin - 1, 2);
       }
     }
-    if (f.Alice_0) {
-      fTriggerBits->Fill(itb, 6);
-      if (f.Hit) {
-        fTriggerBitsHits->Fill(itb, 6);
+    if (level0) {
+      const bool alice0 = triggers & Batch::Alice0;
+      const bool auto0 = triggers & Batch::Auto0;
+      double bc_d = uint32_t(bc / 100);
+      double bc_m = uint32_t(bc % 100);
+      for (int i = 0; i < (int)fMatrixHistoBunch[board][ch].size(); i++) {
+        const auto& condition = fMatrixHistoBunch[board][ch].at(i).condHisto.at(0);
+        if (condition == "A0oT0" || (alice0 && condition == "A0") || (auto0 && condition == "T0")) {
+          mPendingBunch[board][ch][i].add(bc_m, -bc_d);
+        }
       }
     }
-    if (f.Auto_3) {
-      fTriggerBits->Fill(itb, 5);
-      if (f.Hit) {
-        fTriggerBitsHits->Fill(itb, 5);
+    if (bc == last_bc) {
+      // Fill Baseline
+      word16.uns = mBatch.getOffset(r);
+      for (int i = 0; i < (int)fMatrixHistoBaseline[board][ch].size(); i++) {
+        fMatrixHistoBaseline[board][ch].at(i).histo->Fill(word16.sig / 12.);
       }
-    }
-    if (f.Auto_2) {
-      fTriggerBits->Fill(itb, 4);
-      if (f.Hit) {
-        fTriggerBitsHits->Fill(itb, 4);
+
+      // Fill Data Loss
+      if (fDataLoss && mBatch.isDataLoss(r)) {
+        fDataLoss->Fill(board, ch);
+        if (fSummaryError) {
+          fSummaryError->Fill(fMatrixAlign[board][ch].bin - 1, 1);
+        }
       }
-    }
-    if (f.Auto_1) {
-      fTriggerBits->Fill(itb, 3);
-      if (f.Hit) {
-        fTriggerBitsHits->Fill(itb, 3);
+
+      // Fill Bit Error
+      if (fSummaryError && mBatch.isError(r)) {
+        fSummaryError->Fill(fMatrixAlign[board][ch].bin - 1, 0);
       }
-    }
-    if (f.Auto_0) {
-      fTriggerBits->Fill(itb, 2);
-      if (f.Hit) {
-        fTriggerBitsHits->Fill(itb, 2);
+
+      // Fill counts
+      for (int i = 0; i < (int)fMatrixHistoCounts[board][ch].size(); i++) {
+        fMatrixHistoCounts[board][ch].at(i).histo->Fill(mBatch.getHits(r) & 0xfff);
       }
-    }
-    if (f.Auto_m) {
-      fTriggerBits->Fill(itb, 1);
-      if (f.Hit) {
-        fTriggerBitsHits->Fill(itb, 1);
+
+      // Fill counts for trending
+      for (int i = 0; i < (int)fMatrixHistoCounts_a[board][ch].size(); i++) {
+        fMatrixHistoCounts_a[board][ch].at(i).histo->Fill(mBatch.getHits(r) & 0xfff);
       }
+      updateSummary[board][ch] = true;
     }
   }
-  if (!(f.Alice_3 || f.Alice_2 || f.Alice_1 || f.Alice_0 || f.Alice_1 || f.Auto_3 || f.Auto_2 || f.Auto_1 || f.Auto_0 || f.Auto_m)) {
-    if (fTriggerBits && fTriggerBitsHits) {
-      fTriggerBits->Fill(itb, 0);
-      if (f.Hit)
-        fTriggerBitsHits->Fill(itb, 0);
-    }
-  }
-  // Bunch
-  if (fNumCycleErr == fErrorCycle) {
-    fSummaryError->Reset();
-    fNumCycleErr = 0;
-  }
-  if ((fOverBc) && f.bc >= o2::constants::lhc::LHCMaxBunches) {
-    fOverBc->Fill(itb);
-    if (fSummaryError) {
-      fSummaryError->Fill(fMatrixAlign[f.board][f.ch].bin - 1, 2);
-    }
-  }
-  if (f.Alice_0 || f.Auto_0) {
-    double bc_d = uint32_t(f.bc / 100);
-    double bc_m = uint32_t(f.bc % 100);
-    for (int i = 0; i < (int)fMatrixHistoBunch[f.board][f.ch].size(); i++) {
-      if (fMatrixHistoBunch[f.board][f.ch].at(i).condHisto.at(0) == "A0oT0") {
-        fMatrixHistoBunch[f.board][f.ch].at(i).histo->Fill(bc_m, -bc_d);
-      }
-      if (f.Alice_0 && fMatrixHistoBunch[f.board][f.ch].at(i).condHisto.at(0) == "A0") {
-        fMatrixHistoBunch[f.board][f.ch].at(i).histo->Fill(bc_m, -bc_d);
+  mBatch.clear();
+
+  mPendingFireChannel.flush(fFireChannel);
+  mPendingTrasmChannel.flush(fTrasmChannel);
+  mPendingTriggerBits.flush(fTriggerBits);
+  mPendingTriggerBitsHits.flush(fTriggerBitsHits);
+  for (int im = 0; im < o2::zdc::NModules; im++) {
+    for (int ic = 0; ic < o2::zdc::NChPerModule; ic++) {
+      for (size_t j = 0; j < mPendingSignal[im][ic].size(); j++) {
+        mPendingSignal[im][ic][j].flush(fMatrixHistoSignal[im][ic].at(j).histo);
       }
-      if (f.Auto_0 && fMatrixHistoBunch[f.board][f.ch].at(i).condHisto.at(0) == "T0") {
-        fMatrixHistoBunch[f.board][f.ch].at(i).histo->Fill(bc_m, -bc_d);
+      for (size_t j = 0; j < mPendingBunch[im][ic].size(); j++) {
+        mPendingBunch[im][ic][j].flush(fMatrixHistoBunch[im][ic].at(j).histo);
       }
-    }
-  }
-  if (f.bc == last_bc) {
-    // Fill Baseline
-    // int32_t offset =(int32_t) f.offset;
-    // if (offset > 32768) offset = offset - 32768;
-    word16.uns = f.offset;
-    // if (word16.sig < 0) word16.sig = word16.sig + 32768;
-    for (int i = 0; i < (int)fMatrixHistoBaseline[f.board][f.ch].size(); i++) {
-      fMatrixHistoBaseline[f.board][f.ch].at(i).histo->Fill(word16.sig / 12.);
-    }
 
-    // Fill Data Loss
-    if (fDataLoss && (f.dLoss)) {
-      fDataLoss->Fill(f.board, f.ch);
-      if (fSummaryError) {
-        fSummaryError->Fill(fMatrixAlign[f.board][f.ch].bin - 1, 1);
+      // Fill Summary, once per TF with the final means
+      if (!updateSummary[im][ic] || fMapBinNameIdSummaryHisto.find(getNameChannel(im, ic)) == fMapBinNameIdSummaryHisto.end()) {
+        continue;
       }
-    }
-
-    // Fill Bit Error
-    if (fSummaryError && (f.error)) {
-      fSummaryError->Fill(fMatrixAlign[f.board][f.ch].bin - 1, 0);
-    }
-
-    // Fill counts
-    for (int i = 0; i < (int)fMatrixHistoCounts[f.board][f.ch].size(); i++) {
-      fMatrixHistoCounts[f.board][f.ch].at(i).histo->Fill(f.hits & 0xfff);
-    }
-
-    // Fill counts for trending
-    for (int i = 0; i < (int)fMatrixHistoCounts_a[f.board][f.ch].size(); i++) {
-      fMatrixHistoCounts_a[f.board][f.ch].at(i).histo->Fill(f.hits & 0xfff);
-    }
-
-    // Fill Summary
-    if (fMapBinNameIdSummaryHisto.find(getNameChannel(f.board, f.ch)) != fMapBinNameIdSummaryHisto.end()) {
-      if (fMatrixHistoBaseline[f.board][f.ch].size() > 0) {
-        if (fSummaryPedestal && fMatrixHistoBaseline[f.board][f.ch].at(0).histo) {
-          fSummaryPedestal->SetBinContent(fMapBinNameIdSummaryHisto[getNameChannel(f.board, f.ch)], fMatrixHistoBaseline[f.board][f.ch].at(0).histo->GetMean());
-          fSummaryPedestal->SetBinError(fMapBinNameIdSummaryHisto[getNameChannel(f.board, f.ch)], fMatrixHistoBaseline[f.board][f.ch].at(0).histo->GetMeanError());
+      if (fMatrixHistoBaseline[im][ic].size() > 0) {
+        int bin = fMapBinNameIdSummaryHisto[getNameChannel(im, ic)];
+        if (fSummaryPedestal && fMatrixHistoBaseline[im][ic].at(0).histo) {
+          fSummaryPedestal->SetBinContent(bin, fMatrixHistoBaseline[im][ic].at(0).histo->GetMean());
+          fSummaryPedestal->SetBinError(bin, fMatrixHistoBaseline[im][ic].at(0).histo->GetMeanError());
         }
-        if (fSummaryRate && fMatrixHistoBaseline[f.board][f.ch].at(0).histo) {
-          fSummaryRate->SetBinContent(fMapBinNameIdSummaryHisto[getNameChannel(f.board, f.ch)], fMatrixHistoCounts[f.board][f.ch].at(0).histo->GetMean() * 11.2455);
-          fSummaryRate->SetBinError(fMapBinNameIdSummaryHisto[getNameChannel(f.board, f.ch)], fMatrixHistoCounts[f.board][f.ch].at(0).histo->GetMeanError());
+        if (fSummaryRate && fMatrixHistoBaseline[im][ic].at(0).histo) {
+          fSummaryRate->SetBinContent(bin, fMatrixHistoCounts[im][ic].at(0).histo->GetMean() * 11.2455);
+          fSummaryRate->SetBinError(bin, fMatrixHistoCounts[im][ic].at(0).histo->GetMeanError());
         }
       }
     }
   }
-  return 0;
 }
 
 int ZDCRawDataTask::process(const o2::zdc::EventData& ev)
@@ -875,6 +823,7 @@ int ZDCRawDataTask::process(const o2::zdc::EventData& ev)
       }
     }
   }
+  processBatch();
   return 0;
 }
 
@@ -0,0 +1,337 @@
+// Copyright 2019-2022 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file    testZDCRawDataBatch.cxx
+///
+
+#include "ZDC/ZDCRawDataBatch.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <utility>
+#include <vector>
+
+#define BOOST_TEST_MODULE ZDCRawDataBatch test
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+using namespace o2::quality_control_modules::zdc;
+
+namespace
+{
+constexpr size_t WordSize = 10; // GBT words in the packed format
+
+struct Page {
+  size_t begin;
+  size_t size;
+};
+
+// pages of mostly idle GBT words, with a few channel records (three non idle words) here and there
+std::vector<uint8_t> makePayload(size_t nWords, std::mt19937& generator)
+{
+  std::vector<uint8_t> payload(nWords * WordSize, 0xff);
+  std::uniform_int_distribution<int> record(0, 49);
+  std::uniform_int_distribution<int> byte(0, 255);
+  for (size_t word = 0; word + 3 <= nWords; word++) {
+    if (record(generator) == 0) {
+      for (size_t i = word * WordSize; i < (word + 3) * WordSize; i++) {
+        payload[i] = byte(generator);
+      }
+      payload[word * WordSize] &= 0xfe; // at least one bit not set
+      word += 2;
+    }
+  }
+  return payload;
+}
+
+// the word by word scan done before by ZDCRawDataTask
+std::vector<size_t> scanWordByWord(const uint8_t* payload, size_t size)
+{
+  std::vector<size_t> words;
+  for (size_t ip = 0; ip + WordSize <= size; ip += WordSize) {
+    auto gbtw = reinterpret_cast<const uint32_t*>(&payload[ip]);
+    if (gbtw[0] != 0xffffffff || gbtw[1] != 0xffffffff || (gbtw[2] & 0xffff) != 0xffff) {
+      words.push_back(ip);
+    }
+  }
+  return words;
+}
+
+std::vector<size_t> scanInBulk(const uint8_t* payload, size_t size)
+{
+  std::vector<size_t> words;
+  forEachNonIdleWord(payload, size, WordSize, [&](const uint8_t* word) { words.push_back(word - payload); });
+  return words;
+}
+
+// the payloads of the pages of a raw file, using the offset to the next page and the memory size of each RDH
+std::vector<Page> findPages(const std::vector<uint8_t>& file)
+{
+  std::vector<Page> pages;
+  for (size_t position = 0; position + 16 <= file.size();) {
+    size_t headerSize = file[position + 1];
+    size_t offsetToNext = file[position + 8] | (file[position + 9] << 8);
+    size_t memorySize = file[position + 10] | (file[position + 11] << 8);
+    if (offsetToNext == 0 || headerSize > memorySize || position + memorySize > file.size()) {
+      break;
+    }
+    pages.push_back({ position + headerSize, memorySize - headerSize });
+    position += offsetToNext;
+  }
+  return pages;
+}
+
+using Entries = std::vector<std::pair<double, double>>;
+
+o2::zdc::EventChData makeRecord(unsigned triggers, bool hit, const unsigned (&samples)[ChannelRecordBatch::NSamples])
+{
+  o2::zdc::EventChData record{};
+  auto& f = record.f;
+  f.board = 5;
+  f.ch = 2;
+  f.bc = 3563;
+  f.offset = 0x8123;
+  f.hits = 0xabc;
+  f.Hit = hit;
+  f.Auto_m = (triggers >> 0) & 1;
+  f.Auto_0 = (triggers >> 1) & 1;
+  f.Auto_1 = (triggers >> 2) & 1;
+  f.Auto_2 = (triggers >> 3) & 1;
+  f.Auto_3 = (triggers >> 4) & 1;
+  f.Alice_0 = (triggers >> 5) & 1;
+  f.Alice_1 = (triggers >> 6) & 1;
+  f.Alice_2 = (triggers >> 7) & 1;
+  f.Alice_3 = (triggers >> 8) & 1;
+  f.s00 = samples[0];
+  f.s01 = samples[1];
+  f.s02 = samples[2];
+  f.s03 = samples[3];
+  f.s04 = samples[4];
+  f.s05 = samples[5];
+  f.s06 = samples[6];
+  f.s07 = samples[7];
+  f.s08 = samples[8];
+  f.s09 = samples[9];
+  f.s10 = samples[10];
+  f.s11 = samples[11];
+  return record;
+}
+
+// the bins of the trigger bit histograms filled by the per record ZDCRawDataTask::process()
+std::vector<int> referenceTriggerBins(const o2::zdc::EventChData& record)
+{
+  const auto& f = record.f;
+  std::vector<int> bins;
+  if (f.Alice_0 || f.Auto_0 || f.Alice_1 || f.Auto_1 || f.Alice_2 || f.Auto_2 || f.Alice_3 || f.Auto_3 || f.Auto_m) {
+    const unsigned bits[] = { f.Alice_3, f.Alice_2, f.Alice_1, f.Alice_0, f.Auto_3, f.Auto_2, f.Auto_1, f.Auto_0, f.Auto_m };
+    for (int i = 0; i < 9; i++) {
+      if (bits[i]) {
+        bins.push_back(9 - i);
+      }
+    }
+  } else {
+    bins.push_back(0);
+  }
+  return bins;
+}
+
+// the entries of a signal histogram ("AoT") filled by the per record ZDCRawDataTask::process()
+Entries referenceSignalEntries(const o2::zdc::EventChData& record)
+{
+  const auto& f = record.f;
+  const unsigned us[12] = { f.s00, f.s01, f.s02, f.s03, f.s04, f.s05, f.s06, f.s07, f.s08, f.s09, f.s10, f.s11 };
+  Entries entries;
+  if (f.Alice_0 || f.Auto_0 || f.Alice_1 || f.Auto_1 || f.Alice_2 || f.Auto_2 || f.Alice_3 || f.Auto_3) {
+    for (int32_t i = 0; i < 12; i++) {
+      int16_t s = us[i] > o2::zdc::ADCMax ? us[i] - o2::zdc::ADCRange : us[i];
+      if (f.Alice_3 || f.Auto_3) {
+        entries.emplace_back(i - 36., double(s));
+      }
+      if (f.Alice_2 || f.Auto_2) {
+        entries.emplace_back(i - 24., double(s));
+      }
+      if (f.Alice_1 || f.Auto_1) {
+        entries.emplace_back(i - 12., double(s));
+      }
+      if (f.Alice_0 || f.Auto_0) {
+        entries.emplace_back(i + 0., double(s));
+      }
+    }
+  }
+  return entries;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_findNonIdleByte)
+{
+  std::vector<uint8_t> data(100, 0xff);
+  BOOST_CHECK_EQUAL(findNonIdleByte(data.data(), 0, data.size()), data.size());
+  data[70] = 0x7f;
+  BOOST_CHECK_EQUAL(findNonIdleByte(data.data(), 0, data.size()), 70);
+  BOOST_CHECK_EQUAL(findNonIdleByte(data.data(), 70, data.size()), 70);
+  BOOST_CHECK_EQUAL(findNonIdleByte(data.data(), 71, data.size()), data.size());
+  data[3] = 0;
+  BOOST_CHECK_EQUAL(findNonIdleByte(data.data(), 0, data.size()), 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_forEachNonIdleWord_same_as_word_by_word)
+{
+  std::mt19937 generator(42);
+  for (size_t nWords : { 0, 1, 3, 10, 100, 819 }) {
+    auto payload = makePayload(nWords, generator);
+    // the last word of a page can be incomplete
+    for (size_t size : { payload.size(), payload.size() > 4 ? payload.size() - 4 : 0 }) {
+      // some room after the payload, since the word by word scan reads 12 bytes per word
+      std::vector<uint8_t> buffer(payload.begin(), payload.begin() + size);
+      buffer.resize(size + 16, 0xff);
+      auto expected = scanWordByWord(buffer.data(), size);
+      auto result = scanInBulk(buffer.data(), size);
+      BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), expected.begin(), expected.end());
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_ChannelRecordBatch_decoding)
+{
+  const unsigned samples[ChannelRecordBatch::NSamples] = { 0, 1, 2047, 2048, 4095, 3000, 100, 0xfff, 2049, 5, 1000, 2046 };
+  const int16_t expected[ChannelRecordBatch::NSamples] = { 0, 1, 2047, -2048, -1, -1096, 100, -1, -2047, 5, 1000, 2046 };
+  ChannelRecordBatch batch;
+  batch.add(makeRecord(ChannelRecordBatch::Alice3 | ChannelRecordBatch::AutoM, true, samples));
+  BOOST_REQUIRE_EQUAL(batch.size(), 1);
+  BOOST_CHECK_EQUAL(batch.getBoard(0), 5);
+  BOOST_CHECK_EQUAL(batch.getChannel(0), 2);
+  BOOST_CHECK_EQUAL(batch.getBc(0), 3563);
+  BOOST_CHECK_EQUAL(batch.getOffset(0), 0x8123);
+  BOOST_CHECK_EQUAL(batch.getHits(0), 0xabc);
+  BOOST_CHECK_EQUAL(batch.getTriggers(0), ChannelRecordBatch::Alice3 | ChannelRecordBatch::AutoM);
+  BOOST_CHECK(batch.isHit(0));
+  BOOST_CHECK(!batch.isDataLoss(0));
+  BOOST_CHECK(!batch.isError(0));
+  // the samples above ADCMax are negative
+  BOOST_CHECK_EQUAL_COLLECTIONS(batch.getSamples(0), batch.getSamples(0) + ChannelRecordBatch::NSamples, expected, expected + ChannelRecordBatch::NSamples);
+
+  batch.clear();
+  BOOST_CHECK_EQUAL(batch.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_ChannelRecordBatch_trigger_bins)
+{
+  const unsigned samples[ChannelRecordBatch::NSamples] = {};
+  const std::pair<unsigned, int> bitToBin[] = {
+    { ChannelRecordBatch::Alice3, 9 }, { ChannelRecordBatch::Alice2, 8 }, { ChannelRecordBatch::Alice1, 7 },
+    { ChannelRecordBatch::Alice0, 6 }, { ChannelRecordBatch::Auto3, 5 }, { ChannelRecordBatch::Auto2, 4 },
+    { ChannelRecordBatch::Auto1, 3 }, { ChannelRecordBatch::Auto0, 2 }, { ChannelRecordBatch::AutoM, 1 }, { 0, 0 }
+  };
+  ChannelRecordBatch batch;
+  for (const auto& [bit, bin] : bitToBin) {
+    batch.add(makeRecord(bit, false, samples));
+    std::vector<int> bins;
+    batch.forEachTriggerBin(batch.size() - 1, [&](int b) { bins.push_back(b); });
+    BOOST_REQUIRE_EQUAL(bins.size(), 1);
+    BOOST_CHECK_EQUAL(bins[0], bin);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_ChannelRecordBatch_same_as_per_record)
+{
+  std::mt19937 generator(3);
+  std::uniform_int_distribution<unsigned> sample(0, 4095);
+  ChannelRecordBatch batch;
+  std::vector<o2::zdc::EventChData> records;
+  // every combination of trigger bits, with and without hit
+  for (unsigned triggers = 0; triggers < (1u << ChannelRecordBatch::NTriggers); triggers++) {
+    for (bool hit : { false, true }) {
+      unsigned samples[ChannelRecordBatch::NSamples];
+      for (auto& s : samples) {
+        s = sample(generator);
+      }
+      records.push_back(makeRecord(triggers, hit, samples));
+      batch.add(records.back());
+    }
+  }
+
+  BOOST_REQUIRE_EQUAL(batch.size(), records.size());
+  for (size_t r = 0; r < records.size(); r++) {
+    BOOST_TEST_CONTEXT("record " << r)
+    {
+      BOOST_CHECK_EQUAL(batch.isHit(r), records[r].f.Hit == 1);
+
+      std::vector<int> bins;
+      batch.forEachTriggerBin(r, [&](int bin) { bins.push_back(bin); });
+      auto expectedBins = referenceTriggerBins(records[r]);
+      BOOST_CHECK_EQUAL_COLLECTIONS(bins.begin(), bins.end(), expectedBins.begin(), expectedBins.end());
+
+      Entries entries;
+      batch.forEachSignalEntry(r, [&](double x, double y) { entries.emplace_back(x, y); });
+      auto expectedEntries = referenceSignalEntries(records[r]);
+      BOOST_REQUIRE_EQUAL(entries.size(), expectedEntries.size());
+      for (size_t i = 0; i < entries.size(); i++) {
+        BOOST_CHECK_EQUAL(entries[i].first, expectedEntries[i].first);
+        BOOST_CHECK_EQUAL(entries[i].second, expectedEntries[i].second);
+      }
+    }
+  }
+}
+
+// Run with "--run_test=benchmark_scan -- file.raw" to use the pages of a recorded raw file
+BOOST_AUTO_TEST_CASE(benchmark_scan, *boost::unit_test::disabled())
+{
+  std::vector<uint8_t> file;
+  std::vector<Page> pages;
+  auto& suite = boost::unit_test::framework::master_test_suite();
+  if (suite.argc > 1) {
+    std::ifstream input(suite.argv[1], std::ios::binary);
+    file.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    pages = findPages(file);
+  } else {
+    std::mt19937 generator(7);
+    const size_t wordsPerPage = 819; // 8 kB pages
+    for (int page = 0; page < 2000; page++) {
+      auto payload = makePayload(wordsPerPage, generator);
+      pages.push_back({ file.size(), payload.size() });
+      file.insert(file.end(), payload.begin(), payload.end());
+    }
+  }
+  file.resize(file.size() + 16, 0xff);
+  BOOST_REQUIRE(!pages.empty());
+
+  const int repetitions = 20;
+  auto measure = [&](const char* name, auto&& scan) {
+    size_t nWords = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; i++) {
+      for (const auto& page : pages) {
+        nWords += scan(file.data() + page.begin, page.size);
+      }
+    }
+    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << repetitions * file.size() / duration.count() / 1e9 << " GB/s (" << nWords / repetitions << " words)" << std::endl;
+  };
+  measure("word by word", [](const uint8_t* payload, size_t size) {
+    size_t nWords = 0;
+    for (size_t ip = 0; ip + WordSize <= size; ip += WordSize) {
+      auto gbtw = reinterpret_cast<const uint32_t*>(&payload[ip]);
+      nWords += gbtw[0] != 0xffffffff || gbtw[1] != 0xffffffff || (gbtw[2] & 0xffff) != 0xffff;
+    }
+    return nWords;
+  });
+  measure("in bulk", [](const uint8_t* payload, size_t size) {
+    size_t nWords = 0;
+    forEachNonIdleWord(payload, size, WordSize, [&](const uint8_t*) { nWords++; });
+    return nWords;
+  });
+}